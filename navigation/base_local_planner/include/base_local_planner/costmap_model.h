@@ -73,24 +73,39 @@ namespace base_local_planner {
       virtual double footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint,
           double inscribed_radius, double circumscribed_radius);
 
+      /**
+       * @brief  Checks a footprint given in robot coordinates at a pose, orienting each
+       * point as it goes instead of building the oriented footprint first
+       * @param  x The x position of the robot in world coordinates
+       * @param  y The y position of the robot in world coordinates
+       * @param  theta The orientation of the robot
+       * @param  footprint_spec The specification of the footprint of the robot in robot coordinates
+       * @param  inscribed_radius Not needed for the costmap
+       * @param  circumscribed_radius Not needed for the costmap
+       * @return Positive if all the points lie outside the footprint, negative otherwise
+       */
+      virtual double footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+          double inscribed_radius = 0.0, double circumscribed_radius = 0.0);
+
     private:
       /**
-       * @brief  Rasterizes a line in the costmap grid and checks for collisions
+       * @brief  Checks a footprint at (x, y) whose points map to world coordinates as
+       * (origin_x + px * cos_th - py * sin_th, origin_y + px * sin_th + py * cos_th)
+       */
+      double footprintCost(double x, double y, double origin_x, double origin_y, double cos_th, double sin_th,
+          const std::vector<geometry_msgs::Point>& footprint);
+
+      /**
+       * @brief  Rasterizes a line in the costmap grid and finds the highest cost on it
        * @param x0 The x position of the first cell in grid coordinates
        * @param y0 The y position of the first cell in grid coordinates
        * @param x1 The x position of the second cell in grid coordinates
        * @param y1 The y position of the second cell in grid coordinates
-       * @return A positive cost for a legal line... negative otherwise
-       */
-      double lineCost(int x0, int x1, int y0, int y1);
-
-      /**
-       * @brief  Checks the cost of a point in the costmap
-       * @param x The x position of the point in cell coordinates 
-       * @param y The y position of the point in cell coordinates 
-       * @return A positive cost for a legal point... negative otherwise
+       * @param skip_first Leave out the first cell, when it has been looked at already
+       * @param skip_last Leave out the last cell, when it has been looked at already
+       * @return The highest cost of the cells of the line, 0 if it has none
        */
-      double pointCost(int x, int y);
+      unsigned char lineCost(int x0, int x1, int y0, int y1, bool skip_first, bool skip_last) const;
 
       const costmap_2d::Costmap2D& costmap_; ///< @brief Allows access of costmap obstacle information
 
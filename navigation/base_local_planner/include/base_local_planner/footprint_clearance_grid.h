@@ -0,0 +1,92 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef FOOTPRINT_CLEARANCE_GRID_H_
+#define FOOTPRINT_CLEARANCE_GRID_H_
+
+#include <vector>
+#include <costmap_2d/costmap_2d.h>
+
+namespace base_local_planner {
+
+/**
+ * @class FootprintClearanceGrid
+ * @brief Summed-area tables over a snapshot of a costmap, telling in four lookups
+ * whether a footprint of a given circumscribed radius placed at a point can touch
+ * a cell that makes CostmapModel reject it (LETHAL_OBSTACLE or NO_INFORMATION),
+ * or any cell with a cost at all.
+ *
+ * Both checks are conservative: they look at the square of cells around the
+ * point that contains every cell a rasterized footprint edge can cover, and fail
+ * if that square leaves the map. When they fail, the footprint has to be checked
+ * the usual way.
+ */
+class FootprintClearanceGrid {
+public:
+  FootprintClearanceGrid();
+
+  /**
+   * rebuild the tables from the current costmap contents
+   */
+  void update(const costmap_2d::Costmap2D& costmap);
+
+  /**
+   * true if no lethal or unknown cell is within reach of a footprint at (wx, wy)
+   */
+  bool isClear(double wx, double wy, double circumscribed_radius) const {
+    return countCells(lethal_counts_, wx, wy, circumscribed_radius) == 0;
+  }
+
+  /**
+   * true if every cell within reach of a footprint at (wx, wy) is FREE_SPACE
+   */
+  bool isFreeSpace(double wx, double wy, double circumscribed_radius) const {
+    return countCells(cost_counts_, wx, wy, circumscribed_radius) == 0;
+  }
+
+private:
+  /**
+   * number of counted cells in the square around (wx, wy), or -1 if the square is not fully on the map
+   */
+  int countCells(const std::vector<unsigned int>& counts, double wx, double wy, double radius) const;
+
+  unsigned int size_x_, size_y_;
+  double origin_x_, origin_y_, resolution_;
+  // (size_x_ + 1) * (size_y_ + 1) prefix sums, the first row and column are zero
+  std::vector<unsigned int> lethal_counts_, cost_counts_;
+};
+
+} /* namespace base_local_planner */
+#endif /* FOOTPRINT_CLEARANCE_GRID_H_ */
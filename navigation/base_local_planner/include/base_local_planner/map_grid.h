@@ -145,14 +145,6 @@ namespace base_local_planner{
         return map_.size() + 1;
       }
 
-      /**
-       * @brief  Used to update the distance of a cell in path distance computation
-       * @param  current_cell The cell we're currently in 
-       * @param  check_cell The cell to be updated
-       */
-      inline bool updatePathCell(MapCell* current_cell, MapCell* check_cell,
-          const costmap_2d::Costmap2D& costmap);
-
       /**
        * increase global plan resolution to match that of the costmap by adding points linearly between global plan points
        * This is necessary where global planners produce plans with few points.
@@ -192,8 +184,32 @@ namespace base_local_planner{
 
     private:
 
+      /**
+       * @brief  Used to update the distance of a cell in path distance computation
+       * @param  new_target_dist The distance of the cell we're currently in plus one
+       * @param  check_index The index of the cell to be updated
+       * @param  costmap The costmap the distances are computed on
+       * @param  costs The char map of that costmap
+       * @return True if the cell was reached and has to be expanded
+       */
+      inline bool updatePathCell(double new_target_dist, unsigned int check_index,
+          const costmap_2d::Costmap2D& costmap, const unsigned char* costs);
+
+      /**
+       * @brief  Returns the global plan with its resolution adjusted, reusing the previous result if the plan did not move
+       * Only the positions of the returned poses are meant to be used.
+       */
+      const std::vector<geometry_msgs::PoseStamped>& getAdjustedPlan(
+          const std::vector<geometry_msgs::PoseStamped>& global_plan, double resolution);
+
       std::vector<MapCell> map_; ///< @brief Storage for the MapCells
 
+      std::vector<unsigned int> wave_; ///< @brief Cell indices in the order the distance propagation reaches them
+
+      std::vector<geometry_msgs::PoseStamped> cached_plan_; ///< @brief The plan adjusted_plan_ was computed from
+      std::vector<geometry_msgs::PoseStamped> adjusted_plan_; ///< @brief cached_plan_ at the resolution of the costmap
+      double cached_resolution_; ///< @brief The resolution adjusted_plan_ was computed with
+
   };
 };
 
@@ -93,12 +93,21 @@ public:
    * Default is true. */
   void setStopOnFailure(bool stop_on_failure) {stop_on_failure_ = stop_on_failure;}
 
+  /** @brief If true, points are scored by bilinear interpolation between the
+   * distances of the four cells around them, so that the score changes smoothly
+   * with the trajectory. Next to obstacles the cell value is used.
+   *
+   * Default is false. */
+  void setInterpolation(bool interpolate) {interpolate_ = interpolate;}
+
   /**
    * propagate distances
    */
   bool prepare();
 
   double scoreTrajectory(Trajectory &traj);
+  double scoreTrajectoryBounded(Trajectory &traj, double max_cost);
+  bool isThreadSafe() {return true;};
 
   /**
    * return a value that indicates cell is in obstacle
@@ -119,6 +128,17 @@ public:
   double getCellCosts(unsigned int cx, unsigned int cy);
 
 private:
+  /**
+   * distance of the cell under a trajectory point, or a negative failure code
+   */
+  double scorePoint(Trajectory &traj, unsigned int index);
+
+  /**
+   * distance at a world position interpolated between the surrounding cell centers,
+   * or cell_dist if one of them is not reachable
+   */
+  double interpolateDistance(double wx, double wy, double cell_dist);
+
   std::vector<geometry_msgs::PoseStamped> target_poses_;
   costmap_2d::Costmap2D* costmap_;
 
@@ -133,6 +153,7 @@ private:
   // if true, we look for a suitable local goal on path, else we use the full path for costs
   bool is_local_goal_function_;
   bool stop_on_failure_;
+  bool interpolate_;
 };
 
 } /* namespace base_local_planner */
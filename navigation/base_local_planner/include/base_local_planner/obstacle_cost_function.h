@@ -58,10 +58,19 @@ public:
 
   bool prepare();
   double scoreTrajectory(Trajectory &traj);
+  bool isThreadSafe() {return true;};
 
   void setParams(double max_trans_vel, double max_scaling_factor, double scaling_speed);
   void setFootprint(std::vector<geometry_msgs::Point> footprint_spec);
 
+  /** @brief If true, the cost is interpolated bilinearly between the costs the
+   * footprint would have at the centers of the four cells around the last point,
+   * so that the score changes smoothly with the trajectory. Where one of them is
+   * in collision the cell value is used.
+   *
+   * Default is false. */
+  void setInterpolation(bool interpolate) {interpolate_ = interpolate;}
+
   // helper functions, made static for easy unit testing
   static double getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor);
   static double footprintCost(
@@ -69,17 +78,24 @@ public:
       const double& y,
       const double& th,
       double scale,
-      std::vector<geometry_msgs::Point> footprint_spec,
+      const std::vector<geometry_msgs::Point>& footprint_spec,
       costmap_2d::Costmap2D* costmap,
       base_local_planner::WorldModel* world_model);
 
 private:
+  /**
+   * cost of the footprint at a world position interpolated between the surrounding
+   * cell centers, or cell_cost if one of them is not legal
+   */
+  double interpolateCost(double wx, double wy, double th, double scale, double cell_cost);
+
   costmap_2d::Costmap2D* costmap_;
   std::vector<geometry_msgs::Point> footprint_spec_;
   base_local_planner::WorldModel* world_model_;
   double max_trans_vel_;
   //footprint scaling with velocity;
   double max_scaling_factor_, scaling_speed_;
+  bool interpolate_;
 };
 
 } /* namespace base_local_planner */
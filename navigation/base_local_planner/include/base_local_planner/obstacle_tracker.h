@@ -0,0 +1,166 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef OBSTACLE_TRACKER_H_
+#define OBSTACLE_TRACKER_H_
+
+#include <vector>
+#include <map>
+#include <string>
+#include <costmap_2d/observation.h>
+
+namespace base_local_planner {
+
+/**
+ * @brief A blob of obstacle points followed over consecutive observations
+ */
+struct TrackedObstacle {
+  double x, y; ///< @brief Center of the blob, in the frame of the observations
+  double vx, vy; ///< @brief Estimated velocity in m/s
+  double radius; ///< @brief Radius of a circle around the center that covers the blob
+  double last_seen; ///< @brief Stamp of the last observation that matched the blob, in seconds
+  unsigned int hits; ///< @brief Number of observations that matched the blob
+  unsigned int id;
+};
+
+/**
+ * @class ObstacleTracker
+ * @brief Clusters the points of consecutive observations into blobs and
+ * follows them over time to estimate how they move.
+ *
+ * Points are clustered by connecting occupied cells of a grid with a
+ * resolution of cluster_tolerance. Clusters larger than max_cluster_size,
+ * like walls, are static as far as the tracker is concerned and left to
+ * the costmap. Each remaining cluster is associated with the nearest
+ * predicted track within association_distance, and an alpha-beta filter
+ * updates the position and velocity of the track. Tracks that are not seen
+ * for max_age seconds are dropped, and at most max_tracks are kept, the
+ * ones closest to the sensor first.
+ */
+class ObstacleTracker {
+public:
+  ObstacleTracker();
+
+  void setParams(double cluster_tolerance, double max_cluster_size, unsigned int min_cluster_points,
+      double association_distance, double max_age, unsigned int max_tracks);
+
+  /**
+   * @brief Feed the observations of a cycle to the tracker.
+   * Observations with a stamp that is not newer than the last one seen from
+   * their topic are skipped, so the same buffers can be passed in every
+   * cycle, and a sensor that lags behind another is not lost.
+   * @return True if there was new data
+   */
+  bool update(const std::vector<costmap_2d::Observation>& observations);
+
+  /**
+   * @brief Tracks that have been seen at least min_hits times and move at
+   * least min_speed, extrapolated to stamp
+   */
+  void getMovingTracks(double stamp, double min_speed, unsigned int min_hits, std::vector<TrackedObstacle>& tracks) const;
+
+  const std::vector<TrackedObstacle>& getTracks() const {
+    return tracks_;
+  }
+
+  /**
+   * @brief Stamp of the newest observation seen, in seconds
+   */
+  double getLastStamp() const {
+    return last_stamp_;
+  }
+
+  void reset();
+
+private:
+  struct Cell {
+    int cx, cy;
+    unsigned int parent;
+    unsigned int count;
+    double sum_x, sum_y;
+    double min_x, min_y, max_x, max_y;
+    double stamp;
+  };
+
+  struct Cluster {
+    unsigned int count;
+    double sum_x, sum_y;
+    double min_x, min_y, max_x, max_y;
+    double stamp; // of the newest observation with points in the cluster
+    double x, y;
+    double radius;
+    double sensor_dist_sq;
+  };
+
+  struct Match {
+    double dist_sq;
+    unsigned int track, cluster;
+    bool operator<(const Match& other) const {
+      return dist_sq < other.dist_sq;
+    }
+  };
+
+  void addPoint(double x, double y, double stamp);
+  unsigned int findCell(int cx, int cy) const;
+  unsigned int findRoot(unsigned int cell);
+  void buildClusters(double sensor_x, double sensor_y);
+  void associate(double stamp);
+
+  double cluster_tolerance_, max_cluster_size_;
+  unsigned int min_cluster_points_;
+  double association_distance_, max_age_;
+  unsigned int max_tracks_;
+  // fixed gains of the alpha-beta filter
+  double alpha_, beta_;
+
+  double last_stamp_;
+  std::map<std::string, double> topic_stamps_; // newest stamp seen from each topic
+  unsigned int next_id_;
+  std::vector<TrackedObstacle> tracks_;
+
+  // scratch space of an update, kept to avoid allocations
+  std::vector<Cell> cells_;
+  std::vector<unsigned int> cell_table_; // open addressing hash of cell indices, UINT_MAX for empty slots
+  unsigned int table_mask_;
+  std::vector<Cluster> clusters_;
+  std::vector<unsigned int> cluster_of_root_;
+  std::vector<Match> matches_;
+  std::vector<bool> track_matched_, cluster_matched_;
+  std::vector<bool> is_new_;
+  std::vector<unsigned int> new_clusters_;
+};
+
+} /* namespace base_local_planner */
+#endif /* OBSTACLE_TRACKER_H_ */
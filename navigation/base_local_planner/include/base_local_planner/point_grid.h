@@ -37,7 +37,6 @@
 #ifndef POINT_GRID_H_
 #define POINT_GRID_H_
 #include <vector>
-#include <list>
 #include <cfloat>
 #include <geometry_msgs/Point.h>
 #include <costmap_2d/observation.h>
@@ -54,6 +53,11 @@ namespace base_local_planner {
    * stores points binned into a grid and performs point-in-polygon checks when
    * necessary to determine the legality of a footprint at a given
    * position/orientation.
+   *
+   * Points are kept in one contiguous array ordered by cell, with an offset
+   * and a live count per cell. New points are staged and merged into that
+   * array in a single pass before the next query or removal, so a whole
+   * observation can be inserted without reshuffling the grid per point.
    */
   class PointGrid : public WorldModel {
     public:
@@ -79,9 +83,9 @@ namespace base_local_planner {
        * @brief  Returns the points that lie within the cells contained in the specified range. Some of these points may be outside the range itself.
        * @param  lower_left The lower left corner of the range search 
        * @param  upper_right The upper right corner of the range search
-       * @param points A vector of pointers to lists of the relevant points
+       * @param cells The indices of the non-empty cells in the range, to be filled in
        */
-      void getPointsInRange(const geometry_msgs::Point& lower_left, const geometry_msgs::Point& upper_right, std::vector< std::list<pcl::PointXYZ>* >& points);
+      void getPointsInRange(const geometry_msgs::Point& lower_left, const geometry_msgs::Point& upper_right, std::vector<unsigned int>& cells);
 
       /**
        * @brief  Checks if any points in the grid lie inside a convex footprint
@@ -295,7 +299,8 @@ namespace base_local_planner {
       bool ptInPolygon(const pcl::PointXYZ& pt, const std::vector<geometry_msgs::Point>& poly);
 
       /**
-       * @brief  Insert a point into the point grid
+       * @brief  Insert a point into the point grid. The point is staged and
+       * becomes part of the grid the next time the grid is read or cleared.
        * @param pt The point to be inserted 
        */
       void insert(pcl::PointXYZ pt);
@@ -343,15 +348,99 @@ namespace base_local_planner {
       void getPoints(pcl::PointCloud<pcl::PointXYZ>& cloud);
 
     private:
+      /**
+       * @brief  A footprint edge a->b stored as the line a * x + b * y + c,
+       * which is positive for points to the left of the edge
+       */
+      struct HalfPlane {
+        double a, b, c;
+      };
+
+      /**
+       * @brief  Merge the staged points into the per-cell point array
+       */
+      void compact();
+
+      /**
+       * @brief  Find the squared distance from a point to the nearest point stored in a cell, ignoring staged points
+       * @param pt The point used for comparison
+       * @param index The index of the cell
+       * @return The squared distance to the nearest point in the cell, DBL_MAX if it is empty
+       */
+      double nearestInCell(const pcl::PointXYZ& pt, unsigned int index) const;
+
+      /**
+       * @brief  Find the squared distance from a point to its nearest neighbor in the grid, ignoring staged points
+       * @param pt The point used for comparison
+       * @return The squared distance to the nearest neighbor, only exact when it is below the minimum separation
+       */
+      double nearestInGrid(const pcl::PointXYZ& pt) const;
+
+      /**
+       * @brief  Find the squared distance from a point to the nearest staged point
+       * @param pt The point used for comparison
+       * @return The squared distance to the nearest staged point, only exact when it is below the minimum separation
+       */
+      double nearestStaged(const pcl::PointXYZ& pt) const;
+
+      /**
+       * @brief  Get the bucket of the separation hash that a point falls in
+       * @param hx The x coordinate of the point quantized by the minimum separation
+       * @param hy The y coordinate of the point quantized by the minimum separation
+       * @return The index of the bucket in hash_heads_
+       */
+      inline unsigned int hashBucket(int hx, int hy) const {
+        return ((unsigned int) hx * 73856093u ^ (unsigned int) hy * 19349663u) & (hash_heads_.size() - 1);
+      }
+
+      /**
+       * @brief  Add the most recently staged point to the separation hash, growing the hash when it gets crowded
+       */
+      void hashStaged();
+
+      /**
+       * @brief  Compute the half-planes of a polygon's edges into half_planes_
+       * @param poly The polygon
+       */
+      void computeHalfPlanes(const std::vector<geometry_msgs::Point>& poly);
+
+      /**
+       * @brief  Check if a point lies in the polygon last passed to computeHalfPlanes
+       * @param pt The point to check
+       * @return True if the point is in the polygon, false otherwise
+       */
+      inline bool ptInHalfPlanes(const pcl::PointXYZ& pt) const {
+        unsigned int num_edges = half_planes_.size();
+        if(num_edges < 3)
+          return false;
+
+        //the point is inside iff it is on the same side of every edge, so count
+        //the edges it is left of instead of branching on each one
+        unsigned int left = 0;
+        for(unsigned int i = 0; i < num_edges; ++i)
+          left += half_planes_[i].a * pt.x + half_planes_[i].b * pt.y + half_planes_[i].c > 0;
+        return left == 0 || left == num_edges;
+      }
+
       double resolution_; ///< @brief The resolution of the grid in meters/cell
       geometry_msgs::Point origin_; ///< @brief The origin point of the grid
       unsigned int width_; ///< @brief The width of the grid in cells
       unsigned int height_; ///< @brief The height of the grid in cells
-      std::vector< std::list<pcl::PointXYZ> > cells_; ///< @brief Storage for the cells in the grid
+      std::vector<pcl::PointXYZ> cell_points_; ///< @brief Storage for the points in the grid, grouped by cell
+      std::vector<unsigned int> cell_start_; ///< @brief The offset of each cell's points in cell_points_, with one extra entry for the end
+      std::vector<unsigned int> cell_size_; ///< @brief The number of live points in each cell, removal shrinks this without moving other cells
+      std::vector<pcl::PointXYZ> staged_points_; ///< @brief Points inserted since the last compaction
+      std::vector<unsigned int> staged_cells_; ///< @brief The cell index of each staged point
+      std::vector<int> hash_heads_; ///< @brief The first staged point in each bucket of the separation hash, -1 if empty
+      std::vector<int> hash_next_; ///< @brief The next staged point in the same bucket as each staged point, -1 at the end
       double max_z_;  ///< @brief The height cutoff for adding points as obstacles
       double sq_obstacle_range_;  ///< @brief The square distance at which we no longer add obstacles to the grid
+      double min_separation_;  ///< @brief The minimum distance required between points in the grid
       double sq_min_separation_;  ///< @brief The minimum square distance required between points in the grid
-      std::vector< std::list<pcl::PointXYZ>* > points_;  ///< @brief The lists of points returned by a range search, made a member to save on memory allocation
+      std::vector<unsigned int> range_cells_;  ///< @brief The cells returned by a range search, made a member to save on memory allocation
+      std::vector<HalfPlane> half_planes_;  ///< @brief The edges of the polygon being checked, made a member to save on memory allocation
+      std::vector<pcl::PointXYZ> compact_points_;  ///< @brief Scratch storage for compaction, swapped with cell_points_
+      std::vector<unsigned int> compact_start_;  ///< @brief Scratch storage for compaction, swapped with cell_start_
   };
 };
 #endif
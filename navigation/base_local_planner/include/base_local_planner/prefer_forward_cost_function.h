@@ -49,6 +49,7 @@ public:
   ~PreferForwardCostFunction() {}
 
   double scoreTrajectory(Trajectory &traj);
+  bool isThreadSafe() {return true;};
 
   bool prepare() {return true;};
 
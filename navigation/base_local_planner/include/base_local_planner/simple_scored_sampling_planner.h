@@ -39,6 +39,7 @@
 #define SIMPLE_SCORED_SAMPLING_PLANNER_H_
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include <base_local_planner/trajectory.h>
 #include <base_local_planner/trajectory_cost_function.h>
 #include <base_local_planner/trajectory_sample_generator.h>
@@ -60,7 +61,7 @@ public:
 
   ~SimpleScoredSamplingPlanner() {}
 
-  SimpleScoredSamplingPlanner() {}
+  SimpleScoredSamplingPlanner() : max_samples_(-1), num_threads_(1), adaptive_critic_order_(true), num_explored_(0), num_pruned_(0) {}
 
   /**
    * Takes a list of generators and critics. Critics return costs > 0, or negative costs for invalid trajectories.
@@ -76,7 +77,10 @@ public:
   /**
    * runs all scoring functions over the trajectory creating a weigthed sum
    * of positive costs, aborting as soon as a negative cost are found or costs greater
-   * than positive best_traj_cost accumulated
+   * than positive best_traj_cost accumulated. Each critic gets told how much it
+   * may still add, so that it can stop scoring the trajectory early.
+   * Critics are run in the adaptive order, but their costs are summed in the
+   * configured order, so that the result does not depend on it.
    */
   double scoreTrajectory(Trajectory& traj, double best_traj_cost);
 
@@ -89,16 +93,107 @@ public:
    * else returns false.
    *
    * @param traj The container to write the result to
-   * @param all_explored pass NULL or a container to collect all trajectories for debugging (has a penalty)
+   * @param all_explored pass NULL or a container to collect all trajectories for debugging (has a penalty,
+   * getNumExplored and getExplored give access to them without copying)
    */
   bool findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored = 0);
 
+  /**
+   * Number of trajectories scored by the last call to findBestTrajectory
+   */
+  unsigned int getNumExplored() const {
+    return num_explored_;
+  }
+
+  /**
+   * Number of trajectories the last call to findBestTrajectory stopped scoring
+   * early because they were already worse than the best one found before them
+   */
+  unsigned int getNumPruned() const {
+    return num_pruned_;
+  }
+
+  /**
+   * A trajectory scored by the last call to findBestTrajectory, with its cost.
+   * Only valid until the next call.
+   */
+  const Trajectory& getExplored(unsigned int index) const {
+    return samples_[index];
+  }
+
+  /**
+   * Number of threads used to score the samples of one generator.
+   * With more than one thread, all samples are generated first and then scored
+   * concurrently, sharing the best cost found so far as the bound for aborting.
+   * The worker threads are started by the first parallel cycle and kept until
+   * the planner is destroyed or the number of threads changes.
+   * The chosen trajectory is the same as with one thread (the first one with
+   * minimal cost); costs of aborted trajectories in all_explored may differ.
+   * Only used when all critics are thread safe.
+   */
+  void setNumThreads(int num_threads) {
+    num_threads_ = num_threads;
+  }
+
+  /**
+   * If set (the default), critics are run in order of how many trajectories they
+   * rejected per second of scoring in the recent cycles, instead of the order given.
+   * Only changes how fast bad trajectories are rejected, not the result.
+   */
+  void setAdaptiveCriticOrder(bool adaptive) {
+    adaptive_critic_order_ = adaptive;
+    resetCriticOrder();
+  }
+
 
 private:
+  struct ScoringState;
+  struct ScoringContext;
+  class WorkerPool;
+
+  double scoreTrajectory(Trajectory& traj, double best_traj_cost, ScoringContext& context);
+
+  void resetCriticOrder();
+
+  /**
+   * Adds the statistics of the last cycle and sorts the critics again
+   */
+  void updateCriticOrder(const std::vector<ScoringContext>& contexts);
+
+  /**
+   * Generates all samples of gen into the pool and scores them across num_threads_ threads
+   * @return the index of the best sample, or -1 if none is valid
+   */
+  int scoreSamplesParallel(TrajectorySampleGenerator* gen, std::vector<ScoringContext>& contexts, int& count, int& count_valid);
+
+  /**
+   * The first unused trajectory of the pool, added if there is none
+   */
+  Trajectory& nextSample();
+
+  /**
+   * Worker loop, scores samples until none are left
+   * @param thread The index of the context to use, one per thread
+   */
+  void scoreSamples(ScoringState* state, std::vector<ScoringContext>* contexts, unsigned int thread);
+
   std::vector<TrajectorySampleGenerator*> gen_list_;
   std::vector<TrajectoryCostFunction*> critics_;
 
   int max_samples_;
+  int num_threads_;
+
+  bool adaptive_critic_order_;
+  std::vector<unsigned int> critic_order_;
+  std::vector<double> critic_rejections_, critic_time_;
+
+  // scoring threads, shared by copies of the planner, which take turns using them
+  boost::shared_ptr<WorkerPool> workers_;
+
+  // pool of sampled trajectories, keeps its storage between cycles
+  std::vector<Trajectory> samples_;
+  unsigned int num_explored_;
+  unsigned int num_pruned_;
 };
 
 
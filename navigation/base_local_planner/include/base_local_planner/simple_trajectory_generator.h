@@ -61,8 +61,18 @@ namespace base_local_planner {
 class SimpleTrajectoryGenerator: public base_local_planner::TrajectorySampleGenerator {
 public:
 
+  /**
+   * How the poses of a rollout are integrated from its velocities
+   */
+  enum Integration {
+    STEPWISE = 0,             ///< Euler steps, the default
+    INCREMENTAL_ROTATION = 1, ///< Euler steps, turning the heading by a fixed rotation instead of calling cos and sin per point
+    EXACT_ARCS = 2            ///< the closed form constant velocity arc, batched over the points of a rollout
+  };
+
   SimpleTrajectoryGenerator() {
     limits_ = NULL;
+    integration_ = STEPWISE;
   }
 
   ~SimpleTrajectoryGenerator() {}
@@ -112,6 +122,18 @@ public:
       bool use_dwa = false,
       double sim_period = 0.0);
 
+  /**
+   * With INCREMENTAL_ROTATION, the heading is kept as a unit vector that is turned by
+   * the same rotation each step while the velocity stays constant. Points agree with
+   * STEPWISE up to float rounding.
+   * With EXACT_ARCS, the points are taken from the arc the robot drives at constant
+   * velocities, which the Euler steps only approximate. Once the velocity stops
+   * changing, the remaining points of the rollout are computed in one batch.
+   */
+  void setIntegration(Integration integration) {
+    integration_ = integration;
+  }
+
   /**
    * Whether this generator can create more trajectories
    */
@@ -126,6 +148,12 @@ public:
   static Eigen::Vector3f computeNewPositions(const Eigen::Vector3f& pos,
       const Eigen::Vector3f& vel, double dt);
 
+  /**
+   * The pose after driving at constant velocities for dt, along the exact arc
+   */
+  static Eigen::Vector3f computeArcPositions(const Eigen::Vector3f& pos,
+      const Eigen::Vector3f& vel, double dt);
+
   static Eigen::Vector3f computeNewVelocities(const Eigen::Vector3f& sample_target_vel,
       const Eigen::Vector3f& vel, Eigen::Vector3f acclimits, double dt);
 
@@ -137,6 +165,12 @@ public:
 
 protected:
 
+  /**
+   * Adds num_points points dt apart along the arc from pos at constant velocities
+   */
+  static void addArcPoints(const Eigen::Vector3f& pos, const Eigen::Vector3f& vel, double dt,
+      int num_points, base_local_planner::Trajectory& traj);
+
   unsigned int next_sample_index_;
   // to store sample params of each sample between init and generation
   std::vector<Eigen::Vector3f> sample_params_;
@@ -150,6 +184,7 @@ protected:
 
   double sim_time_, sim_granularity_, angular_sim_granularity_;
   bool use_dwa_;
+  Integration integration_;
   double sim_period_; // only for dwa
 };
 
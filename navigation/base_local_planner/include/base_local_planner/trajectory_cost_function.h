@@ -64,6 +64,26 @@ public:
    */
   virtual double scoreTrajectory(Trajectory &traj) = 0;
 
+  /**
+   * return a score for trajectory traj, but allowed to stop as soon as the
+   * score is known to be above max_cost (max_cost < 0 means no bound).
+   * When the result is above max_cost, the full score would have been
+   * above max_cost too, or negative.
+   * Subclasses that can score incrementally may overwrite.
+   */
+  virtual double scoreTrajectoryBounded(Trajectory &traj, double max_cost) {
+    return scoreTrajectory(traj);
+  }
+
+  /**
+   * Whether scoreTrajectory may be called for different trajectories from
+   * several threads at once, between two calls to prepare.
+   * Subclasses that only read their state while scoring may overwrite.
+   */
+  virtual bool isThreadSafe() {
+    return false;
+  }
+
   double getScale() {
     return scale_;
   }
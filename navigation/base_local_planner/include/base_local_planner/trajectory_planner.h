@@ -44,6 +44,7 @@
 #include <costmap_2d/costmap_2d.h>
 #include <costmap_2d/cost_values.h>
 #include <base_local_planner/footprint_helper.h>
+#include <base_local_planner/footprint_clearance_grid.h>
 
 #include <base_local_planner/world_model.h>
 #include <base_local_planner/trajectory.h>
@@ -310,6 +311,7 @@ namespace base_local_planner {
       bool heading_scoring_; ///< @brief Should we score based on the rollout approach or the heading approach
       double heading_scoring_timestep_; ///< @brief How far to look ahead in time when we score a heading
       bool simple_attractor_;  ///< @brief Enables simple attraction to a goal point
+      bool exact_arcs_; ///< @brief Roll out along exact constant velocity arcs instead of straight steps
 
       std::vector<double> y_vels_; ///< @brief Y velocities to explore
 
@@ -318,6 +320,9 @@ namespace base_local_planner {
 
       double inscribed_radius_, circumscribed_radius_;
 
+      FootprintClearanceGrid clearance_grid_; ///< @brief Lets footprint checks far from any cost return early
+      bool use_clearance_grid_; ///< @brief True while clearance_grid_ matches the costmap the world model checks against
+
       boost::mutex configuration_mutex_;
 
       /**
@@ -357,6 +362,24 @@ namespace base_local_planner {
         return thetai + vth * dt;
       }
 
+      /**
+       * @brief  Move a pose along the arc driven at constant velocities, instead of a straight step
+       * @param  x, y, theta The pose to move
+       * @param  vx The current x velocity
+       * @param  vy The current y velocity
+       * @param  vth The current theta velocity
+       * @param  dt The timestep to take
+       */
+      inline void computeArcPosition(double& x, double& y, double& theta, double vx, double vy, double vth, double dt){
+        //the chord of the arc points along the heading halfway through it, sin(h)/h goes to its series near zero
+        double half_turn = 0.5 * vth * dt;
+        double chord = fabs(half_turn) < 1e-3 ? dt * (1.0 - half_turn * half_turn / 6.0) : dt * sin(half_turn) / half_turn;
+        double mid_theta = theta + half_turn;
+        x += (vx * cos(mid_theta) - vy * sin(mid_theta)) * chord;
+        y += (vx * sin(mid_theta) + vy * cos(mid_theta)) * chord;
+        theta += vth * dt;
+      }
+
       //compute velocity based on acceleration
       /**
        * @brief  Compute velocity based on acceleration
@@ -0,0 +1,103 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef VELOCITY_OBSTACLE_COST_FUNCTION_H_
+#define VELOCITY_OBSTACLE_COST_FUNCTION_H_
+
+#include <vector>
+#include <geometry_msgs/Point.h>
+#include <base_local_planner/trajectory_cost_function.h>
+#include <base_local_planner/obstacle_tracker.h>
+
+namespace base_local_planner {
+
+/**
+ * class VelocityObstacleCostFunction
+ * @brief Penalizes trajectories that run into the predicted positions of
+ * moving obstacles. Point i of a trajectory is compared against the tracks
+ * of an ObstacleTracker moved ahead by i * time_delta_ seconds at their
+ * estimated velocity. The cost is 1 for a collision right away and drops
+ * linearly to 0 for one at the end of the time horizon, so trajectories
+ * that get closer to trouble sooner are worse, but none is discarded.
+ */
+class VelocityObstacleCostFunction : public TrajectoryCostFunction {
+public:
+  VelocityObstacleCostFunction(const ObstacleTracker* tracker);
+
+  bool prepare();
+  double scoreTrajectory(Trajectory &traj);
+  bool isThreadSafe() {return true;};
+
+  /**
+   * @param time_horizon How far ahead collisions count, in seconds
+   * @param min_speed Tracks slower than this are left to the costmap, in m/s
+   * @param min_hits Observations a track needs before its velocity is trusted
+   * @param safety_margin Extra distance kept to a moving obstacle, in meters
+   */
+  void setParams(double time_horizon, double min_speed, unsigned int min_hits, double safety_margin);
+  void setFootprint(std::vector<geometry_msgs::Point> footprint_spec);
+
+  /**
+   * @brief The time the trajectories start at, prepare moves the tracks ahead to it
+   * @param stamp The time in seconds, the planner passes ros::Time::now()
+   */
+  void setStamp(double stamp) {
+    stamp_ = stamp;
+  }
+
+  /**
+   * Number of tracks taken into account since the last prepare
+   */
+  unsigned int getNumTracks() const {
+    return tracks_.size();
+  }
+
+private:
+  const ObstacleTracker* tracker_;
+  double time_horizon_, min_speed_, safety_margin_;
+  double stamp_; // negative until setStamp, then the tracks stay at the last observation
+  unsigned int min_hits_;
+  double circumscribed_radius_;
+
+  // snapshot of the moving tracks, with the area each one sweeps over the horizon
+  std::vector<TrackedObstacle> tracks_;
+  struct Sweep {
+    double min_x, min_y, max_x, max_y;
+  };
+  std::vector<Sweep> sweeps_;
+};
+
+} /* namespace base_local_planner */
+#endif /* VELOCITY_OBSTACLE_COST_FUNCTION_H_ */
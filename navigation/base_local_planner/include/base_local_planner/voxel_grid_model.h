@@ -39,6 +39,7 @@
 #include <vector>
 #include <list>
 #include <cfloat>
+#include <algorithm>
 #include <geometry_msgs/Point.h>
 #include <costmap_2d/observation.h>
 #include <base_local_planner/world_model.h>
@@ -89,6 +90,20 @@ namespace base_local_planner {
       virtual double footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint,
           double inscribed_radius, double circumscribed_radius);
 
+      /**
+       * @brief  Checks a footprint given in robot coordinates at a pose, orienting each
+       * point as it goes instead of building the oriented footprint first
+       * @param  x The x position of the robot in world coordinates
+       * @param  y The y position of the robot in world coordinates
+       * @param  theta The orientation of the robot
+       * @param  footprint_spec The specification of the footprint of the robot in robot coordinates
+       * @param  inscribed_radius Not needed for the voxel grid
+       * @param  circumscribed_radius Not needed for the voxel grid
+       * @return Positive if all the points lie outside the footprint, negative otherwise
+       */
+      virtual double footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+          double inscribed_radius = 0.0, double circumscribed_radius = 0.0);
+
       using WorldModel::footprintCost;
 
       /**
@@ -103,6 +118,13 @@ namespace base_local_planner {
       void getPoints(pcl::PointCloud<pcl::PointXYZ>& cloud);
 
     private:
+      /**
+       * @brief  Checks a footprint whose points map to world coordinates as
+       * (origin_x + px * cos_th - py * sin_th, origin_y + px * sin_th + py * cos_th)
+       */
+      double footprintCost(double origin_x, double origin_y, double cos_th, double sin_th,
+          const std::vector<geometry_msgs::Point>& footprint);
+
       /**
        * @brief  Rasterizes a line in the costmap grid and checks for collisions
        * @param x0 The x position of the first cell in grid coordinates
@@ -123,6 +145,25 @@ namespace base_local_planner {
 
       void removePointsInScanBoundry(const PlanarLaserScan& laser_scan, double raytrace_range);
 
+      /**
+       * @brief  Recomputes the column and block summaries for a region of the grid
+       * @param min_x The lowest x cell of the region
+       * @param min_y The lowest y cell of the region
+       * @param max_x The highest x cell of the region
+       * @param max_y The highest y cell of the region
+       */
+      void updateSummary(unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y);
+
+      /**
+       * @brief  Grows the region that changed during an update to include a cell
+       */
+      inline void touchColumn(unsigned int x, unsigned int y){
+        dirty_min_x_ = std::min(dirty_min_x_, x);
+        dirty_min_y_ = std::min(dirty_min_y_, y);
+        dirty_max_x_ = std::max(dirty_max_x_, x);
+        dirty_max_y_ = std::max(dirty_max_y_, y);
+      }
+
       inline bool worldToMap3D(double wx, double wy, double wz, unsigned int& mx, unsigned int& my, unsigned int& mz){
         if(wx < origin_x_ || wy < origin_y_ || wz < origin_z_)
           return false;
@@ -162,6 +203,7 @@ namespace base_local_planner {
         if(!worldToMap3D(pt.x, pt.y, pt.z, cell_x, cell_y, cell_z))
           return;
         obstacle_grid_.markVoxel(cell_x, cell_y, cell_z);
+        touchColumn(cell_x, cell_y);
       }
 
       voxel_grid::VoxelGrid obstacle_grid_;
@@ -173,6 +215,15 @@ namespace base_local_planner {
       double max_z_;  ///< @brief The height cutoff for adding points as obstacles
       double sq_obstacle_range_;  ///< @brief The square distance at which we no longer add obstacles to the grid
 
+      //a column is blocked if it has any marked or unknown voxels, which is all
+      //the footprint check needs to know, and blocks of columns count their
+      //blocked columns so that footprints in empty space skip the rasterization
+      static const unsigned int BLOCK_SHIFT = 3;
+      unsigned int size_x_, size_y_, blocks_x_;
+      std::vector<unsigned char> column_blocked_;
+      std::vector<unsigned int> block_counts_;
+      unsigned int dirty_min_x_, dirty_min_y_, dirty_max_x_, dirty_max_y_;
+
   };
 };
 #endif
@@ -0,0 +1,92 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef WARM_START_TRAJECTORY_GENERATOR_H_
+#define WARM_START_TRAJECTORY_GENERATOR_H_
+
+#include <base_local_planner/simple_trajectory_generator.h>
+
+namespace base_local_planner {
+
+/**
+ * Generates the same velocity samples as SimpleTrajectoryGenerator, but starts
+ * with the command chosen in the previous cycle and continues with the samples
+ * closest to it.
+ *
+ * Consecutive commands are usually close, so the first samples give the scoring
+ * planner a tight bound early on, and the critics can give up on most of the
+ * remaining samples after looking at a part of them. The previous command is
+ * added as a sample of its own if it lies within the current velocity window.
+ */
+class WarmStartTrajectoryGenerator: public base_local_planner::SimpleTrajectoryGenerator {
+public:
+
+  WarmStartTrajectoryGenerator() : has_warm_start_(false) {}
+
+  ~WarmStartTrajectoryGenerator() {}
+
+  /**
+   * Same as SimpleTrajectoryGenerator::initialise, then orders the samples around the warm start if there is one
+   */
+  void initialise(
+      const Eigen::Vector3f& pos,
+      const Eigen::Vector3f& vel,
+      const Eigen::Vector3f& goal,
+      base_local_planner::LocalPlannerLimits* limits,
+      const Eigen::Vector3f& vsamples,
+      bool discretize_by_time = false);
+
+  /**
+   * @param previous_vel the velocity command to sample first and around in the next initialise
+   */
+  void setWarmStart(const Eigen::Vector3f& previous_vel) {
+    warm_start_ = previous_vel;
+    has_warm_start_ = true;
+  }
+
+  /**
+   * Go back to the order of SimpleTrajectoryGenerator, e.g. when the previous cycle found no valid command
+   */
+  void clearWarmStart() {
+    has_warm_start_ = false;
+  }
+
+protected:
+  bool has_warm_start_;
+  Eigen::Vector3f warm_start_;
+};
+
+} /* namespace base_local_planner */
+#endif /* WARM_START_TRAJECTORY_GENERATOR_H_ */
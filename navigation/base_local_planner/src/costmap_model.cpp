@@ -34,9 +34,11 @@
 *
 * Author: Eitan Marder-Eppstein
 *********************************************************************/
-#include <base_local_planner/line_iterator.h>
 #include <base_local_planner/costmap_model.h>
 #include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 
 using namespace std;
 using namespace costmap_2d;
@@ -46,12 +48,23 @@ namespace base_local_planner {
 
   double CostmapModel::footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint, 
       double inscribed_radius, double circumscribed_radius){
+    return footprintCost(position.x, position.y, 0.0, 0.0, 1.0, 0.0, footprint);
+  }
+
+  double CostmapModel::footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+      double inscribed_radius, double circumscribed_radius){
+    //the points come out exactly as WorldModel would orient them
+    return footprintCost(x, y, x, y, cos(theta), sin(theta), footprint_spec);
+  }
+
+  double CostmapModel::footprintCost(double x, double y, double origin_x, double origin_y, double cos_th, double sin_th,
+      const std::vector<geometry_msgs::Point>& footprint){
 
     //used to put things into grid coordinates
     unsigned int cell_x, cell_y;
 
     //get the cell coord of the center point of the robot
-    if(!costmap_.worldToMap(position.x, position.y, cell_x, cell_y))
+    if(!costmap_.worldToMap(x, y, cell_x, cell_y))
       return -1.0;
 
     //if number of points in the footprint is less than 3, we'll just assume a circular robot
@@ -63,79 +76,102 @@ namespace base_local_planner {
       return cost;
     }
 
-    //now we really have to lay down the footprint in the costmap grid
-    unsigned int x0, x1, y0, y1;
-    double line_cost = 0.0;
-    double footprint_cost = 0.0;
-
-    //we need to rasterize each line in the footprint
-    for(unsigned int i = 0; i < footprint.size() - 1; ++i){
-      //get the cell coord of the first point
-      if(!costmap_.worldToMap(footprint[i].x, footprint[i].y, x0, y0))
-        return -1.0;
-
-      //get the cell coord of the second point
-      if(!costmap_.worldToMap(footprint[i + 1].x, footprint[i + 1].y, x1, y1))
+    //now we really have to lay down the footprint in the costmap grid, one
+    //line per edge, where each vertex is converted once and each cell where
+    //two edges meet is only looked at once
+    unsigned int first_x, first_y, x0, y0, x1, y1;
+    if(!costmap_.worldToMap(origin_x + (footprint[0].x * cos_th - footprint[0].y * sin_th),
+          origin_y + (footprint[0].x * sin_th + footprint[0].y * cos_th), first_x, first_y))
+      return -1.0;
+    x0 = first_x;
+    y0 = first_y;
+
+    unsigned char footprint_cost = 0;
+    for(unsigned int i = 1; i <= footprint.size(); ++i){
+      //the last edge connects the last point in the footprint back to the first
+      bool closing = i == footprint.size();
+      if(closing){
+        x1 = first_x;
+        y1 = first_y;
+      }
+      else if(!costmap_.worldToMap(origin_x + (footprint[i].x * cos_th - footprint[i].y * sin_th),
+            origin_y + (footprint[i].x * sin_th + footprint[i].y * cos_th), x1, y1))
         return -1.0;
 
-      line_cost = lineCost(x0, x1, y0, y1);
-      footprint_cost = std::max(line_cost, footprint_cost);
+      footprint_cost = std::max(footprint_cost, lineCost(x0, x1, y0, y1, i > 1, closing));
 
-      //if there is an obstacle that hits the line... we know that we can return false right away 
-      if(line_cost < 0)
+      //lethal and unknown are the highest costs, so the maximum tells whether
+      //an obstacle hits the footprint and we can return right away
+      if(footprint_cost >= LETHAL_OBSTACLE)
         return -1.0;
-    }
-
-    //we also need to connect the first point in the footprint to the last point
-    //get the cell coord of the last point
-    if(!costmap_.worldToMap(footprint.back().x, footprint.back().y, x0, y0))
-      return -1.0;
-
-    //get the cell coord of the first point
-    if(!costmap_.worldToMap(footprint.front().x, footprint.front().y, x1, y1))
-      return -1.0;
 
-    line_cost = lineCost(x0, x1, y0, y1);
-    footprint_cost = std::max(line_cost, footprint_cost);
-
-    if(line_cost < 0)
-      return -1.0;
+      x0 = x1;
+      y0 = y1;
+    }
 
     //if all line costs are legal... then we can return that the footprint is legal
     return footprint_cost;
 
   }
 
-  //calculate the cost of a ray-traced line
-  double CostmapModel::lineCost(int x0, int x1, 
-      int y0, int y1){
-    
-    double line_cost = 0.0;
-    double point_cost = -1.0;
-
-    for( LineIterator line( x0, y0, x1, y1 ); line.isValid(); line.advance() )
-    {
-      point_cost = pointCost( line.getX(), line.getY() ); //Score the current point
-
-      if(point_cost < 0)
-        return -1;
-
-      if(line_cost < point_cost)
-        line_cost = point_cost;
+  //calculate the highest cost of a ray-traced line
+  unsigned char CostmapModel::lineCost(int x0, int x1, int y0, int y1, bool skip_first, bool skip_last) const {
+    //the cells are walked like LineIterator does, but on their index into the
+    //grid, and their costs are gathered into a batch that is reduced in one go
+    const unsigned char* grid = costmap_.getCharMap();
+    int size_x = costmap_.getSizeInCellsX();
+    int deltax = abs(x1 - x0), deltay = abs(y1 - y0);
+    int xinc = x1 >= x0 ? 1 : -1, yinc = y1 >= y0 ? size_x : -size_x;
+    int den, num, numadd, numpixels, step, corner_step;
+    if(deltax >= deltay){
+      den = deltax;
+      numadd = deltay;
+      numpixels = deltax;
+      step = xinc;
     }
-
-    return line_cost;
-  }
-
-  double CostmapModel::pointCost(int x, int y){
-    unsigned char cost = costmap_.getCost(x, y);
-    //if the cell is in an obstacle the path is invalid
-    //if(cost == LETHAL_OBSTACLE){
-    if(cost == LETHAL_OBSTACLE || cost == NO_INFORMATION){
-      return -1;
+    else {
+      den = deltay;
+      numadd = deltax;
+      numpixels = deltay;
+      step = yinc;
+    }
+    num = den / 2;
+    corner_step = xinc + yinc;
+
+    const int batch_size = 128;
+    unsigned char costs[batch_size];
+    unsigned char line_cost = 0;
+    int index = y0 * size_x + x0;
+    int end = numpixels - (skip_last ? 1 : 0);
+    int pixel = 0;
+    if(skip_first){
+      num += numadd;
+      if(num >= den){
+        num -= den;
+        index += corner_step;
+      }
+      else
+        index += step;
+      pixel = 1;
+    }
+    while(pixel <= end){
+      int count = std::min(batch_size, end - pixel + 1);
+      for(int j = 0; j < count; ++j){
+        costs[j] = grid[index];
+        num += numadd;
+        if(num >= den){
+          num -= den;
+          index += corner_step;
+        }
+        else
+          index += step;
+      }
+      for(int j = 0; j < count; ++j)
+        line_cost = costs[j] > line_cost ? costs[j] : line_cost;
+      pixel += count;
     }
 
-    return cost;
+    return line_cost;
   }
 
 };
@@ -0,0 +1,93 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/footprint_clearance_grid.h>
+#include <cmath>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+FootprintClearanceGrid::FootprintClearanceGrid() :
+    size_x_(0), size_y_(0), origin_x_(0.0), origin_y_(0.0), resolution_(1.0) {}
+
+void FootprintClearanceGrid::update(const costmap_2d::Costmap2D& costmap) {
+  size_x_ = costmap.getSizeInCellsX();
+  size_y_ = costmap.getSizeInCellsY();
+  origin_x_ = costmap.getOriginX();
+  origin_y_ = costmap.getOriginY();
+  resolution_ = costmap.getResolution();
+
+  unsigned int stride = size_x_ + 1;
+  lethal_counts_.assign(stride * (size_y_ + 1), 0);
+  cost_counts_.assign(stride * (size_y_ + 1), 0);
+
+  const unsigned char* costs = costmap.getCharMap();
+  for (unsigned int y = 0; y < size_y_; ++y) {
+    unsigned int lethal_row = 0, cost_row = 0;
+    const unsigned char* row = costs + y * size_x_;
+    unsigned int* lethal_out = &lethal_counts_[(y + 1) * stride + 1];
+    unsigned int* cost_out = &cost_counts_[(y + 1) * stride + 1];
+    const unsigned int* lethal_above = lethal_out - stride;
+    const unsigned int* cost_above = cost_out - stride;
+    for (unsigned int x = 0; x < size_x_; ++x) {
+      unsigned char cost = row[x];
+      lethal_row += (cost == costmap_2d::LETHAL_OBSTACLE || cost == costmap_2d::NO_INFORMATION);
+      cost_row += (cost != costmap_2d::FREE_SPACE);
+      lethal_out[x] = lethal_above[x] + lethal_row;
+      cost_out[x] = cost_above[x] + cost_row;
+    }
+  }
+}
+
+int FootprintClearanceGrid::countCells(const std::vector<unsigned int>& counts, double wx, double wy, double radius) const {
+  if (size_x_ == 0 || size_y_ == 0 || wx < origin_x_ || wy < origin_y_) {
+    return -1;
+  }
+  // the cell of a footprint corner is at most ceil(radius / resolution) cells from
+  // the center cell, one more covers rounding in the world to map conversion
+  int reach = (int)ceil(radius / resolution_) + 1;
+  int mx = (int)((wx - origin_x_) / resolution_);
+  int my = (int)((wy - origin_y_) / resolution_);
+  if (mx - reach < 0 || my - reach < 0 || mx + reach >= (int)size_x_ || my + reach >= (int)size_y_) {
+    return -1;
+  }
+
+  unsigned int stride = size_x_ + 1;
+  unsigned int x0 = mx - reach, x1 = mx + reach + 1;
+  unsigned int y0 = my - reach, y1 = my + reach + 1;
+  return counts[y1 * stride + x1] - counts[y0 * stride + x1] - counts[y1 * stride + x0] + counts[y0 * stride + x0];
+}
+
+} /* namespace base_local_planner */
@@ -38,17 +38,17 @@ using namespace std;
 namespace base_local_planner{
 
   MapGrid::MapGrid()
-    : size_x_(0), size_y_(0)
+    : size_x_(0), size_y_(0), cached_resolution_(0.0)
   {
   }
 
   MapGrid::MapGrid(unsigned int size_x, unsigned int size_y) 
-    : size_x_(size_x), size_y_(size_y)
+    : size_x_(size_x), size_y_(size_y), cached_resolution_(0.0)
   {
     commonInit();
   }
 
-  MapGrid::MapGrid(const MapGrid& mg){
+  MapGrid::MapGrid(const MapGrid& mg) : cached_resolution_(0.0) {
     size_y_ = mg.size_y_;
     size_x_ = mg.size_x_;
     map_ = mg.map_;
@@ -100,22 +100,22 @@ namespace base_local_planner{
   }
 
 
-  inline bool MapGrid::updatePathCell(MapCell* current_cell, MapCell* check_cell,
-      const costmap_2d::Costmap2D& costmap){
+  inline bool MapGrid::updatePathCell(double new_target_dist, unsigned int check_index,
+      const costmap_2d::Costmap2D& costmap, const unsigned char* costs){
+    MapCell& check_cell = map_[check_index];
 
     //if the cell is an obstacle set the max path distance
-    unsigned char cost = costmap.getCost(check_cell->cx, check_cell->cy);
-    if(! getCell(check_cell->cx, check_cell->cy).within_robot &&
+    unsigned char cost = costs[costmap.getIndex(check_cell.cx, check_cell.cy)];
+    if(! check_cell.within_robot &&
         (cost == costmap_2d::LETHAL_OBSTACLE ||
          cost == costmap_2d::INSCRIBED_INFLATED_OBSTACLE ||
          cost == costmap_2d::NO_INFORMATION)){
-      check_cell->target_dist = obstacleCosts();
+      check_cell.target_dist = obstacleCosts();
       return false;
     }
 
-    double new_target_dist = current_cell->target_dist + 1;
-    if (new_target_dist < check_cell->target_dist) {
-      check_cell->target_dist = new_target_dist;
+    if (new_target_dist < check_cell.target_dist) {
+      check_cell.target_dist = new_target_dist;
     }
     return true;
   }
@@ -168,6 +168,24 @@ namespace base_local_planner{
     }
   }
 
+  const std::vector<geometry_msgs::PoseStamped>& MapGrid::getAdjustedPlan(
+      const std::vector<geometry_msgs::PoseStamped>& global_plan, double resolution) {
+    // the plan usually only changes when the global planner runs, most
+    // control cycles can skip the copying and interpolation
+    bool unchanged = resolution == cached_resolution_ && global_plan.size() == cached_plan_.size();
+    for (unsigned int i = 0; unchanged && i < global_plan.size(); ++i) {
+      unchanged = global_plan[i].pose.position.x == cached_plan_[i].pose.position.x &&
+          global_plan[i].pose.position.y == cached_plan_[i].pose.position.y;
+    }
+    if (!unchanged) {
+      cached_plan_ = global_plan;
+      cached_resolution_ = resolution;
+      adjusted_plan_.clear();
+      adjustPlanResolution(global_plan, adjusted_plan_, resolution);
+    }
+    return adjusted_plan_;
+  }
+
   //update what map cells are considered path based on the global_plan
   void MapGrid::setTargetCells(const costmap_2d::Costmap2D& costmap,
       const std::vector<geometry_msgs::PoseStamped>& global_plan) {
@@ -177,8 +195,7 @@ namespace base_local_planner{
 
     queue<MapCell*> path_dist_queue;
 
-    std::vector<geometry_msgs::PoseStamped> adjusted_global_plan;
-    adjustPlanResolution(global_plan, adjusted_global_plan, costmap.getResolution());
+    const std::vector<geometry_msgs::PoseStamped>& adjusted_global_plan = getAdjustedPlan(global_plan, costmap.getResolution());
     if (adjusted_global_plan.size() != global_plan.size()) {
       ROS_DEBUG("Adjusted global plan resolution, added %zu points", adjusted_global_plan.size() - global_plan.size());
     }
@@ -216,8 +233,7 @@ namespace base_local_planner{
     int local_goal_y = -1;
     bool started_path = false;
 
-    std::vector<geometry_msgs::PoseStamped> adjusted_global_plan;
-    adjustPlanResolution(global_plan, adjusted_global_plan, costmap.getResolution());
+    const std::vector<geometry_msgs::PoseStamped>& adjusted_global_plan = getAdjustedPlan(global_plan, costmap.getResolution());
 
     // skip global path points until we reach the border of the local map
     for (unsigned int i = 0; i < adjusted_global_plan.size(); ++i) {
@@ -254,54 +270,53 @@ namespace base_local_planner{
 
 
   void MapGrid::computeTargetDistance(queue<MapCell*>& dist_queue, const costmap_2d::Costmap2D& costmap){
-    MapCell* current_cell;
-    MapCell* check_cell;
-    unsigned int last_col = size_x_ - 1;
-    unsigned int last_row = size_y_ - 1;
+    if(map_.empty()){
+      return;
+    }
+    //with unit steps a FIFO expands cells in order of their distance, and since
+    //every cell is queued once after the seeds a flat array can serve as the queue
+    MapCell* cells = &map_[0];
+    wave_.clear();
+    wave_.reserve(map_.size());
     while(!dist_queue.empty()){
-      current_cell = dist_queue.front();
-
-
+      wave_.push_back(dist_queue.front() - cells);
       dist_queue.pop();
+    }
 
-      if(current_cell->cx > 0){
-        check_cell = current_cell - 1;
-        if(!check_cell->target_mark){
-          //mark the cell as visisted
-          check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
-          }
+    const unsigned char* costs = costmap.getCharMap();
+    unsigned int last_col = size_x_ - 1;
+    unsigned int last_row = size_y_ - 1;
+    for(size_t head = 0; head < wave_.size(); ++head){
+      unsigned int index = wave_[head];
+      const MapCell& current_cell = cells[index];
+      double new_target_dist = current_cell.target_dist + 1;
+
+      if(current_cell.cx > 0 && !cells[index - 1].target_mark){
+        //mark the cell as visisted
+        cells[index - 1].target_mark = true;
+        if(updatePathCell(new_target_dist, index - 1, costmap, costs)) {
+          wave_.push_back(index - 1);
         }
       }
 
-      if(current_cell->cx < last_col){
-        check_cell = current_cell + 1;
-        if(!check_cell->target_mark){
-          check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
-          }
+      if(current_cell.cx < last_col && !cells[index + 1].target_mark){
+        cells[index + 1].target_mark = true;
+        if(updatePathCell(new_target_dist, index + 1, costmap, costs)) {
+          wave_.push_back(index + 1);
         }
       }
 
-      if(current_cell->cy > 0){
-        check_cell = current_cell - size_x_;
-        if(!check_cell->target_mark){
-          check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
-          }
+      if(current_cell.cy > 0 && !cells[index - size_x_].target_mark){
+        cells[index - size_x_].target_mark = true;
+        if(updatePathCell(new_target_dist, index - size_x_, costmap, costs)) {
+          wave_.push_back(index - size_x_);
         }
       }
 
-      if(current_cell->cy < last_row){
-        check_cell = current_cell + size_x_;
-        if(!check_cell->target_mark){
-          check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
-          }
+      if(current_cell.cy < last_row && !cells[index + size_x_].target_mark){
+        cells[index + size_x_].target_mark = true;
+        if(updatePathCell(new_target_dist, index + size_x_, costmap, costs)) {
+          wave_.push_back(index + size_x_);
         }
       }
     }
@@ -36,6 +36,7 @@
  *********************************************************************/
 
 #include <base_local_planner/map_grid_cost_function.h>
+#include <cmath>
 
 namespace base_local_planner {
 
@@ -50,7 +51,8 @@ MapGridCostFunction::MapGridCostFunction(costmap_2d::Costmap2D* costmap,
     xshift_(xshift),
     yshift_(yshift),
     is_local_goal_function_(is_local_goal_function),
-    stop_on_failure_(true) {}
+    stop_on_failure_(true),
+    interpolate_(false) {}
 
 void MapGridCostFunction::setTargetPoses(std::vector<geometry_msgs::PoseStamped> target_poses) {
   target_poses_ = target_poses;
@@ -72,51 +74,102 @@ double MapGridCostFunction::getCellCosts(unsigned int px, unsigned int py) {
   return grid_dist;
 }
 
-double MapGridCostFunction::scoreTrajectory(Trajectory &traj) {
-  double cost = 0.0;
-  if (aggregationType_ == Product) {
-    cost = 1.0;
+double MapGridCostFunction::interpolateDistance(double wx, double wy, double cell_dist) {
+  // position in cell units, relative to the center of cell (0, 0)
+  double gx = (wx - costmap_->getOriginX()) / costmap_->getResolution() - 0.5;
+  double gy = (wy - costmap_->getOriginY()) / costmap_->getResolution() - 0.5;
+  int x0 = (int)floor(gx);
+  int y0 = (int)floor(gy);
+  if (x0 < 0 || y0 < 0 || x0 + 1 >= (int)map_.size_x_ || y0 + 1 >= (int)map_.size_y_) {
+    return cell_dist;
   }
+  double d00 = map_(x0, y0).target_dist;
+  double d10 = map_(x0 + 1, y0).target_dist;
+  double d01 = map_(x0, y0 + 1).target_dist;
+  double d11 = map_(x0 + 1, y0 + 1).target_dist;
+  double invalid = map_.obstacleCosts();
+  if (d00 >= invalid || d10 >= invalid || d01 >= invalid || d11 >= invalid) {
+    return cell_dist;
+  }
+  double fx = gx - x0;
+  double fy = gy - y0;
+  return (1 - fy) * ((1 - fx) * d00 + fx * d10) + fy * ((1 - fx) * d01 + fx * d11);
+}
+
+double MapGridCostFunction::scorePoint(Trajectory &traj, unsigned int index) {
   double px, py, pth;
   unsigned int cell_x, cell_y;
-  double grid_dist;
+  traj.getPoint(index, px, py, pth);
 
-  for (unsigned int i = 0; i < traj.getPointsSize(); ++i) {
-    traj.getPoint(i, px, py, pth);
+  // translate point forward if specified
+  if (xshift_ != 0.0) {
+    px = px + xshift_ * cos(pth);
+    py = py + xshift_ * sin(pth);
+  }
+  // translate point sideways if specified
+  if (yshift_ != 0.0) {
+    px = px + yshift_ * cos(pth + M_PI_2);
+    py = py + yshift_ * sin(pth + M_PI_2);
+  }
 
-    // translate point forward if specified
-    if (xshift_ != 0.0) {
-      px = px + xshift_ * cos(pth);
-      py = py + xshift_ * sin(pth);
-    }
-    // translate point sideways if specified
-    if (yshift_ != 0.0) {
-      px = px + yshift_ * cos(pth + M_PI_2);
-      py = py + yshift_ * sin(pth + M_PI_2);
+  //we won't allow trajectories that go off the map... shouldn't happen that often anyways
+  if ( ! costmap_->worldToMap(px, py, cell_x, cell_y)) {
+    //we're off the map
+    ROS_WARN("Off Map %f, %f", px, py);
+    return -4.0;
+  }
+  double grid_dist = getCellCosts(cell_x, cell_y);
+  //if a point on this trajectory has no clear path to the goal... it may be invalid
+  if (stop_on_failure_) {
+    if (grid_dist == map_.obstacleCosts()) {
+      return -3.0;
+    } else if (grid_dist == map_.unreachableCellCosts()) {
+      return -2.0;
     }
+  }
+  if (interpolate_ && grid_dist < map_.obstacleCosts()) {
+    grid_dist = interpolateDistance(px, py, grid_dist);
+  }
+  return grid_dist;
+}
+
+double MapGridCostFunction::scoreTrajectory(Trajectory &traj) {
+  return scoreTrajectoryBounded(traj, -1.0);
+}
+
+double MapGridCostFunction::scoreTrajectoryBounded(Trajectory &traj, double max_cost) {
+  double cost = 0.0;
+  if (aggregationType_ == Product) {
+    cost = 1.0;
+  }
+  unsigned int num_points = traj.getPointsSize();
 
-    //we won't allow trajectories that go off the map... shouldn't happen that often anyways
-    if ( ! costmap_->worldToMap(px, py, cell_x, cell_y)) {
-      //we're off the map
-      ROS_WARN("Off Map %f, %f", px, py);
-      return -4.0;
+  // the last point alone decides the score, so look at it first and only
+  // walk the rest for failures if the score is still within the bound
+  if (aggregationType_ == Last && num_points > 0) {
+    cost = scorePoint(traj, num_points - 1);
+    if (cost < 0 || (max_cost >= 0 && cost > max_cost)) {
+      return cost;
     }
-    grid_dist = getCellCosts(cell_x, cell_y);
-    //if a point on this trajectory has no clear path to the goal... it may be invalid
-    if (stop_on_failure_) {
-      if (grid_dist == map_.obstacleCosts()) {
-        return -3.0;
-      } else if (grid_dist == map_.unreachableCellCosts()) {
-        return -2.0;
-      }
+    num_points--;
+  }
+
+  double grid_dist;
+  for (unsigned int i = 0; i < num_points; ++i) {
+    grid_dist = scorePoint(traj, i);
+    if (grid_dist < 0) {
+      return grid_dist;
     }
 
     switch( aggregationType_ ) {
     case Last:
-      cost = grid_dist;
       break;
     case Sum:
       cost += grid_dist;
+      // distances are positive, the sum only grows
+      if (max_cost >= 0 && cost > max_cost) {
+        return cost;
+      }
       break;
     case Product:
       if (cost > 0) {
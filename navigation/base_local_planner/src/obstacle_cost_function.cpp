@@ -42,7 +42,8 @@
 
 namespace base_local_planner {
 
-ObstacleCostFunction::ObstacleCostFunction(costmap_2d::Costmap2D* costmap) : costmap_(costmap) {
+ObstacleCostFunction::ObstacleCostFunction(costmap_2d::Costmap2D* costmap)
+    : costmap_(costmap), world_model_(NULL), interpolate_(false) {
   if (costmap != NULL) {
     world_model_ = new base_local_planner::CostmapModel(*costmap_);
   }
@@ -71,7 +72,6 @@ bool ObstacleCostFunction::prepare() {
 }
 
 double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
-  double cost = 0;
   double scale = getScalingFactor(traj, scaling_speed_, max_trans_vel_, max_scaling_factor_);
   double px, py, pth;
   if (footprint_spec_.size() == 0) {
@@ -79,18 +79,49 @@ double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
     ROS_ERROR("Footprint spec is empty, maybe missing call to setFootprint?");
     return -9;
   }
+  if (traj.getPointsSize() == 0) {
+    return 0;
+  }
 
-  for (unsigned int i = 0; i < traj.getPointsSize(); ++i) {
-    traj.getPoint(i, px, py, pth);
-    cost = footprintCost(px, py, pth,
-        scale,
-        footprint_spec_,
-        costmap_,
-        world_model_);
+  // the score is the cost of the footprint at the end of the trajectory,
+  // the points before it do not change it
+  traj.getPoint(traj.getPointsSize() - 1, px, py, pth);
+  double cost = footprintCost(px, py, pth,
+      scale,
+      footprint_spec_,
+      costmap_,
+      world_model_);
+  if (interpolate_ && cost >= 0) {
+    cost = interpolateCost(px, py, pth, scale, cost);
   }
   return cost;
 }
 
+double ObstacleCostFunction::interpolateCost(double wx, double wy, double th, double scale, double cell_cost) {
+  // position in cell units, relative to the center of cell (0, 0)
+  double gx = (wx - costmap_->getOriginX()) / costmap_->getResolution() - 0.5;
+  double gy = (wy - costmap_->getOriginY()) / costmap_->getResolution() - 0.5;
+  int x0 = (int)floor(gx);
+  int y0 = (int)floor(gy);
+  if (x0 < 0 || y0 < 0 || x0 + 1 >= (int)costmap_->getSizeInCellsX() || y0 + 1 >= (int)costmap_->getSizeInCellsY()) {
+    return cell_cost;
+  }
+  double c[2][2];
+  for (int dx = 0; dx < 2; ++dx) {
+    for (int dy = 0; dy < 2; ++dy) {
+      double cx, cy;
+      costmap_->mapToWorld(x0 + dx, y0 + dy, cx, cy);
+      c[dx][dy] = footprintCost(cx, cy, th, scale, footprint_spec_, costmap_, world_model_);
+      if (c[dx][dy] < 0) {
+        return cell_cost;
+      }
+    }
+  }
+  double fx = gx - x0;
+  double fy = gy - y0;
+  return (1 - fy) * ((1 - fx) * c[0][0] + fx * c[1][0]) + fy * ((1 - fx) * c[0][1] + fx * c[1][1]);
+}
+
 double ObstacleCostFunction::getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor) {
   double vmag = sqrt(traj.xv_ * traj.xv_ + traj.yv_ * traj.yv_);
 
@@ -110,7 +141,7 @@ double ObstacleCostFunction::footprintCost (
     const double& y,
     const double& th,
     double scale,
-    std::vector<geometry_msgs::Point> footprint_spec,
+    const std::vector<geometry_msgs::Point>& footprint_spec,
     costmap_2d::Costmap2D* costmap,
     base_local_planner::WorldModel* world_model) {
 
@@ -128,7 +159,7 @@ double ObstacleCostFunction::footprintCost (
     return -7.0;
   }
 
-  double occ_cost = std::max(std::max(occ_cost, footprint_cost), double(costmap->getCost(cell_x, cell_y)));
+  double occ_cost = std::max(std::max(0.0, footprint_cost), double(costmap->getCost(cell_x, cell_y)));
 
   return occ_cost;
 }
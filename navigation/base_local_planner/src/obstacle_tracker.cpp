@@ -0,0 +1,371 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/obstacle_tracker.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace base_local_planner {
+
+ObstacleTracker::ObstacleTracker() :
+    cluster_tolerance_(0.2), max_cluster_size_(1.0), min_cluster_points_(3),
+    association_distance_(0.5), max_age_(0.5), max_tracks_(50),
+    alpha_(0.5), beta_(0.2), last_stamp_(-1.0), next_id_(0), table_mask_(0) {
+}
+
+void ObstacleTracker::setParams(double cluster_tolerance, double max_cluster_size, unsigned int min_cluster_points,
+    double association_distance, double max_age, unsigned int max_tracks) {
+  cluster_tolerance_ = cluster_tolerance;
+  max_cluster_size_ = max_cluster_size;
+  min_cluster_points_ = std::max(1u, min_cluster_points);
+  association_distance_ = association_distance;
+  max_age_ = max_age;
+  max_tracks_ = max_tracks;
+}
+
+void ObstacleTracker::reset() {
+  tracks_.clear();
+  last_stamp_ = -1.0;
+  topic_stamps_.clear();
+}
+
+bool ObstacleTracker::update(const std::vector<costmap_2d::Observation>& observations) {
+  // only look at what arrived from each topic since the last update, the
+  // buffers hand out the same observation until the sensor publishes again
+  is_new_.assign(observations.size(), false);
+  double stamp = -1.0;
+  unsigned int num_points = 0;
+  const costmap_2d::Observation* sensor = NULL;
+  for (unsigned int i = 0; i < observations.size(); ++i) {
+    double obs_stamp = observations[i].cloud_.header.stamp.toSec();
+    std::map<std::string, double>::const_iterator seen = topic_stamps_.find(observations[i].topic_);
+    if (seen != topic_stamps_.end() && obs_stamp <= seen->second) {
+      continue;
+    }
+    is_new_[i] = true;
+    stamp = std::max(stamp, obs_stamp);
+    num_points += observations[i].cloud_.points.size();
+    if (sensor == NULL) {
+      sensor = &observations[i];
+    }
+  }
+  if (sensor == NULL) {
+    return false;
+  }
+  for (unsigned int i = 0; i < observations.size(); ++i) {
+    if (is_new_[i]) {
+      double& topic_stamp = topic_stamps_.insert(std::make_pair(observations[i].topic_, -1.0)).first->second;
+      topic_stamp = std::max(topic_stamp, observations[i].cloud_.header.stamp.toSec());
+    }
+  }
+
+  // a table with at least twice as many slots as there can be cells
+  unsigned int table_size = 64;
+  while (table_size < 2 * num_points) {
+    table_size *= 2;
+  }
+  cell_table_.assign(table_size, UINT_MAX);
+  table_mask_ = table_size - 1;
+  cells_.clear();
+
+  for (unsigned int i = 0; i < observations.size(); ++i) {
+    const costmap_2d::Observation& obs = observations[i];
+    if (!is_new_[i]) {
+      continue;
+    }
+    // same range limit as the obstacle layer uses for marking
+    double obs_stamp = obs.cloud_.header.stamp.toSec();
+    double range_sq = obs.obstacle_range_ * obs.obstacle_range_;
+    const std::vector<pcl::PointXYZ>& points = obs.cloud_.points;
+    for (unsigned int j = 0; j < points.size(); ++j) {
+      double dx = points[j].x - obs.origin_.x;
+      double dy = points[j].y - obs.origin_.y;
+      if (dx * dx + dy * dy > range_sq) {
+        continue;
+      }
+      addPoint(points[j].x, points[j].y, obs_stamp);
+    }
+  }
+
+  buildClusters(sensor->origin_.x, sensor->origin_.y);
+  associate(stamp);
+  last_stamp_ = std::max(last_stamp_, stamp);
+  return true;
+}
+
+void ObstacleTracker::addPoint(double x, double y, double stamp) {
+  int cx = (int) floor(x / cluster_tolerance_);
+  int cy = (int) floor(y / cluster_tolerance_);
+  unsigned int slot = ((unsigned int) cx * 73856093u ^ (unsigned int) cy * 19349663u) & table_mask_;
+  while (cell_table_[slot] != UINT_MAX) {
+    Cell& cell = cells_[cell_table_[slot]];
+    if (cell.cx == cx && cell.cy == cy) {
+      cell.count++;
+      cell.sum_x += x;
+      cell.sum_y += y;
+      cell.min_x = std::min(cell.min_x, x);
+      cell.max_x = std::max(cell.max_x, x);
+      cell.min_y = std::min(cell.min_y, y);
+      cell.max_y = std::max(cell.max_y, y);
+      cell.stamp = std::max(cell.stamp, stamp);
+      return;
+    }
+    slot = (slot + 1) & table_mask_;
+  }
+  cell_table_[slot] = cells_.size();
+  Cell cell;
+  cell.cx = cx;
+  cell.cy = cy;
+  cell.parent = cells_.size();
+  cell.count = 1;
+  cell.sum_x = cell.min_x = cell.max_x = x;
+  cell.sum_y = cell.min_y = cell.max_y = y;
+  cell.stamp = stamp;
+  cells_.push_back(cell);
+}
+
+unsigned int ObstacleTracker::findCell(int cx, int cy) const {
+  unsigned int slot = ((unsigned int) cx * 73856093u ^ (unsigned int) cy * 19349663u) & table_mask_;
+  while (cell_table_[slot] != UINT_MAX) {
+    const Cell& cell = cells_[cell_table_[slot]];
+    if (cell.cx == cx && cell.cy == cy) {
+      return cell_table_[slot];
+    }
+    slot = (slot + 1) & table_mask_;
+  }
+  return UINT_MAX;
+}
+
+unsigned int ObstacleTracker::findRoot(unsigned int cell) {
+  while (cells_[cell].parent != cell) {
+    // path halving
+    cells_[cell].parent = cells_[cells_[cell].parent].parent;
+    cell = cells_[cell].parent;
+  }
+  return cell;
+}
+
+void ObstacleTracker::buildClusters(double sensor_x, double sensor_y) {
+  // connect each cell with its 8 neighbors, looking at half of them from each side
+  static const int offsets[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+  for (unsigned int i = 0; i < cells_.size(); ++i) {
+    for (unsigned int k = 0; k < 4; ++k) {
+      unsigned int neighbor = findCell(cells_[i].cx + offsets[k][0], cells_[i].cy + offsets[k][1]);
+      if (neighbor == UINT_MAX) {
+        continue;
+      }
+      unsigned int root_a = findRoot(i);
+      unsigned int root_b = findRoot(neighbor);
+      if (root_a != root_b) {
+        cells_[std::max(root_a, root_b)].parent = std::min(root_a, root_b);
+      }
+    }
+  }
+
+  clusters_.clear();
+  cluster_of_root_.assign(cells_.size(), UINT_MAX);
+  for (unsigned int i = 0; i < cells_.size(); ++i) {
+    const Cell& cell = cells_[i];
+    unsigned int root = findRoot(i);
+    if (cluster_of_root_[root] == UINT_MAX) {
+      cluster_of_root_[root] = clusters_.size();
+      Cluster cluster;
+      cluster.count = 0;
+      cluster.sum_x = cluster.sum_y = 0.0;
+      cluster.min_x = cell.min_x;
+      cluster.max_x = cell.max_x;
+      cluster.min_y = cell.min_y;
+      cluster.max_y = cell.max_y;
+      cluster.stamp = cell.stamp;
+      clusters_.push_back(cluster);
+    }
+    Cluster& cluster = clusters_[cluster_of_root_[root]];
+    cluster.count += cell.count;
+    cluster.sum_x += cell.sum_x;
+    cluster.sum_y += cell.sum_y;
+    cluster.min_x = std::min(cluster.min_x, cell.min_x);
+    cluster.max_x = std::max(cluster.max_x, cell.max_x);
+    cluster.min_y = std::min(cluster.min_y, cell.min_y);
+    cluster.max_y = std::max(cluster.max_y, cell.max_y);
+    cluster.stamp = std::max(cluster.stamp, cell.stamp);
+  }
+
+  for (unsigned int i = 0; i < clusters_.size(); ++i) {
+    clusters_[i].x = clusters_[i].sum_x / clusters_[i].count;
+    clusters_[i].y = clusters_[i].sum_y / clusters_[i].count;
+    clusters_[i].radius = 0.0;
+  }
+  // the farthest corner of the points in each cell bounds the radius
+  for (unsigned int i = 0; i < cells_.size(); ++i) {
+    const Cell& cell = cells_[i];
+    Cluster& cluster = clusters_[cluster_of_root_[findRoot(i)]];
+    double reach_x = std::max(cell.max_x - cluster.x, cluster.x - cell.min_x);
+    double reach_y = std::max(cell.max_y - cluster.y, cluster.y - cell.min_y);
+    cluster.radius = std::max(cluster.radius, reach_x * reach_x + reach_y * reach_y);
+  }
+
+  // keep the clusters that could be something moving
+  unsigned int num_kept = 0;
+  for (unsigned int i = 0; i < clusters_.size(); ++i) {
+    Cluster cluster = clusters_[i];
+    double size_x = cluster.max_x - cluster.min_x;
+    double size_y = cluster.max_y - cluster.min_y;
+    if (cluster.count < min_cluster_points_ || size_x > max_cluster_size_ || size_y > max_cluster_size_) {
+      continue;
+    }
+    cluster.radius = sqrt(cluster.radius);
+    cluster.sensor_dist_sq = (cluster.x - sensor_x) * (cluster.x - sensor_x) + (cluster.y - sensor_y) * (cluster.y - sensor_y);
+    clusters_[num_kept++] = cluster;
+  }
+  clusters_.resize(num_kept);
+}
+
+void ObstacleTracker::associate(double stamp) {
+  unsigned int num_tracks = 0;
+  for (unsigned int i = 0; i < tracks_.size(); ++i) {
+    if (stamp - tracks_[i].last_seen <= max_age_) {
+      tracks_[num_tracks++] = tracks_[i];
+    }
+  }
+  tracks_.resize(num_tracks);
+
+  // greedy nearest neighbor association between tracks and clusters, each
+  // track predicted to the stamp of the topic that saw the cluster
+  double gate_sq = association_distance_ * association_distance_;
+  matches_.clear();
+  for (unsigned int i = 0; i < tracks_.size(); ++i) {
+    const TrackedObstacle& track = tracks_[i];
+    for (unsigned int j = 0; j < clusters_.size(); ++j) {
+      double dt = clusters_[j].stamp - track.last_seen;
+      double dx = clusters_[j].x - (track.x + track.vx * dt);
+      double dy = clusters_[j].y - (track.y + track.vy * dt);
+      double dist_sq = dx * dx + dy * dy;
+      if (dist_sq <= gate_sq) {
+        Match match;
+        match.dist_sq = dist_sq;
+        match.track = i;
+        match.cluster = j;
+        matches_.push_back(match);
+      }
+    }
+  }
+  std::sort(matches_.begin(), matches_.end());
+
+  track_matched_.assign(tracks_.size(), false);
+  cluster_matched_.assign(clusters_.size(), false);
+  for (unsigned int m = 0; m < matches_.size(); ++m) {
+    const Match& match = matches_[m];
+    if (track_matched_[match.track] || cluster_matched_[match.cluster]) {
+      continue;
+    }
+    track_matched_[match.track] = true;
+    cluster_matched_[match.cluster] = true;
+
+    TrackedObstacle& track = tracks_[match.track];
+    const Cluster& cluster = clusters_[match.cluster];
+    double dt = cluster.stamp - track.last_seen;
+    if (dt <= 0.0) {
+      // a lagging topic saw the track before its last sighting, which only
+      // corrects the position, the velocity would be divided by nothing
+      track.x += alpha_ * (cluster.x - (track.x + track.vx * dt));
+      track.y += alpha_ * (cluster.y - (track.y + track.vy * dt));
+    } else if (track.hits == 1) {
+      // the second sighting gives the first velocity
+      track.vx = (cluster.x - track.x) / dt;
+      track.vy = (cluster.y - track.y) / dt;
+      track.x = cluster.x;
+      track.y = cluster.y;
+    } else {
+      double px = track.x + track.vx * dt;
+      double py = track.y + track.vy * dt;
+      double rx = cluster.x - px;
+      double ry = cluster.y - py;
+      track.x = px + alpha_ * rx;
+      track.y = py + alpha_ * ry;
+      track.vx += beta_ * rx / dt;
+      track.vy += beta_ * ry / dt;
+    }
+    track.radius += alpha_ * (cluster.radius - track.radius);
+    track.last_seen = std::max(track.last_seen, cluster.stamp);
+    track.hits++;
+  }
+
+  // start tracks for the remaining clusters, closest to the sensor first
+  new_clusters_.clear();
+  for (unsigned int j = 0; j < clusters_.size(); ++j) {
+    if (!cluster_matched_[j]) {
+      new_clusters_.push_back(j);
+    }
+  }
+  for (unsigned int k = 0; k < new_clusters_.size() && tracks_.size() < max_tracks_; ++k) {
+    // partial selection sort, there are rarely many slots left
+    unsigned int best = k;
+    for (unsigned int l = k + 1; l < new_clusters_.size(); ++l) {
+      if (clusters_[new_clusters_[l]].sensor_dist_sq < clusters_[new_clusters_[best]].sensor_dist_sq) {
+        best = l;
+      }
+    }
+    std::swap(new_clusters_[k], new_clusters_[best]);
+    const Cluster& cluster = clusters_[new_clusters_[k]];
+    TrackedObstacle track;
+    track.x = cluster.x;
+    track.y = cluster.y;
+    track.vx = track.vy = 0.0;
+    track.radius = cluster.radius;
+    track.last_seen = cluster.stamp;
+    track.hits = 1;
+    track.id = next_id_++;
+    tracks_.push_back(track);
+  }
+}
+
+void ObstacleTracker::getMovingTracks(double stamp, double min_speed, unsigned int min_hits,
+    std::vector<TrackedObstacle>& tracks) const {
+  tracks.clear();
+  for (unsigned int i = 0; i < tracks_.size(); ++i) {
+    const TrackedObstacle& track = tracks_[i];
+    if (track.hits < min_hits || track.vx * track.vx + track.vy * track.vy < min_speed * min_speed) {
+      continue;
+    }
+    double dt = stamp - track.last_seen;
+    TrackedObstacle moved = track;
+    moved.x += track.vx * dt;
+    moved.y += track.vy * dt;
+    tracks.push_back(moved);
+  }
+}
+
+} /* namespace base_local_planner */
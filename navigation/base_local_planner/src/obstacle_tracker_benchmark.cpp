@@ -0,0 +1,341 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <base_local_planner/obstacle_tracker.h>
+#include <base_local_planner/velocity_obstacle_cost_function.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ros/time.h>
+
+using namespace base_local_planner;
+
+/*
+ * Replays a recording of obstacle observations through the ObstacleTracker
+ * and the VelocityObstacleCostFunction at the rate of a local planner, and
+ * reports how long the tracker update and the scoring of a sample set take
+ * per cycle. Recordings are text files made of frames:
+ *
+ *   frame <stamp> <origin x> <origin y> <number of points>
+ *   <x> <y>
+ *   ...
+ *
+ * Without a recording, a room with walkers is synthesized, which can also
+ * be written out with --write.
+ */
+
+struct Frame {
+  double stamp;
+  double origin_x, origin_y;
+  std::vector<pcl::PointXYZ> points;
+  // velocities of the walkers in the synthesized scene
+  std::vector<double> truth_x, truth_y, truth_vx, truth_vy;
+};
+
+void usage(const char* name){
+  fprintf(stderr,
+      "Usage: %s [options] [recording.txt]\n"
+      "Replays recorded obstacle observations through the obstacle tracker and the velocity obstacle critic\n"
+      "  --walkers n        walkers in the synthesized scene (default 50)\n"
+      "  --duration s       length of the synthesized scene in seconds (default 30)\n"
+      "  --write file       write the synthesized scene as a recording\n"
+      "  --samples n        trajectories scored per cycle (default 600)\n"
+      "  --rate hz          controller frequency (default 20)\n"
+      "  --budget ms        time allowed per cycle (default 2)\n", name);
+}
+
+double uniform(double low, double high){
+  return low + (high - low) * (rand() / (RAND_MAX + 1.0));
+}
+
+// a 20x20 m room with the sensor in the middle, scanned at 10 Hz
+void synthesize(int num_walkers, double duration, std::vector<Frame>& frames){
+  const double half_size = 10.0, walker_radius = 0.25;
+  srand(42);
+  std::vector<double> x(num_walkers), y(num_walkers), vx(num_walkers), vy(num_walkers);
+  for(int i = 0; i < num_walkers; ++i){
+    do {
+      x[i] = uniform(-half_size + 1.0, half_size - 1.0);
+      y[i] = uniform(-half_size + 1.0, half_size - 1.0);
+    } while(hypot(x[i], y[i]) < 2.0);
+    double speed = uniform(0.3, 1.5), heading = uniform(-M_PI, M_PI);
+    vx[i] = speed * cos(heading);
+    vy[i] = speed * sin(heading);
+  }
+
+  const double dt = 0.1;
+  for(int f = 0; f * dt < duration; ++f){
+    Frame frame;
+    frame.stamp = f * dt;
+    frame.origin_x = frame.origin_y = 0.0;
+    for(double s = -half_size; s < half_size; s += 0.05){
+      frame.points.push_back(pcl::PointXYZ(s, -half_size, 0.5));
+      frame.points.push_back(pcl::PointXYZ(s, half_size, 0.5));
+      frame.points.push_back(pcl::PointXYZ(-half_size, s, 0.5));
+      frame.points.push_back(pcl::PointXYZ(half_size, s, 0.5));
+    }
+    for(int i = 0; i < num_walkers; ++i){
+      // the side of the walker that faces the sensor, with a little noise
+      double facing = atan2(-y[i], -x[i]);
+      for(double a = -M_PI / 2; a <= M_PI / 2; a += M_PI / 16){
+        frame.points.push_back(pcl::PointXYZ(
+            x[i] + walker_radius * cos(facing + a) + uniform(-0.01, 0.01),
+            y[i] + walker_radius * sin(facing + a) + uniform(-0.01, 0.01), 0.5));
+      }
+      frame.truth_x.push_back(x[i]);
+      frame.truth_y.push_back(y[i]);
+      frame.truth_vx.push_back(vx[i]);
+      frame.truth_vy.push_back(vy[i]);
+
+      x[i] += vx[i] * dt;
+      y[i] += vy[i] * dt;
+      if(fabs(x[i]) > half_size - 1.0)
+        vx[i] = -vx[i];
+      if(fabs(y[i]) > half_size - 1.0)
+        vy[i] = -vy[i];
+    }
+    frames.push_back(frame);
+  }
+}
+
+bool readRecording(const char* file_name, std::vector<Frame>& frames){
+  FILE* file = fopen(file_name, "r");
+  if(file == NULL){
+    fprintf(stderr, "Could not open %s\n", file_name);
+    return false;
+  }
+  char line[256];
+  while(fgets(line, sizeof(line), file)){
+    Frame frame;
+    unsigned int num_points;
+    if(line[0] == '#' || line[0] == '\n')
+      continue;
+    if(sscanf(line, "frame %lf %lf %lf %u", &frame.stamp, &frame.origin_x, &frame.origin_y, &num_points) != 4){
+      fprintf(stderr, "Bad frame header in %s: %s", file_name, line);
+      fclose(file);
+      return false;
+    }
+    for(unsigned int i = 0; i < num_points; ++i){
+      double px, py;
+      if(!fgets(line, sizeof(line), file) || sscanf(line, "%lf %lf", &px, &py) != 2){
+        fprintf(stderr, "Truncated frame at %.3f in %s\n", frame.stamp, file_name);
+        fclose(file);
+        return false;
+      }
+      frame.points.push_back(pcl::PointXYZ(px, py, 0.5));
+    }
+    frames.push_back(frame);
+  }
+  fclose(file);
+  return true;
+}
+
+bool writeRecording(const char* file_name, const std::vector<Frame>& frames){
+  FILE* file = fopen(file_name, "w");
+  if(file == NULL){
+    fprintf(stderr, "Could not open %s\n", file_name);
+    return false;
+  }
+  fprintf(file, "# frame <stamp> <origin x> <origin y> <number of points>, then <x> <y> per point\n");
+  for(unsigned int f = 0; f < frames.size(); ++f){
+    const Frame& frame = frames[f];
+    fprintf(file, "frame %.6f %.4f %.4f %u\n", frame.stamp, frame.origin_x, frame.origin_y, (unsigned int) frame.points.size());
+    for(unsigned int i = 0; i < frame.points.size(); ++i)
+      fprintf(file, "%.4f %.4f\n", frame.points[i].x, frame.points[i].y);
+  }
+  fclose(file);
+  return true;
+}
+
+double percentile(std::vector<double> values, double p){
+  if(values.empty())
+    return 0.0;
+  std::sort(values.begin(), values.end());
+  unsigned int index = std::min(values.size() - 1, (size_t) (p / 100.0 * values.size()));
+  return values[index];
+}
+
+int main(int argc, char** argv){
+  int num_walkers = 50, num_samples = 600;
+  double duration = 30.0, rate = 20.0, budget = 2.0;
+  const char* recording = NULL;
+  const char* write_file = NULL;
+  for(int i = 1; i < argc; ++i){
+    if(!strcmp(argv[i], "--walkers") && i + 1 < argc)
+      num_walkers = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--duration") && i + 1 < argc)
+      duration = atof(argv[++i]);
+    else if(!strcmp(argv[i], "--write") && i + 1 < argc)
+      write_file = argv[++i];
+    else if(!strcmp(argv[i], "--samples") && i + 1 < argc)
+      num_samples = std::max(1, atoi(argv[++i]));
+    else if(!strcmp(argv[i], "--rate") && i + 1 < argc)
+      rate = atof(argv[++i]);
+    else if(!strcmp(argv[i], "--budget") && i + 1 < argc)
+      budget = atof(argv[++i]);
+    else if(argv[i][0] != '-' && recording == NULL)
+      recording = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<Frame> frames;
+  if(recording != NULL){
+    if(!readRecording(recording, frames))
+      return 1;
+  }
+  else {
+    synthesize(num_walkers, duration, frames);
+    if(write_file != NULL && !writeRecording(write_file, frames))
+      return 1;
+  }
+  if(frames.empty()){
+    fprintf(stderr, "No frames to replay\n");
+    return 1;
+  }
+
+  // a sample set like the one of the dwa planner: arcs of a robot at the origin
+  std::vector<geometry_msgs::Point> footprint;
+  geometry_msgs::Point pt;
+  pt.x = 0.3; pt.y = 0.25; footprint.push_back(pt);
+  pt.x = 0.3; pt.y = -0.25; footprint.push_back(pt);
+  pt.x = -0.3; pt.y = -0.25; footprint.push_back(pt);
+  pt.x = -0.3; pt.y = 0.25; footprint.push_back(pt);
+  std::vector<Trajectory> trajectories;
+  int num_vx = std::max(1, (int) sqrt(num_samples / 6.0));
+  int num_vth = std::max(1, num_samples / num_vx);
+  for(int i = 0; i < num_vx; ++i){
+    for(int j = 0; j < num_vth; ++j){
+      double v = 0.6 * (i + 1) / num_vx, w = num_vth > 1 ? -1.0 + 2.0 * j / (num_vth - 1) : 0.0;
+      Trajectory traj(v, 0.0, w, 0.1, 0);
+      double x = 0.0, y = 0.0, th = 0.0;
+      for(int k = 0; k < 18; ++k){
+        traj.addPoint(x, y, th);
+        x += v * cos(th) * 0.1;
+        y += v * sin(th) * 0.1;
+        th += w * 0.1;
+      }
+      trajectories.push_back(traj);
+    }
+  }
+
+  ObstacleTracker tracker;
+  VelocityObstacleCostFunction critic(&tracker);
+  critic.setFootprint(footprint);
+
+  std::vector<double> update_times, score_times, cycle_times;
+  double max_tracks = 0, sum_moving = 0, velocity_error_sq = 0;
+  unsigned int num_cycles = 0, num_penalized = 0, num_matched = 0;
+  std::vector<costmap_2d::Observation> observations(1);
+  unsigned int next_frame = 0;
+  double start = frames.front().stamp, end = frames.back().stamp;
+  for(double now = start; now <= end + 1e-9; now += 1.0 / rate){
+    // the buffer holds the newest frame up to now
+    while(next_frame < frames.size() && frames[next_frame].stamp <= now + 1e-9){
+      const Frame& frame = frames[next_frame];
+      costmap_2d::Observation& obs = observations[0];
+      obs.origin_.x = frame.origin_x;
+      obs.origin_.y = frame.origin_y;
+      obs.cloud_.points = frame.points;
+      obs.cloud_.header.stamp = ros::Time(frame.stamp);
+      obs.obstacle_range_ = 10.0;
+      ++next_frame;
+    }
+
+    ros::WallTime cycle_start = ros::WallTime::now();
+    tracker.update(observations);
+    ros::WallTime update_end = ros::WallTime::now();
+    critic.setStamp(now);
+    critic.prepare();
+    for(unsigned int i = 0; i < trajectories.size(); ++i){
+      if(critic.scoreTrajectory(trajectories[i]) > 0)
+        ++num_penalized;
+    }
+    ros::WallTime cycle_end = ros::WallTime::now();
+
+    update_times.push_back(1000 * (update_end - cycle_start).toSec());
+    score_times.push_back(1000 * (cycle_end - update_end).toSec());
+    cycle_times.push_back(1000 * (cycle_end - cycle_start).toSec());
+    max_tracks = std::max(max_tracks, (double) tracker.getTracks().size());
+    sum_moving += critic.getNumTracks();
+    ++num_cycles;
+
+    // against the synthesized walkers, the velocity of the nearest confirmed track
+    const Frame& frame = frames[next_frame - 1];
+    std::vector<TrackedObstacle> moving;
+    tracker.getMovingTracks(tracker.getLastStamp(), 0.0, 5, moving);
+    for(unsigned int i = 0; i < moving.size(); ++i){
+      double best = 0.3 * 0.3;
+      int walker = -1;
+      for(unsigned int w = 0; w < frame.truth_x.size(); ++w){
+        double dx = moving[i].x - frame.truth_x[w], dy = moving[i].y - frame.truth_y[w];
+        if(dx * dx + dy * dy < best){
+          best = dx * dx + dy * dy;
+          walker = w;
+        }
+      }
+      if(walker >= 0){
+        double ex = moving[i].vx - frame.truth_vx[walker], ey = moving[i].vy - frame.truth_vy[walker];
+        velocity_error_sq += ex * ex + ey * ey;
+        ++num_matched;
+      }
+    }
+  }
+
+  unsigned int num_points = 0;
+  for(unsigned int f = 0; f < frames.size(); ++f)
+    num_points += frames[f].points.size();
+  printf("%u frames, %.0f points per frame, %u cycles at %.0f Hz, %u trajectories per cycle\n",
+      (unsigned int) frames.size(), (double) num_points / frames.size(), num_cycles, rate,
+      (unsigned int) trajectories.size());
+  printf("tracks: at most %.0f, %.1f moving on average, %.1f%% of trajectories penalized\n",
+      max_tracks, sum_moving / num_cycles, 100.0 * num_penalized / (num_cycles * trajectories.size()));
+  if(num_matched > 0)
+    printf("velocity error of confirmed tracks: %.3f m/s rms over %u estimates\n",
+        sqrt(velocity_error_sq / num_matched), num_matched);
+  printf("%-10s %8s %8s %8s %8s\n", "[ms]", "p50", "p90", "p99", "max");
+  printf("%-10s %8.3f %8.3f %8.3f %8.3f\n", "update", percentile(update_times, 50), percentile(update_times, 90),
+      percentile(update_times, 99), percentile(update_times, 100));
+  printf("%-10s %8.3f %8.3f %8.3f %8.3f\n", "scoring", percentile(score_times, 50), percentile(score_times, 90),
+      percentile(score_times, 99), percentile(score_times, 100));
+  printf("%-10s %8.3f %8.3f %8.3f %8.3f\n", "cycle", percentile(cycle_times, 50), percentile(cycle_times, 90),
+      percentile(cycle_times, 99), percentile(cycle_times, 100));
+  bool within_budget = percentile(cycle_times, 99) <= budget;
+  printf("p99 cycle time %s the %.1f ms budget\n", within_budget ? "is within" : "exceeds", budget);
+  return within_budget ? 0 : 2;
+}
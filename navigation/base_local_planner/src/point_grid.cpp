@@ -40,6 +40,8 @@
 #include <sys/time.h>
 #include <math.h>
 #include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 
 using namespace std;
 using namespace costmap_2d;
@@ -75,15 +77,19 @@ void printPolygonPS(const std::vector<geometry_msgs::Point>& poly, double line_w
 namespace base_local_planner {
 
 PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_msgs::Point origin, double max_z, double obstacle_range, double min_seperation) :
-  resolution_(resolution), origin_(origin), max_z_(max_z), sq_obstacle_range_(obstacle_range * obstacle_range), sq_min_separation_(min_seperation * min_seperation)
+  resolution_(resolution), origin_(origin), max_z_(max_z), sq_obstacle_range_(obstacle_range * obstacle_range),
+  min_separation_(min_seperation), sq_min_separation_(min_seperation * min_seperation)
   {
     width_ = (int) (size_x / resolution_);
     height_ = (int) (size_y / resolution_);
-    cells_.resize(width_ * height_);
+    cell_start_.resize(width_ * height_ + 1, 0);
+    cell_size_.resize(width_ * height_, 0);
   }
 
   double PointGrid::footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint, 
       double inscribed_radius, double circumscribed_radius){
+    compact();
+
     //the half-width of the circumscribed sqaure of the robot is equal to the circumscribed radius
     double outer_square_radius = circumscribed_radius;
 
@@ -97,10 +103,10 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
 
     //This may return points that are still outside of the cirumscribed square because it returns the cells
     //contained by the range
-    getPointsInRange(c_lower_left, c_upper_right, points_);
+    getPointsInRange(c_lower_left, c_upper_right, range_cells_);
 
     //if there are no points in the circumscribed square... we don't have to check against the footprint
-    if(points_.empty())
+    if(range_cells_.empty())
       return 1.0;
 
     //compute the half-width of the inner square from the inscribed radius of the robot
@@ -114,31 +120,42 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
     i_upper_right.x = position.x + inner_square_radius;
     i_upper_right.y = position.y + inner_square_radius;
 
-    //if there are points, we have to do a more expensive check
-    for(unsigned int i = 0; i < points_.size(); ++i){
-      list<pcl::PointXYZ>* cell_points = points_[i];
-      if(cell_points != NULL){
-        for(list<pcl::PointXYZ>::iterator it = cell_points->begin(); it != cell_points->end(); ++it){
-          const pcl::PointXYZ& pt = *it;
-          //first, we'll check to make sure we're in the outer square
-          //printf("(%.2f, %.2f) ... l(%.2f, %.2f) ... u(%.2f, %.2f)\n", pt.x, pt.y, c_lower_left.x, c_lower_left.y, c_upper_right.x, c_upper_right.y);
-          if(pt.x > c_lower_left.x && pt.x < c_upper_right.x && pt.y > c_lower_left.y && pt.y < c_upper_right.y){
-            //do a quick check to see if the point lies in the inner square of the robot
-            if(pt.x > i_lower_left.x && pt.x < i_upper_right.x && pt.y > i_lower_left.y && pt.y < i_upper_right.y)
-              return -1.0;
-
-            //now we really have to do a full footprint check on the point
-            if(ptInPolygon(pt, footprint))
-              return -1.0;
-          }
-        }
+    computeHalfPlanes(footprint);
+
+    //if there are points, we have to do a more expensive check, a cell at a time
+    //so the inner loop runs over contiguous points without early exits
+    for(unsigned int i = 0; i < range_cells_.size(); ++i){
+      unsigned int index = range_cells_[i];
+      const pcl::PointXYZ* cell_points = &cell_points_[cell_start_[index]];
+      unsigned int num_points = cell_size_[index];
+      bool hit = false;
+      for(unsigned int j = 0; j < num_points; ++j){
+        const pcl::PointXYZ& pt = cell_points[j];
+        //the point has to be in the outer square and then either in the inner square or the footprint itself
+        bool in_outer = pt.x > c_lower_left.x && pt.x < c_upper_right.x && pt.y > c_lower_left.y && pt.y < c_upper_right.y;
+        bool in_inner = pt.x > i_lower_left.x && pt.x < i_upper_right.x && pt.y > i_lower_left.y && pt.y < i_upper_right.y;
+        hit |= in_outer && (in_inner || ptInHalfPlanes(pt));
       }
+      if(hit)
+        return -1.0;
     }
 
     //if we get through all the points and none of them are in the footprint it's legal
     return 1.0;
   }
 
+  void PointGrid::computeHalfPlanes(const std::vector<geometry_msgs::Point>& poly){
+    half_planes_.resize(poly.size());
+    for(unsigned int i = 0; i < poly.size(); ++i){
+      //orient(a, b, c) expanded so that it is linear in c
+      const geometry_msgs::Point& a = poly[i];
+      const geometry_msgs::Point& b = poly[(i + 1) % poly.size()];
+      half_planes_[i].a = a.y - b.y;
+      half_planes_[i].b = b.x - a.x;
+      half_planes_[i].c = a.x * b.y - a.y * b.x;
+    }
+  }
+
   bool PointGrid::ptInPolygon(const pcl::PointXYZ& pt, const std::vector<geometry_msgs::Point>& poly){
     if(poly.size() < 3)
       return false;
@@ -146,37 +163,18 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
     //a point is in a polygon iff the orientation of the point
     //with respect to sides of the polygon is the same for every
     //side of the polygon
-    bool all_left = false;
-    bool all_right = false;
-    for(unsigned int i = 0; i < poly.size() - 1; ++i){
-      //if pt left of a->b
-      if(orient(poly[i], poly[i + 1], pt) > 0){
-        if(all_right)
-          return false;
-        all_left = true;
-      }
-      //if pt right of a->b
-      else{
-        if(all_left)
-          return false;
-        all_right = true;
-      }
-    }
+    unsigned int left = 0;
+    for(unsigned int i = 0; i < poly.size() - 1; ++i)
+      left += orient(poly[i], poly[i + 1], pt) > 0;
     //also need to check the last point with the first point
-    if(orient(poly[poly.size() - 1], poly[0], pt) > 0){
-      if(all_right)
-        return false;
-    }
-    else{
-      if(all_left)
-        return false;
-    }
+    left += orient(poly[poly.size() - 1], poly[0], pt) > 0;
 
-    return true;
+    return left == 0 || left == poly.size();
   }
 
-  void PointGrid::getPointsInRange(const geometry_msgs::Point& lower_left, const geometry_msgs::Point& upper_right, vector< list<pcl::PointXYZ>* >& points){
-    points.clear();
+  void PointGrid::getPointsInRange(const geometry_msgs::Point& lower_left, const geometry_msgs::Point& upper_right, vector<unsigned int>& cells){
+    cells.clear();
+    compact();
 
     //compute the other corners of the box so we can get cells indicies for them
     geometry_msgs::Point upper_left, lower_right;
@@ -214,20 +212,13 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
      *  |                               |
      * (0, height) ----------------- (width, height)
      */
-    //get an iterator
-    vector< list<pcl::PointXYZ> >::iterator cell_iterator = cells_.begin() + lower_left_index;
-    //printf("Index: %d, Width: %d, x_steps: %d, y_steps: %d\n", lower_left_index, width_, x_steps, y_steps);
     for(unsigned int i = 0; i < y_steps; ++i){
+      unsigned int row_start = lower_left_index + i * width_;
       for(unsigned int j = 0; j < x_steps; ++j){
-        list<pcl::PointXYZ>& cell = *cell_iterator;
-        //if the cell contains any points... we need to push them back to our list
-        if(!cell.empty()){
-          points.push_back(&cell);
-        }
-        if(j < x_steps - 1)
-          cell_iterator++; //move a cell in the x direction
+        //if the cell contains any points... we need to push it back to our list
+        if(cell_size_[row_start + j] > 0)
+          cells.push_back(row_start + j);
       }
-      cell_iterator += width_ - (x_steps - 1); //move down a row
     }
   }
 
@@ -239,30 +230,111 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
     if(!gridCoords(pt, gx, gy))
       return;
 
-    //if the point is too close to its nearest neighbor... return
-    if(nearestNeighborDistance(pt) < sq_min_separation_)
+    //if the point is too close to its nearest neighbor in the grid or among
+    //the points waiting to be added... return
+    if(sq_min_separation_ > 0.0 && (nearestInGrid(pt) < sq_min_separation_ || nearestStaged(pt) < sq_min_separation_))
       return;
 
-    //get the associated index
-    unsigned int pt_index = gridIndex(gx, gy);
+    //stage the point, it is moved into its cell at the next compaction
+    staged_points_.push_back(pt);
+    staged_cells_.push_back(gridIndex(gx, gy));
+    if(sq_min_separation_ > 0.0)
+      hashStaged();
+  }
 
-    //insert the point into the grid at the correct location
-    cells_[pt_index].push_back(pt);
-    //printf("Index: %d, size: %d\n", pt_index, cells_[pt_index].size());
+  void PointGrid::hashStaged(){
+    //keep at least two buckets per staged point so the chains stay short
+    if(hash_heads_.size() < 2 * staged_points_.size()){
+      hash_heads_.assign(std::max<size_t>(1024, 2 * hash_heads_.size()), -1);
+      hash_next_.resize(staged_points_.size());
+      for(unsigned int i = 0; i < staged_points_.size(); ++i){
+        unsigned int bucket = hashBucket((int) floor(staged_points_[i].x / min_separation_), (int) floor(staged_points_[i].y / min_separation_));
+        hash_next_[i] = hash_heads_[bucket];
+        hash_heads_[bucket] = i;
+      }
+      return;
+    }
+
+    int i = staged_points_.size() - 1;
+    unsigned int bucket = hashBucket((int) floor(staged_points_[i].x / min_separation_), (int) floor(staged_points_[i].y / min_separation_));
+    hash_next_.push_back(hash_heads_[bucket]);
+    hash_heads_[bucket] = i;
   }
 
-  double PointGrid::getNearestInCell(pcl::PointXYZ& pt, unsigned int gx, unsigned int gy){
-    unsigned int index = gridIndex(gx, gy);
+  double PointGrid::nearestStaged(const pcl::PointXYZ& pt) const {
+    double min_sq_dist = DBL_MAX;
+    if(staged_points_.empty())
+      return min_sq_dist;
+
+    //buckets are min_separation wide, so any staged point closer than that
+    //lies in one of the 3x3 buckets around the point
+    int hx = (int) floor(pt.x / min_separation_);
+    int hy = (int) floor(pt.y / min_separation_);
+    for(int dy = -1; dy <= 1; ++dy){
+      for(int dx = -1; dx <= 1; ++dx){
+        for(int i = hash_heads_[hashBucket(hx + dx, hy + dy)]; i >= 0; i = hash_next_[i]){
+          const pcl::PointXYZ& other = staged_points_[i];
+          min_sq_dist = min(min_sq_dist, (double) (pt.x - other.x) * (pt.x - other.x) + (pt.y - other.y) * (pt.y - other.y));
+        }
+      }
+    }
+    return min_sq_dist;
+  }
+
+  void PointGrid::compact(){
+    if(staged_points_.empty())
+      return;
+
+    unsigned int num_cells = width_ * height_;
+
+    //count the points that will end up in each cell and turn the counts into offsets
+    compact_start_.resize(num_cells + 1);
+    compact_start_[0] = 0;
+    for(unsigned int i = 0; i < num_cells; ++i)
+      compact_start_[i + 1] = cell_size_[i];
+    for(unsigned int i = 0; i < staged_cells_.size(); ++i)
+      compact_start_[staged_cells_[i] + 1]++;
+    for(unsigned int i = 0; i < num_cells; ++i)
+      compact_start_[i + 1] += compact_start_[i];
+
+    //copy the live points over, dropping the gaps left by removals, then append the staged points
+    compact_points_.resize(compact_start_[num_cells]);
+    for(unsigned int i = 0; i < num_cells; ++i){
+      if(cell_size_[i] > 0)
+        std::copy(cell_points_.begin() + cell_start_[i], cell_points_.begin() + cell_start_[i] + cell_size_[i],
+            compact_points_.begin() + compact_start_[i]);
+    }
+    for(unsigned int i = 0; i < staged_points_.size(); ++i){
+      unsigned int index = staged_cells_[i];
+      compact_points_[compact_start_[index] + cell_size_[index]++] = staged_points_[i];
+    }
+
+    cell_points_.swap(compact_points_);
+    cell_start_.swap(compact_start_);
+
+    staged_points_.clear();
+    staged_cells_.clear();
+    hash_next_.clear();
+    if(!hash_heads_.empty())
+      std::fill(hash_heads_.begin(), hash_heads_.end(), -1);
+  }
+
+  double PointGrid::nearestInCell(const pcl::PointXYZ& pt, unsigned int index) const {
     double min_sq_dist = DBL_MAX;
     //loop through the points in the cell and find the minimum distance to the passed point
-    for(list<pcl::PointXYZ>::iterator it = cells_[index].begin(); it != cells_[index].end(); ++it){
-      min_sq_dist = min(min_sq_dist, sq_distance(pt, *it));
+    for(unsigned int i = cell_start_[index]; i < cell_start_[index] + cell_size_[index]; ++i){
+      const pcl::PointXYZ& other = cell_points_[i];
+      min_sq_dist = min(min_sq_dist, (double) (pt.x - other.x) * (pt.x - other.x) + (pt.y - other.y) * (pt.y - other.y));
     }
     return min_sq_dist;
   }
 
+  double PointGrid::getNearestInCell(pcl::PointXYZ& pt, unsigned int gx, unsigned int gy){
+    compact();
+    return nearestInCell(pt, gridIndex(gx, gy));
+  }
 
-  double PointGrid::nearestNeighborDistance(pcl::PointXYZ& pt){
+  double PointGrid::nearestInGrid(const pcl::PointXYZ& pt) const {
     //get the grid coordinates of the point
     unsigned int gx, gy;
 
@@ -272,89 +344,31 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
     geometry_msgs::Point lower_left, upper_right;
     getCellBounds(gx, gy, lower_left, upper_right);
 
-    //now we need to check what cells could contain the nearest neighbor
-    pcl::PointXYZ check_point;
-    double sq_dist = DBL_MAX;
-    double neighbor_sq_dist = DBL_MAX;
-    
-    //left
-    if(gx > 0){
-      check_point.x = lower_left.x;
-      check_point.y = pt.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx - 1, gy));
-    }
-
-    //upper left
-    if(gx > 0 && gy < height_ - 1){
-      check_point.x = lower_left.x;
-      check_point.y = upper_right.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx - 1, gy + 1));
-    }
-
-    //top
-    if(gy < height_ - 1){
-      check_point.x = pt.x;
-      check_point.y = upper_right.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx, gy + 1));
-    }
-
-    //upper right
-    if(gx < width_ - 1 && gy < height_ - 1){
-      check_point.x = upper_right.x;
-      check_point.y = upper_right.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx + 1, gy + 1));
-    }
-
-    //right
-    if(gx < width_ - 1){
-      check_point.x = upper_right.x;
-      check_point.y = pt.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx + 1, gy));
-    }
-
-    //lower right
-    if(gx < width_ - 1 && gy > 0){
-      check_point.x = upper_right.x;
-      check_point.y = lower_left.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx + 1, gy - 1));
-    }
-
-    //bottom
-    if(gy > 0){
-      check_point.x = pt.x;
-      check_point.y = lower_left.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx, gy - 1));
-    }
+    //we must always check within the cell we're in for a nearest neighbor
+    double neighbor_sq_dist = nearestInCell(pt, gridIndex(gx, gy));
 
-    //lower left
-    if(gx > 0 && gy > 0){
-      check_point.x = lower_left.x;
-      check_point.y = lower_left.y;
-      sq_dist = sq_distance(pt, check_point);
-      if(sq_dist < sq_min_separation_)
-        neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx - 1, gy - 1));
+    //the neighboring cells only need checking if they are closer than the minimum separation
+    for(int dy = -1; dy <= 1; ++dy){
+      if((dy < 0 && gy == 0) || (dy > 0 && gy >= height_ - 1))
+        continue;
+      double y_gap = dy < 0 ? pt.y - lower_left.y : (dy > 0 ? upper_right.y - pt.y : 0.0);
+      for(int dx = -1; dx <= 1; ++dx){
+        if((dx == 0 && dy == 0) || (dx < 0 && gx == 0) || (dx > 0 && gx >= width_ - 1))
+          continue;
+        double x_gap = dx < 0 ? pt.x - lower_left.x : (dx > 0 ? upper_right.x - pt.x : 0.0);
+        if(x_gap * x_gap + y_gap * y_gap < sq_min_separation_)
+          neighbor_sq_dist = min(neighbor_sq_dist, nearestInCell(pt, gridIndex(gx + dx, gy + dy)));
+      }
     }
 
-    //we must also check within the cell we're in for a nearest neighbor
-    neighbor_sq_dist = min(neighbor_sq_dist, getNearestInCell(pt, gx, gy));
-
     return neighbor_sq_dist;
   }
 
+  double PointGrid::nearestNeighborDistance(pcl::PointXYZ& pt){
+    compact();
+    return nearestInGrid(pt);
+  }
+
   void PointGrid::updateWorld(const std::vector<geometry_msgs::Point>& footprint, 
       const vector<Observation>& observations, const vector<PlanarLaserScan>& laser_scans){
     //for our 2D point grid we only remove freespace based on the first laser scan
@@ -385,7 +399,8 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
       }
     }
 
-    //remove the points that are in the footprint of the robot
+    //remove the points that are in the footprint of the robot, this also
+    //merges everything inserted above into the grid
     removePointsInPolygon(footprint);
   }
 
@@ -407,27 +422,24 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
       upper_right.y = max((double)upper_right.y, (double)laser_scan.cloud.points[i].y);
     }
 
-    getPointsInRange(lower_left, upper_right, points_);
+    getPointsInRange(lower_left, upper_right, range_cells_);
 
     //if there are no points in the containing square... we don't have to do anything
-    if(points_.empty())
+    if(range_cells_.empty())
       return;
 
     //if there are points, we have to check them against the scan explicitly to remove them
-    for(unsigned int i = 0; i < points_.size(); ++i){
-      list<pcl::PointXYZ>* cell_points = points_[i];
-      if(cell_points != NULL){
-        list<pcl::PointXYZ>::iterator it = cell_points->begin();
-        while(it != cell_points->end()){
-          const pcl::PointXYZ& pt = *it;
-
-          //check if the point is in the polygon and if it is, erase it from the grid
-          if(ptInScan(pt, laser_scan)){
-            it = cell_points->erase(it);
-          }
-          else
-            it++;
-        }
+    for(unsigned int i = 0; i < range_cells_.size(); ++i){
+      unsigned int index = range_cells_[i];
+      pcl::PointXYZ* cell_points = &cell_points_[cell_start_[index]];
+      unsigned int& num_points = cell_size_[index];
+      unsigned int j = 0;
+      while(j < num_points){
+        //check if the point is in the scan and if it is, replace it with the last point in the cell
+        if(ptInScan(cell_points[j], laser_scan))
+          cell_points[j] = cell_points[--num_points];
+        else
+          j++;
       }
     }
   }
@@ -477,9 +489,10 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
   }
 
   void PointGrid::getPoints(pcl::PointCloud<pcl::PointXYZ>& cloud){
-    for(unsigned int i = 0; i < cells_.size(); ++i){
-      for(list<pcl::PointXYZ>::iterator it = cells_[i].begin(); it != cells_[i].end(); ++it){
-        cloud.push_back(*it);
+    compact();
+    for(unsigned int i = 0; i < cell_size_.size(); ++i){
+      for(unsigned int j = cell_start_[i]; j < cell_start_[i] + cell_size_[i]; ++j){
+        cloud.push_back(cell_points_[j]);
       }
     }
   }
@@ -503,27 +516,26 @@ PointGrid::PointGrid(double size_x, double size_y, double resolution, geometry_m
     }
 
     ROS_DEBUG("Lower: (%.2f, %.2f), Upper: (%.2f, %.2f)\n", lower_left.x, lower_left.y, upper_right.x, upper_right.y);
-    getPointsInRange(lower_left, upper_right, points_);
+    getPointsInRange(lower_left, upper_right, range_cells_);
 
     //if there are no points in the containing square... we don't have to do anything
-    if(points_.empty())
+    if(range_cells_.empty())
       return;
 
+    computeHalfPlanes(poly);
+
     //if there are points, we have to check them against the polygon explicitly to remove them
-    for(unsigned int i = 0; i < points_.size(); ++i){
-      list<pcl::PointXYZ>* cell_points = points_[i];
-      if(cell_points != NULL){
-        list<pcl::PointXYZ>::iterator it = cell_points->begin();
-        while(it != cell_points->end()){
-          const pcl::PointXYZ& pt = *it;
-
-          //check if the point is in the polygon and if it is, erase it from the grid
-          if(ptInPolygon(pt, poly)){
-            it = cell_points->erase(it);
-          }
-          else
-            it++;
-        }
+    for(unsigned int i = 0; i < range_cells_.size(); ++i){
+      unsigned int index = range_cells_[i];
+      pcl::PointXYZ* cell_points = &cell_points_[cell_start_[index]];
+      unsigned int& num_points = cell_size_[index];
+      unsigned int j = 0;
+      while(j < num_points){
+        //check if the point is in the polygon and if it is, replace it with the last point in the cell
+        if(ptInHalfPlanes(cell_points[j]))
+          cell_points[j] = cell_points[--num_points];
+        else
+          j++;
       }
     }
   }
@@ -678,6 +690,86 @@ int main(int argc, char** argv){
   else
     printf("%%Illegal footprint\n");
 
+  //a dense cloud around the robot that persists between updates, with a
+  //short range laser only clearing the area close by
+  geometry_msgs::Point dense_origin;
+  PointGrid dense_pg(20.0, 20.0, 0.2, dense_origin, 2.0, 10.0, 0.01);
+
+  Observation dense_obs;
+  dense_obs.origin_.x = 10.0;
+  dense_obs.origin_.y = 10.0;
+  srand(1);
+  for(unsigned int i = 0; i < 50000; ++i){
+    double angle = 2 * M_PI * (rand() / (double) RAND_MAX);
+    double range = 1.0 + 6.0 * (rand() / (double) RAND_MAX);
+    pcl::PointXYZ dense_pt;
+    dense_pt.x = 10.0 + range * cos(angle);
+    dense_pt.y = 10.0 + range * sin(angle);
+    dense_pt.z = 0.5;
+    dense_obs.cloud_.push_back(dense_pt);
+  }
+  obs.push_back(dense_obs);
+
+  PlanarLaserScan dense_scan;
+  dense_scan.origin.x = 10.0;
+  dense_scan.origin.y = 10.0;
+  dense_scan.angle_min = -M_PI;
+  dense_scan.angle_max = M_PI;
+  dense_scan.angle_increment = M_PI / 360;
+  for(unsigned int i = 0; i <= 720; ++i){
+    geometry_msgs::Point32 scan_pt;
+    scan_pt.x = 10.0 + 3.0 * cos(dense_scan.angle_min + i * dense_scan.angle_increment);
+    scan_pt.y = 10.0 + 3.0 * sin(dense_scan.angle_min + i * dense_scan.angle_increment);
+    dense_scan.cloud.points.push_back(scan_pt);
+  }
+  scan.push_back(dense_scan);
+
+  std::vector<geometry_msgs::Point> robot;
+  double robot_x[] = {-0.3, -0.3, 0.3, 0.4, 0.3};
+  double robot_y[] = {-0.25, 0.25, 0.25, 0.0, -0.25};
+  for(unsigned int i = 0; i < 5; ++i){
+    pt.x = 10.0 + robot_x[i];
+    pt.y = 10.0 + robot_y[i];
+    robot.push_back(pt);
+  }
+
+  gettimeofday(&start, NULL);
+  for(unsigned int i = 0; i < 10; ++i){
+    //jitter the cloud so each update brings some new points
+    for(unsigned int j = 0; j < obs[0].cloud_.points.size(); ++j)
+      obs[0].cloud_.points[j].x += 0.003;
+    dense_pg.updateWorld(robot, obs, scan);
+  }
+  gettimeofday(&end, NULL);
+  start_t = start.tv_sec + double(start.tv_usec) / 1e6;
+  end_t = end.tv_sec + double(end.tv_usec) / 1e6;
+  printf("%%Dense update time (10 updates): %.9f \n", end_t - start_t);
+
+  unsigned int num_legal = 0;
+  std::vector<geometry_msgs::Point> moved(robot.size());
+  gettimeofday(&start, NULL);
+  for(unsigned int i = 0; i < 20000; ++i){
+    //sweep the robot over a 7m x 7m square around the cloud's origin
+    double dx = 7.0 * ((i * 7919) % 1000) / 1000.0 - 3.5;
+    double dy = 7.0 * ((i * 104729) % 997) / 997.0 - 3.5;
+    for(unsigned int j = 0; j < robot.size(); ++j){
+      moved[j].x = robot[j].x + dx;
+      moved[j].y = robot[j].y + dy;
+    }
+    pt.x = 10.0 + dx;
+    pt.y = 10.0 + dy;
+    if(dense_pg.footprintCost(pt, moved, 0.25, 0.5) >= 0.0)
+      num_legal++;
+  }
+  gettimeofday(&end, NULL);
+  start_t = start.tv_sec + double(start.tv_usec) / 1e6;
+  end_t = end.tv_sec + double(end.tv_usec) / 1e6;
+
+  pcl::PointCloud<pcl::PointXYZ> dense_cloud;
+  dense_pg.getPoints(dense_cloud);
+  printf("%%Dense footprint calc (20000 poses): %.9f \n", end_t - start_t);
+  printf("%%Dense grid: %u legal poses, %u points\n", num_legal, (unsigned int) dense_cloud.size());
+
   printPSFooter();
 
   return 0;
@@ -37,52 +37,247 @@
 
 #include <base_local_planner/simple_scored_sampling_planner.h>
 
+#include <algorithm>
+
 #include <ros/console.h>
+#include <ros/time.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
 
 namespace base_local_planner {
-  
+
+  /**
+   * Threads that stay around between cycles. Each cycle hands them a job through
+   * a condition variable, and the caller waits on another for them to finish.
+   */
+  class SimpleScoredSamplingPlanner::WorkerPool {
+  public:
+    typedef boost::function<void (unsigned int)> Job;
+
+    WorkerPool(unsigned int num_workers) : generation_(0), num_jobs_(0), running_(0), quit_(false) {
+      for (unsigned int t = 1; t <= num_workers; ++t) {
+        threads_.create_thread(boost::bind(&WorkerPool::work, this, t));
+      }
+    }
+
+    ~WorkerPool() {
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        quit_ = true;
+      }
+      start_cond_.notify_all();
+      threads_.join_all();
+    }
+
+    unsigned int size() const {
+      return threads_.size();
+    }
+
+    /**
+     * Runs job(0) on the caller and job(t) for t in [1, num_jobs) on the workers,
+     * returns when all of them are done
+     */
+    void run(const Job& job, unsigned int num_jobs) {
+      boost::lock_guard<boost::mutex> run_lock(run_mutex_);
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        job_ = job;
+        num_jobs_ = num_jobs;
+        running_ = std::min(num_jobs, size() + 1) - 1;
+        generation_++;
+      }
+      start_cond_.notify_all();
+
+      job(0);
+
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      while (running_ > 0) {
+        done_cond_.wait(lock);
+      }
+    }
+
+  private:
+    void work(unsigned int t) {
+      unsigned int done_generation = 0;
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      while (true) {
+        while (!quit_ && generation_ == done_generation) {
+          start_cond_.wait(lock);
+        }
+        if (quit_) {
+          return;
+        }
+        done_generation = generation_;
+        if (t >= num_jobs_) {
+          continue;
+        }
+        Job job = job_;
+        lock.unlock();
+        job(t);
+        lock.lock();
+        if (--running_ == 0) {
+          done_cond_.notify_all();
+        }
+      }
+    }
+
+    boost::mutex mutex_, run_mutex_;
+    boost::condition_variable start_cond_, done_cond_;
+    Job job_;
+    unsigned int generation_, num_jobs_, running_;
+    bool quit_;
+    boost::thread_group threads_;
+  };
+
+  struct SimpleScoredSamplingPlanner::ScoringState {
+    boost::mutex mutex;
+    unsigned int num_samples, next_sample;
+    double best_cost;
+    int best_index;
+  };
+
+  struct SimpleScoredSamplingPlanner::ScoringContext {
+    ScoringContext(unsigned int num_critics) :
+      costs(num_critics, 0.0), rejections(num_critics, 0.0), time(num_critics, 0.0), pruned(0) {}
+    std::vector<double> costs;
+    std::vector<double> rejections;
+    std::vector<double> time;
+    unsigned int pruned;
+  };
+
+  // sums of critic costs are only compared to the bound with this much slack,
+  // as partial sums in evaluation order may round differently from the total
+  static const double BOUND_SLACK = 1e-9;
+
+  // weight of the previous cycles in the critic statistics
+  static const double CRITIC_STATS_DECAY = 0.5;
+
+  // sorts critic indices by rejections per second of scoring, most first
+  class CriticRejectionRate {
+  public:
+    CriticRejectionRate(const std::vector<double>& rates) : rates_(rates) {}
+    bool operator()(unsigned int a, unsigned int b) const {
+      return rates_[a] > rates_[b];
+    }
+  private:
+    const std::vector<double>& rates_;
+  };
+
   SimpleScoredSamplingPlanner::SimpleScoredSamplingPlanner(std::vector<TrajectorySampleGenerator*> gen_list, std::vector<TrajectoryCostFunction*>& critics, int max_samples) {
     max_samples_ = max_samples;
+    num_threads_ = 1;
+    num_explored_ = 0;
+    num_pruned_ = 0;
     gen_list_ = gen_list;
     critics_ = critics;
+    adaptive_critic_order_ = true;
+    resetCriticOrder();
+  }
+
+  void SimpleScoredSamplingPlanner::resetCriticOrder() {
+    critic_order_.resize(critics_.size());
+    for (unsigned int i = 0; i < critic_order_.size(); ++i) {
+      critic_order_[i] = i;
+    }
+    critic_rejections_.assign(critics_.size(), 0.0);
+    critic_time_.assign(critics_.size(), 0.0);
+  }
+
+  void SimpleScoredSamplingPlanner::updateCriticOrder(const std::vector<ScoringContext>& contexts) {
+    for (unsigned int i = 0; i < critics_.size(); ++i) {
+      critic_rejections_[i] *= CRITIC_STATS_DECAY;
+      critic_time_[i] *= CRITIC_STATS_DECAY;
+      for (unsigned int c = 0; c < contexts.size(); ++c) {
+        critic_rejections_[i] += contexts[c].rejections[i];
+        critic_time_[i] += contexts[c].time[i];
+      }
+    }
+    if (!adaptive_critic_order_) {
+      return;
+    }
+    // critics that have not rejected anything keep their configured order at the end
+    std::vector<double> rates(critics_.size());
+    for (unsigned int i = 0; i < critic_order_.size(); ++i) {
+      critic_order_[i] = i;
+      rates[i] = critic_rejections_[i] / (critic_time_[i] + 1e-9);
+    }
+    std::stable_sort(critic_order_.begin(), critic_order_.end(), CriticRejectionRate(rates));
   }
 
   double SimpleScoredSamplingPlanner::scoreTrajectory(Trajectory& traj, double best_traj_cost) {
-    double traj_cost = 0;
-    int gen_id = 0;
-    for(std::vector<TrajectoryCostFunction*>::iterator score_function = critics_.begin(); score_function != critics_.end(); ++score_function) {
-      TrajectoryCostFunction* score_function_p = *score_function;
-      if (score_function_p->getScale() == 0) {
+    ScoringContext context(critics_.size());
+    return scoreTrajectory(traj, best_traj_cost, context);
+  }
+
+  double SimpleScoredSamplingPlanner::scoreTrajectory(Trajectory& traj, double best_traj_cost, ScoringContext& context) {
+    double bound = -1;
+    if (best_traj_cost > 0) {
+      bound = best_traj_cost * (1.0 + BOUND_SLACK);
+    }
+
+    double partial_cost = 0;
+    for (unsigned int k = 0; k < critic_order_.size(); ++k) {
+      unsigned int critic_id = critic_order_[k];
+      TrajectoryCostFunction* score_function_p = critics_[critic_id];
+      context.costs[critic_id] = 0;
+      double scale = score_function_p->getScale();
+      if (scale == 0) {
         continue;
       }
-      double cost = score_function_p->scoreTrajectory(traj);
+
+      // what this critic may still add before the trajectory is worse than the best
+      double max_cost = -1;
+      if (bound > 0 && scale > 0) {
+        max_cost = (bound - partial_cost) / scale;
+      }
+
+      ros::WallTime start = ros::WallTime::now();
+      double cost = score_function_p->scoreTrajectoryBounded(traj, max_cost);
+      if (max_cost >= 0 && cost > max_cost && partial_cost + cost * scale <= bound) {
+        // rounding disagrees with the critic about the bound, get the full score
+        cost = score_function_p->scoreTrajectory(traj);
+      }
+      context.time[critic_id] += (ros::WallTime::now() - start).toSec();
+
       if (cost < 0) {
-        ROS_DEBUG("Velocity %.3lf, %.3lf, %.3lf discarded by cost function  %d with cost: %f", traj.xv_, traj.yv_, traj.thetav_, gen_id, cost);
-        traj_cost = cost;
-        break;
+        ROS_DEBUG("Velocity %.3lf, %.3lf, %.3lf discarded by cost function  %d with cost: %f", traj.xv_, traj.yv_, traj.thetav_, critic_id, cost);
+        context.rejections[critic_id] += 1;
+        return cost;
       }
       if (cost != 0) {
-        cost *= score_function_p->getScale();
+        cost *= scale;
       }
-      traj_cost += cost;
-      if (best_traj_cost > 0) {
+      context.costs[critic_id] = cost;
+      partial_cost += cost;
+      if (bound > 0) {
         // since we keep adding positives, once we are worse than the best, we will stay worse
-        if (traj_cost > best_traj_cost) {
-          break;
+        if (partial_cost > bound) {
+          context.rejections[critic_id] += 1;
+          context.pruned++;
+          return partial_cost;
         }
       }
-      gen_id ++;
     }
 
-
+    // add up in the configured order, so that the order of evaluation cannot change the result
+    double traj_cost = 0;
+    for (unsigned int i = 0; i < context.costs.size(); ++i) {
+      traj_cost += context.costs[i];
+    }
     return traj_cost;
   }
 
+  Trajectory& SimpleScoredSamplingPlanner::nextSample() {
+    if (num_explored_ == samples_.size()) {
+      samples_.push_back(Trajectory());
+    }
+    return samples_[num_explored_];
+  }
+
   bool SimpleScoredSamplingPlanner::findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored) {
-    Trajectory loop_traj;
-    Trajectory best_traj;
-    double loop_traj_cost, best_traj_cost = -1;
-    bool gen_success;
+    double best_traj_cost = -1;
+    int best_index = -1;
     int count, count_valid;
     for (std::vector<TrajectoryCostFunction*>::iterator loop_critic = critics_.begin(); loop_critic != critics_.end(); ++loop_critic) {
       TrajectoryCostFunction* loop_critic_p = *loop_critic;
@@ -92,45 +287,59 @@ namespace base_local_planner {
       }
     }
 
+    // critics that keep state while scoring force the serial path
+    bool parallel = num_threads_ > 1;
+    for (std::vector<TrajectoryCostFunction*>::iterator loop_critic = critics_.begin(); loop_critic != critics_.end(); ++loop_critic) {
+      if ((*loop_critic)->getScale() != 0 && !(*loop_critic)->isThreadSafe()) {
+        parallel = false;
+      }
+    }
+
+    if (critic_order_.size() != critics_.size()) {
+      resetCriticOrder();
+    }
+    // one set of per critic statistics and scratch space for each scoring thread
+    std::vector<ScoringContext> contexts(parallel ? num_threads_ : 1, ScoringContext(critics_.size()));
+
+    // samples are generated into the pool, which keeps its storage between cycles
+    num_explored_ = 0;
     for (std::vector<TrajectorySampleGenerator*>::iterator loop_gen = gen_list_.begin(); loop_gen != gen_list_.end(); ++loop_gen) {
       count = 0;
       count_valid = 0;
+      unsigned int first_sample = num_explored_;
       TrajectorySampleGenerator* gen_ = *loop_gen;
-      while (gen_->hasMoreTrajectories()) {
-        gen_success = gen_->nextTrajectory(loop_traj);
-        if (gen_success == false) {
+      if (parallel) {
+        best_index = scoreSamplesParallel(gen_, contexts, count, count_valid);
+        if (best_index >= 0) {
+          best_traj_cost = samples_[best_index].cost_;
+        }
+      }
+      while (!parallel && gen_->hasMoreTrajectories()) {
+        Trajectory& loop_traj = nextSample();
+        if (gen_->nextTrajectory(loop_traj) == false) {
           // TODO use this for debugging
           continue;
         }
-        loop_traj_cost = scoreTrajectory(loop_traj, best_traj_cost);
-        if (all_explored != NULL) {
-          loop_traj.cost_ = loop_traj_cost;
-          all_explored->push_back(loop_traj);
-        }
+        loop_traj.cost_ = scoreTrajectory(loop_traj, best_traj_cost, contexts[0]);
 
-        if (loop_traj_cost >= 0) {
+        if (loop_traj.cost_ >= 0) {
           count_valid++;
-          if (best_traj_cost < 0 || loop_traj_cost < best_traj_cost) {
-            best_traj_cost = loop_traj_cost;
-            best_traj = loop_traj;
+          if (best_traj_cost < 0 || loop_traj.cost_ < best_traj_cost) {
+            best_traj_cost = loop_traj.cost_;
+            best_index = num_explored_;
           }
         }
+        num_explored_++;
         count++;
         if (max_samples_ > 0 && count >= max_samples_) {
           break;
         }        
       }
+      if (all_explored != NULL) {
+        all_explored->insert(all_explored->end(), samples_.begin() + first_sample, samples_.begin() + num_explored_);
+      }
       if (best_traj_cost >= 0) {
-        traj.xv_ = best_traj.xv_;
-        traj.yv_ = best_traj.yv_;
-        traj.thetav_ = best_traj.thetav_;
-        traj.cost_ = best_traj_cost;
-        traj.resetPoints();
-        double px, py, pth;
-        for (unsigned int i = 0; i < best_traj.getPointsSize(); i++) {
-          best_traj.getPoint(i, px, py, pth);
-          traj.addPoint(px, py, pth);
-        }
+        traj = samples_[best_index];
       }
       ROS_DEBUG("Evaluated %d trajectories, found %d valid", count, count_valid);
       if (best_traj_cost >= 0) {
@@ -138,8 +347,72 @@ namespace base_local_planner {
         break;
       }
     }
+    num_pruned_ = 0;
+    for (unsigned int c = 0; c < contexts.size(); ++c) {
+      num_pruned_ += contexts[c].pruned;
+    }
+    updateCriticOrder(contexts);
     return best_traj_cost >= 0;
   }
 
+  int SimpleScoredSamplingPlanner::scoreSamplesParallel(TrajectorySampleGenerator* gen, std::vector<ScoringContext>& contexts, int& count, int& count_valid) {
+    // the generators are sequential, so take all their samples first
+    unsigned int first_sample = num_explored_;
+    while (gen->hasMoreTrajectories()) {
+      if (gen->nextTrajectory(nextSample()) == false) {
+        continue;
+      }
+      num_explored_++;
+      if (max_samples_ > 0 && (int)(num_explored_ - first_sample) >= max_samples_) {
+        break;
+      }
+    }
+
+    ScoringState state;
+    state.num_samples = num_explored_;
+    state.next_sample = first_sample;
+    state.best_cost = -1;
+    state.best_index = -1;
+
+    // the caller scores as well, the pool provides the other threads
+    if (!workers_ || workers_->size() != contexts.size() - 1) {
+      workers_.reset(new WorkerPool(contexts.size() - 1));
+    }
+    unsigned int num_jobs = std::max(1u, std::min((unsigned int)contexts.size(), num_explored_ - first_sample));
+    workers_->run(boost::bind(&SimpleScoredSamplingPlanner::scoreSamples, this, &state, &contexts, _1), num_jobs);
+
+    count = num_explored_ - first_sample;
+    count_valid = 0;
+    for (unsigned int i = first_sample; i < num_explored_; ++i) {
+      if (samples_[i].cost_ >= 0) {
+        count_valid++;
+      }
+    }
+    return state.best_index;
+  }
+
+  void SimpleScoredSamplingPlanner::scoreSamples(ScoringState* state, std::vector<ScoringContext>* contexts, unsigned int thread) {
+    ScoringContext* context = &(*contexts)[thread];
+    boost::unique_lock<boost::mutex> lock(state->mutex);
+    while (state->next_sample < state->num_samples) {
+      int index = state->next_sample++;
+      double bound = state->best_cost;
+      lock.unlock();
+
+      Trajectory& sample = samples_[index];
+      sample.cost_ = scoreTrajectory(sample, bound, *context);
+
+      lock.lock();
+      if (sample.cost_ >= 0) {
+        // ties go to the lower index, as they would when scoring in order
+        if (state->best_cost < 0 || sample.cost_ < state->best_cost ||
+            (sample.cost_ == state->best_cost && index < state->best_index)) {
+          state->best_cost = sample.cost_;
+          state->best_index = index;
+        }
+      }
+    }
+  }
+
   
 }// namespace
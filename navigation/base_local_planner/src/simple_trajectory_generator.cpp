@@ -234,9 +234,19 @@ bool SimpleTrajectoryGenerator::generateTrajectory(
     traj.thetav_ = sample_target_vel[2];
   }
 
+  // heading as unit vector and the rotation it makes per step, for incremental rotation
+  double cos_th = cos(pos[2]), sin_th = sin(pos[2]);
+  double cos_step = 1.0, sin_step = 0.0, step_vel_th = 0.0;
+
   //simulate the trajectory and check for collisions, updating costs along the way
   for (int i = 0; i < num_steps; ++i) {
 
+    if (integration_ == EXACT_ARCS && (!continued_acceleration_ || loop_vel == sample_target_vel)) {
+      // the velocity does not change anymore, the rest of the rollout is one arc
+      addArcPoints(pos, loop_vel, dt, num_steps - i, traj);
+      break;
+    }
+
     //add the point to the trajectory so we can draw it later if we want
     traj.addPoint(pos[0], pos[1], pos[2]);
 
@@ -247,7 +257,24 @@ bool SimpleTrajectoryGenerator::generateTrajectory(
     }
 
     //update the position of the robot using the velocities passed in
-    pos = computeNewPositions(pos, loop_vel, dt);
+    if (integration_ == EXACT_ARCS) {
+      pos = computeArcPositions(pos, loop_vel, dt);
+    } else if (integration_ == INCREMENTAL_ROTATION) {
+      // only needs trig while the rotational velocity still changes
+      if (loop_vel[2] != step_vel_th) {
+        step_vel_th = loop_vel[2];
+        cos_step = cos(step_vel_th * dt);
+        sin_step = sin(step_vel_th * dt);
+      }
+      pos[0] = pos[0] + (loop_vel[0] * cos_th - loop_vel[1] * sin_th) * dt;
+      pos[1] = pos[1] + (loop_vel[0] * sin_th + loop_vel[1] * cos_th) * dt;
+      pos[2] = pos[2] + loop_vel[2] * dt;
+      double next_cos_th = cos_th * cos_step - sin_th * sin_step;
+      sin_th = sin_th * cos_step + cos_th * sin_step;
+      cos_th = next_cos_th;
+    } else {
+      pos = computeNewPositions(pos, loop_vel, dt);
+    }
 
   } // end for simulation steps
 
@@ -263,6 +290,40 @@ Eigen::Vector3f SimpleTrajectoryGenerator::computeNewPositions(const Eigen::Vect
   return new_pos;
 }
 
+// below this half turn the chord of an arc is taken from the series of sin(h)/h
+static const double SMALL_HALF_TURN = 1e-3;
+
+Eigen::Vector3f SimpleTrajectoryGenerator::computeArcPositions(const Eigen::Vector3f& pos,
+    const Eigen::Vector3f& vel, double dt) {
+  // the chord of the arc points along the heading halfway through it
+  double half_turn = 0.5 * vel[2] * dt;
+  double chord = fabs(half_turn) < SMALL_HALF_TURN ?
+      dt * (1.0 - half_turn * half_turn / 6.0) : dt * sin(half_turn) / half_turn;
+  double mid_th = pos[2] + half_turn;
+  Eigen::Vector3f new_pos = Eigen::Vector3f::Zero();
+  new_pos[0] = pos[0] + (vel[0] * cos(mid_th) - vel[1] * sin(mid_th)) * chord;
+  new_pos[1] = pos[1] + (vel[0] * sin(mid_th) + vel[1] * cos(mid_th)) * chord;
+  new_pos[2] = pos[2] + vel[2] * dt;
+  return new_pos;
+}
+
+void SimpleTrajectoryGenerator::addArcPoints(const Eigen::Vector3f& pos, const Eigen::Vector3f& vel, double dt,
+    int num_points, base_local_planner::Trajectory& traj) {
+  // the same as computeArcPositions, for all points at once, which Eigen vectorizes
+  float last = num_points - 1;
+  Eigen::ArrayXf time = Eigen::ArrayXf::LinSpaced(num_points, 0.0f, dt * last);
+  Eigen::ArrayXf half_turn = Eigen::ArrayXf::LinSpaced(num_points, 0.0f, 0.5 * vel[2] * dt * last);
+  Eigen::ArrayXf chord = (half_turn.abs() < SMALL_HALF_TURN).select(
+      time * (1.0f - half_turn.square() / 6.0f), time * half_turn.sin() / half_turn);
+  Eigen::ArrayXf mid_th = pos[2] + half_turn;
+  Eigen::ArrayXf cos_th = mid_th.cos(), sin_th = mid_th.sin();
+  Eigen::ArrayXf dx = (vel[0] * cos_th - vel[1] * sin_th) * chord;
+  Eigen::ArrayXf dy = (vel[0] * sin_th + vel[1] * cos_th) * chord;
+  for (int i = 0; i < num_points; ++i) {
+    traj.addPoint(pos[0] + dx[i], pos[1] + dy[i], pos[2] + 2.0f * half_turn[i]);
+  }
+}
+
 /**
  * cheange vel using acceleration limits to converge towards sample_target-vel
  */
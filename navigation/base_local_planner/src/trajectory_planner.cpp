@@ -37,6 +37,7 @@
 
 #include <base_local_planner/trajectory_planner.h>
 #include <costmap_2d/footprint.h>
+#include <base_local_planner/costmap_model.h>
 #include <string>
 #include <sstream>
 #include <math.h>
@@ -120,6 +121,8 @@ namespace base_local_planner{
 
       simple_attractor_ = config.simple_attractor;
 
+      exact_arcs_ = config.exact_arcs;
+
       //y-vels
       string y_string = config.y_vels;
       vector<string> y_strs;
@@ -182,6 +185,8 @@ namespace base_local_planner{
 
     escaping_ = false;
     final_goal_position_valid_ = false;
+    use_clearance_grid_ = false;
+    exact_arcs_ = false;
 
 
     costmap_2d::calculateMinAndMaxDistances(footprint_spec_, inscribed_radius_, circumscribed_radius_);
@@ -350,9 +355,13 @@ namespace base_local_planner{
       vtheta_i = computeNewVelocity(vtheta_samp, vtheta_i, acc_theta, dt);
 
       //calculate positions
-      x_i = computeNewXPosition(x_i, vx_i, vy_i, theta_i, dt);
-      y_i = computeNewYPosition(y_i, vx_i, vy_i, theta_i, dt);
-      theta_i = computeNewThetaPosition(theta_i, vtheta_i, dt);
+      if (exact_arcs_) {
+        computeArcPosition(x_i, y_i, theta_i, vx_i, vy_i, vtheta_i, dt);
+      } else {
+        x_i = computeNewXPosition(x_i, vx_i, vy_i, theta_i, dt);
+        y_i = computeNewYPosition(y_i, vx_i, vy_i, theta_i, dt);
+        theta_i = computeNewThetaPosition(theta_i, vtheta_i, dt);
+      }
 
       //increment time
       time += dt;
@@ -946,11 +955,19 @@ namespace base_local_planner{
     goal_map_.setLocalGoal(costmap_, global_plan_);
     ROS_DEBUG("Path/Goal distance computed");
 
+    //the clearance grid only reproduces what a costmap model would see, other
+    //world models (point clouds, voxels) have to be asked for every footprint
+    use_clearance_grid_ = footprint_spec_.size() >= 3 && dynamic_cast<CostmapModel*>(&world_model_) != NULL;
+    if (use_clearance_grid_) {
+      clearance_grid_.update(costmap_);
+    }
+
     //rollout trajectories and find the minimum cost one
     Trajectory best = createTrajectories(pos[0], pos[1], pos[2],
         vel[0], vel[1], vel[2],
         acc_lim_x_, acc_lim_y_, acc_lim_theta_);
     ROS_DEBUG("Trajectories created");
+    use_clearance_grid_ = false;
 
     /*
     //If we want to print a ppm file to draw goal dist
@@ -993,6 +1010,10 @@ namespace base_local_planner{
 
   //we need to take the footprint of the robot into account when we calculate cost to obstacles
   double TrajectoryPlanner::footprintCost(double x_i, double y_i, double theta_i){
+    //no cell the footprint can cover has a cost, so its cost is zero without rasterizing it
+    if (use_clearance_grid_ && clearance_grid_.isFreeSpace(x_i, y_i, circumscribed_radius_)) {
+      return 0.0;
+    }
     //check if the footprint is legal
     return world_model_.footprintCost(x_i, y_i, theta_i, footprint_spec_, inscribed_radius_, circumscribed_radius_);
   }
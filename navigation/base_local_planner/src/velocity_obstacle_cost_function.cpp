@@ -0,0 +1,134 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/velocity_obstacle_cost_function.h>
+#include <costmap_2d/footprint.h>
+#include <algorithm>
+#include <cmath>
+
+namespace base_local_planner {
+
+VelocityObstacleCostFunction::VelocityObstacleCostFunction(const ObstacleTracker* tracker)
+    : tracker_(tracker), time_horizon_(2.0), min_speed_(0.2), safety_margin_(0.1), stamp_(-1.0), min_hits_(3),
+      circumscribed_radius_(0.0) {
+}
+
+void VelocityObstacleCostFunction::setParams(double time_horizon, double min_speed, unsigned int min_hits,
+    double safety_margin) {
+  time_horizon_ = time_horizon;
+  min_speed_ = min_speed;
+  min_hits_ = min_hits;
+  safety_margin_ = safety_margin;
+}
+
+void VelocityObstacleCostFunction::setFootprint(std::vector<geometry_msgs::Point> footprint_spec) {
+  double inscribed_radius;
+  costmap_2d::calculateMinAndMaxDistances(footprint_spec, inscribed_radius, circumscribed_radius_);
+}
+
+bool VelocityObstacleCostFunction::prepare() {
+  tracks_.clear();
+  sweeps_.clear();
+  if (tracker_ == NULL) {
+    return true;
+  }
+  // the observations are older than the trajectories, which start now
+  double stamp = stamp_ >= 0.0 ? stamp_ : tracker_->getLastStamp();
+  tracker_->getMovingTracks(stamp, min_speed_, min_hits_, tracks_);
+
+  // the box each track covers over the horizon, grown by the distance at
+  // which it touches the robot, lets most trajectories skip most tracks
+  sweeps_.resize(tracks_.size());
+  for (unsigned int i = 0; i < tracks_.size(); ++i) {
+    const TrackedObstacle& track = tracks_[i];
+    double reach = track.radius + circumscribed_radius_ + safety_margin_;
+    double end_x = track.x + track.vx * time_horizon_;
+    double end_y = track.y + track.vy * time_horizon_;
+    sweeps_[i].min_x = std::min(track.x, end_x) - reach;
+    sweeps_[i].max_x = std::max(track.x, end_x) + reach;
+    sweeps_[i].min_y = std::min(track.y, end_y) - reach;
+    sweeps_[i].max_y = std::max(track.y, end_y) + reach;
+  }
+  return true;
+}
+
+double VelocityObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
+  unsigned int num_points = traj.getPointsSize();
+  if (tracks_.empty() || num_points == 0 || time_horizon_ <= 0) {
+    return 0.0;
+  }
+  if (traj.time_delta_ > 0) {
+    num_points = std::min(num_points, (unsigned int) (time_horizon_ / traj.time_delta_) + 1);
+  }
+
+  double px, py, pth;
+  traj.getPoint(0, px, py, pth);
+  double min_x = px, max_x = px, min_y = py, max_y = py;
+  for (unsigned int i = 1; i < num_points; ++i) {
+    traj.getPoint(i, px, py, pth);
+    min_x = std::min(min_x, px);
+    max_x = std::max(max_x, px);
+    min_y = std::min(min_y, py);
+    max_y = std::max(max_y, py);
+  }
+
+  // earliest time any of the tracks hits the trajectory
+  double first_hit = time_horizon_;
+  for (unsigned int k = 0; k < tracks_.size(); ++k) {
+    const Sweep& sweep = sweeps_[k];
+    if (sweep.max_x < min_x || sweep.min_x > max_x || sweep.max_y < min_y || sweep.min_y > max_y) {
+      continue;
+    }
+    const TrackedObstacle& track = tracks_[k];
+    double reach = track.radius + circumscribed_radius_ + safety_margin_;
+    double reach_sq = reach * reach;
+    for (unsigned int i = 0; i < num_points; ++i) {
+      double t = i * traj.time_delta_;
+      if (t >= first_hit) {
+        break;
+      }
+      traj.getPoint(i, px, py, pth);
+      double dx = px - (track.x + track.vx * t);
+      double dy = py - (track.y + track.vy * t);
+      if (dx * dx + dy * dy < reach_sq) {
+        first_hit = t;
+        break;
+      }
+    }
+  }
+  return 1.0 - first_hit / time_horizon_;
+}
+
+} /* namespace base_local_planner */
@@ -35,6 +35,7 @@
 * Author: Eitan Marder-Eppstein
 *********************************************************************/
 #include <base_local_planner/voxel_grid_model.h>
+#include <climits>
 
 using namespace std;
 using namespace costmap_2d;
@@ -44,10 +45,29 @@ namespace base_local_planner {
           double origin_x, double origin_y, double origin_z, double max_z, double obstacle_range) :
     obstacle_grid_(size_x, size_y, size_z), xy_resolution_(xy_resolution), z_resolution_(z_resolution), 
     origin_x_(origin_x), origin_y_(origin_y), origin_z_(origin_z),
-    max_z_(max_z), sq_obstacle_range_(obstacle_range * obstacle_range) {}
+    max_z_(max_z), sq_obstacle_range_(obstacle_range * obstacle_range) {
+    size_x_ = obstacle_grid_.sizeX();
+    size_y_ = obstacle_grid_.sizeY();
+    blocks_x_ = (size_x_ >> BLOCK_SHIFT) + 1;
+    column_blocked_.assign(size_x_ * size_y_, 0);
+    block_counts_.assign(blocks_x_ * ((size_y_ >> BLOCK_SHIFT) + 1), 0);
+    if(size_x_ > 0 && size_y_ > 0)
+      updateSummary(0, 0, size_x_ - 1, size_y_ - 1);
+  }
 
   double VoxelGridModel::footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint, 
       double inscribed_radius, double circumscribed_radius){
+    return footprintCost(0.0, 0.0, 1.0, 0.0, footprint);
+  }
+
+  double VoxelGridModel::footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+      double inscribed_radius, double circumscribed_radius){
+    //the points come out exactly as WorldModel would orient them
+    return footprintCost(x, y, cos(theta), sin(theta), footprint_spec);
+  }
+
+  double VoxelGridModel::footprintCost(double origin_x, double origin_y, double cos_th, double sin_th,
+      const std::vector<geometry_msgs::Point>& footprint){
     if(footprint.size() < 3)
       return -1.0;
 
@@ -55,36 +75,48 @@ namespace base_local_planner {
     unsigned int x0, x1, y0, y1;
     double line_cost = 0.0;
 
-    //we need to rasterize each line in the footprint
-    for(unsigned int i = 0; i < footprint.size() - 1; ++i){
-      //get the cell coord of the first point
-      if(!worldToMap2D(footprint[i].x, footprint[i].y, x0, y0))
+    //the edges stay within the bounding box of the points, if no column in the
+    //blocks that box touches is blocked, the footprint is legal
+    unsigned int min_x = UINT_MAX, min_y = UINT_MAX, max_x = 0, max_y = 0;
+    for(unsigned int i = 0; i < footprint.size(); ++i){
+      //points off the grid lie in unknown space
+      if(!worldToMap2D(origin_x + (footprint[i].x * cos_th - footprint[i].y * sin_th),
+            origin_y + (footprint[i].x * sin_th + footprint[i].y * cos_th), x0, y0) || x0 >= size_x_ || y0 >= size_y_)
         return -1.0;
+      min_x = std::min(min_x, x0);
+      min_y = std::min(min_y, y0);
+      max_x = std::max(max_x, x0);
+      max_y = std::max(max_y, y0);
+    }
+    bool blocked = false;
+    for(unsigned int by = min_y >> BLOCK_SHIFT; by <= max_y >> BLOCK_SHIFT && !blocked; ++by){
+      for(unsigned int bx = min_x >> BLOCK_SHIFT; bx <= max_x >> BLOCK_SHIFT; ++bx){
+        if(block_counts_[by * blocks_x_ + bx] > 0){
+          blocked = true;
+          break;
+        }
+      }
+    }
+    if(!blocked)
+      return 0.0;
 
-      //get the cell coord of the second point
-      if(!worldToMap2D(footprint[i + 1].x, footprint[i + 1].y, x1, y1))
-        return -1.0;
+    //we need to rasterize each line in the footprint, the last one connects
+    //the last point in the footprint back to the first
+    worldToMap2D(origin_x + (footprint.back().x * cos_th - footprint.back().y * sin_th),
+        origin_y + (footprint.back().x * sin_th + footprint.back().y * cos_th), x0, y0);
+    for(unsigned int i = 0; i < footprint.size(); ++i){
+      worldToMap2D(origin_x + (footprint[i].x * cos_th - footprint[i].y * sin_th),
+          origin_y + (footprint[i].x * sin_th + footprint[i].y * cos_th), x1, y1);
 
       line_cost = lineCost(x0, x1, y0, y1);
 
       //if there is an obstacle that hits the line... we know that we can return false right away 
       if(line_cost < 0)
         return -1.0;
-    }
-
-    //we also need to connect the first point in the footprint to the last point
-    //get the cell coord of the last point
-    if(!worldToMap2D(footprint.back().x, footprint.back().y, x0, y0))
-      return -1.0;
-
-    //get the cell coord of the first point
-    if(!worldToMap2D(footprint.front().x, footprint.front().y, x1, y1))
-      return -1.0;
-
-    line_cost = lineCost(x0, x1, y0, y1);
 
-    if(line_cost < 0)
-      return -1.0;
+      x0 = x1;
+      y0 = y1;
+    }
 
     //if all line costs are legal... then we can return that the footprint is legal
     return 0.0;
@@ -171,8 +203,9 @@ namespace base_local_planner {
   }
 
   double VoxelGridModel::pointCost(int x, int y){
-    //if the cell is in an obstacle the path is invalid
-    if(obstacle_grid_.getVoxelColumn(x, y)){
+    //if the cell is in an obstacle the path is invalid, the summary says so
+    //for any column with marked or unknown voxels
+    if(column_blocked_[y * size_x_ + x]){
       return -1;
     }
 
@@ -182,6 +215,9 @@ namespace base_local_planner {
   void VoxelGridModel::updateWorld(const std::vector<geometry_msgs::Point>& footprint, 
       const vector<Observation>& observations, const vector<PlanarLaserScan>& laser_scans){
 
+    dirty_min_x_ = dirty_min_y_ = UINT_MAX;
+    dirty_max_x_ = dirty_max_y_ = 0;
+
     //remove points in the laser scan boundry
     for(unsigned int i = 0; i < laser_scans.size(); ++i)
       removePointsInScanBoundry(laser_scans[i], 10.0);
@@ -210,6 +246,31 @@ namespace base_local_planner {
 
     //remove the points that are in the footprint of the robot
     //removePointsInPolygon(footprint);
+
+    //only the columns that were marked or raytraced through can have changed
+    if(dirty_min_x_ <= dirty_max_x_)
+      updateSummary(dirty_min_x_, dirty_min_y_, dirty_max_x_, dirty_max_y_);
+  }
+
+  void VoxelGridModel::updateSummary(unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y){
+    const uint32_t* data = obstacle_grid_.getData();
+    max_x = std::min(max_x, size_x_ - 1);
+    max_y = std::min(max_y, size_y_ - 1);
+    for(unsigned int y = min_y; y <= max_y; ++y){
+      unsigned int block_row = (y >> BLOCK_SHIFT) * blocks_x_;
+      for(unsigned int x = min_x; x <= max_x; ++x){
+        unsigned int index = y * size_x_ + x;
+        //a column is free exactly when it has neither marked nor unknown bits
+        unsigned char blocked = data[index] != 0;
+        if(blocked != column_blocked_[index]){
+          column_blocked_[index] = blocked;
+          if(blocked)
+            ++block_counts_[block_row + (x >> BLOCK_SHIFT)];
+          else
+            --block_counts_[block_row + (x >> BLOCK_SHIFT)];
+        }
+      }
+    }
   }
 
   void VoxelGridModel::removePointsInScanBoundry(const PlanarLaserScan& laser_scan, double raytrace_range){
@@ -223,6 +284,7 @@ namespace base_local_planner {
     
     if(!worldToMap3D(ox, oy, oz, sensor_x, sensor_y, sensor_z))
       return;
+    touchColumn(sensor_x, sensor_y);
 
     for(unsigned int i = 0; i < laser_scan.cloud.points.size(); ++i){
       double wpx = laser_scan.cloud.points[i].x;
@@ -262,6 +324,7 @@ namespace base_local_planner {
       unsigned int point_x, point_y, point_z;
       if(worldToMap3D(wpx, wpy, wpz, point_x, point_y, point_z)){
         obstacle_grid_.clearVoxelLine(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z);
+        touchColumn(point_x, point_y);
       }
     }
   }
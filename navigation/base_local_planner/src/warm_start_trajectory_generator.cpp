@@ -0,0 +1,91 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/warm_start_trajectory_generator.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace base_local_planner {
+
+void WarmStartTrajectoryGenerator::initialise(
+    const Eigen::Vector3f& pos,
+    const Eigen::Vector3f& vel,
+    const Eigen::Vector3f& goal,
+    base_local_planner::LocalPlannerLimits* limits,
+    const Eigen::Vector3f& vsamples,
+    bool discretize_by_time) {
+  SimpleTrajectoryGenerator::initialise(pos, vel, goal, limits, vsamples, discretize_by_time);
+  if ( ! has_warm_start_ || sample_params_.empty()) {
+    return;
+  }
+
+  // the window the samples cover, distances are measured relative to its size
+  // in each dimension so that e.g. rotation does not dominate translation
+  Eigen::Vector3f min_vel = sample_params_[0];
+  Eigen::Vector3f max_vel = sample_params_[0];
+  for (unsigned int i = 1; i < sample_params_.size(); ++i) {
+    min_vel = min_vel.cwiseMin(sample_params_[i]);
+    max_vel = max_vel.cwiseMax(sample_params_[i]);
+  }
+  Eigen::Vector3f weight = Eigen::Vector3f::Zero();
+  for (int d = 0; d < 3; ++d) {
+    if (max_vel[d] > min_vel[d]) {
+      weight[d] = 1.0 / (max_vel[d] - min_vel[d]);
+    }
+  }
+
+  // nearest first, ties keep the order of the grid
+  std::vector<std::pair<float, unsigned int> > order(sample_params_.size());
+  for (unsigned int i = 0; i < sample_params_.size(); ++i) {
+    order[i].first = (sample_params_[i] - warm_start_).cwiseProduct(weight).squaredNorm();
+    order[i].second = i;
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<Eigen::Vector3f> samples;
+  samples.reserve(sample_params_.size() + 1);
+  // the previous command itself, unless it left the window or the grid has it already
+  if ((warm_start_.array() >= min_vel.array()).all() && (warm_start_.array() <= max_vel.array()).all() &&
+      sample_params_[order[0].second] != warm_start_) {
+    samples.push_back(warm_start_);
+  }
+  for (unsigned int i = 0; i < order.size(); ++i) {
+    samples.push_back(sample_params_[order[i].second]);
+  }
+  sample_params_.swap(samples);
+}
+
+} /* namespace base_local_planner */
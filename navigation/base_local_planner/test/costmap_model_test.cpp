@@ -0,0 +1,117 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <costmap_2d/cost_values.h>
+#include <base_local_planner/costmap_model.h>
+#include <base_local_planner/line_iterator.h>
+
+namespace base_local_planner {
+
+// the footprint check as a cell by cell walk along the oriented edges
+double referenceCost(const costmap_2d::Costmap2D& costmap, double x, double y, double th,
+    const std::vector<geometry_msgs::Point>& footprint) {
+  unsigned int cx, cy;
+  if (!costmap.worldToMap(x, y, cx, cy)) {
+    return -1.0;
+  }
+  double cost = 0.0;
+  for (unsigned int i = 0; i < footprint.size(); ++i) {
+    const geometry_msgs::Point& a = footprint[i];
+    const geometry_msgs::Point& b = footprint[(i + 1) % footprint.size()];
+    unsigned int x0, y0, x1, y1;
+    if (!costmap.worldToMap(x + (a.x * cos(th) - a.y * sin(th)), y + (a.x * sin(th) + a.y * cos(th)), x0, y0) ||
+        !costmap.worldToMap(x + (b.x * cos(th) - b.y * sin(th)), y + (b.x * sin(th) + b.y * cos(th)), x1, y1)) {
+      return -1.0;
+    }
+    for (LineIterator line(x0, y0, x1, y1); line.isValid(); line.advance()) {
+      unsigned char c = costmap.getCost(line.getX(), line.getY());
+      if (c == costmap_2d::LETHAL_OBSTACLE || c == costmap_2d::NO_INFORMATION) {
+        return -1.0;
+      }
+      cost = std::max(cost, double(c));
+    }
+  }
+  return cost;
+}
+
+TEST(CostmapModelTest, agreesWithCellWalk){
+  costmap_2d::Costmap2D costmap(100, 80, 0.05, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  srand(7);
+  for (unsigned int j = 0; j < 80; ++j) {
+    for (unsigned int i = 0; i < 100; ++i) {
+      int r = rand() % 500;
+      unsigned char cost = r == 0 ? costmap_2d::LETHAL_OBSTACLE : r == 1 ? costmap_2d::NO_INFORMATION :
+          r == 2 ? costmap_2d::INSCRIBED_INFLATED_OBSTACLE : (unsigned char) (rand() % 200);
+      costmap.setCost(i, j, cost);
+    }
+  }
+  CostmapModel model(costmap);
+
+  std::vector<geometry_msgs::Point> footprint;
+  geometry_msgs::Point pt;
+  pt.x = 0.3; pt.y = 0.2; footprint.push_back(pt);
+  pt.x = 0.45; pt.y = 0.0; footprint.push_back(pt);
+  pt.x = 0.3; pt.y = -0.2; footprint.push_back(pt);
+  pt.x = -0.2; pt.y = -0.2; footprint.push_back(pt);
+  pt.x = -0.2; pt.y = 0.2; footprint.push_back(pt);
+
+  int legal = 0, illegal = 0;
+  for (double x = -0.3; x < 5.3; x += 0.031) {
+    for (double y = -0.3; y < 4.3; y += 0.047) {
+      double th = x * 2.0 - y;
+      double expected = referenceCost(costmap, x, y, th, footprint);
+      EXPECT_EQ(expected, model.footprintCost(x, y, th, footprint)) << x << " " << y;
+
+      // the same through the oriented footprint
+      std::vector<geometry_msgs::Point> oriented;
+      for (unsigned int i = 0; i < footprint.size(); ++i) {
+        pt.x = x + (footprint[i].x * cos(th) - footprint[i].y * sin(th));
+        pt.y = y + (footprint[i].x * sin(th) + footprint[i].y * cos(th));
+        oriented.push_back(pt);
+      }
+      pt.x = x;
+      pt.y = y;
+      EXPECT_EQ(expected, model.footprintCost(pt, oriented, 0.0, 0.0)) << x << " " << y;
+      expected < 0 ? ++illegal : ++legal;
+    }
+  }
+  EXPECT_GT(legal, 0);
+  EXPECT_GT(illegal, 0);
+}
+
+}
@@ -0,0 +1,84 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <costmap_2d/cost_values.h>
+#include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_clearance_grid.h>
+
+namespace base_local_planner {
+
+TEST(FootprintClearanceGridTest, agreesWithCostmapModel){
+  costmap_2d::Costmap2D costmap(40, 30, 0.05, -0.5, 0.25, costmap_2d::FREE_SPACE);
+  costmap.setCost(10, 10, costmap_2d::LETHAL_OBSTACLE);
+  costmap.setCost(30, 5, costmap_2d::NO_INFORMATION);
+  costmap.setCost(25, 20, 100);
+  CostmapModel model(costmap);
+  FootprintClearanceGrid grid;
+  grid.update(costmap);
+
+  std::vector<geometry_msgs::Point> footprint;
+  geometry_msgs::Point pt;
+  pt.x = 0.2; pt.y = 0.1; footprint.push_back(pt);
+  pt.x = 0.2; pt.y = -0.1; footprint.push_back(pt);
+  pt.x = -0.15; pt.y = -0.1; footprint.push_back(pt);
+  pt.x = -0.15; pt.y = 0.1; footprint.push_back(pt);
+  double radius = hypot(0.2, 0.1);
+
+  int clear = 0, free_space = 0;
+  for (double x = -0.6; x < 1.6; x += 0.013) {
+    for (double y = 0.2; y < 1.8; y += 0.017) {
+      double th = x * 3.0 + y;
+      double cost = model.footprintCost(x, y, th, footprint);
+      if (grid.isClear(x, y, radius)) {
+        EXPECT_GE(cost, 0.0) << x << " " << y;
+        ++clear;
+      }
+      if (grid.isFreeSpace(x, y, radius)) {
+        EXPECT_EQ(0.0, cost) << x << " " << y;
+        ++free_space;
+      }
+    }
+  }
+  // the checks have to let a useful number of poses skip the footprint
+  EXPECT_GT(clear, free_space);
+  EXPECT_GT(free_space, 0);
+
+  // footprints that can reach off the map are never clear
+  EXPECT_FALSE(grid.isClear(-0.45, 0.3, radius));
+}
+
+}
@@ -159,4 +159,35 @@ TEST(MapGridTest, distancePropagation){
   EXPECT_EQ(18.0, mg(9, 9).target_dist);
 }
 
+TEST(MapGridTest, targetCellsFollowPlan){
+  MapGrid mg(10, 10);
+  costmap_2d::Costmap2D costmap(10, 10, 1.0, 0.0, 0.0);
+  std::vector<geometry_msgs::PoseStamped> global_plan;
+  geometry_msgs::PoseStamped pose;
+  pose.pose.position.x = 0.5;
+  pose.pose.position.y = 0.5;
+  global_plan.push_back(pose);
+  pose.pose.position.y = 9.5;
+  global_plan.push_back(pose);
+
+  mg.resetPathDist();
+  mg.setTargetCells(costmap, global_plan);
+  EXPECT_EQ(0.0, mg(0, 5).target_dist);
+  EXPECT_EQ(5.0, mg(5, 5).target_dist);
+
+  // same plan again
+  mg.resetPathDist();
+  mg.setTargetCells(costmap, global_plan);
+  EXPECT_EQ(5.0, mg(5, 5).target_dist);
+
+  // the plan moved, distances have to follow it
+  global_plan[0].pose.position.x = 4.5;
+  global_plan[1].pose.position.x = 4.5;
+  mg.resetPathDist();
+  mg.setTargetCells(costmap, global_plan);
+  EXPECT_EQ(0.0, mg(4, 5).target_dist);
+  EXPECT_EQ(1.0, mg(5, 5).target_dist);
+  EXPECT_EQ(4.0, mg(0, 5).target_dist);
+}
+
 }
@@ -0,0 +1,210 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <base_local_planner/obstacle_tracker.h>
+#include <base_local_planner/velocity_obstacle_cost_function.h>
+
+namespace base_local_planner {
+
+// a round blob around (cx, cy) and a wall along y = 2, seen from the origin
+costmap_2d::Observation makeScene(double stamp, double cx, double cy) {
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  for (int i = 0; i < 24; ++i) {
+    double angle = i * M_PI / 12;
+    cloud.points.push_back(pcl::PointXYZ(cx + 0.2 * cos(angle), cy + 0.2 * sin(angle), 0.5));
+  }
+  for (double x = -3.0; x <= 3.0; x += 0.05) {
+    cloud.points.push_back(pcl::PointXYZ(x, 2.0, 0.5));
+  }
+  cloud.header.stamp = ros::Time(stamp);
+  geometry_msgs::Point origin;
+  origin.x = origin.y = origin.z = 0.0;
+  return costmap_2d::Observation(origin, cloud, 5.0, 5.0);
+}
+
+TEST(ObstacleTrackerTest, followsMovingBlob){
+  ObstacleTracker tracker;
+  std::vector<costmap_2d::Observation> observations;
+  for (int frame = 0; frame < 10; ++frame) {
+    double t = 10.0 + frame * 0.1;
+    observations.clear();
+    observations.push_back(makeScene(t, -1.0 + 0.8 * (t - 10.0), 1.0));
+    EXPECT_TRUE(tracker.update(observations));
+  }
+  // the buffers hand out the last observation again until a new one comes in
+  EXPECT_FALSE(tracker.update(observations));
+
+  // the wall is too large to be tracked
+  ASSERT_EQ(1u, tracker.getTracks().size());
+  std::vector<TrackedObstacle> moving;
+  tracker.getMovingTracks(tracker.getLastStamp(), 0.2, 3, moving);
+  ASSERT_EQ(1u, moving.size());
+  EXPECT_NEAR(-1.0 + 0.8 * 0.9, moving[0].x, 0.02);
+  EXPECT_NEAR(1.0, moving[0].y, 0.02);
+  EXPECT_NEAR(0.8, moving[0].vx, 0.05);
+  EXPECT_NEAR(0.0, moving[0].vy, 0.05);
+  // the radius may overestimate the blob a little, but never misses it
+  EXPECT_GE(moving[0].radius, 0.2);
+  EXPECT_LT(moving[0].radius, 0.3);
+
+  // once out of sight, the track is dropped after max_age
+  observations.clear();
+  observations.push_back(makeScene(11.0, 10.0, 10.0));
+  tracker.update(observations);
+  tracker.getMovingTracks(tracker.getLastStamp(), 0.2, 3, moving);
+  EXPECT_EQ(1u, moving.size());
+  observations.clear();
+  observations.push_back(makeScene(11.5, 10.0, 10.0));
+  tracker.update(observations);
+  tracker.getMovingTracks(tracker.getLastStamp(), 0.2, 3, moving);
+  EXPECT_EQ(0u, moving.size());
+}
+
+// the blob and the wall of makeScene, each from its own topic
+costmap_2d::Observation makeTopic(const std::string& topic, double stamp, const costmap_2d::Observation& scene,
+    bool blob) {
+  costmap_2d::Observation obs = scene;
+  std::vector<pcl::PointXYZ> points = obs.cloud_.points;
+  obs.cloud_.points.assign(blob ? points.begin() : points.begin() + 24, blob ? points.begin() + 24 : points.end());
+  obs.cloud_.header.stamp = ros::Time(stamp);
+  obs.topic_ = topic;
+  return obs;
+}
+
+TEST(ObstacleTrackerTest, keepsLaggingTopic){
+  ObstacleTracker tracker;
+  std::vector<costmap_2d::Observation> observations;
+  double t = 0.0;
+  for (int frame = 0; frame < 10; ++frame) {
+    t = 10.0 + frame * 0.1;
+    // the rear sensor only sees the blob, and its clouds come in 0.15 s older than the front ones
+    double rear_t = t - 0.15;
+    observations.clear();
+    observations.push_back(makeTopic("front", t, makeScene(t, 5.0, 5.0), false));
+    observations.push_back(makeTopic("rear", rear_t, makeScene(rear_t, -1.0 + 0.8 * (rear_t - 10.0), 1.0), true));
+    EXPECT_TRUE(tracker.update(observations));
+  }
+  EXPECT_FALSE(tracker.update(observations));
+  EXPECT_DOUBLE_EQ(t, tracker.getLastStamp());
+
+  // the track is dated by the rear topic, and predicted forward to the stamp asked for
+  ASSERT_EQ(1u, tracker.getTracks().size());
+  EXPECT_NEAR(t - 0.15, tracker.getTracks()[0].last_seen, 1e-9);
+  std::vector<TrackedObstacle> moving;
+  tracker.getMovingTracks(t, 0.2, 3, moving);
+  ASSERT_EQ(1u, moving.size());
+  EXPECT_NEAR(-1.0 + 0.8 * (t - 10.0), moving[0].x, 0.02);
+  EXPECT_NEAR(0.8, moving[0].vx, 0.05);
+  tracker.getMovingTracks(t + 0.5, 0.2, 3, moving);
+  ASSERT_EQ(1u, moving.size());
+  EXPECT_NEAR(-1.0 + 0.8 * (t + 0.5 - 10.0), moving[0].x, 0.05);
+
+  // a new cloud from one topic is enough, the other one keeps its stamp
+  observations[0].cloud_.header.stamp = ros::Time(t + 0.1);
+  EXPECT_TRUE(tracker.update(observations));
+  EXPECT_NEAR(t - 0.15, tracker.getTracks()[0].last_seen, 1e-9);
+}
+
+TEST(ObstacleTrackerTest, capsTracksClosestFirst){
+  ObstacleTracker tracker;
+  tracker.setParams(0.1, 1.0, 3, 0.5, 0.5, 2);
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      cloud.points.push_back(pcl::PointXYZ(1.0 + i, 0.05 * j, 0.5));
+    }
+  }
+  cloud.header.stamp = ros::Time(1.0);
+  geometry_msgs::Point origin;
+  origin.x = origin.y = origin.z = 0.0;
+  std::vector<costmap_2d::Observation> observations;
+  observations.push_back(costmap_2d::Observation(origin, cloud, 3.5, 3.5));
+  tracker.update(observations);
+
+  // the blob at x = 4 is out of obstacle range, and only the two closest make it
+  ASSERT_EQ(2u, tracker.getTracks().size());
+  EXPECT_NEAR(1.0, std::min(tracker.getTracks()[0].x, tracker.getTracks()[1].x), 1e-6);
+  EXPECT_NEAR(2.0, std::max(tracker.getTracks()[0].x, tracker.getTracks()[1].x), 1e-6);
+}
+
+TEST(VelocityObstacleCostFunctionTest, penalizesEarlyCollisions){
+  ObstacleTracker tracker;
+  std::vector<costmap_2d::Observation> observations;
+  // a blob crossing the x axis at x = 1.5 from the left, one second from now
+  for (int frame = 0; frame < 5; ++frame) {
+    double t = frame * 0.1;
+    observations.clear();
+    observations.push_back(makeScene(t, 1.5, -1.4 + t));
+    tracker.update(observations);
+  }
+
+  std::vector<geometry_msgs::Point> footprint;
+  geometry_msgs::Point pt;
+  pt.x = 0.2; pt.y = 0.2; footprint.push_back(pt);
+  pt.x = 0.2; pt.y = -0.2; footprint.push_back(pt);
+  pt.x = -0.2; pt.y = -0.2; footprint.push_back(pt);
+  pt.x = -0.2; pt.y = 0.2; footprint.push_back(pt);
+
+  VelocityObstacleCostFunction critic(&tracker);
+  critic.setParams(2.0, 0.2, 3, 0.1);
+  critic.setFootprint(footprint);
+  ASSERT_TRUE(critic.prepare());
+  EXPECT_EQ(1u, critic.getNumTracks());
+
+  // driving along the x axis at 1.5 m/s meets the blob, driving backwards does not
+  Trajectory forward(1.5, 0.0, 0.0, 0.1, 0);
+  Trajectory backward(-0.5, 0.0, 0.0, 0.1, 0);
+  Trajectory slow(0.5, 0.0, 0.0, 0.1, 0);
+  for (int i = 0; i <= 20; ++i) {
+    forward.addPoint(1.5 * i * 0.1, 0.0, 0.0);
+    backward.addPoint(-0.5 * i * 0.1, 0.0, 0.0);
+    slow.addPoint(0.5 * i * 0.1, 0.0, 0.0);
+  }
+  double forward_cost = critic.scoreTrajectory(forward);
+  EXPECT_GT(forward_cost, 0.0);
+  EXPECT_LT(forward_cost, 1.0);
+  EXPECT_EQ(0.0, critic.scoreTrajectory(backward));
+  // arriving later, after the blob has passed, is cheaper or free
+  EXPECT_LT(critic.scoreTrajectory(slow), forward_cost);
+
+  // a trajectory that starts on top of the blob costs the full scale
+  Trajectory here(0.0, 0.0, 0.0, 0.1, 0);
+  here.addPoint(1.5, -1.0, 0.0);
+  EXPECT_NEAR(1.0, critic.scoreTrajectory(here), 1e-9);
+}
+
+}
@@ -0,0 +1,329 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cfloat>
+#include <list>
+#include <algorithm>
+#include <base_local_planner/point_grid.h>
+
+namespace base_local_planner {
+
+namespace {
+
+/**
+ * The PointGrid as it was before the points moved into flat per-cell arrays,
+ * one std::list per cell, trimmed to what the comparison needs.
+ */
+class ListPointGrid {
+  public:
+    ListPointGrid(double size_x, double size_y, double resolution, double min_separation) :
+      resolution_(resolution), sq_min_separation_(min_separation * min_separation) {
+      width_ = (int) (size_x / resolution_);
+      height_ = (int) (size_y / resolution_);
+      cells_.resize(width_ * height_);
+    }
+
+    bool gridCoords(double x, double y, unsigned int& gx, unsigned int& gy) const {
+      if(x < 0.0 || y < 0.0)
+        return false;
+      gx = (int) (x / resolution_);
+      gy = (int) (y / resolution_);
+      return gx < width_ && gy < height_;
+    }
+
+    void insert(const pcl::PointXYZ& pt){
+      unsigned int gx, gy;
+      if(!gridCoords(pt.x, pt.y, gx, gy))
+        return;
+      if(nearestNeighborDistance(pt, gx, gy) < sq_min_separation_)
+        return;
+      cells_[gx + gy * width_].push_back(pt);
+    }
+
+    double footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint,
+        double inscribed_radius, double circumscribed_radius){
+      geometry_msgs::Point c_lower_left, c_upper_right;
+      c_lower_left.x = position.x - circumscribed_radius;
+      c_lower_left.y = position.y - circumscribed_radius;
+      c_upper_right.x = position.x + circumscribed_radius;
+      c_upper_right.y = position.y + circumscribed_radius;
+
+      std::vector<std::list<pcl::PointXYZ>*> points;
+      getPointsInRange(c_lower_left, c_upper_right, points);
+
+      double inner_square_radius = sqrt((inscribed_radius * inscribed_radius) / 2.0);
+      for(unsigned int i = 0; i < points.size(); ++i){
+        for(std::list<pcl::PointXYZ>::iterator it = points[i]->begin(); it != points[i]->end(); ++it){
+          const pcl::PointXYZ& pt = *it;
+          if(pt.x > c_lower_left.x && pt.x < c_upper_right.x && pt.y > c_lower_left.y && pt.y < c_upper_right.y){
+            if(pt.x > position.x - inner_square_radius && pt.x < position.x + inner_square_radius
+                && pt.y > position.y - inner_square_radius && pt.y < position.y + inner_square_radius)
+              return -1.0;
+            if(ptInPolygon(pt, footprint))
+              return -1.0;
+          }
+        }
+      }
+      return 1.0;
+    }
+
+    void removePointsInPolygon(const std::vector<geometry_msgs::Point>& poly){
+      geometry_msgs::Point lower_left = poly[0], upper_right = poly[0];
+      for(unsigned int i = 1; i < poly.size(); ++i){
+        lower_left.x = std::min(lower_left.x, poly[i].x);
+        lower_left.y = std::min(lower_left.y, poly[i].y);
+        upper_right.x = std::max(upper_right.x, poly[i].x);
+        upper_right.y = std::max(upper_right.y, poly[i].y);
+      }
+
+      std::vector<std::list<pcl::PointXYZ>*> points;
+      getPointsInRange(lower_left, upper_right, points);
+      for(unsigned int i = 0; i < points.size(); ++i){
+        std::list<pcl::PointXYZ>::iterator it = points[i]->begin();
+        while(it != points[i]->end()){
+          if(ptInPolygon(*it, poly))
+            it = points[i]->erase(it);
+          else
+            it++;
+        }
+      }
+    }
+
+    void getPoints(std::vector<pcl::PointXYZ>& points) const {
+      for(unsigned int i = 0; i < cells_.size(); ++i)
+        points.insert(points.end(), cells_[i].begin(), cells_[i].end());
+    }
+
+  private:
+    static double orient(const geometry_msgs::Point& a, const geometry_msgs::Point& b, const pcl::PointXYZ& c){
+      return (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+    }
+
+    static bool ptInPolygon(const pcl::PointXYZ& pt, const std::vector<geometry_msgs::Point>& poly){
+      bool all_left = false, all_right = false;
+      for(unsigned int i = 0; i < poly.size(); ++i){
+        if(orient(poly[i], poly[(i + 1) % poly.size()], pt) > 0){
+          if(all_right)
+            return false;
+          all_left = true;
+        }
+        else{
+          if(all_left)
+            return false;
+          all_right = true;
+        }
+      }
+      return true;
+    }
+
+    void getPointsInRange(const geometry_msgs::Point& lower_left, const geometry_msgs::Point& upper_right,
+        std::vector<std::list<pcl::PointXYZ>*>& points){
+      //ranges that reach off the grid return nothing, like they always did
+      unsigned int min_x, min_y, max_x, max_y;
+      if(!gridCoords(lower_left.x, lower_left.y, min_x, min_y) || !gridCoords(upper_right.x, upper_right.y, max_x, max_y))
+        return;
+      for(unsigned int gy = min_y; gy <= max_y; ++gy)
+        for(unsigned int gx = min_x; gx <= max_x; ++gx)
+          if(!cells_[gx + gy * width_].empty())
+            points.push_back(&cells_[gx + gy * width_]);
+    }
+
+    double nearestNeighborDistance(const pcl::PointXYZ& pt, unsigned int gx, unsigned int gy) const {
+      double min_sq_dist = DBL_MAX;
+      for(int dy = -1; dy <= 1; ++dy){
+        for(int dx = -1; dx <= 1; ++dx){
+          int x = gx + dx, y = gy + dy;
+          if(x < 0 || y < 0 || x >= (int) width_ || y >= (int) height_)
+            continue;
+          const std::list<pcl::PointXYZ>& cell = cells_[x + y * width_];
+          for(std::list<pcl::PointXYZ>::const_iterator it = cell.begin(); it != cell.end(); ++it)
+            min_sq_dist = std::min(min_sq_dist, (double) (pt.x - it->x) * (pt.x - it->x) + (pt.y - it->y) * (pt.y - it->y));
+        }
+      }
+      return min_sq_dist;
+    }
+
+    double resolution_, sq_min_separation_;
+    unsigned int width_, height_;
+    std::vector<std::list<pcl::PointXYZ> > cells_;
+};
+
+bool lessXY(const pcl::PointXYZ& a, const pcl::PointXYZ& b){
+  return a.x < b.x || (a.x == b.x && (a.y < b.y || (a.y == b.y && a.z < b.z)));
+}
+
+bool equalXYZ(const pcl::PointXYZ& a, const pcl::PointXYZ& b){
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+void expectSamePoints(PointGrid& grid, const ListPointGrid& reference){
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  grid.getPoints(cloud);
+  std::vector<pcl::PointXYZ> actual(cloud.points.begin(), cloud.points.end()), expected;
+  reference.getPoints(expected);
+  std::sort(actual.begin(), actual.end(), lessXY);
+  std::sort(expected.begin(), expected.end(), lessXY);
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin(), equalXYZ));
+}
+
+// all coordinates are multiples of 1/16 with a 0.25 m grid, so points land exactly on cell
+// boundaries and footprint edges and every orientation test is exact in both versions
+double dyadic(int max_sixteenths){
+  return (rand() % (max_sixteenths + 1)) / 16.0;
+}
+
+pcl::PointXYZ point(double x, double y, double z){
+  pcl::PointXYZ pt;
+  pt.x = x;
+  pt.y = y;
+  pt.z = z;
+  return pt;
+}
+
+std::vector<geometry_msgs::Point> diamond(double x, double y, double radius){
+  std::vector<geometry_msgs::Point> poly(4);
+  poly[0].x = x + radius; poly[0].y = y;
+  poly[1].x = x; poly[1].y = y + radius;
+  poly[2].x = x - radius; poly[2].y = y;
+  poly[3].x = x; poly[3].y = y - radius;
+  return poly;
+}
+
+void compareWithListGrid(double min_separation){
+  srand(42);
+  geometry_msgs::Point origin;
+  PointGrid grid(4.0, 3.0, 0.25, origin, 2.0, 10.0, min_separation);
+  ListPointGrid reference(4.0, 3.0, 0.25, min_separation);
+
+  for(int round = 0; round < 20; ++round){
+    // random points, some on or past the edge of the grid, and points on the cell corners
+    for(int i = 0; i < 200; ++i){
+      pcl::PointXYZ pt = point(dyadic(68) - 0.125, dyadic(52) - 0.125, i);
+      grid.insert(pt);
+      reference.insert(pt);
+    }
+    for(int i = 0; i < 20; ++i){
+      pcl::PointXYZ pt = point(0.25 * (rand() % 17), 0.25 * (rand() % 13), 1000 + i);
+      grid.insert(pt);
+      reference.insert(pt);
+    }
+
+    // legality is queried on merged and unmerged grids alike, then a footprint clears its points
+    for(int i = 0; i < 50; ++i){
+      geometry_msgs::Point position;
+      position.x = dyadic(64);
+      position.y = dyadic(48);
+      double radius = 0.125 * (1 + rand() % 4);
+      std::vector<geometry_msgs::Point> footprint = diamond(position.x, position.y, radius);
+      if(rand() % 2)
+        std::reverse(footprint.begin(), footprint.end());
+      EXPECT_EQ(reference.footprintCost(position, footprint, radius / sqrt(2.0), radius),
+          grid.footprintCost(position, footprint, radius / sqrt(2.0), radius)) << position.x << " " << position.y << " " << radius;
+    }
+
+    std::vector<geometry_msgs::Point> footprint = diamond(0.25 * (rand() % 17), 0.25 * (rand() % 13), 0.5);
+    if(rand() % 2)
+      std::reverse(footprint.begin(), footprint.end());
+    grid.removePointsInPolygon(footprint);
+    reference.removePointsInPolygon(footprint);
+    expectSamePoints(grid, reference);
+  }
+}
+
+}
+
+TEST(PointGridTest, matchesListGrid){
+  compareWithListGrid(0.0);
+}
+
+TEST(PointGridTest, matchesListGridWithMinSeparation){
+  compareWithListGrid(0.1);
+}
+
+TEST(PointGridTest, boundaryPoints){
+  geometry_msgs::Point origin;
+  PointGrid grid(2.0, 2.0, 0.25, origin, 2.0, 10.0, 0.0);
+
+  // the far edges and anything below the origin are off the grid, the origin and the inner cell corners are on it
+  grid.insert(point(2.0, 0.5, 0.0));
+  grid.insert(point(0.5, 2.0, 0.0));
+  grid.insert(point(-0.0625, 0.5, 0.0));
+  grid.insert(point(0.0, 0.0, 0.0));
+  grid.insert(point(0.5, 0.5, 0.0));
+  grid.insert(point(1.0, 0.5, 0.0));
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  grid.getPoints(cloud);
+  EXPECT_EQ(3u, cloud.size());
+
+  // points on the circumscribed square do not count
+  geometry_msgs::Point position;
+  position.x = 0.75;
+  position.y = 0.5;
+  EXPECT_EQ(1.0, grid.footprintCost(position, diamond(0.75, 0.5, 0.25), 0.0, 0.25));
+
+  // a point on a footprint edge is outside a counterclockwise footprint and inside a clockwise one
+  position.x = 0.625;
+  position.y = 0.375;
+  std::vector<geometry_msgs::Point> footprint = diamond(0.625, 0.375, 0.25);
+  EXPECT_EQ(1.0, grid.footprintCost(position, footprint, 0.0, 0.25));
+  std::reverse(footprint.begin(), footprint.end());
+  EXPECT_EQ(-1.0, grid.footprintCost(position, footprint, 0.0, 0.25));
+
+  // a polygon reaching off the grid removes nothing
+  grid.removePointsInPolygon(diamond(0.25, 0.25, 0.5));
+  cloud.clear();
+  grid.getPoints(cloud);
+  EXPECT_EQ(3u, cloud.size());
+
+  // the same goes for points on the vertices of a polygon
+  footprint = diamond(0.75, 0.5, 0.25);
+  grid.removePointsInPolygon(footprint);
+  cloud.clear();
+  grid.getPoints(cloud);
+  EXPECT_EQ(3u, cloud.size());
+  std::reverse(footprint.begin(), footprint.end());
+  grid.removePointsInPolygon(footprint);
+  cloud.clear();
+  grid.getPoints(cloud);
+  ASSERT_EQ(1u, cloud.size());
+  EXPECT_EQ(0.0, cloud[0].x);
+}
+
+}
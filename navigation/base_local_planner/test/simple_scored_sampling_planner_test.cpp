@@ -0,0 +1,284 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+#include <boost/thread.hpp>
+#include <base_local_planner/simple_scored_sampling_planner.h>
+
+namespace base_local_planner {
+
+// samples a grid of x and theta velocities, rolled out along straight lines
+class GridSampleGenerator : public TrajectorySampleGenerator {
+public:
+  GridSampleGenerator(int nx, int nth) : nx_(nx), nth_(nth), next_(0) {}
+
+  bool hasMoreTrajectories() {
+    return next_ < nx_ * nth_;
+  }
+
+  bool nextTrajectory(Trajectory &traj) {
+    int i = next_++;
+    traj.resetPoints();
+    traj.xv_ = 0.1 * (i % nx_);
+    traj.yv_ = 0.0;
+    traj.thetav_ = -1.0 + 0.1 * (i / nx_);
+    for (int p = 0; p < 20; ++p) {
+      traj.addPoint(traj.xv_ * p * 0.1, 0.0, traj.thetav_ * p * 0.1);
+    }
+    return true;
+  }
+
+  void reset() {
+    next_ = 0;
+  }
+
+private:
+  int nx_, nth_, next_;
+};
+
+// distance of the rollout end to a target, rounded so that many samples tie
+class EndpointCostFunction : public TrajectoryCostFunction {
+public:
+  bool prepare() {return true;};
+  double scoreTrajectory(Trajectory &traj) {
+    double x, y, th;
+    traj.getEndpoint(x, y, th);
+    return floor(10 * (fabs(x - 0.9) + fabs(th - 0.3)));
+  }
+  bool isThreadSafe() {return true;};
+};
+
+// rejects turning left fast
+class TurnCostFunction : public TrajectoryCostFunction {
+public:
+  bool prepare() {return true;};
+  double scoreTrajectory(Trajectory &traj) {
+    if (traj.thetav_ > 0.45) {
+      return -1.0;
+    }
+    return fabs(traj.thetav_);
+  }
+  bool isThreadSafe() {return true;};
+};
+
+// sums a cost along the trajectory, stopping once over the bound, and counts the points it looked at
+class CountingCostFunction : public TrajectoryCostFunction {
+public:
+  CountingCostFunction() : points_scored_(0) {}
+  bool prepare() {return true;};
+  double scoreTrajectory(Trajectory &traj) {
+    return scoreTrajectoryBounded(traj, -1.0);
+  }
+  double scoreTrajectoryBounded(Trajectory &traj, double max_cost) {
+    double cost = 0;
+    double x, y, th;
+    for (unsigned int i = 0; i < traj.getPointsSize(); ++i) {
+      points_scored_++;
+      traj.getPoint(i, x, y, th);
+      // stands in for an expensive critic, so that its rejection rate is clearly the lower one
+      for (volatile int k = 0; k < 200; ++k) {}
+      cost += fabs(x - 1.2) + 0.1 * fabs(th);
+      if (max_cost >= 0 && cost > max_cost) {
+        return cost;
+      }
+    }
+    return cost;
+  }
+  unsigned int points_scored_;
+};
+
+// remembers which threads scored trajectories
+class ThreadRecordingCostFunction : public TrajectoryCostFunction {
+public:
+  bool prepare() {return true;};
+  double scoreTrajectory(Trajectory &traj) {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    threads_.insert(boost::this_thread::get_id());
+    return 0.0;
+  }
+  bool isThreadSafe() {return true;};
+  boost::mutex mutex_;
+  std::set<boost::thread::id> threads_;
+};
+
+TEST(SimpleScoredSamplingPlannerTest, parallel_matches_serial) {
+  EndpointCostFunction endpoint_costs;
+  TurnCostFunction turn_costs;
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&turn_costs);
+  critics.push_back(&endpoint_costs);
+
+  GridSampleGenerator generator(15, 21);
+  std::vector<TrajectorySampleGenerator*> generator_list;
+  generator_list.push_back(&generator);
+
+  SimpleScoredSamplingPlanner serial(generator_list, critics);
+  Trajectory serial_traj;
+  std::vector<Trajectory> serial_explored;
+  ASSERT_TRUE(serial.findBestTrajectory(serial_traj, &serial_explored));
+
+  for (int num_threads = 2; num_threads <= 4; ++num_threads) {
+    generator.reset();
+    SimpleScoredSamplingPlanner parallel(generator_list, critics);
+    parallel.setNumThreads(num_threads);
+    Trajectory parallel_traj;
+    std::vector<Trajectory> parallel_explored;
+    ASSERT_TRUE(parallel.findBestTrajectory(parallel_traj, &parallel_explored));
+
+    EXPECT_EQ(serial_traj.xv_, parallel_traj.xv_);
+    EXPECT_EQ(serial_traj.thetav_, parallel_traj.thetav_);
+    EXPECT_EQ(serial_traj.cost_, parallel_traj.cost_);
+    ASSERT_EQ(serial_traj.getPointsSize(), parallel_traj.getPointsSize());
+    ASSERT_EQ(serial_explored.size(), parallel_explored.size());
+    for (unsigned int i = 0; i < serial_explored.size(); ++i) {
+      // aborted samples may carry a different partial cost, but never become valid
+      EXPECT_EQ(serial_explored[i].cost_ < 0, parallel_explored[i].cost_ < 0);
+    }
+  }
+}
+
+TEST(SimpleScoredSamplingPlannerTest, critic_order_does_not_change_result) {
+  CountingCostFunction counting_costs;
+  TurnCostFunction turn_costs;
+  // the expensive critic comes first, the one rejecting a third of the samples last
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&counting_costs);
+  critics.push_back(&turn_costs);
+
+  GridSampleGenerator generator(15, 21);
+  std::vector<TrajectorySampleGenerator*> generator_list;
+  generator_list.push_back(&generator);
+
+  SimpleScoredSamplingPlanner fixed(generator_list, critics);
+  fixed.setAdaptiveCriticOrder(false);
+  SimpleScoredSamplingPlanner adaptive(generator_list, critics);
+
+  unsigned int first_cycle_points = 0, last_cycle_points = 0;
+  for (int cycle = 0; cycle < 3; ++cycle) {
+    Trajectory fixed_traj, adaptive_traj;
+    generator.reset();
+    ASSERT_TRUE(fixed.findBestTrajectory(fixed_traj));
+    generator.reset();
+    counting_costs.points_scored_ = 0;
+    ASSERT_TRUE(adaptive.findBestTrajectory(adaptive_traj));
+    if (cycle == 0) {
+      first_cycle_points = counting_costs.points_scored_;
+    }
+    last_cycle_points = counting_costs.points_scored_;
+
+    EXPECT_EQ(fixed_traj.xv_, adaptive_traj.xv_);
+    EXPECT_EQ(fixed_traj.thetav_, adaptive_traj.thetav_);
+    EXPECT_EQ(fixed_traj.cost_, adaptive_traj.cost_);
+  }
+  // the rejecting critic moved to the front, sparing the expensive one
+  EXPECT_LT(last_cycle_points, first_cycle_points);
+}
+
+TEST(SimpleScoredSamplingPlannerTest, explored_pool_respects_max_samples) {
+  TurnCostFunction turn_costs;
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&turn_costs);
+
+  GridSampleGenerator generator(10, 10);
+  std::vector<TrajectorySampleGenerator*> generator_list;
+  generator_list.push_back(&generator);
+
+  SimpleScoredSamplingPlanner parallel(generator_list, critics, 25);
+  parallel.setNumThreads(3);
+  Trajectory traj;
+  std::vector<Trajectory> explored;
+  ASSERT_TRUE(parallel.findBestTrajectory(traj, &explored));
+  EXPECT_EQ(25u, explored.size());
+  ASSERT_EQ(25u, parallel.getNumExplored());
+  for (unsigned int i = 0; i < explored.size(); ++i) {
+    EXPECT_EQ(explored[i].xv_, parallel.getExplored(i).xv_);
+    EXPECT_EQ(explored[i].cost_, parallel.getExplored(i).cost_);
+  }
+
+  // the pool is reused by the next cycle
+  generator.reset();
+  parallel.setNumThreads(1);
+  Trajectory serial_traj;
+  ASSERT_TRUE(parallel.findBestTrajectory(serial_traj));
+  EXPECT_EQ(25u, parallel.getNumExplored());
+  EXPECT_EQ(traj.xv_, serial_traj.xv_);
+  EXPECT_EQ(traj.thetav_, serial_traj.thetav_);
+}
+
+TEST(SimpleScoredSamplingPlannerTest, workers_persist_between_cycles) {
+  EndpointCostFunction endpoint_costs;
+  ThreadRecordingCostFunction thread_costs;
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&thread_costs);
+  critics.push_back(&endpoint_costs);
+
+  GridSampleGenerator generator(15, 21);
+  std::vector<TrajectorySampleGenerator*> generator_list;
+  generator_list.push_back(&generator);
+
+  SimpleScoredSamplingPlanner serial(generator_list, critics);
+  Trajectory serial_traj;
+  ASSERT_TRUE(serial.findBestTrajectory(serial_traj));
+
+  // assigned like the dwa_local_planner does, before the first cycle starts the workers
+  SimpleScoredSamplingPlanner parallel;
+  parallel = SimpleScoredSamplingPlanner(generator_list, critics);
+  parallel.setNumThreads(3);
+  thread_costs.threads_.clear();
+  for (int cycle = 0; cycle < 20; ++cycle) {
+    generator.reset();
+    Trajectory traj;
+    ASSERT_TRUE(parallel.findBestTrajectory(traj));
+    EXPECT_EQ(serial_traj.xv_, traj.xv_);
+    EXPECT_EQ(serial_traj.thetav_, traj.thetav_);
+    EXPECT_EQ(serial_traj.cost_, traj.cost_);
+  }
+  // the caller and two workers, the same ones every cycle
+  EXPECT_LE(thread_costs.threads_.size(), 3u);
+
+  // a different number of threads replaces the workers
+  parallel.setNumThreads(4);
+  for (int cycle = 0; cycle < 5; ++cycle) {
+    generator.reset();
+    Trajectory traj;
+    ASSERT_TRUE(parallel.findBestTrajectory(traj));
+    EXPECT_EQ(serial_traj.xv_, traj.xv_);
+    EXPECT_EQ(serial_traj.thetav_, traj.thetav_);
+  }
+}
+
+}
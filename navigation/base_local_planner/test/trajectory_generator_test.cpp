@@ -8,8 +8,10 @@
 #include <gtest/gtest.h>
 
 #include <vector>
+#include <algorithm>
 
 #include <base_local_planner/simple_trajectory_generator.h>
+#include <base_local_planner/warm_start_trajectory_generator.h>
 
 namespace base_local_planner {
 
@@ -23,4 +25,164 @@ public:
   virtual void TestBody(){}
 };
   
+static std::vector<Eigen::Vector3f> sampledVelocities(TrajectorySampleGenerator& gen) {
+  std::vector<Eigen::Vector3f> result;
+  Trajectory traj;
+  while (gen.hasMoreTrajectories()) {
+    if (gen.nextTrajectory(traj)) {
+      result.push_back(Eigen::Vector3f(traj.xv_, traj.yv_, traj.thetav_));
+    }
+  }
+  return result;
+}
+
+static bool velocityLess(const Eigen::Vector3f& a, const Eigen::Vector3f& b) {
+  return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+}
+
+TEST(WarmStartTrajectoryGeneratorTest, samplesAroundPreviousCommand) {
+  LocalPlannerLimits limits(1.0, 0.0, 1.0, -0.5, 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 2.0, 1.0, 0.1, 0.1);
+  Eigen::Vector3f pos(0, 0, 0), vel(0.3, 0, 0.2), goal(5, 0, 0), vsamples(5, 1, 5);
+
+  SimpleTrajectoryGenerator simple;
+  simple.setParameters(1.0, 0.1, 0.1, true, 0.5);
+  simple.initialise(pos, vel, goal, &limits, vsamples);
+  std::vector<Eigen::Vector3f> uniform = sampledVelocities(simple);
+  ASSERT_GT(uniform.size(), 10u);
+
+  // without a warm start the order is the one of the grid
+  WarmStartTrajectoryGenerator warm;
+  warm.setParameters(1.0, 0.1, 0.1, true, 0.5);
+  warm.initialise(pos, vel, goal, &limits, vsamples);
+  std::vector<Eigen::Vector3f> cold = sampledVelocities(warm);
+  ASSERT_EQ(uniform.size(), cold.size());
+  for (unsigned int i = 0; i < cold.size(); ++i) {
+    EXPECT_EQ(uniform[i], cold[i]);
+  }
+
+  // with one, the previous command comes first, then the grid nearest first
+  Eigen::Vector3f previous(0.35, 0, 0.25);
+  warm.setWarmStart(previous);
+  warm.initialise(pos, vel, goal, &limits, vsamples);
+  std::vector<Eigen::Vector3f> warm_samples = sampledVelocities(warm);
+  ASSERT_EQ(uniform.size() + 1, warm_samples.size());
+  EXPECT_EQ(previous, warm_samples[0]);
+  // window is x in [-0.2, 0.8], theta in [-0.8, 1.0]
+  Eigen::Vector3f weight(1.0 / 1.0, 0.0, 1.0 / 1.8);
+  for (unsigned int i = 2; i < warm_samples.size(); ++i) {
+    EXPECT_LE((warm_samples[i - 1] - previous).cwiseProduct(weight).norm(),
+        (warm_samples[i] - previous).cwiseProduct(weight).norm() + 1e-6);
+  }
+
+  warm_samples.erase(warm_samples.begin());
+  std::sort(warm_samples.begin(), warm_samples.end(), velocityLess);
+  std::sort(uniform.begin(), uniform.end(), velocityLess);
+  for (unsigned int i = 0; i < uniform.size(); ++i) {
+    EXPECT_EQ(uniform[i], warm_samples[i]);
+  }
+
+  // a command outside the window is not sampled, only sampled around
+  warm.setWarmStart(Eigen::Vector3f(1.0, 0, 0));
+  warm.initialise(pos, vel, goal, &limits, vsamples);
+  warm_samples = sampledVelocities(warm);
+  ASSERT_EQ(uniform.size(), warm_samples.size());
+  EXPECT_FLOAT_EQ(0.8, warm_samples[0][0]);
+  EXPECT_FLOAT_EQ(0.0, warm_samples[0][2]);
+}
+
+TEST(TrajectoryGeneratorTest, incrementalRotationMatchesStepwise) {
+  LocalPlannerLimits limits(1.0, 0.0, 1.0, -0.5, 0.5, -0.5, 1.5, 0.0, 1.0, 1.0, 2.0, 1.0, 0.1, 0.1);
+  Eigen::Vector3f pos(1.0, -2.0, 2.5), vel(0.3, 0.1, 0.2), goal(5, 0, 0), vsamples(5, 3, 7);
+
+  // both with constant velocities (dwa) and with an acceleration phase
+  for (int use_dwa = 0; use_dwa < 2; ++use_dwa) {
+    SimpleTrajectoryGenerator stepwise, incremental;
+    stepwise.setParameters(1.7, 0.025, 0.05, use_dwa, 0.2);
+    incremental.setParameters(1.7, 0.025, 0.05, use_dwa, 0.2);
+    incremental.setIntegration(SimpleTrajectoryGenerator::INCREMENTAL_ROTATION);
+    stepwise.initialise(pos, vel, goal, &limits, vsamples);
+    incremental.initialise(pos, vel, goal, &limits, vsamples);
+
+    Trajectory expected, actual;
+    unsigned int compared = 0;
+    while (stepwise.hasMoreTrajectories()) {
+      ASSERT_TRUE(incremental.hasMoreTrajectories());
+      bool valid = stepwise.nextTrajectory(expected);
+      ASSERT_EQ(valid, incremental.nextTrajectory(actual));
+      if (!valid) {
+        continue;
+      }
+      EXPECT_EQ(expected.xv_, actual.xv_);
+      EXPECT_EQ(expected.thetav_, actual.thetav_);
+      ASSERT_EQ(expected.getPointsSize(), actual.getPointsSize());
+      for (unsigned int i = 0; i < expected.getPointsSize(); ++i) {
+        double ex, ey, eth, ax, ay, ath;
+        expected.getPoint(i, ex, ey, eth);
+        actual.getPoint(i, ax, ay, ath);
+        EXPECT_NEAR(ex, ax, 1e-5);
+        EXPECT_NEAR(ey, ay, 1e-5);
+        EXPECT_EQ(eth, ath);
+      }
+      compared++;
+    }
+    EXPECT_GT(compared, 50u);
+  }
+}
+
+TEST(TrajectoryGeneratorTest, exactArcsMatchStepwiseEndpoint) {
+  LocalPlannerLimits limits(1.0, 0.0, 1.0, -0.5, 0.5, -0.5, 1.5, 0.0, 1.0, 1.0, 2.0, 1.0, 0.1, 0.1);
+  Eigen::Vector3f pos(1.0, -2.0, 2.5), vel(0.3, 0.1, 0.2), goal(5, 0, 0), vsamples(5, 3, 7);
+
+  for (int use_dwa = 0; use_dwa < 2; ++use_dwa) {
+    SimpleTrajectoryGenerator stepwise, exact;
+    stepwise.setParameters(1.7, 0.025, 0.05, use_dwa, 0.2);
+    exact.setParameters(1.7, 0.025, 0.05, use_dwa, 0.2);
+    exact.setIntegration(SimpleTrajectoryGenerator::EXACT_ARCS);
+    stepwise.initialise(pos, vel, goal, &limits, vsamples);
+    exact.initialise(pos, vel, goal, &limits, vsamples);
+
+    Trajectory expected, actual;
+    unsigned int compared = 0;
+    while (stepwise.hasMoreTrajectories()) {
+      ASSERT_TRUE(exact.hasMoreTrajectories());
+      bool valid = stepwise.nextTrajectory(expected);
+      ASSERT_EQ(valid, exact.nextTrajectory(actual));
+      if (!valid) {
+        continue;
+      }
+      EXPECT_EQ(expected.xv_, actual.xv_);
+      EXPECT_EQ(expected.thetav_, actual.thetav_);
+      ASSERT_EQ(expected.getPointsSize(), actual.getPointsSize());
+
+      double ex, ey, eth, ax, ay, ath;
+      expected.getEndpoint(ex, ey, eth);
+      actual.getEndpoint(ax, ay, ath);
+      EXPECT_NEAR(eth, ath, 1e-5);
+      // the Euler steps cut every turn short by about v * w * dt / 2 per second
+      double dt = expected.time_delta_;
+      double time = dt * (expected.getPointsSize() - 1);
+      // the velocities of a trajectory are those of its first step, with acceleration the limits bound the later ones
+      double speed = use_dwa ? hypot(expected.xv_, expected.yv_) : limits.max_trans_vel;
+      double turn = use_dwa ? fabs(expected.thetav_) : limits.max_rot_vel;
+      EXPECT_LE(hypot(ex - ax, ey - ay), speed * turn * time * dt + 1e-5);
+
+      if (use_dwa) {
+        // at constant velocities the arc is what Euler steps converge to
+        double fx = pos[0], fy = pos[1], fth = pos[2];
+        int substeps = 1000 * (expected.getPointsSize() - 1);
+        double fine_dt = time / substeps;
+        for (int i = 0; i < substeps; ++i) {
+          fx += (expected.xv_ * cos(fth) - expected.yv_ * sin(fth)) * fine_dt;
+          fy += (expected.xv_ * sin(fth) + expected.yv_ * cos(fth)) * fine_dt;
+          fth += expected.thetav_ * fine_dt;
+        }
+        EXPECT_NEAR(fx, ax, 1e-4);
+        EXPECT_NEAR(fy, ay, 1e-4);
+      }
+      compared++;
+    }
+    EXPECT_GT(compared, 50u);
+  }
+}
+
 }
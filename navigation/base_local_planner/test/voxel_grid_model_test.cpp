@@ -0,0 +1,104 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/voxel_grid_model.h>
+
+namespace base_local_planner {
+
+// a scan at each height of the grid, from the middle out to the edges
+std::vector<PlanarLaserScan> clearingScans(double range, double resolution, unsigned int size_z) {
+  std::vector<PlanarLaserScan> scans(size_z);
+  for (unsigned int z = 0; z < size_z; ++z) {
+    scans[z].origin.x = 2.0;
+    scans[z].origin.y = 2.0;
+    scans[z].origin.z = (z + 0.5) * resolution;
+    for (int i = 0; i < 1440; ++i) {
+      geometry_msgs::Point32 pt;
+      pt.x = 2.0 + range * cos(i * M_PI / 720);
+      pt.y = 2.0 + range * sin(i * M_PI / 720);
+      pt.z = scans[z].origin.z;
+      scans[z].cloud.points.push_back(pt);
+    }
+  }
+  return scans;
+}
+
+TEST(VoxelGridModelTest, columnSummaryFollowsUpdates){
+  // 4x4 m, 10 cm cells, 16 levels of 10 cm
+  VoxelGridModel model(40, 40, 16, 0.1, 0.1, 0.0, 0.0, 0.0, 1.6, 3.0);
+  std::vector<geometry_msgs::Point> footprint;
+  geometry_msgs::Point pt;
+  pt.x = 0.2; pt.y = 0.15; footprint.push_back(pt);
+  pt.x = 0.2; pt.y = -0.15; footprint.push_back(pt);
+  pt.x = -0.2; pt.y = -0.15; footprint.push_back(pt);
+  pt.x = -0.2; pt.y = 0.15; footprint.push_back(pt);
+
+  // everything is unknown at first
+  std::vector<costmap_2d::Observation> observations;
+  std::vector<PlanarLaserScan> scans;
+  EXPECT_LT(model.footprintCost(2.0, 2.0, 0.0, footprint), 0.0);
+
+  // clear the middle of the grid at all heights
+  scans = clearingScans(1.9, 0.1, 16);
+  model.updateWorld(footprint, observations, scans);
+  EXPECT_EQ(0.0, model.footprintCost(2.0, 2.0, 0.0, footprint));
+  EXPECT_EQ(0.0, model.footprintCost(1.0, 2.5, 0.7, footprint));
+  // the corners were out of reach of the scans
+  EXPECT_LT(model.footprintCost(0.25, 0.25, 0.0, footprint), 0.0);
+  // and the footprint has to be on the grid
+  EXPECT_LT(model.footprintCost(3.9, 2.0, 0.0, footprint), 0.0);
+
+  // an obstacle on the edge of a footprint, but not one that only surrounds it
+  costmap_2d::Observation obs;
+  obs.origin_.x = 2.0;
+  obs.origin_.y = 2.0;
+  obs.origin_.z = 0.5;
+  obs.cloud_.points.push_back(pcl::PointXYZ(2.2, 2.05, 0.5));
+  observations.push_back(obs);
+  scans.clear();
+  model.updateWorld(footprint, observations, scans);
+  EXPECT_LT(model.footprintCost(2.0, 2.0, 0.0, footprint), 0.0);
+  EXPECT_EQ(0.0, model.footprintCost(2.2, 2.05, 0.0, footprint));
+  EXPECT_EQ(0.0, model.footprintCost(1.5, 2.0, 0.0, footprint));
+
+  // and gone again once a scan passes through it
+  observations.clear();
+  scans = clearingScans(1.9, 0.1, 16);
+  model.updateWorld(footprint, observations, scans);
+  EXPECT_EQ(0.0, model.footprintCost(2.0, 2.0, 0.0, footprint));
+}
+
+}
@@ -47,8 +47,7 @@
 #include <tf/tf.h>
 #include <tf/transform_datatypes.h>
 
-#include <base_local_planner/world_model.h>
-#include <base_local_planner/costmap_model.h>
+#include <carrot_planner/segment_search.h>
 
 namespace carrot_planner{
   /**
@@ -68,6 +67,11 @@ namespace carrot_planner{
        */
       CarrotPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
 
+      /**
+       * @brief  Destructor for the CarrotPlanner
+       */
+      ~CarrotPlanner();
+
       /**
        * @brief  Initialization function for the CarrotPlanner
        * @param  name The name of this planner
@@ -88,17 +92,9 @@ namespace carrot_planner{
     private:
       costmap_2d::Costmap2DROS* costmap_ros_;
       double step_size_, min_dist_from_robot_;
+      bool binary_search_; ///< @brief Bisect between the goal and the start instead of stepping back from the goal
       costmap_2d::Costmap2D* costmap_;
-      base_local_planner::WorldModel* world_model_; ///< @brief The world model that the controller will use
-
-      /**
-       * @brief  Checks the legality of the robot footprint at a position and orientation using the world model
-       * @param x_i The x position of the robot 
-       * @param y_i The y position of the robot 
-       * @param theta_i The orientation of the robot
-       * @return 
-       */
-      double footprintCost(double x_i, double y_i, double theta_i);
+      SegmentSearch* search_; ///< @brief Finds the legal pose closest to the goal
 
       bool initialized_;
   };
@@ -0,0 +1,95 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef CARROT_PLANNER_CLEARANCE_FIELD_H_
+#define CARROT_PLANNER_CLEARANCE_FIELD_H_
+#include <vector>
+#include <costmap_2d/costmap_2d.h>
+
+namespace carrot_planner {
+  /**
+   * @class ClearanceField
+   * @brief A Euclidean distance transform over a window of a costmap, giving
+   * the distance from any cell in the window to the nearest cell that
+   * base_local_planner::CostmapModel rejects (LETHAL_OBSTACLE or
+   * NO_INFORMATION) or to the edge of the map, whichever is closer.
+   *
+   * Obstacles outside the window are not seen, so a distance is only exact
+   * when it is smaller than the distance from the cell to the window's edge.
+   */
+  class ClearanceField {
+    public:
+      /**
+       * @brief  Constructor for an empty field
+       */
+      ClearanceField();
+
+      /**
+       * @brief  Compute the distances for the cells of a costmap within a window
+       * @param costmap The costmap to read
+       * @param min_x The lower x bound of the window in world coordinates
+       * @param min_y The lower y bound of the window in world coordinates
+       * @param max_x The upper x bound of the window in world coordinates
+       * @param max_y The upper y bound of the window in world coordinates
+       */
+      void update(const costmap_2d::Costmap2D& costmap, double min_x, double min_y, double max_x, double max_y);
+
+      /**
+       * @brief  Get the clearance of the cell containing a point
+       * @param wx The x coordinate of the point in world coordinates
+       * @param wy The y coordinate of the point in world coordinates
+       * @return The distance in meters between the center of the cell and the center of the nearest rejected cell, 0 outside the window
+       */
+      double distance(double wx, double wy) const;
+
+    private:
+      /**
+       * @brief  The squared distance transform of a sampled function in one dimension (Felzenszwalb and Huttenlocher)
+       * @param f The n samples of the function, unreachable() where there is nothing
+       * @param n The number of samples
+       * @param d The n transformed values to be filled in
+       */
+      void transform1D(const double* f, unsigned int n, double* d);
+
+      static double unreachable() { return 1e30; }
+
+      unsigned int map_size_x_, map_size_y_;
+      unsigned int x0_, y0_, size_x_, size_y_; ///< @brief The window in cells
+      double origin_x_, origin_y_, resolution_;
+      std::vector<float> sq_distances_; ///< @brief Squared distances in cells, row major over the window
+      std::vector<double> f_, d_, z_; ///< @brief Scratch space for transform1D
+      std::vector<unsigned int> v_;
+  };
+};
+#endif
@@ -0,0 +1,117 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef CARROT_PLANNER_SEGMENT_SEARCH_H_
+#define CARROT_PLANNER_SEGMENT_SEARCH_H_
+#include <vector>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+#include <base_local_planner/costmap_model.h>
+#include <carrot_planner/clearance_field.h>
+
+namespace carrot_planner {
+  /**
+   * @class SegmentSearch
+   * @brief Finds the legal pose closest to the goal on the segment between the
+   * start and the goal, the part of the CarrotPlanner that does not need ROS.
+   */
+  class SegmentSearch {
+    public:
+      /**
+       * @brief  Constructor for the SegmentSearch
+       * @param costmap The costmap to check footprints against
+       */
+      SegmentSearch(const costmap_2d::Costmap2D& costmap);
+
+      /**
+       * @brief  Set how the segment is searched
+       * @param step_size The distance between poses checked along the segment, the costmap resolution if not positive
+       * @param binary_search Bisect between the goal and the start instead of stepping back from the goal
+       */
+      void setParameters(double step_size, bool binary_search);
+
+      /**
+       * @brief  Set the footprint of the robot for the following searches
+       * @param footprint The footprint of the robot, centered at the robot
+       */
+      void setFootprint(const std::vector<geometry_msgs::Point>& footprint);
+
+      /**
+       * @brief  Search the segment from the start to the goal for the legal pose closest to the goal
+       * @param start_x The x position of the start
+       * @param start_y The y position of the start
+       * @param start_yaw The orientation at the start
+       * @param goal_x The x position of the goal
+       * @param goal_y The y position of the goal
+       * @param goal_yaw The orientation at the goal
+       * @param target_x Set to the x position of the legal pose, the start if there is none
+       * @param target_y Set to the y position of the legal pose, the start if there is none
+       * @param target_yaw Set to the orientation of the legal pose, the start if there is none
+       * @return True if a legal pose was found, false otherwise
+       */
+      bool findTarget(double start_x, double start_y, double start_yaw,
+          double goal_x, double goal_y, double goal_yaw,
+          double& target_x, double& target_y, double& target_yaw);
+
+      /**
+       * @brief  Checks the legality of the robot footprint at a pose, using the clearance field where it is
+       * conclusive and the world model otherwise. Only valid near the segment of the last search.
+       * @param x The x position of the robot
+       * @param y The y position of the robot
+       * @param theta The orientation of the robot
+       * @param skip Set to a distance the robot can move from here and still be illegal, 0 if unknown
+       * @return True if the footprint is legal, false otherwise
+       */
+      bool isLegalPose(double x, double y, double theta, double* skip);
+
+      /**
+       * @brief  Checks the legality of the robot footprint at a position and orientation using the world model
+       * @param x_i The x position of the robot
+       * @param y_i The y position of the robot
+       * @param theta_i The orientation of the robot
+       * @return The cost of the footprint, negative if it is illegal
+       */
+      double footprintCost(double x_i, double y_i, double theta_i);
+
+    private:
+      const costmap_2d::Costmap2D& costmap_;
+      base_local_planner::CostmapModel world_model_;
+      ClearanceField clearance_; ///< @brief Distances to obstacles around the current start to goal segment
+      std::vector<geometry_msgs::Point> footprint_spec_; ///< @brief The footprint for the current plan
+      double inscribed_radius_, circumscribed_radius_;
+      double step_size_;
+      bool binary_search_;
+  };
+};
+#endif
@@ -43,12 +43,16 @@ PLUGINLIB_EXPORT_CLASS(carrot_planner::CarrotPlanner, nav_core::BaseGlobalPlanne
 namespace carrot_planner {
 
   CarrotPlanner::CarrotPlanner()
-  : costmap_ros_(NULL), initialized_(false){}
+  : costmap_ros_(NULL), search_(NULL), initialized_(false){}
 
   CarrotPlanner::CarrotPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
-  : costmap_ros_(NULL), initialized_(false){
+  : costmap_ros_(NULL), search_(NULL), initialized_(false){
     initialize(name, costmap_ros);
   }
+
+  CarrotPlanner::~CarrotPlanner(){
+    delete search_;
+  }
   
   void CarrotPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros){
     if(!initialized_){
@@ -58,7 +62,9 @@ namespace carrot_planner {
       ros::NodeHandle private_nh("~/" + name);
       private_nh.param("step_size", step_size_, costmap_->getResolution());
       private_nh.param("min_dist_from_robot", min_dist_from_robot_, 0.10);
-      world_model_ = new base_local_planner::CostmapModel(*costmap_); 
+      private_nh.param("binary_search", binary_search_, false);
+      search_ = new SegmentSearch(*costmap_);
+      search_->setParameters(step_size_, binary_search_);
 
       initialized_ = true;
     }
@@ -66,24 +72,6 @@ namespace carrot_planner {
       ROS_WARN("This planner has already been initialized... doing nothing");
   }
 
-  //we need to take the footprint of the robot into account when we calculate cost to obstacles
-  double CarrotPlanner::footprintCost(double x_i, double y_i, double theta_i){
-    if(!initialized_){
-      ROS_ERROR("The planner has not been initialized, please call initialize() to use the planner");
-      return -1.0;
-    }
-
-    std::vector<geometry_msgs::Point> footprint = costmap_ros_->getRobotFootprint();
-    //if we have no footprint... do nothing
-    if(footprint.size() < 3)
-      return -1.0;
-
-    //check if the footprint is legal
-    double footprint_cost = world_model_->footprintCost(x_i, y_i, theta_i, footprint);
-    return footprint_cost;
-  }
-
-
   bool CarrotPlanner::makePlan(const geometry_msgs::PoseStamped& start, 
       const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan){
 
@@ -119,38 +107,14 @@ namespace carrot_planner {
     double start_x = start.pose.position.x;
     double start_y = start.pose.position.y;
 
-    double diff_x = goal_x - start_x;
-    double diff_y = goal_y - start_y;
-    double diff_yaw = angles::normalize_angle(goal_yaw-start_yaw);
-
-    double target_x = goal_x;
-    double target_y = goal_y;
-    double target_yaw = goal_yaw;
-
-    bool done = false;
-    double scale = 1.0;
-    double dScale = 0.01;
-
-    while(!done)
-    {
-      if(scale < 0)
-      {
-        target_x = start_x;
-        target_y = start_y;
-        target_yaw = start_yaw;
-        ROS_WARN("The carrot planner could not find a valid plan for this goal");
-        break;
-      }
-      target_x = start_x + scale * diff_x;
-      target_y = start_y + scale * diff_y;
-      target_yaw = angles::normalize_angle(start_yaw + scale * diff_yaw);
-      
-      double footprint_cost = footprintCost(target_x, target_y, target_yaw);
-      if(footprint_cost >= 0)
-      {
-          done = true;
-      }
-      scale -=dScale;
+    double target_x, target_y, target_yaw;
+
+    //we need to take the footprint of the robot into account when we calculate cost to obstacles
+    search_->setFootprint(costmap_ros_->getRobotFootprint());
+    bool done = search_->findTarget(start_x, start_y, start_yaw, goal_x, goal_y, goal_yaw, target_x, target_y, target_yaw);
+
+    if(!done){
+      ROS_WARN("The carrot planner could not find a valid plan for this goal");
     }
 
     plan.push_back(start);
@@ -0,0 +1,144 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <carrot_planner/clearance_field.h>
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <cmath>
+
+namespace carrot_planner {
+
+  ClearanceField::ClearanceField()
+  : map_size_x_(0), map_size_y_(0), x0_(0), y0_(0), size_x_(0), size_y_(0),
+    origin_x_(0.0), origin_y_(0.0), resolution_(1.0) {}
+
+  void ClearanceField::update(const costmap_2d::Costmap2D& costmap, double min_x, double min_y, double max_x, double max_y){
+    map_size_x_ = costmap.getSizeInCellsX();
+    map_size_y_ = costmap.getSizeInCellsY();
+    origin_x_ = costmap.getOriginX();
+    origin_y_ = costmap.getOriginY();
+    resolution_ = costmap.getResolution();
+
+    int x0, y0, xn, yn;
+    costmap.worldToMapEnforceBounds(min_x, min_y, x0, y0);
+    costmap.worldToMapEnforceBounds(max_x, max_y, xn, yn);
+    x0_ = x0;
+    y0_ = y0;
+    size_x_ = std::max(xn - x0 + 1, 0);
+    size_y_ = std::max(yn - y0 + 1, 0);
+
+    sq_distances_.resize(size_x_ * size_y_);
+    if(sq_distances_.empty())
+      return;
+
+    unsigned int longest = std::max(size_x_, size_y_);
+    f_.resize(longest);
+    d_.resize(longest);
+    z_.resize(longest + 1);
+    v_.resize(longest);
+
+    //transform the columns, seeding the rejected cells with zero
+    const unsigned char* costs = costmap.getCharMap();
+    for(unsigned int x = 0; x < size_x_; ++x){
+      for(unsigned int y = 0; y < size_y_; ++y){
+        unsigned char cost = costs[(y0_ + y) * map_size_x_ + x0_ + x];
+        f_[y] = (cost == costmap_2d::LETHAL_OBSTACLE || cost == costmap_2d::NO_INFORMATION) ? 0.0 : unreachable();
+      }
+      transform1D(&f_[0], size_y_, &d_[0]);
+      for(unsigned int y = 0; y < size_y_; ++y)
+        sq_distances_[y * size_x_ + x] = d_[y];
+    }
+
+    //then the rows of the column result
+    for(unsigned int y = 0; y < size_y_; ++y){
+      float* row = &sq_distances_[y * size_x_];
+      std::copy(row, row + size_x_, f_.begin());
+      transform1D(&f_[0], size_x_, &d_[0]);
+      std::copy(d_.begin(), d_.begin() + size_x_, row);
+    }
+  }
+
+  void ClearanceField::transform1D(const double* f, unsigned int n, double* d){
+    //lower envelope of the parabolas rooted at the reachable samples
+    int k = -1;
+    for(unsigned int q = 0; q < n; ++q){
+      if(f[q] >= unreachable())
+        continue;
+      if(k < 0){
+        k = 0;
+        v_[0] = q;
+        z_[0] = -unreachable();
+        z_[1] = unreachable();
+        continue;
+      }
+      double s = ((f[q] + double(q) * q) - (f[v_[k]] + double(v_[k]) * v_[k])) / (2.0 * q - 2.0 * v_[k]);
+      while(s <= z_[k]){
+        k--;
+        s = ((f[q] + double(q) * q) - (f[v_[k]] + double(v_[k]) * v_[k])) / (2.0 * q - 2.0 * v_[k]);
+      }
+      k++;
+      v_[k] = q;
+      z_[k] = s;
+      z_[k + 1] = unreachable();
+    }
+
+    if(k < 0){
+      std::fill(d, d + n, unreachable());
+      return;
+    }
+
+    k = 0;
+    for(unsigned int q = 0; q < n; ++q){
+      while(z_[k + 1] < q)
+        k++;
+      double dq = double(q) - v_[k];
+      d[q] = dq * dq + f[v_[k]];
+    }
+  }
+
+  double ClearanceField::distance(double wx, double wy) const {
+    if(wx < origin_x_ || wy < origin_y_)
+      return 0.0;
+    unsigned int mx = (unsigned int) ((wx - origin_x_) / resolution_);
+    unsigned int my = (unsigned int) ((wy - origin_y_) / resolution_);
+    if(mx < x0_ || my < y0_ || mx >= x0_ + size_x_ || my >= y0_ + size_y_)
+      return 0.0;
+
+    //anything past the edge of the map counts as rejected too
+    unsigned int edge = std::min(std::min(mx + 1, my + 1), std::min(map_size_x_ - mx, map_size_y_ - my));
+    double cells = std::min(sqrt(sq_distances_[(my - y0_) * size_x_ + mx - x0_]), double(edge));
+    return cells * resolution_;
+  }
+
+};
@@ -0,0 +1,163 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <carrot_planner/segment_search.h>
+#include <costmap_2d/footprint.h>
+#include <angles/angles.h>
+#include <algorithm>
+#include <cmath>
+
+namespace carrot_planner {
+
+  SegmentSearch::SegmentSearch(const costmap_2d::Costmap2D& costmap)
+  : costmap_(costmap), world_model_(costmap), inscribed_radius_(0.0), circumscribed_radius_(0.0),
+    step_size_(costmap.getResolution()), binary_search_(false) {}
+
+  void SegmentSearch::setParameters(double step_size, bool binary_search){
+    step_size_ = step_size;
+    binary_search_ = binary_search;
+  }
+
+  void SegmentSearch::setFootprint(const std::vector<geometry_msgs::Point>& footprint){
+    //the footprint and its radii are the same for every pose we check
+    footprint_spec_ = footprint;
+    costmap_2d::calculateMinAndMaxDistances(footprint_spec_, inscribed_radius_, circumscribed_radius_);
+  }
+
+  double SegmentSearch::footprintCost(double x_i, double y_i, double theta_i){
+    //if we have no footprint... do nothing
+    if(footprint_spec_.size() < 3)
+      return -1.0;
+
+    //check if the footprint is legal
+    return world_model_.footprintCost(x_i, y_i, theta_i, footprint_spec_);
+  }
+
+  bool SegmentSearch::isLegalPose(double x, double y, double theta, double* skip){
+    *skip = 0.0;
+    if(footprint_spec_.size() < 3)
+      return false;
+
+    //cell centers can be off by up to a cell diagonal from the points they stand for
+    double resolution = costmap_.getResolution();
+    double slack = 2.0 * resolution;
+    double clearance = clearance_.distance(x, y);
+
+    //no rejected cell is within reach of the footprint, so there is nothing to rasterize
+    if(clearance > circumscribed_radius_ + slack)
+      return true;
+
+    //a rejected cell is under the robot, and stays under it until the robot
+    //has moved far enough for the clearance to reach the inscribed radius
+    if(clearance < inscribed_radius_ - slack){
+      *skip = std::max(0.0, inscribed_radius_ - slack - clearance - 1.5 * resolution);
+      return false;
+    }
+
+    return footprintCost(x, y, theta) >= 0;
+  }
+
+  bool SegmentSearch::findTarget(double start_x, double start_y, double start_yaw,
+      double goal_x, double goal_y, double goal_yaw,
+      double& target_x, double& target_y, double& target_yaw){
+    double diff_x = goal_x - start_x;
+    double diff_y = goal_y - start_y;
+    double diff_yaw = angles::normalize_angle(goal_yaw - start_yaw);
+
+    //distances only matter out to where the footprint can reach from the segment
+    double margin = circumscribed_radius_ + 3.0 * costmap_.getResolution();
+    clearance_.update(costmap_, std::min(start_x, goal_x) - margin, std::min(start_y, goal_y) - margin,
+        std::max(start_x, goal_x) + margin, std::max(start_y, goal_y) + margin);
+
+    //positions along the segment are measured back from the goal
+    double length = sqrt(diff_x * diff_x + diff_y * diff_y);
+    double step = step_size_ > 0.0 ? step_size_ : costmap_.getResolution();
+    double skip = 0.0;
+    bool done = false;
+
+    if(binary_search_){
+      //assume a single change from illegal to legal between the goal and the start
+      //and bisect for it, this can step over a legal pocket closer to the goal
+      double illegal = 0.0;
+      double legal = length;
+      if(isLegalPose(goal_x, goal_y, goal_yaw, &skip)){
+        legal = 0.0;
+        done = true;
+      }
+      else if(isLegalPose(start_x, start_y, start_yaw, &skip)){
+        while(legal - illegal > step){
+          double mid = 0.5 * (illegal + legal);
+          double scale = 1.0 - mid / length;
+          if(isLegalPose(start_x + scale * diff_x, start_y + scale * diff_y,
+                angles::normalize_angle(start_yaw + scale * diff_yaw), &skip))
+            legal = mid;
+          else
+            illegal = mid;
+        }
+        done = true;
+      }
+
+      double scale = length > 0.0 ? 1.0 - legal / length : 1.0;
+      target_x = start_x + scale * diff_x;
+      target_y = start_y + scale * diff_y;
+      target_yaw = angles::normalize_angle(start_yaw + scale * diff_yaw);
+    }
+    else{
+      //march back from the goal, jumping over stretches the clearance says are illegal
+      double back = 0.0;
+      while(true){
+        double scale = length > 0.0 ? 1.0 - back / length : 1.0;
+        target_x = start_x + scale * diff_x;
+        target_y = start_y + scale * diff_y;
+        target_yaw = angles::normalize_angle(start_yaw + scale * diff_yaw);
+
+        if(isLegalPose(target_x, target_y, target_yaw, &skip)){
+          done = true;
+          break;
+        }
+        if(back >= length)
+          break;
+        back = std::min(length, back + std::max(step, skip));
+      }
+    }
+
+    if(!done){
+      target_x = start_x;
+      target_y = start_y;
+      target_yaw = start_yaw;
+    }
+    return done;
+  }
+
+};
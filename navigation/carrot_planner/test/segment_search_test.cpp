@@ -0,0 +1,246 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <angles/angles.h>
+#include <costmap_2d/cost_values.h>
+#include <carrot_planner/clearance_field.h>
+#include <carrot_planner/segment_search.h>
+
+using namespace carrot_planner;
+
+namespace {
+
+  const double RESOLUTION = 0.05;
+
+  //a 5 x 4 m map with boxes of obstacles and a patch of unknown space
+  void makeCostmap(costmap_2d::Costmap2D& costmap){
+    srand(7);
+    for(int i = 0; i < 12; ++i){
+      unsigned int x0 = rand() % 90, y0 = rand() % 70;
+      unsigned int w = 1 + rand() % 8, h = 1 + rand() % 8;
+      for(unsigned int y = y0; y < y0 + h; ++y)
+        for(unsigned int x = x0; x < x0 + w; ++x)
+          costmap.setCost(x, y, costmap_2d::LETHAL_OBSTACLE);
+    }
+    for(unsigned int y = 60; y < 66; ++y)
+      for(unsigned int x = 10; x < 20; ++x)
+        costmap.setCost(x, y, costmap_2d::NO_INFORMATION);
+    //some inflation, which the footprint check accepts
+    costmap.setCost(50, 40, 200);
+  }
+
+  std::vector<geometry_msgs::Point> rectangle(double length, double width){
+    std::vector<geometry_msgs::Point> footprint(4);
+    footprint[0].x = length / 2; footprint[0].y = width / 2;
+    footprint[1].x = -length / 2; footprint[1].y = width / 2;
+    footprint[2].x = -length / 2; footprint[2].y = -width / 2;
+    footprint[3].x = length / 2; footprint[3].y = -width / 2;
+    return footprint;
+  }
+
+  //the distance to the center of the nearest cell that CostmapModel rejects
+  double nearestRejected(const costmap_2d::Costmap2D& costmap, double wx, double wy){
+    double best = 1e30;
+    for(unsigned int y = 0; y < costmap.getSizeInCellsY(); ++y){
+      for(unsigned int x = 0; x < costmap.getSizeInCellsX(); ++x){
+        unsigned char cost = costmap.getCost(x, y);
+        if(cost != costmap_2d::LETHAL_OBSTACLE && cost != costmap_2d::NO_INFORMATION)
+          continue;
+        double cx, cy;
+        costmap.mapToWorld(x, y, cx, cy);
+        best = std::min(best, hypot(cx - wx, cy - wy));
+      }
+    }
+    return best;
+  }
+
+  double uniform(double min, double max){
+    return min + (max - min) * rand() / (double) RAND_MAX;
+  }
+
+  //the carrot planner before the clearance field, stepping back from the goal one step at a time
+  double stepBack(SegmentSearch& search, double start_x, double start_y, double start_yaw,
+      double goal_x, double goal_y, double goal_yaw, double step){
+    double diff_x = goal_x - start_x, diff_y = goal_y - start_y;
+    double length = sqrt(diff_x * diff_x + diff_y * diff_y);
+    double diff_yaw = angles::normalize_angle(goal_yaw - start_yaw);
+    for(double back = 0.0; back <= length; back += step){
+      double scale = 1.0 - back / length;
+      if(search.footprintCost(start_x + scale * diff_x, start_y + scale * diff_y,
+            angles::normalize_angle(start_yaw + scale * diff_yaw)) >= 0)
+        return back;
+    }
+    return -1.0;
+  }
+
+}
+
+TEST(ClearanceFieldTest, matchesBruteForce){
+  costmap_2d::Costmap2D costmap(100, 80, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  makeCostmap(costmap);
+
+  //the window reaches past the edge of the map on one side
+  ClearanceField field;
+  field.update(costmap, -1.0, 0.5, 3.0, 3.5);
+  unsigned int x0 = 0, y0 = 10, xn = 60, yn = 70;
+
+  for(unsigned int my = 0; my < 80; ++my){
+    for(unsigned int mx = 0; mx < 100; ++mx){
+      double wx, wy;
+      costmap.mapToWorld(mx, my, wx, wy);
+      if(mx < x0 || my < y0 || mx > xn || my > yn){
+        EXPECT_EQ(0.0, field.distance(wx, wy)) << mx << " " << my;
+        continue;
+      }
+
+      //the nearest rejected cell inside the window, or the edge of the map
+      double best = std::min(std::min(mx + 1, my + 1), std::min(100 - mx, 80 - my));
+      for(unsigned int y = y0; y <= yn; ++y){
+        for(unsigned int x = x0; x <= xn; ++x){
+          unsigned char cost = costmap.getCost(x, y);
+          if(cost == costmap_2d::LETHAL_OBSTACLE || cost == costmap_2d::NO_INFORMATION)
+            best = std::min(best, hypot(double(x) - mx, double(y) - my));
+        }
+      }
+      EXPECT_NEAR(best * RESOLUTION, field.distance(wx, wy), 1e-6) << mx << " " << my;
+    }
+  }
+}
+
+TEST(SegmentSearchTest, legalPoseMatchesWorldModel){
+  costmap_2d::Costmap2D costmap(100, 80, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  makeCostmap(costmap);
+  SegmentSearch search(costmap);
+  double inscribed_radius = 0.3;
+  search.setFootprint(rectangle(0.9, 2 * inscribed_radius));
+
+  //the search computes the clearance around its segment, this one covers most of the map
+  double x, y, yaw;
+  search.findTarget(0.5, 0.5, 0.0, 4.5, 3.5, 0.0, x, y, yaw);
+
+  int legal_poses = 0, covered_poses = 0, skipped = 0;
+  for(int i = 0; i < 2000; ++i){
+    double px = uniform(0.6, 4.4), py = uniform(0.6, 3.4), th = uniform(-M_PI, M_PI);
+    double skip;
+    bool legal = search.isLegalPose(px, py, th, &skip);
+    bool model_legal = search.footprintCost(px, py, th) >= 0;
+
+    //the clearance never accepts what the world model rejects
+    if(legal){
+      EXPECT_TRUE(model_legal) << px << " " << py << " " << th;
+      EXPECT_EQ(0.0, skip);
+      legal_poses++;
+      continue;
+    }
+
+    //it only rejects what the world model accepts when a rejected cell is inside the robot,
+    //where the outline of the footprint does not reach
+    if(model_legal){
+      EXPECT_LT(nearestRejected(costmap, px, py), inscribed_radius) << px << " " << py << " " << th;
+      covered_poses++;
+    }
+
+    //the rejected cell stays inside the robot for the whole distance it says can be skipped, in any direction
+    if(skip > 0.0)
+      skipped++;
+    double dir = uniform(-M_PI, M_PI);
+    for(double d = RESOLUTION / 4; d <= skip; d += RESOLUTION / 4){
+      EXPECT_LT(nearestRejected(costmap, px + d * cos(dir), py + d * sin(dir)), inscribed_radius) << px << " " << py << " " << d;
+      EXPECT_FALSE(search.isLegalPose(px + d * cos(dir), py + d * sin(dir), th, &x)) << px << " " << py << " " << d;
+    }
+  }
+  EXPECT_GT(legal_poses, 0);
+  EXPECT_GT(covered_poses, 0);
+  EXPECT_GT(skipped, 0);
+}
+
+TEST(SegmentSearchTest, findsTheLastLegalPose){
+  costmap_2d::Costmap2D costmap(100, 80, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  makeCostmap(costmap);
+  SegmentSearch search(costmap);
+  search.setFootprint(rectangle(0.45, 0.3));
+  double step = RESOLUTION;
+
+  int single_transitions = 0;
+  for(int i = 0; i < 400; ++i){
+    double start_x = uniform(0.2, 4.8), start_y = uniform(0.2, 3.8), start_yaw = uniform(-M_PI, M_PI);
+    double goal_x = uniform(0.2, 4.8), goal_y = uniform(0.2, 3.8), goal_yaw = uniform(-M_PI, M_PI);
+    double length = hypot(goal_x - start_x, goal_y - start_y);
+
+    double x, y, yaw;
+    search.setParameters(step, false);
+    bool found = search.findTarget(start_x, start_y, start_yaw, goal_x, goal_y, goal_yaw, x, y, yaw);
+    if(!found){
+      EXPECT_EQ(start_x, x);
+      EXPECT_EQ(start_y, y);
+      continue;
+    }
+    EXPECT_GE(search.footprintCost(x, y, yaw), 0.0);
+
+    //the rest needs a single change from illegal to legal, narrower pockets can fall between the steps
+    bool single = true, was_legal = false;
+    for(double d = 0.0; d <= length; d += step / 4){
+      double scale = 1.0 - d / length;
+      bool legal = search.footprintCost(start_x + scale * (goal_x - start_x), start_y + scale * (goal_y - start_y),
+          angles::normalize_angle(start_yaw + scale * angles::normalize_angle(goal_yaw - start_yaw))) >= 0;
+      single = single && (legal || !was_legal);
+      was_legal = legal;
+    }
+    if(!single || !was_legal)
+      continue;
+    single_transitions++;
+
+    //the old stepping and the march look at different poses, but stop within a step of each other
+    double back = hypot(goal_x - x, goal_y - y);
+    double old_back = stepBack(search, start_x, start_y, start_yaw, goal_x, goal_y, goal_yaw, step);
+    EXPECT_NEAR(old_back, back, step + 1e-9) << i;
+
+    //and so does the bisection
+    search.setParameters(step, true);
+    ASSERT_TRUE(search.findTarget(start_x, start_y, start_yaw, goal_x, goal_y, goal_yaw, x, y, yaw));
+    EXPECT_GE(search.footprintCost(x, y, yaw), 0.0);
+    EXPECT_NEAR(back, hypot(goal_x - x, goal_y - y), step + 1e-9) << i;
+  }
+  EXPECT_GT(single_transitions, 50);
+}
+
+int main(int argc, char **argv){
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -40,7 +40,7 @@
 #include <costmap_2d/costmap_2d_ros.h>
 #include <tf/transform_listener.h>
 #include <ros/ros.h>
-#include <costmap_2d/obstacle_layer.h>
+#include <costmap_2d/layer.h>
 
 namespace clear_costmap_recovery{
   /**
@@ -74,7 +74,6 @@ namespace clear_costmap_recovery{
 
     private:
       void clear(costmap_2d::Costmap2DROS* costmap);      
-      void clearMap(boost::shared_ptr<costmap_2d::ObstacleLayer> costmap, double pose_x, double pose_y);
       costmap_2d::Costmap2DROS* global_costmap_, *local_costmap_;
       std::string name_;
       tf::TransformListener* tf_;
@@ -41,8 +41,6 @@
 //register this planner as a RecoveryBehavior plugin
 PLUGINLIB_DECLARE_CLASS(clear_costmap_recovery, ClearCostmapRecovery, clear_costmap_recovery::ClearCostmapRecovery, nav_core::RecoveryBehavior)
 
-using costmap_2d::NO_INFORMATION;
-
 namespace clear_costmap_recovery {
 ClearCostmapRecovery::ClearCostmapRecovery(): global_costmap_(NULL), local_costmap_(NULL), 
   tf_(NULL), initialized_(false) {} 
@@ -96,44 +94,18 @@ void ClearCostmapRecovery::clear(costmap_2d::Costmap2DROS* costmap){
   double x = pose.getOrigin().x();
   double y = pose.getOrigin().y();
 
-      for (std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator pluginp = plugins->begin(); pluginp != plugins->end(); ++pluginp) {
-            boost::shared_ptr<costmap_2d::Layer> plugin = *pluginp;
-          if(plugin->getName().find(layer_search_string_)!=std::string::npos){
-            boost::shared_ptr<costmap_2d::ObstacleLayer> costmap;
-            costmap = boost::static_pointer_cast<costmap_2d::ObstacleLayer>(plugin);
-            clearMap(costmap, x, y);
-          }
-      }
-}
-
-
-  void ClearCostmapRecovery::clearMap(boost::shared_ptr<costmap_2d::ObstacleLayer> costmap, double pose_x, double pose_y){
-         boost::unique_lock< boost::shared_mutex > lock(*(costmap->getLock()));
-         
-         double start_point_x = pose_x - reset_distance_ / 2;
-         double start_point_y = pose_y - reset_distance_ / 2;
-         double end_point_x = start_point_x + reset_distance_;
-         double end_point_y = start_point_y + reset_distance_;
+  //keep the window around the robot and reset everything outside of it, each
+  //layer reports the area it actually changed so the next update stays bounded
+  for(std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator pluginp = plugins->begin(); pluginp != plugins->end(); ++pluginp){
+    boost::shared_ptr<costmap_2d::Layer> plugin = *pluginp;
+    if(plugin->getName().find(layer_search_string_) == std::string::npos)
+      continue;
 
-         int start_x, start_y, end_x, end_y;
-         costmap->worldToMapNoBounds(start_point_x, start_point_y, start_x, start_y);
-         costmap->worldToMapNoBounds(end_point_x, end_point_y, end_x, end_y);
-
-         unsigned char* grid = costmap->getCharMap();
-         for(int x=0; x<(int)costmap->getSizeInCellsX(); x++){
-	   bool xrange = x>start_x && x<end_x;
-	                   
-            for(int y=0; y<(int)costmap->getSizeInCellsY(); y++){
-	      if(xrange && y>start_y && y<end_y)
-	          continue;
-                int index = costmap->getIndex(x,y);
-                if(grid[index]!=NO_INFORMATION){
-		  grid[index] = NO_INFORMATION;
-		}
-	    }
-	 }
-	 costmap->setResetBounds(0,0, costmap->getSizeInMetersX(), costmap->getSizeInMetersY());
-	 return;
+    if(!plugin->clearRegion(x - reset_distance_ / 2, y - reset_distance_ / 2,
+          x + reset_distance_ / 2, y + reset_distance_ / 2, true)){
+      ROS_WARN("Layer %s does not support clearing, leaving it as is", plugin->getName().c_str());
     }
+  }
+}
 
 };
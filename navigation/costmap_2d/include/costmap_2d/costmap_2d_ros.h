@@ -41,11 +41,15 @@
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/layer.h>
 #include <costmap_2d/costmap_2d_publisher.h>
+#include <costmap_2d/shared_costmap.h>
+#include <costmap_2d/costmap_snapshot.h>
 #include <costmap_2d/Costmap2DConfig.h>
+#include <costmap_2d/ObservationLatency.h>
 #include <costmap_2d/footprint.h>
 #include <geometry_msgs/Polygon.h>
 #include <dynamic_reconfigure/server.h>
 #include <pluginlib/class_loader.h>
+#include <std_srvs/Empty.h>
 
 class SuperValue : public XmlRpc::XmlRpcValue
 {
@@ -102,6 +106,15 @@ public:
    */
   void resume();
 
+  /**
+   * @brief  Save the master grid and the state of every layer to a file
+   * that a later start restores from, see the snapshot_file parameter.
+   * Must not run concurrently with map updates, so call it with updates
+   * paused or use the save_snapshot service.
+   * @return True if the file was written
+   */
+  bool saveSnapshot(const std::string& path);
+
   /** @brief Same as getLayeredCostmap()->isCurrent(). */
   bool isCurrent()
     {
@@ -268,6 +281,23 @@ private:
   void reconfigureCB(costmap_2d::Costmap2DConfig &config, uint32_t level);
   void movementCB(const ros::TimerEvent &event);
   void mapUpdateLoop(double frequency);
+
+  /** @brief Copy the area changed by the last map update, or the whole map, into the shared costmap segment. */
+  void exportSharedCostmap(bool whole_map = false);
+
+  /**
+   * @brief  Restore the costmap from a snapshot if it was taken with the
+   * same map, geometry and layer parameters
+   * @return False if the costmap has to be built as usual
+   */
+  bool restoreSnapshot(const std::string& path);
+
+  /** @brief Ask the map update thread to save a snapshot and wait for it. */
+  bool saveSnapshotService(std_srvs::Empty::Request& req, std_srvs::Empty::Response& resp);
+
+  /** @brief Publish the observation latency histograms of every source. */
+  void latencyCB(const ros::TimerEvent &event);
+
   bool map_update_thread_shutdown_;
   bool stop_updates_, initialized_, stopped_, robot_stopped_;
   boost::thread* map_update_thread_;  ///< @brief A thread for updating the map
@@ -277,6 +307,15 @@ private:
   pluginlib::ClassLoader<Layer> plugin_loader_;
   tf::Stamped<tf::Pose> old_pose_;
   Costmap2DPublisher* publisher_;
+  std::string shared_costmap_segment_;  ///< @brief Segment to export the master grid to, empty to not share it
+  SharedCostmap* shared_costmap_;
+  std::string snapshot_file_;  ///< @brief Where snapshots are saved and restored from, empty to not use them
+  bool save_snapshot_on_shutdown_;
+  bool restore_snapshot_, snapshot_requested_, snapshot_saved_;
+  bool map_updated_;  ///< @brief Whether the master grid holds a complete costmap worth saving
+  ros::ServiceServer save_snapshot_srv_;
+  ros::Publisher latency_pub_;
+  ros::Timer latency_timer_;
   dynamic_reconfigure::Server<costmap_2d::Costmap2DConfig> *dsrv_;
 
   boost::recursive_mutex configuration_mutex_;
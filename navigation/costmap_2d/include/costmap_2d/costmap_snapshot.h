@@ -0,0 +1,146 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_COSTMAP_SNAPSHOT_H_
+#define COSTMAP_COSTMAP_SNAPSHOT_H_
+#include <costmap_2d/costmap_2d.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace costmap_2d
+{
+/**
+ * @class CostmapSnapshot
+ * @brief A versioned binary file holding named sections of costmap state.
+ *
+ * Sections are collected in memory with addSection() and addGrid() and
+ * written by save(). load() maps a file read only, so restoring only
+ * copies the sections that are actually used.
+ *
+ * File layout: a FileHeader, num_sections SectionEntry records, then
+ * the section data, each section aligned to ALIGNMENT bytes. Grids are
+ * stored as a GridHeader followed by the cells, row major.
+ */
+class CostmapSnapshot
+{
+public:
+  static const uint32_t MAGIC = 0x50534d43;  // "CMSP"
+  static const uint32_t FORMAT_VERSION = 1;
+  static const size_t ALIGNMENT = 64;
+
+  struct FileHeader
+  {
+    uint32_t magic;
+    uint32_t format_version;
+    uint32_t num_sections;
+    uint32_t reserved;
+    char frame_id[64];
+  };
+
+  struct SectionEntry
+  {
+    char name[112];
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  struct GridHeader
+  {
+    uint32_t size_x, size_y;
+    double resolution, origin_x, origin_y;
+  };
+
+  CostmapSnapshot();
+  ~CostmapSnapshot();
+
+  /** @brief Copy a section to be written by save(), replacing one of the same name. */
+  void addSection(const std::string& name, const void* data, size_t size);
+
+  /** @brief Copy the geometry and cells of a grid to be written by save(). */
+  void addGrid(const std::string& name, const Costmap2D& grid);
+
+  /**
+   * @brief  Write the added sections to a file. The file is written
+   * next to path and renamed, so a reader never sees half of it.
+   * @return True if the file was written
+   */
+  bool save(const std::string& path, const std::string& frame_id) const;
+
+  /**
+   * @brief  Map a file written by save() and check its layout
+   * @return False if the file is missing, truncated or of another format version
+   */
+  bool load(const std::string& path);
+
+  void close();
+
+  bool isLoaded() const
+  {
+    return mapped_ != NULL;
+  }
+
+  std::string getFrameID() const;
+
+  /**
+   * @brief  Look up a section of the loaded file
+   * @return The section data, NULL if there is no such section
+   */
+  const unsigned char* getSection(const std::string& name, size_t& size) const;
+
+  /** @brief True if the loaded file has a grid of that name with the geometry of grid. */
+  bool matchesGrid(const std::string& name, const Costmap2D& grid) const;
+
+  /** @brief Copy a grid section into grid if matchesGrid(). */
+  bool getGrid(const std::string& name, Costmap2D& grid) const;
+
+  /** @brief 64 bit FNV-1a hash, pass a previous result as seed to hash several buffers. */
+  static uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ULL);
+
+private:
+  CostmapSnapshot(const CostmapSnapshot&);
+  CostmapSnapshot& operator=(const CostmapSnapshot&);
+
+  struct Section
+  {
+    std::string name;
+    std::vector<unsigned char> data;
+  };
+  std::vector<Section> sections_;
+
+  const unsigned char* mapped_;
+  size_t mapped_size_;
+};
+}  // namespace costmap_2d
+#endif  // COSTMAP_COSTMAP_SNAPSHOT_H_
@@ -90,6 +90,7 @@ public:
   virtual ~InflationLayer()
   {
     deleteKernels();
+    delete[] seen_;
   }
 
   virtual void onInitialize();
@@ -102,6 +103,16 @@ public:
   }
   virtual void matchSize();
 
+  virtual void saveSnapshot(CostmapSnapshot& snapshot);
+  virtual bool matchesSnapshot(const CostmapSnapshot& snapshot);
+  virtual void restoreSnapshot(const CostmapSnapshot& snapshot);
+
+  /**
+   * @brief Change the inflation radius and the cost scaling factor, the whole
+   * costmap is reinflated on the next update. The layer has to be initialized.
+   */
+  void setInflationParameters(double inflation_radius, double cost_scaling_factor);
+
   /** @brief  Given a distance, compute a cost.
    * @param  distance The distance from an obstacle in cells
    * @return A cost value for the distance */
@@ -158,6 +169,9 @@ private:
 
   void computeCaches();
   void deleteKernels();
+
+  /** @brief The values the inflated costs in the master grid depend on, as stored in snapshots. */
+  void getSnapshotParameters(double parameters[4]) const;
   void inflate_area(int min_i, int min_j, int max_i, int max_j, unsigned char* master_grid);
 
   unsigned int cellDistance(double world_dist)
@@ -170,6 +184,7 @@ private:
 
   double inflation_radius_, inscribed_radius_, weight_;
   unsigned int cell_inflation_radius_;
+  unsigned int cached_cell_inflation_radius_; ///< The radius the caches were allocated for
   std::priority_queue<CellData> inflation_queue_;
 
   double resolution_;
@@ -0,0 +1,171 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_LATENCY_TRACER_H_
+#define COSTMAP_LATENCY_TRACER_H_
+#include <ros/time.h>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace costmap_2d
+{
+/**
+ * @class LatencyHistogram
+ * @brief Counts latencies in bins whose upper edges grow by a factor of sqrt(2) from half a millisecond
+ */
+class LatencyHistogram
+{
+public:
+  static const unsigned int BINS = 32;
+
+  LatencyHistogram();
+
+  void add(double seconds);
+
+  /** @brief The upper edge of a bin in seconds, the last bin also counts anything slower */
+  static double binEdge(unsigned int bin);
+
+  /** @brief The upper edge of the bin holding the given fraction of the latencies, or the max for the last bin */
+  double quantile(double fraction) const;
+
+  uint32_t getCount(unsigned int bin) const
+  {
+    return counts_[bin];
+  }
+
+  uint64_t getTotal() const
+  {
+    return total_;
+  }
+
+  double getMax() const
+  {
+    return max_;
+  }
+
+private:
+  uint32_t counts_[BINS];
+  uint64_t total_;
+  double max_;
+};
+
+/**
+ * @class LatencyTracer
+ * @brief Follows observations from their sensor stamp to the first read of a costmap that holds them.
+ *
+ * Sensor layers report the observations an update uses, LayeredCostmap
+ * reports when that update is in the master grid, and the local planner
+ * reports when it reads the grid. Each source gets a histogram per stage,
+ * and the stages of every observation can also be written to a trace
+ * file that chrome://tracing loads.
+ */
+class LatencyTracer
+{
+public:
+  enum Stage
+  {
+    BUFFERED,  ///< @brief Added to an ObservationBuffer
+    USED,  ///< @brief Taken by a layer's updateBounds()
+    MAPPED,  ///< @brief In the master grid
+    READ,  ///< @brief Seen by a reader of the master grid
+    NUM_STAGES
+  };
+
+  static const char* getStageName(unsigned int stage);
+
+  LatencyTracer();
+  ~LatencyTracer();
+
+  /** @brief Turn tracing on or off, all calls but this return right away while it is off */
+  void setEnabled(bool enabled);
+
+  bool isEnabled() const
+  {
+    return enabled_;
+  }
+
+  /**
+   * @brief  Also write every traced observation to a Chrome trace file, enables tracing
+   * @return False if the file could not be opened
+   */
+  bool openTrace(const std::string& path);
+
+  void closeTrace();
+
+  /**
+   * @brief  Report an observation taken by an update, observations already on their way are ignored
+   * @param source The topic of the observation
+   * @param stamp The sensor stamp
+   * @param buffered When the observation entered its buffer
+   */
+  void observationUsed(const std::string& source, const ros::Time& stamp, const ros::Time& buffered);
+
+  /** @brief Report that the observations used so far are in the master grid, with its lock held. */
+  void mapUpdated();
+
+  /** @brief Report a read of the master grid, with its lock held. */
+  void costmapRead();
+
+  /**
+   * @brief  Copy the histograms of all sources
+   * @param sources Filled with the source names
+   * @param histograms Filled with NUM_STAGES histograms per source
+   */
+  void getHistograms(std::vector<std::string>& sources, std::vector<std::vector<LatencyHistogram> >& histograms) const;
+
+private:
+  struct Trace
+  {
+    unsigned int source;
+    ros::Time stamp, buffered, used, mapped;
+  };
+
+  unsigned int getSource(const std::string& source);
+  void writeSpan(unsigned int source, const char* name, const ros::Time& start, const ros::Time& end);
+
+  boost::atomic<bool> enabled_;  ///< @brief Written under mutex_, read without it to return early
+  mutable boost::mutex mutex_;
+  std::vector<std::string> sources_;
+  std::vector<std::vector<LatencyHistogram> > histograms_;
+  std::vector<ros::Time> mapped_until_;  ///< @brief Newest stamp per source that reached the master grid
+  std::vector<Trace> used_, mapped_;
+  FILE* trace_file_;
+  bool trace_empty_;
+};
+}  // namespace costmap_2d
+#endif  // COSTMAP_LATENCY_TRACER_H_
@@ -38,6 +38,7 @@
 #define COSTMAP_PLUGIN_BASE_H_
 #include <costmap_2d/costmap_2d.h>
 #include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/costmap_snapshot.h>
 #include <string>
 #include <tf/tf.h>
 #include <tf/transform_listener.h>
@@ -69,6 +70,41 @@ public:
   /** @brief Implement this to make this layer match the size of the parent costmap. */
   virtual void matchSize() {}
 
+  /**
+   * @brief Reset the cells of this layer to NO_INFORMATION inside the
+   * window [min_x, max_x] x [min_y, max_y], or outside of it if invert is
+   * true. Coordinates are in the global frame.
+   *
+   * Layers that support this report the bounds of the cells that
+   * actually changed from their next updateBounds(), so the
+   * LayeredCostmap only recomputes that area.
+   * @return True if the layer supports clearing, false otherwise */
+  virtual bool clearRegion(double min_x, double min_y, double max_x, double max_y, bool invert)
+  {
+    return false;
+  }
+
+  /**
+   * @brief Add the state that this layer builds at startup to a
+   * snapshot of the costmap, in sections prefixed with the layer name.
+   * Called from the map update thread. */
+  virtual void saveSnapshot(CostmapSnapshot& snapshot) {}
+
+  /**
+   * @brief Check that a snapshot was taken from the same inputs this
+   * layer has now, like the same map or the same parameters.
+   * @return False if restoring the snapshot would give another costmap than rebuilding it */
+  virtual bool matchesSnapshot(const CostmapSnapshot& snapshot)
+  {
+    return true;
+  }
+
+  /**
+   * @brief Restore what saveSnapshot() stored. This is only called
+   * when every layer matches the snapshot, and right after the master
+   * grid was restored from it, so nothing needs to be recomputed. */
+  virtual void restoreSnapshot(const CostmapSnapshot& snapshot) {}
+
   std::string getName() const
   {
     return name_;
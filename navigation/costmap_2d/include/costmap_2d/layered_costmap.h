@@ -41,6 +41,7 @@
 #include <costmap_2d/cost_values.h>
 #include <costmap_2d/layer.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/latency_tracer.h>
 #include <vector>
 #include <string>
 
@@ -99,6 +100,12 @@ public:
     return rolling_window_;
   }
 
+  /** @brief Follows observations into the master grid, see LatencyTracer. */
+  LatencyTracer* getLatencyTracer()
+  {
+    return &latency_tracer_;
+  }
+
   std::vector<boost::shared_ptr<Layer> >* getPlugins()
   {
     return &plugins_;
@@ -161,6 +168,8 @@ private:
   bool size_locked_;
   double circumscribed_radius_, inscribed_radius_;
   std::vector<geometry_msgs::Point> footprint_;
+
+  LatencyTracer latency_tracer_;
 };
 }
 ;
@@ -0,0 +1,58 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_NEAREST_CELL_H_
+#define COSTMAP_NEAREST_CELL_H_
+#include <costmap_2d/costmap_2d.h>
+
+namespace costmap_2d
+{
+/**
+ * @brief  Find the cell closest to a world point whose value is below a limit. Square rings of
+ * cells are searched outward from the cell holding the point, so the search stops at the first
+ * ring no closer cell can lie beyond.
+ * @param costmap Gives the size and placement of the values
+ * @param values One value per cell of the costmap, row major, e.g. the potential of a planner
+ * @param limit Cells with a value at or above it are skipped
+ * @param wx The x coordinate of the point, may be off the map
+ * @param wy The y coordinate of the point, may be off the map
+ * @param radius How far from the cell of the point to search, in meters
+ * @param mx Filled with the x coordinate of the closest cell found
+ * @param my Filled with the y coordinate of the closest cell found
+ * @return True if a cell with a value below the limit was found
+ */
+bool findNearestCell(const Costmap2D& costmap, const float* values, float limit, double wx, double wy,
+                     double radius, unsigned int& mx, unsigned int& my);
+}  // namespace costmap_2d
+#endif  // COSTMAP_NEAREST_CELL_H_
@@ -32,9 +32,12 @@
 #ifndef COSTMAP_OBSERVATION_H_
 #define COSTMAP_OBSERVATION_H_
 
+#include <ros/time.h>
 #include <geometry_msgs/Point.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
+#include <algorithm>
+#include <string>
 
 namespace costmap_2d
 {
@@ -51,7 +54,8 @@ public:
    * @brief  Creates an empty observation
    */
   Observation() :
-      cloud_(), obstacle_range_(0.0), raytrace_range_(0.0)
+      cloud_(), obstacle_range_(0.0), raytrace_range_(0.0), cell_origin_x_(0.0), cell_origin_y_(0.0), cell_resolution_(
+          0.0)
   {
   }
   /**
@@ -63,7 +67,8 @@ public:
    */
   Observation(geometry_msgs::Point& origin, pcl::PointCloud<pcl::PointXYZ> cloud, double obstacle_range,
               double raytrace_range) :
-      origin_(origin), cloud_(cloud), obstacle_range_(obstacle_range), raytrace_range_(raytrace_range)
+      origin_(origin), cloud_(cloud), obstacle_range_(obstacle_range), raytrace_range_(raytrace_range), cell_origin_x_(
+          0.0), cell_origin_y_(0.0), cell_resolution_(0.0)
   {
   }
 
@@ -73,7 +78,9 @@ public:
    */
   Observation(const Observation& obs) :
       origin_(obs.origin_), cloud_(obs.cloud_), obstacle_range_(obs.obstacle_range_), raytrace_range_(
-          obs.raytrace_range_)
+          obs.raytrace_range_), cell_cloud_(obs.cell_cloud_), cell_origin_x_(obs.cell_origin_x_), cell_origin_y_(
+          obs.cell_origin_y_), cell_resolution_(obs.cell_resolution_), buffered_time_(obs.buffered_time_), topic_(
+          obs.topic_)
   {
   }
 
@@ -83,13 +90,52 @@ public:
    * @param obstacle_range The range out to which an observation should be able to insert obstacles
    */
   Observation(pcl::PointCloud<pcl::PointXYZ> cloud, double obstacle_range) :
-      cloud_(cloud), obstacle_range_(obstacle_range), raytrace_range_(0.0)
+      cloud_(cloud), obstacle_range_(obstacle_range), raytrace_range_(0.0), cell_origin_x_(0.0), cell_origin_y_(0.0), cell_resolution_(
+          0.0)
   {
   }
 
+  /**
+   * @brief  Exchange contents with another observation, keeping the storage of both clouds
+   * @param obs The observation to swap with
+   */
+  void swap(Observation& obs)
+  {
+    std::swap(origin_, obs.origin_);
+    std::swap(cloud_.header, obs.cloud_.header);
+    cloud_.points.swap(obs.cloud_.points);
+    std::swap(cloud_.width, obs.cloud_.width);
+    std::swap(cloud_.height, obs.cloud_.height);
+    std::swap(cloud_.is_dense, obs.cloud_.is_dense);
+    std::swap(obstacle_range_, obs.obstacle_range_);
+    std::swap(raytrace_range_, obs.raytrace_range_);
+    std::swap(cell_cloud_.header, obs.cell_cloud_.header);
+    cell_cloud_.points.swap(obs.cell_cloud_.points);
+    std::swap(cell_cloud_.width, obs.cell_cloud_.width);
+    std::swap(cell_cloud_.height, obs.cell_cloud_.height);
+    std::swap(cell_cloud_.is_dense, obs.cell_cloud_.is_dense);
+    std::swap(cell_origin_x_, obs.cell_origin_x_);
+    std::swap(cell_origin_y_, obs.cell_origin_y_);
+    std::swap(cell_resolution_, obs.cell_resolution_);
+    std::swap(buffered_time_, obs.buffered_time_);
+    topic_.swap(obs.topic_);
+  }
+
   geometry_msgs::Point origin_;
   pcl::PointCloud<pcl::PointXYZ> cloud_;
   double obstacle_range_, raytrace_range_;
+
+  /**
+   * @brief One point per cell of the grid at cell_origin_x_, cell_origin_y_ with cell_resolution_: the lowest
+   * point of cloud_ in the cell that lies within obstacle_range_ of the origin. Only valid when cell_resolution_
+   * is not zero.
+   */
+  pcl::PointCloud<pcl::PointXYZ> cell_cloud_;
+  double cell_origin_x_, cell_origin_y_;
+  double cell_resolution_;
+
+  ros::Time buffered_time_; ///< @brief When the observation entered its ObservationBuffer, the sensor stamp is in cloud_
+  std::string topic_; ///< @brief The topic of the ObservationBuffer it came from, empty for static observations
 };
 
 }
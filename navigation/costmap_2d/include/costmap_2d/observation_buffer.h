@@ -42,12 +42,14 @@
 #include <string>
 #include <ros/time.h>
 #include <costmap_2d/observation.h>
+#include <costmap_2d/latency_tracer.h>
 #include <tf/transform_listener.h>
 #include <tf/transform_datatypes.h>
 
 //PCL Stuff
 #include <pcl/point_cloud.h>
 #include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/LaserScan.h>
 
 // Thread support
 #include <boost/thread.hpp>
@@ -108,6 +110,44 @@ public:
    */
   void bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud);
 
+  /**
+   * @brief  Projects a LaserScan into the global frame and filters it by height in a single pass,
+   * without touching the buffer. Only one thread may call this at a time.
+   * @param  scan The scan to project
+   * @param  observation Filled with the result, the storage of its cloud is reused
+   * @return True if the transforms were available
+   */
+  bool transformScan(const sensor_msgs::LaserScan& scan, Observation& observation);
+
+  /**
+   * @brief  Transforms a PointCloud2 into the global frame and filters it by height in a single pass,
+   * without touching the buffer
+   * @param  cloud The cloud to transform
+   * @param  observation Filled with the result, the storage of its cloud is reused
+   * @return True if the transforms were available
+   */
+  bool transformCloud(const sensor_msgs::PointCloud2& cloud, Observation& observation);
+
+  /**
+   * @brief  Buffers an observation made by transformScan() or transformCloud()
+   * @param  observation The observation to buffer, swapped for the storage of a purged one
+   */
+  void bufferObservation(Observation& observation);
+
+  /**
+   * @brief  Report the sensor stamps of the current observations as used by an update
+   * @param  tracer The tracer of the costmap doing the update
+   */
+  void traceObservations(LatencyTracer& tracer);
+
+  /**
+   * @brief  Whether only the latest observation is kept, so older ones never need to be buffered
+   */
+  bool keepsLatestOnly() const
+  {
+    return observation_keep_time_ == ros::Duration(0.0);
+  }
+
   /**
    * @brief  Pushes copies of all current observations onto the end of the vector passed in
    * @param  observations The vector to be filled
@@ -147,6 +187,23 @@ private:
    */
   void purgeStaleObservations();
 
+  /**
+   * @brief  Puts an observation on the front of the list, reusing the storage of a purged one if there is any
+   */
+  Observation& newObservation();
+
+  /**
+   * @brief  Removes the observations from first on, keeping the storage of one of them
+   */
+  void recycleObservations(std::list<Observation>::iterator first);
+
+  /**
+   * @brief  Looks up the transform of a frame and the sensor origin at a stamp, and prepares an
+   * observation in the global frame
+   */
+  bool beginObservation(const std::string& frame_id, const ros::Time& stamp, tf::StampedTransform& transform,
+                        Observation& observation);
+
   tf::TransformListener& tf_;
   const ros::Duration observation_keep_time_;
   const ros::Duration expected_update_rate_;
@@ -154,11 +211,16 @@ private:
   std::string global_frame_;
   std::string sensor_frame_;
   std::list<Observation> observation_list_;
+  std::list<Observation> spare_observations_; ///< @brief At most one purged observation, kept for its storage
   std::string topic_name_;
   double min_obstacle_height_, max_obstacle_height_;
   boost::recursive_mutex lock_; ///< @brief A lock for accessing data in callbacks safely
   double obstacle_range_, raytrace_range_;
   double tf_tolerance_;
+
+  // unit vectors of the beams of the last scan given to transformScan()
+  std::vector<double> beam_cos_, beam_sin_;
+  float beam_angle_min_, beam_angle_increment_;
 };
 }
 #endif
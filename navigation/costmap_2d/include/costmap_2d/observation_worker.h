@@ -0,0 +1,140 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_OBSERVATION_WORKER_H_
+#define COSTMAP_OBSERVATION_WORKER_H_
+#include <costmap_2d/observation_buffer.h>
+#include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/PointCloud.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace costmap_2d
+{
+/**
+ * @class ObservationWorker
+ * @brief Turns sensor messages into observations on a thread of its own.
+ *
+ * Callbacks only put the message on a bounded lock-free queue and
+ * return. The worker transforms and height filters each message in a
+ * single pass, bins the points that may mark into cells of the costmap,
+ * and hands the result to the observation buffer it came for.
+ */
+class ObservationWorker
+{
+public:
+  /**
+   * @param queue_size The number of messages that may wait for the worker, rounded up to a power of two
+   */
+  ObservationWorker(unsigned int queue_size = 64);
+
+  /**
+   * @brief  Stops the thread, messages still queued are dropped
+   */
+  ~ObservationWorker();
+
+  /**
+   * @brief  Add a buffer messages may be queued for, only before start()
+   */
+  void addBuffer(const boost::shared_ptr<ObservationBuffer>& buffer);
+
+  void start();
+  void stop();
+
+  /**
+   * @brief  Bin the marking points of new observations into the cells of this grid
+   * @param resolution The size of a cell, zero to not bin at all
+   */
+  void setGrid(double origin_x, double origin_y, double resolution);
+
+  /**
+   * @brief  Queue a message for a buffer added with addBuffer(), safe from any thread
+   * @return False if the queue was full and the message was dropped
+   */
+  bool enqueue(const boost::shared_ptr<ObservationBuffer>& buffer, const sensor_msgs::LaserScanConstPtr& message);
+  bool enqueue(const boost::shared_ptr<ObservationBuffer>& buffer, const sensor_msgs::PointCloudConstPtr& message);
+  bool enqueue(const boost::shared_ptr<ObservationBuffer>& buffer, const sensor_msgs::PointCloud2ConstPtr& message);
+
+  /**
+   * @brief  Fill the cell cloud of an observation with the lowest point in obstacle range of each cell
+   * of the grid with the given origin and resolution
+   */
+  void binObservation(Observation& observation, double origin_x, double origin_y, double resolution);
+
+private:
+  struct Message
+  {
+    unsigned int buffer;
+    sensor_msgs::LaserScanConstPtr scan;
+    sensor_msgs::PointCloudConstPtr cloud;
+    sensor_msgs::PointCloud2ConstPtr cloud2;
+  };
+
+  struct Slot
+  {
+    volatile size_t sequence;  ///< @brief The queue position the slot is free for, one more once it is filled
+    Message message;
+  };
+
+  bool push(const boost::shared_ptr<ObservationBuffer>& buffer, Message& message);
+  bool pop(Message& message);
+  void run();
+  void process(const Message& message);
+
+  std::vector<boost::shared_ptr<ObservationBuffer> > buffers_;
+
+  std::vector<Slot> slots_;
+  size_t mask_;
+  volatile size_t enqueue_pos_, dequeue_pos_;
+
+  // only guard waking the thread up, never the messages
+  boost::mutex wake_mutex_;
+  boost::condition_variable wake_;
+  bool pending_, shutdown_;
+  boost::thread* thread_;
+
+  boost::mutex grid_mutex_;
+  double grid_origin_x_, grid_origin_y_, grid_resolution_;
+
+  // only touched by the worker thread
+  Observation observation_;
+  std::vector<Message> batch_;
+  std::vector<uint64_t> cell_keys_;
+  std::vector<unsigned int> cell_points_;
+};
+}  // namespace costmap_2d
+#endif  // COSTMAP_OBSERVATION_WORKER_H_
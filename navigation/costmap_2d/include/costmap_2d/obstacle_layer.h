@@ -41,6 +41,7 @@
 #include <costmap_2d/layer.h>
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/observation_buffer.h>
+#include <costmap_2d/observation_worker.h>
 
 #include <nav_msgs/OccupancyGrid.h>
 
@@ -60,11 +61,14 @@ namespace costmap_2d
 class ObstacleLayer : public Layer, public Costmap2D
 {
 public:
-  ObstacleLayer()
+  ObstacleLayer() :
+      worker_(NULL), bin_observations_(true)
   {
     costmap_ = NULL; // this is the unsigned char* member of parent class Costmap2D.
   }
 
+  virtual ~ObstacleLayer();
+
   virtual void onInitialize();
   virtual void updateBounds(double origin_x, double origin_y, double origin_yaw, double* min_x, double* min_y, double* max_x,
                              double* max_y);
@@ -77,6 +81,11 @@ public:
     return true;
   }
   virtual void matchSize();
+  virtual bool clearRegion(double min_x, double min_y, double max_x, double max_y, bool invert);
+
+  virtual void saveSnapshot(CostmapSnapshot& snapshot);
+  virtual bool matchesSnapshot(const CostmapSnapshot& snapshot);
+  virtual void restoreSnapshot(const CostmapSnapshot& snapshot);
 
   /**
    * @brief  A callback to handle buffering LaserScan messages
@@ -111,12 +120,6 @@ public:
     has_been_reset_ = true;
   }
 
-  // for testing purposes
-  void addStaticObservation(costmap_2d::Observation& obs, bool marking, bool clearing);
-
-protected:
-  void initMaps();
-
   /**
    * @brief  Get the observations used to mark space
    * @param marking_observations A reference to a vector that will be populated with the observations
@@ -124,6 +127,12 @@ protected:
    */
   bool getMarkingObservations(std::vector<costmap_2d::Observation>& marking_observations) const;
 
+  // for testing purposes
+  void addStaticObservation(costmap_2d::Observation& obs, bool marking, bool clearing);
+
+protected:
+  void initMaps();
+
   /**
    * @brief  Get the observations used to clear space
    * @param marking_observations A reference to a vector that will be populated with the observations
@@ -131,6 +140,11 @@ protected:
    */
   bool getClearingObservations(std::vector<costmap_2d::Observation>& clearing_observations) const;
 
+  /**
+   * @brief  Report the observations of all buffers to the latency tracer, if it is enabled
+   */
+  void traceObservations();
+
   /**
    * @brief  Clear freespace based on one observation
    * @param clearing_observation The observation used to raytrace
@@ -138,6 +152,16 @@ protected:
   virtual void raytraceFreespace(const costmap_2d::Observation& clearing_observation, double* min_x, double* min_y,
                                  double* max_x, double* max_y);
 
+  /**
+   * @brief  Reset the cells in [x0, xn) x [y0, yn) to NO_INFORMATION
+   * @param touched_x0 Lowered to the smallest x of a cell that changed
+   * @param touched_y0 Lowered to the smallest y of a cell that changed
+   * @param touched_xn Raised to the largest x of a cell that changed
+   * @param touched_yn Raised to the largest y of a cell that changed
+   */
+  virtual void clearCells(int x0, int y0, int xn, int yn, int* touched_x0, int* touched_y0, int* touched_xn,
+                          int* touched_yn);
+
   /** @brief Overridden from superclass Layer to pass new footprint into footprint_layer_. */
   virtual void onFootprintChanged();
 
@@ -155,6 +179,9 @@ protected:
   // Used only for testing purposes
   std::vector<costmap_2d::Observation> static_clearing_observations_, static_marking_observations_;
 
+  ObservationWorker* worker_; ///< @brief Processes sensor messages off the callback threads, if async_ingestion is set
+  bool bin_observations_; ///< @brief Whether updateBounds marks from the cells the worker binned observations into
+
   bool rolling_window_;
   dynamic_reconfigure::Server<costmap_2d::ObstaclePluginConfig> *dsrv_;
 
@@ -0,0 +1,175 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_SHARED_COSTMAP_H_
+#define COSTMAP_SHARED_COSTMAP_H_
+#include <costmap_2d/costmap_2d.h>
+#include <stdint.h>
+#include <string>
+
+namespace costmap_2d
+{
+/**
+ * @brief Layout of the start of a shared costmap segment. The cells
+ * follow at SharedCostmap::DATA_OFFSET, row major.
+ */
+struct SharedCostmapHeader
+{
+  uint32_t magic;
+  uint32_t layout;
+  uint32_t sequence;  ///< @brief Odd while the owner is writing, bumped by two per published version
+  uint32_t stale;  ///< @brief Set when the owner has moved to a new segment or shut down
+  uint64_t capacity;  ///< @brief Number of cells the segment has room for
+  uint32_t size_x, size_y;
+  double resolution, origin_x, origin_y;
+  char frame_id[64];
+};
+
+/** @brief A consistent copy of the geometry of a published version. */
+struct SharedCostmapInfo
+{
+  uint32_t version;
+  unsigned int size_x, size_y;
+  double resolution, origin_x, origin_y;
+  std::string frame_id;
+};
+
+/**
+ * @class SharedCostmap
+ * @brief A costmap exported through a POSIX shared memory segment.
+ *
+ * One owner process publishes into the segment, any number of
+ * processes on the same host map it read only. Writes are guarded by
+ * a sequence counter, so readers never block the owner: they take the
+ * version before reading and check it afterwards with unchanged().
+ */
+class SharedCostmap
+{
+public:
+  static const uint32_t MAGIC = 0x434d5348;  // "HSMC"
+  static const uint32_t LAYOUT = 1;
+  static const size_t DATA_OFFSET = 128;
+
+  SharedCostmap();
+
+  /**
+   * @brief  Unmaps the segment. An owner also marks it stale and unlinks
+   * it, clients that still map it keep the last published version.
+   */
+  ~SharedCostmap();
+
+  /**
+   * @brief  Create the segment as its owner, replacing any left over
+   * under the same name
+   * @param name The segment name, a leading '/' is added if missing
+   * @param capacity The number of cells to reserve
+   * @return True if the segment was created
+   */
+  bool create(const std::string& name, uint64_t capacity);
+
+  /**
+   * @brief  Map an existing segment read only. When already open, the
+   * old mapping is only replaced if the new one could be mapped.
+   * @return True if a segment written by a compatible owner was mapped
+   */
+  bool open(const std::string& name);
+
+  void close();
+
+  bool isOpen() const
+  {
+    return header_ != NULL;
+  }
+
+  bool isOwner() const
+  {
+    return owner_;
+  }
+
+  /** @brief True once the owner has replaced or abandoned the mapped segment, clients should open() again. */
+  bool isStale() const;
+
+  /**
+   * @brief  Copy a window of a costmap into the segment as a new version.
+   * The whole map is copied when the geometry differs from the last
+   * published one, and the segment is recreated if it is too small.
+   * @return False if the segment could not be grown
+   */
+  bool publish(const Costmap2D& costmap, const std::string& frame_id, unsigned int x0, unsigned int xn,
+               unsigned int y0, unsigned int yn);
+
+  /** @brief The current sequence number, zero until the first publish(). */
+  uint32_t getVersion() const;
+
+  /** @brief True if nothing was published since getVersion() returned version. */
+  bool unchanged(uint32_t version) const;
+
+  /**
+   * @brief  Read the geometry of the current version
+   * @return False before the first publish() or if the owner kept writing
+   */
+  bool getInfo(SharedCostmapInfo& info) const;
+
+  const unsigned char* getData() const
+  {
+    return data_;
+  }
+
+  uint64_t getCapacity() const
+  {
+    return capacity_;
+  }
+
+  const std::string& getName() const
+  {
+    return name_;
+  }
+
+  static std::string segmentName(const std::string& name);
+
+private:
+  SharedCostmap(const SharedCostmap&);
+  SharedCostmap& operator=(const SharedCostmap&);
+
+  static void markStale(const std::string& name);
+
+  SharedCostmapHeader* header_;
+  unsigned char* data_;
+  size_t mapped_size_;
+  uint64_t capacity_;
+  std::string name_;
+  bool owner_;
+};
+}  // namespace costmap_2d
+#endif  // COSTMAP_SHARED_COSTMAP_H_
@@ -0,0 +1,86 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef SHARED_COSTMAP_PLUGIN_H_
+#define SHARED_COSTMAP_PLUGIN_H_
+#include <ros/ros.h>
+#include <costmap_2d/layer.h>
+#include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/shared_costmap.h>
+#include <costmap_2d/GenericPluginConfig.h>
+#include <dynamic_reconfigure/server.h>
+#include <vector>
+
+namespace costmap_2d
+{
+/**
+ * @class SharedLayer
+ * @brief Merges a costmap exported by another Costmap2DROS on the same
+ * host (see the shared_costmap_segment parameter) into the master grid.
+ *
+ * The segment is mapped read only and read in place, so the layer keeps
+ * no grid of its own and nothing is rebuilt at startup. It is meant to
+ * replace a static layer and the inflation of it: list it after the
+ * local layers and their inflation, the shared costs are already
+ * inflated and are combined by taking the maximum.
+ */
+class SharedLayer : public Layer
+{
+public:
+  SharedLayer();
+  virtual ~SharedLayer();
+
+  virtual void onInitialize();
+  virtual void updateBounds(double origin_x, double origin_y, double origin_yaw, double* min_x, double* min_y,
+                            double* max_x, double* max_y);
+  virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+  virtual void activate();
+
+private:
+  void reconfigureCB(costmap_2d::GenericPluginConfig &config, uint32_t level);
+
+  /** @brief Size the master grid like the shared one, unless the costmap is rolling. */
+  void matchSharedGeometry();
+
+  std::string segment_;
+  SharedCostmap shared_;
+  SharedCostmapInfo info_;  ///< @brief Geometry of the version seen by the last updateBounds()
+  bool has_info_;
+  uint32_t applied_version_;  ///< @brief Last version merged over its whole extent
+  std::vector<int> columns_;  ///< @brief Shared column for each master column of the current update
+
+  dynamic_reconfigure::Server<costmap_2d::GenericPluginConfig> *dsrv_;
+};
+}
+#endif
@@ -62,6 +62,10 @@ public:
 
   virtual void matchSize();
 
+  virtual void saveSnapshot(CostmapSnapshot& snapshot);
+  virtual bool matchesSnapshot(const CostmapSnapshot& snapshot);
+  virtual void restoreSnapshot(const CostmapSnapshot& snapshot);
+
 private:
   /**
    * @brief  Callback to update the costmap's map from the map_server
@@ -78,6 +82,7 @@ private:
   ros::Subscriber map_sub_;
 
   unsigned char lethal_threshold_, unknown_cost_value_;
+  uint64_t map_hash_;  ///< @brief Hash of the geometry and translated cells of the last map
 
   mutable boost::recursive_mutex lock_;
   dynamic_reconfigure::Server<costmap_2d::GenericPluginConfig> *dsrv_;
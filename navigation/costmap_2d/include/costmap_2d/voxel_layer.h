@@ -64,6 +64,7 @@ public:
       voxel_grid_(0, 0, 0)
   {
     costmap_ = NULL; // this is the unsigned char* member of parent class's parent class Costmap2D.
+    bin_observations_ = false; // marking goes through the voxel grid, which needs every point
   }
 
   virtual void onInitialize();
@@ -77,9 +78,15 @@ public:
   }
   virtual void matchSize();
 
+  virtual void saveSnapshot(CostmapSnapshot& snapshot);
+  virtual bool matchesSnapshot(const CostmapSnapshot& snapshot);
+  virtual void restoreSnapshot(const CostmapSnapshot& snapshot);
+
 private:
   void reconfigureCB(costmap_2d::VoxelPluginConfig &config, uint32_t level);
   void clearNonLethal(double wx, double wy, double w_size_x, double w_size_y, bool clear_no_info);
+  virtual void clearCells(int x0, int y0, int xn, int yn, int* touched_x0, int* touched_y0, int* touched_xn,
+                          int* touched_yn);
   virtual void raytraceFreespace(const costmap_2d::Observation& clearing_observation, double* min_x, double* min_y,
                                  double* max_x, double* max_y);
   void initMaps();
@@ -2,6 +2,7 @@
 #include<costmap_2d/costmap_math.h>
 #include<costmap_2d/footprint.h>
 #include <pluginlib/class_list_macros.h>
+#include <cstring>
 
 PLUGINLIB_EXPORT_CLASS(costmap_2d::InflationLayer, costmap_2d::Layer)
 using costmap_2d::LETHAL_OBSTACLE;
@@ -13,15 +14,22 @@ namespace costmap_2d
 
 InflationLayer::InflationLayer()
   : inflation_radius_( 0 )
+  , inscribed_radius_( 0 )
   , weight_( 0 )
+  , cell_inflation_radius_( 0 )
+  , cached_cell_inflation_radius_( 0 )
+  , resolution_( 0 )
+  , seen_( NULL )
+  , cached_costs_( NULL )
+  , cached_distances_( NULL )
+  , dsrv_( NULL )
+  , need_reinflation_( false )
 {}
 
 void InflationLayer::onInitialize()
 {
   ros::NodeHandle nh("~/" + name_), g_nh;
   current_ = true;
-  seen_ = NULL;
-  need_reinflation_ = false;
 
   dsrv_ = new dynamic_reconfigure::Server<costmap_2d::InflationPluginConfig>(ros::NodeHandle("~/" + name_));
   dynamic_reconfigure::Server<costmap_2d::InflationPluginConfig>::CallbackType cb = boost::bind(
@@ -33,30 +41,68 @@ void InflationLayer::onInitialize()
 
 void InflationLayer::reconfigureCB(costmap_2d::InflationPluginConfig &config, uint32_t level)
 {
-  if (weight_ != config.cost_scaling_factor || inflation_radius_ != config.inflation_radius)
+  setInflationParameters(config.inflation_radius, config.cost_scaling_factor);
+  enabled_ = config.enabled;
+}
+
+void InflationLayer::setInflationParameters(double inflation_radius, double cost_scaling_factor)
+{
+  if (weight_ != cost_scaling_factor || inflation_radius_ != inflation_radius)
   {
-    inflation_radius_ = config.inflation_radius;
+    // called from the reconfigure thread, updateCosts must not be reading the kernels while they are replaced
+    boost::unique_lock < boost::shared_mutex > lock(*(layered_costmap_->getCostmap()->getLock()));
+    inflation_radius_ = inflation_radius;
     cell_inflation_radius_ = cellDistance(inflation_radius_);
-    weight_ = config.cost_scaling_factor;
+    weight_ = cost_scaling_factor;
     need_reinflation_ = true;
     computeCaches();
   }
-  enabled_ = config.enabled;
 }
 
 void InflationLayer::matchSize()
 {
   costmap_2d::Costmap2D* costmap = layered_costmap_->getCostmap();
+  boost::unique_lock < boost::shared_mutex > lock(*(costmap->getLock()));
   resolution_ = costmap->getResolution();
   cell_inflation_radius_ = cellDistance(inflation_radius_);
   computeCaches();
 
   unsigned int size_x = costmap->getSizeInCellsX(), size_y = costmap->getSizeInCellsY();
   if (seen_)
-    delete seen_;
+    delete[] seen_;
   seen_ = new bool[size_x * size_y];
 }
 
+void InflationLayer::getSnapshotParameters(double parameters[4]) const
+{
+  parameters[0] = inflation_radius_;
+  parameters[1] = weight_;
+  parameters[2] = inscribed_radius_;
+  parameters[3] = resolution_;
+}
+
+void InflationLayer::saveSnapshot(CostmapSnapshot& snapshot)
+{
+  double parameters[4];
+  getSnapshotParameters(parameters);
+  snapshot.addSection(name_ + "/parameters", parameters, sizeof(parameters));
+}
+
+bool InflationLayer::matchesSnapshot(const CostmapSnapshot& snapshot)
+{
+  double parameters[4];
+  getSnapshotParameters(parameters);
+  size_t size;
+  const unsigned char* data = snapshot.getSection(name_ + "/parameters", size);
+  return data != NULL && size == sizeof(parameters) && memcmp(data, parameters, size) == 0;
+}
+
+void InflationLayer::restoreSnapshot(const CostmapSnapshot& snapshot)
+{
+  // the restored master grid is already inflated, the kernels are rebuilt from the parameters
+  need_reinflation_ = false;
+}
+
 void InflationLayer::updateBounds(double origin_x, double origin_y, double origin_yaw, double* min_x,
                                            double* min_y, double* max_x, double* max_y)
 {
@@ -65,6 +111,7 @@ void InflationLayer::updateBounds(double origin_x, double origin_y, double origi
   //make sure the inflation queue is empty at the beginning of the cycle (should always be true)
   ROS_ASSERT_MSG(inflation_queue_.empty(), "The inflation queue must be empty at the beginning of inflation");
 
+  boost::unique_lock < boost::shared_mutex > lock(*(layered_costmap_->getCostmap()->getLock()));
   if( need_reinflation_ )
   {
     // For some reason when I make these -<double>::max() it does not
@@ -80,6 +127,7 @@ void InflationLayer::updateBounds(double origin_x, double origin_y, double origi
 
 void InflationLayer::onFootprintChanged()
 {
+  boost::unique_lock < boost::shared_mutex > lock(*(layered_costmap_->getCostmap()->getLock()));
   inscribed_radius_ = layered_costmap_->getInscribedRadius();
   cell_inflation_radius_ = cellDistance( inflation_radius_ );
   computeCaches();
@@ -192,6 +240,8 @@ inline void InflationLayer::enqueue(unsigned char* grid, unsigned int index, uns
 void InflationLayer::computeCaches()
 {
   //based on the inflation radius... compute distance and cost caches
+  deleteKernels();
+  cached_cell_inflation_radius_ = cell_inflation_radius_;
   cached_costs_ = new unsigned char*[cell_inflation_radius_ + 2];
   cached_distances_ = new double*[cell_inflation_radius_ + 2];
   for (unsigned int i = 0; i <= cell_inflation_radius_ + 1; ++i)
@@ -210,20 +260,22 @@ void InflationLayer::deleteKernels()
 {
   if (cached_distances_ != NULL)
   {
-    for (unsigned int i = 0; i <= cell_inflation_radius_ + 1; ++i)
+    for (unsigned int i = 0; i <= cached_cell_inflation_radius_ + 1; ++i)
     {
       delete[] cached_distances_[i];
     }
     delete[] cached_distances_;
+    cached_distances_ = NULL;
   }
 
   if (cached_costs_ != NULL)
   {
-    for (unsigned int i = 0; i <= cell_inflation_radius_ + 1; ++i)
+    for (unsigned int i = 0; i <= cached_cell_inflation_radius_ + 1; ++i)
     {
       delete[] cached_costs_[i];
     }
     delete[] cached_costs_;
+    cached_costs_ = NULL;
   }
 }
 
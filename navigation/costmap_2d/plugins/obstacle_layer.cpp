@@ -1,5 +1,6 @@
 #include<costmap_2d/obstacle_layer.h>
 #include<costmap_2d/costmap_math.h>
+#include <limits>
 
 #include <pluginlib/class_list_macros.h>
 PLUGINLIB_EXPORT_CLASS(costmap_2d::ObstacleLayer, costmap_2d::Layer)
@@ -23,11 +24,21 @@ void ObstacleLayer::onInitialize()
   initMaps();
   current_ = true;
   has_been_reset_ = false;
+  reset_min_x_ = 1e6;
+  reset_min_y_ = 1e6;
+  reset_max_x_ = -1e6;
+  reset_max_y_ = -1e6;
 
   global_frame_ = layered_costmap_->getGlobalFrameID();
   double transform_tolerance;
   nh.param("transform_tolerance", transform_tolerance, 0.2);
 
+  //hand sensor messages to a worker thread instead of processing them in the callbacks
+  bool async_ingestion;
+  nh.param("async_ingestion", async_ingestion, false);
+  if (async_ingestion)
+    worker_ = new ObservationWorker();
+
   std::string topics_string;
   //get the topics that we'll subscribe to from the parameter server
   nh.param("observation_sources", topics_string, std::string(""));
@@ -88,6 +99,9 @@ void ObstacleLayer::onInitialize()
                                      max_obstacle_height, obstacle_range, raytrace_range, *tf_, global_frame_,
                                      sensor_frame, transform_tolerance)));
 
+    if (worker_)
+      worker_->addBuffer(observation_buffers_.back());
+
     //check if we'll add this buffer to our marking observation buffers
     if (marking)
       marking_buffers_.push_back(observation_buffers_.back());
@@ -153,6 +167,13 @@ void ObstacleLayer::onInitialize()
 
   }
 
+  if (worker_)
+  {
+    if (bin_observations_)
+      worker_->setGrid(origin_x_, origin_y_, resolution_);
+    worker_->start();
+  }
+
   dsrv_ = new dynamic_reconfigure::Server<costmap_2d::ObstaclePluginConfig>(nh);
   dynamic_reconfigure::Server<costmap_2d::ObstaclePluginConfig>::CallbackType cb = boost::bind(
       &ObstacleLayer::reconfigureCB, this, _1, _2);
@@ -161,6 +182,16 @@ void ObstacleLayer::onInitialize()
   footprint_layer_.initialize( layered_costmap_, name_ + "_footprint", tf_);
 }
 
+ObstacleLayer::~ObstacleLayer()
+{
+  if (worker_)
+  {
+    worker_->stop();
+    delete worker_;
+    worker_ = NULL;
+  }
+}
+
 void ObstacleLayer::reconfigureCB(costmap_2d::ObstaclePluginConfig &config, uint32_t level)
 {
   enabled_ = config.enabled;
@@ -172,6 +203,10 @@ void ObstacleLayer::initMaps()
   Costmap2D* master = layered_costmap_->getCostmap();
   resizeMap(master->getSizeInCellsX(), master->getSizeInCellsY(), master->getResolution(),
             master->getOriginX(), master->getOriginY());
+
+  //a rolling window only moves by whole cells, so the cells stay the same until the next resize
+  if (worker_ && bin_observations_)
+    worker_->setGrid(origin_x_, origin_y_, resolution_);
 }
 
 void ObstacleLayer::matchSize()
@@ -179,9 +214,86 @@ void ObstacleLayer::matchSize()
   initMaps();
 }
 
+void ObstacleLayer::saveSnapshot(CostmapSnapshot& snapshot)
+{
+  boost::shared_lock < boost::shared_mutex > lock(*getLock());
+  snapshot.addGrid(name_ + "/grid", *this);
+}
+
+bool ObstacleLayer::matchesSnapshot(const CostmapSnapshot& snapshot)
+{
+  return snapshot.matchesGrid(name_ + "/grid", *this);
+}
+
+void ObstacleLayer::restoreSnapshot(const CostmapSnapshot& snapshot)
+{
+  boost::unique_lock < boost::shared_mutex > lock(*getLock());
+  snapshot.getGrid(name_ + "/grid", *this);
+}
+
+bool ObstacleLayer::clearRegion(double min_x, double min_y, double max_x, double max_y, bool invert)
+{
+  boost::unique_lock < boost::shared_mutex > lock(*getLock());
+
+  //the window as a half-open range of cells, clamped to the map
+  int size_x = size_x_, size_y = size_y_;
+  int x0, y0, xn, yn;
+  worldToMapNoBounds(min_x, min_y, x0, y0);
+  worldToMapNoBounds(max_x, max_y, xn, yn);
+  x0 = std::min(std::max(x0, 0), size_x);
+  y0 = std::min(std::max(y0, 0), size_y);
+  xn = std::min(std::max(xn + 1, x0), size_x);
+  yn = std::min(std::max(yn + 1, y0), size_y);
+
+  int touched_x0 = size_x, touched_y0 = size_y, touched_xn = -1, touched_yn = -1;
+  if (!invert)
+  {
+    clearCells(x0, y0, xn, yn, &touched_x0, &touched_y0, &touched_xn, &touched_yn);
+  }
+  else
+  {
+    //everything below and above the window, then the strips to its left and right
+    clearCells(0, 0, size_x, y0, &touched_x0, &touched_y0, &touched_xn, &touched_yn);
+    clearCells(0, yn, size_x, size_y, &touched_x0, &touched_y0, &touched_xn, &touched_yn);
+    clearCells(0, y0, x0, yn, &touched_x0, &touched_y0, &touched_xn, &touched_yn);
+    clearCells(xn, y0, size_x, yn, &touched_x0, &touched_y0, &touched_xn, &touched_yn);
+  }
+
+  //only the cells that changed need to be recomputed on the next update
+  if (touched_xn >= touched_x0)
+    setResetBounds(origin_x_ + touched_x0 * resolution_, origin_x_ + (touched_xn + 1) * resolution_,
+                   origin_y_ + touched_y0 * resolution_, origin_y_ + (touched_yn + 1) * resolution_);
+  return true;
+}
+
+void ObstacleLayer::clearCells(int x0, int y0, int xn, int yn, int* touched_x0, int* touched_y0, int* touched_xn,
+                               int* touched_yn)
+{
+  for (int j = y0; j < yn; j++)
+  {
+    unsigned char* row = costmap_ + j * size_x_;
+    for (int i = x0; i < xn; i++)
+    {
+      if (row[i] == NO_INFORMATION)
+        continue;
+      row[i] = NO_INFORMATION;
+      *touched_x0 = std::min(*touched_x0, i);
+      *touched_y0 = std::min(*touched_y0, j);
+      *touched_xn = std::max(*touched_xn, i);
+      *touched_yn = std::max(*touched_yn, j);
+    }
+  }
+}
+
 void ObstacleLayer::laserScanCallback(const sensor_msgs::LaserScanConstPtr& message,
                                               const boost::shared_ptr<ObservationBuffer>& buffer)
 {
+  if (worker_)
+  {
+    worker_->enqueue(buffer, message);
+    return;
+  }
+
   //project the laser into a point cloud
   sensor_msgs::PointCloud2 cloud;
   cloud.header = message->header;
@@ -207,6 +319,12 @@ void ObstacleLayer::laserScanCallback(const sensor_msgs::LaserScanConstPtr& mess
 void ObstacleLayer::pointCloudCallback(const sensor_msgs::PointCloudConstPtr& message,
                                                const boost::shared_ptr<ObservationBuffer>& buffer)
 {
+  if (worker_)
+  {
+    worker_->enqueue(buffer, message);
+    return;
+  }
+
   sensor_msgs::PointCloud2 cloud2;
 
   if (!sensor_msgs::convertPointCloudToPointCloud2(*message, cloud2))
@@ -224,6 +342,12 @@ void ObstacleLayer::pointCloudCallback(const sensor_msgs::PointCloudConstPtr& me
 void ObstacleLayer::pointCloud2Callback(const sensor_msgs::PointCloud2ConstPtr& message,
                                                 const boost::shared_ptr<ObservationBuffer>& buffer)
 {
+  if (worker_)
+  {
+    worker_->enqueue(buffer, message);
+    return;
+  }
+
   //buffer the point cloud
   buffer->lock();
   buffer->bufferCloud(*message);
@@ -262,6 +386,8 @@ void ObstacleLayer::updateBounds(double origin_x, double origin_y, double origin
   //update the global current status
   current_ = current;
 
+  traceObservations();
+
   //raytrace freespace
   for (unsigned int i = 0; i < clearing_observations.size(); ++i)
   {
@@ -273,9 +399,15 @@ void ObstacleLayer::updateBounds(double origin_x, double origin_y, double origin
   {
     const Observation& obs = *it;
 
-    const pcl::PointCloud<pcl::PointXYZ>& cloud = obs.cloud_;
+    //binned observations hold only the lowest point in range of each cell, which decides whether it is marked,
+    //as long as they were binned into the cells of this layer, the rolling window moves them by whole cells
+    double cells_x = (obs.cell_origin_x_ - origin_x_) / resolution_;
+    double cells_y = (obs.cell_origin_y_ - origin_y_) / resolution_;
+    bool binned = bin_observations_ && obs.cell_resolution_ == resolution_
+        && fabs(cells_x - floor(cells_x + 0.5)) < 1e-3 && fabs(cells_y - floor(cells_y + 0.5)) < 1e-3;
+    const pcl::PointCloud<pcl::PointXYZ>& cloud = binned ? obs.cell_cloud_ : obs.cloud_;
 
-    double sq_obstacle_range = obs.obstacle_range_ * obs.obstacle_range_;
+    double sq_obstacle_range = binned ? std::numeric_limits<double>::max() : obs.obstacle_range_ * obs.obstacle_range_;
 
     for (unsigned int i = 0; i < cloud.points.size(); ++i)
     {
@@ -343,6 +475,20 @@ void ObstacleLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, i
   }
 }
 
+void ObstacleLayer::traceObservations()
+{
+  LatencyTracer* tracer = layered_costmap_->getLatencyTracer();
+  if (!tracer->isEnabled())
+    return;
+
+  for (unsigned int i = 0; i < observation_buffers_.size(); ++i)
+  {
+    observation_buffers_[i]->lock();
+    observation_buffers_[i]->traceObservations(*tracer);
+    observation_buffers_[i]->unlock();
+  }
+}
+
 void ObstacleLayer::addStaticObservation(costmap_2d::Observation& obs, bool marking, bool clearing)
 {
   if(marking)
@@ -0,0 +1,211 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/shared_layer.h>
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <cmath>
+
+#include <pluginlib/class_list_macros.h>
+
+PLUGINLIB_EXPORT_CLASS(costmap_2d::SharedLayer, costmap_2d::Layer)
+
+using costmap_2d::NO_INFORMATION;
+
+namespace costmap_2d
+{
+
+SharedLayer::SharedLayer() :
+    has_info_(false), applied_version_(0), dsrv_(NULL)
+{
+}
+
+SharedLayer::~SharedLayer()
+{
+  if (dsrv_)
+    delete dsrv_;
+}
+
+void SharedLayer::onInitialize()
+{
+  ros::NodeHandle nh("~/" + name_), g_nh;
+  current_ = true;
+
+  nh.param("segment", segment_, std::string("shared_costmap"));
+
+  // like the static layer waits for the map, wait for the owner to publish
+  ROS_INFO("Waiting for shared costmap segment %s...", SharedCostmap::segmentName(segment_).c_str());
+  ros::Rate r(10);
+  while (g_nh.ok() && !(shared_.open(segment_) && shared_.getInfo(info_)))
+  {
+    ros::spinOnce();
+    r.sleep();
+  }
+  has_info_ = shared_.isOpen() && shared_.getInfo(info_);
+  if (has_info_)
+  {
+    ROS_INFO("Mapped a %d X %d shared costmap at %f m/pix", info_.size_x, info_.size_y, info_.resolution);
+    if (info_.frame_id != layered_costmap_->getGlobalFrameID())
+      ROS_WARN("The shared costmap is in frame %s, but this costmap is in frame %s", info_.frame_id.c_str(),
+               layered_costmap_->getGlobalFrameID().c_str());
+    matchSharedGeometry();
+  }
+
+  dsrv_ = new dynamic_reconfigure::Server<costmap_2d::GenericPluginConfig>(nh);
+  dynamic_reconfigure::Server<costmap_2d::GenericPluginConfig>::CallbackType cb = boost::bind(
+      &SharedLayer::reconfigureCB, this, _1, _2);
+  dsrv_->setCallback(cb);
+}
+
+void SharedLayer::reconfigureCB(costmap_2d::GenericPluginConfig &config, uint32_t level)
+{
+  if (config.enabled != enabled_)
+  {
+    enabled_ = config.enabled;
+    applied_version_ = 0;
+  }
+}
+
+void SharedLayer::activate()
+{
+  applied_version_ = 0;
+}
+
+void SharedLayer::matchSharedGeometry()
+{
+  if (layered_costmap_->isRolling())
+    return;
+
+  Costmap2D* master = layered_costmap_->getCostmap();
+  if (master->getSizeInCellsX() != info_.size_x || master->getSizeInCellsY() != info_.size_y
+      || master->getResolution() != info_.resolution || master->getOriginX() != info_.origin_x
+      || master->getOriginY() != info_.origin_y)
+  {
+    layered_costmap_->resizeMap(info_.size_x, info_.size_y, info_.resolution, info_.origin_x, info_.origin_y, true);
+  }
+}
+
+void SharedLayer::updateBounds(double origin_x, double origin_y, double origin_yaw, double* min_x, double* min_y,
+                               double* max_x, double* max_y)
+{
+  if (!enabled_)
+    return;
+
+  // the owner restarted or grew the map, keep the old mapping until the new segment is up
+  if (shared_.isStale() && shared_.open(segment_))
+  {
+    ROS_INFO("Remapped shared costmap segment %s", shared_.getName().c_str());
+    has_info_ = false;
+    applied_version_ = 0;
+  }
+
+  SharedCostmapInfo info;
+  if (!shared_.getInfo(info))
+    return;
+
+  bool resized = !has_info_ || info.size_x != info_.size_x || info.size_y != info_.size_y
+      || info.resolution != info_.resolution || info.origin_x != info_.origin_x || info.origin_y != info_.origin_y;
+  info_ = info;
+  has_info_ = true;
+  if (resized)
+    matchSharedGeometry();
+
+  if (layered_costmap_->isRolling())
+  {
+    // the window moves under the shared map, so it is merged in whole every cycle
+    Costmap2D* master = layered_costmap_->getCostmap();
+    *min_x = std::min(*min_x, master->getOriginX());
+    *min_y = std::min(*min_y, master->getOriginY());
+    *max_x = std::max(*max_x, master->getOriginX() + master->getSizeInMetersX());
+    *max_y = std::max(*max_y, master->getOriginY() + master->getSizeInMetersY());
+  }
+  else if (info_.version != applied_version_)
+  {
+    *min_x = std::min(*min_x, info_.origin_x);
+    *min_y = std::min(*min_y, info_.origin_y);
+    *max_x = std::max(*max_x, info_.origin_x + info_.size_x * info_.resolution);
+    *max_y = std::max(*max_y, info_.origin_y + info_.size_y * info_.resolution);
+  }
+}
+
+void SharedLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+{
+  if (!enabled_ || !has_info_ || max_i <= min_i || max_j <= min_j)
+    return;
+
+  uint32_t version = shared_.getVersion();
+  const unsigned char* shared = shared_.getData();
+  unsigned char* master = master_grid.getCharMap();
+  unsigned int master_size_x = master_grid.getSizeInCellsX();
+  double resolution = master_grid.getResolution();
+
+  // cell centers of the master grid looked up in the shared grid, which
+  // also covers a rolling window that is not aligned with it
+  columns_.resize(max_i - min_i);
+  double wx0 = master_grid.getOriginX() + (min_i + 0.5) * resolution - info_.origin_x;
+  for (int i = min_i; i < max_i; ++i)
+  {
+    int sx = (int)floor((wx0 + (i - min_i) * resolution) / info_.resolution);
+    columns_[i - min_i] = (sx >= 0 && sx < (int)info_.size_x) ? sx : -1;
+  }
+
+  double wy0 = master_grid.getOriginY() + (min_j + 0.5) * resolution - info_.origin_y;
+  for (int j = min_j; j < max_j; ++j)
+  {
+    int sy = (int)floor((wy0 + (j - min_j) * resolution) / info_.resolution);
+    if (sy < 0 || sy >= (int)info_.size_y)
+      continue;
+
+    const unsigned char* shared_row = shared + (size_t)sy * info_.size_x;
+    unsigned char* master_row = master + (size_t)j * master_size_x;
+    for (int i = min_i; i < max_i; ++i)
+    {
+      int sx = columns_[i - min_i];
+      if (sx < 0)
+        continue;
+      unsigned char cost = shared_row[sx];
+      if (cost == NO_INFORMATION)
+        continue;
+      unsigned char old_cost = master_row[i];
+      if (old_cost == NO_INFORMATION || old_cost < cost)
+        master_row[i] = cost;
+    }
+  }
+
+  // a version published while we were reading is merged in whole on the next cycle
+  if (version == info_.version && shared_.unchanged(version))
+    applied_version_ = version;
+}
+
+}
@@ -2,6 +2,7 @@
 #include<costmap_2d/costmap_math.h>
 
 #include <pluginlib/class_list_macros.h>
+#include <cstring>
 
 PLUGINLIB_EXPORT_CLASS(costmap_2d::StaticLayer, costmap_2d::Layer)
 
@@ -92,9 +93,36 @@ void StaticLayer::incomingMap(const nav_msgs::OccupancyGridConstPtr& new_map)
       ++index;
     }
   }
+
+  // the translated cells stand in for the map data and the thresholds
+  map_hash_ = CostmapSnapshot::hash(&new_map->info.width, sizeof(new_map->info.width));
+  map_hash_ = CostmapSnapshot::hash(&new_map->info.height, sizeof(new_map->info.height), map_hash_);
+  map_hash_ = CostmapSnapshot::hash(&new_map->info.resolution, sizeof(new_map->info.resolution), map_hash_);
+  map_hash_ = CostmapSnapshot::hash(&new_map->info.origin.position.x, sizeof(double), map_hash_);
+  map_hash_ = CostmapSnapshot::hash(&new_map->info.origin.position.y, sizeof(double), map_hash_);
+  map_hash_ = CostmapSnapshot::hash(costmap_, size_x * size_y, map_hash_);
   map_recieved_ = true;
 }
 
+void StaticLayer::saveSnapshot(CostmapSnapshot& snapshot)
+{
+  if (map_recieved_)
+    snapshot.addSection(name_ + "/map_hash", &map_hash_, sizeof(map_hash_));
+}
+
+bool StaticLayer::matchesSnapshot(const CostmapSnapshot& snapshot)
+{
+  size_t size;
+  const unsigned char* data = snapshot.getSection(name_ + "/map_hash", size);
+  return map_recieved_ && data != NULL && size == sizeof(map_hash_) && memcmp(data, &map_hash_, size) == 0;
+}
+
+void StaticLayer::restoreSnapshot(const CostmapSnapshot& snapshot)
+{
+  // the master grid already holds the map
+  map_initialized_ = true;
+}
+
 void StaticLayer::updateBounds(double origin_x, double origin_y, double origin_z, double* min_x, double* min_y,
                                         double* max_x, double* max_y)
 {
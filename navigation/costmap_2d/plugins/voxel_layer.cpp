@@ -1,5 +1,7 @@
 #include<costmap_2d/voxel_layer.h>
 #include <pluginlib/class_list_macros.h>
+#include <algorithm>
+#include <cstring>
 #define VOXEL_BITS 16
 PLUGINLIB_EXPORT_CLASS(costmap_2d::VoxelLayer, costmap_2d::Layer)
 
@@ -55,6 +57,59 @@ void VoxelLayer::matchSize()
 
 }
 
+/** @brief Geometry stored in front of the columns in a snapshot section. */
+struct VoxelSnapshotHeader
+{
+  uint32_t size_x, size_y, size_z, reserved;
+  double origin_z, z_resolution;
+};
+
+void VoxelLayer::saveSnapshot(CostmapSnapshot& snapshot)
+{
+  ObstacleLayer::saveSnapshot(snapshot);
+
+  VoxelSnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  header.size_x = voxel_grid_.sizeX();
+  header.size_y = voxel_grid_.sizeY();
+  header.size_z = voxel_grid_.sizeZ();
+  header.origin_z = origin_z_;
+  header.z_resolution = z_resolution_;
+
+  size_t columns = (size_t)header.size_x * header.size_y;
+  std::vector<unsigned char> data(sizeof(header) + columns * sizeof(uint32_t));
+  memcpy(&data[0], &header, sizeof(header));
+  if (columns > 0)
+    memcpy(&data[sizeof(header)], voxel_grid_.getData(), columns * sizeof(uint32_t));
+  snapshot.addSection(name_ + "/voxels", &data[0], data.size());
+}
+
+bool VoxelLayer::matchesSnapshot(const CostmapSnapshot& snapshot)
+{
+  if (!ObstacleLayer::matchesSnapshot(snapshot))
+    return false;
+
+  size_t size;
+  const unsigned char* data = snapshot.getSection(name_ + "/voxels", size);
+  if (data == NULL || size < sizeof(VoxelSnapshotHeader))
+    return false;
+
+  VoxelSnapshotHeader header;
+  memcpy(&header, data, sizeof(header));
+  return header.size_x == voxel_grid_.sizeX() && header.size_y == voxel_grid_.sizeY()
+      && header.size_z == voxel_grid_.sizeZ() && header.origin_z == origin_z_ && header.z_resolution == z_resolution_
+      && size == sizeof(header) + (size_t)header.size_x * header.size_y * sizeof(uint32_t);
+}
+
+void VoxelLayer::restoreSnapshot(const CostmapSnapshot& snapshot)
+{
+  ObstacleLayer::restoreSnapshot(snapshot);
+
+  size_t size;
+  const unsigned char* data = snapshot.getSection(name_ + "/voxels", size);
+  memcpy(voxel_grid_.getData(), data + sizeof(VoxelSnapshotHeader), size - sizeof(VoxelSnapshotHeader));
+}
+
 void VoxelLayer::updateBounds(double origin_x, double origin_y, double origin_yaw, double* min_x,
                                        double* min_y, double* max_x, double* max_y)
 {
@@ -87,6 +142,8 @@ void VoxelLayer::updateBounds(double origin_x, double origin_y, double origin_ya
   //update the global current status
   current_ = current;
 
+  traceObservations();
+
   //raytrace freespace
   for (unsigned int i = 0; i < clearing_observations.size(); ++i)
   {
@@ -219,6 +276,22 @@ void VoxelLayer::clearNonLethal(double wx, double wy, double w_size_x, double w_
   }
 }
 
+void VoxelLayer::clearCells(int x0, int y0, int xn, int yn, int* touched_x0, int* touched_y0, int* touched_xn,
+                            int* touched_yn)
+{
+  ObstacleLayer::clearCells(x0, y0, xn, yn, touched_x0, touched_y0, touched_xn, touched_yn);
+  if (xn <= x0)
+    return;
+
+  //columns of a row are contiguous, so reset each row's span to unknown in one go
+  uint32_t unknown_col = ~((uint32_t)0) >> 16;
+  uint32_t* voxel_map = voxel_grid_.getData();
+  for (int j = y0; j < yn; j++)
+  {
+    std::fill(voxel_map + j * size_x_ + x0, voxel_map + j * size_x_ + xn, unknown_col);
+  }
+}
+
 void VoxelLayer::raytraceFreespace(const Observation& clearing_observation, double* min_x, double* min_y,
                                            double* max_x, double* max_y)
 {
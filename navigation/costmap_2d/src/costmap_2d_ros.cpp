@@ -64,7 +64,8 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
     layered_costmap_(NULL), name_(name), tf_(tf), stop_updates_(false), initialized_(true), stopped_(false), robot_stopped_(
         false), map_update_thread_(NULL), last_publish_(0), plugin_loader_("costmap_2d",
                                                                            "costmap_2d::Layer"), publisher_(
-        NULL)
+        NULL), shared_costmap_(NULL), restore_snapshot_(false), snapshot_requested_(false), snapshot_saved_(
+        false), map_updated_(false)
 {
   ros::NodeHandle private_nh("~/" + name);
   ros::NodeHandle g_nh;
@@ -139,6 +140,40 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
 
   publisher_ = new Costmap2DPublisher(private_nh, layered_costmap_->getCostmap(), global_frame_, "costmap");
 
+  // other costmaps on this host can map our grid with a SharedLayer instead of building it themselves
+  private_nh.param("shared_costmap_segment", shared_costmap_segment_, std::string(""));
+  if (!shared_costmap_segment_.empty())
+  {
+    ROS_INFO("Sharing the costmap as segment %s", SharedCostmap::segmentName(shared_costmap_segment_).c_str());
+    shared_costmap_ = new SharedCostmap();
+  }
+
+  // a saved costmap lets a restart skip waiting for the first full update
+  private_nh.param("snapshot_file", snapshot_file_, std::string(""));
+  private_nh.param("save_snapshot_on_shutdown", save_snapshot_on_shutdown_, true);
+  if (!snapshot_file_.empty() && rolling_window)
+  {
+    ROS_WARN("Snapshots are not supported for rolling window costmaps, ignoring snapshot_file");
+    snapshot_file_.clear();
+  }
+  restore_snapshot_ = !snapshot_file_.empty();
+  save_snapshot_srv_ = private_nh.advertiseService("save_snapshot", &Costmap2DROS::saveSnapshotService, this);
+
+  // how long observations take from the sensor into the costmap and to the local planner
+  bool trace_latency;
+  std::string latency_trace_file;
+  private_nh.param("trace_latency", trace_latency, false);
+  private_nh.param("latency_trace_file", latency_trace_file, std::string(""));
+  LatencyTracer* tracer = layered_costmap_->getLatencyTracer();
+  if (!latency_trace_file.empty())
+    tracer->openTrace(latency_trace_file);
+  if (trace_latency || tracer->isEnabled())
+  {
+    tracer->setEnabled(true);
+    latency_pub_ = private_nh.advertise<costmap_2d::ObservationLatency>("observation_latency", 10);
+    latency_timer_ = private_nh.createTimer(ros::Duration(1.0), &Costmap2DROS::latencyCB, this);
+  }
+
   // create a thread to handle updating the map
   stop_updates_ = false;
   initialized_ = true;
@@ -167,8 +202,12 @@ Costmap2DROS::~Costmap2DROS()
     map_update_thread_->join();
     delete map_update_thread_;
   }
+  if (save_snapshot_on_shutdown_ && !snapshot_file_.empty() && map_updated_)
+    saveSnapshot(snapshot_file_);
   if (publisher_ != NULL)
     delete publisher_;
+  if (shared_costmap_ != NULL)
+    delete shared_costmap_;
 
   delete layered_costmap_;
 }
@@ -533,6 +572,13 @@ void Costmap2DROS::movementCB(const ros::TimerEvent &event)
 
 void Costmap2DROS::mapUpdateLoop(double frequency)
 {
+  // only the first loop after startup restores, later ones run after a reconfigure
+  if (restore_snapshot_)
+  {
+    restore_snapshot_ = false;
+    map_updated_ = restoreSnapshot(snapshot_file_);
+  }
+
   // the user might not want to run the loop every cycle
   if (frequency == 0.0)
     return;
@@ -551,9 +597,17 @@ void Costmap2DROS::mapUpdateLoop(double frequency)
       if (getRobotPose (pose))
       {
         layered_costmap_->updateMap(pose.getOrigin().x(), pose.getOrigin().y(), tf::getYaw(pose.getRotation()));
+        if (shared_costmap_ != NULL)
+          exportSharedCostmap();
         initialized_ = true;
+        map_updated_ = true;
       }
     }
+    if (snapshot_requested_)
+    {
+      snapshot_saved_ = saveSnapshot(snapshot_file_);
+      snapshot_requested_ = false;
+    }
     gettimeofday(&end, NULL);
     start_t = start.tv_sec + double(start.tv_usec) / 1e6;
     end_t = end.tv_sec + double(end.tv_usec) / 1e6;
@@ -580,6 +634,152 @@ void Costmap2DROS::mapUpdateLoop(double frequency)
   }
 }
 
+void Costmap2DROS::exportSharedCostmap(bool whole_map)
+{
+  if (layered_costmap_->getPlugins()->empty())
+    return;
+
+  if (!whole_map)
+  {
+    // nothing changed in this cycle
+    double minx, miny, maxx, maxy;
+    layered_costmap_->getUpdatedBounds(minx, miny, maxx, maxy);
+    if (minx > maxx || miny > maxy)
+      return;
+  }
+
+  Costmap2D* costmap = layered_costmap_->getCostmap();
+  if (!shared_costmap_->isOpen()
+      && !shared_costmap_->create(shared_costmap_segment_,
+                                  (uint64_t)costmap->getSizeInCellsX() * costmap->getSizeInCellsY()))
+    return;
+
+  unsigned int x0 = 0, xn = costmap->getSizeInCellsX(), y0 = 0, yn = costmap->getSizeInCellsY();
+  if (!whole_map)
+    layered_costmap_->getBounds(&x0, &xn, &y0, &yn);
+  shared_costmap_->publish(*costmap, global_frame_, x0, xn, y0, yn);
+}
+
+bool Costmap2DROS::saveSnapshot(const std::string& path)
+{
+  CostmapSnapshot snapshot;
+  Costmap2D* master = layered_costmap_->getCostmap();
+  {
+    boost::shared_lock < boost::shared_mutex > lock(*(master->getLock()));
+    snapshot.addGrid("master", *master);
+  }
+
+  std::vector < boost::shared_ptr<Layer> > *plugins = layered_costmap_->getPlugins();
+  for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins->begin(); plugin != plugins->end();
+      ++plugin)
+  {
+    (*plugin)->saveSnapshot(snapshot);
+  }
+
+  if (!snapshot.save(path, global_frame_))
+    return false;
+  ROS_INFO("Saved the costmap to %s", path.c_str());
+  return true;
+}
+
+bool Costmap2DROS::restoreSnapshot(const std::string& path)
+{
+  ros::WallTime start = ros::WallTime::now();
+  CostmapSnapshot snapshot;
+  if (!snapshot.load(path))
+    return false;
+
+  Costmap2D* master = layered_costmap_->getCostmap();
+  if (snapshot.getFrameID() != global_frame_ || !snapshot.matchesGrid("master", *master))
+  {
+    ROS_INFO("The costmap snapshot %s was taken of another map, building the costmap", path.c_str());
+    return false;
+  }
+
+  std::vector < boost::shared_ptr<Layer> > *plugins = layered_costmap_->getPlugins();
+  for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins->begin(); plugin != plugins->end();
+      ++plugin)
+  {
+    if (!(*plugin)->matchesSnapshot(snapshot))
+    {
+      ROS_INFO("Layer %s changed since the costmap snapshot %s was taken, building the costmap",
+               (*plugin)->getName().c_str(), path.c_str());
+      return false;
+    }
+  }
+
+  {
+    boost::unique_lock < boost::shared_mutex > lock(*(master->getLock()));
+    snapshot.getGrid("master", *master);
+  }
+  for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins->begin(); plugin != plugins->end();
+      ++plugin)
+  {
+    (*plugin)->restoreSnapshot(snapshot);
+  }
+
+  // publish the restored map in full
+  publisher_->updateBounds(0, master->getSizeInCellsX(), 0, master->getSizeInCellsY());
+  if (shared_costmap_ != NULL)
+    exportSharedCostmap(true);
+  ROS_INFO("Restored the costmap from %s in %.3f seconds", path.c_str(), (ros::WallTime::now() - start).toSec());
+  return true;
+}
+
+void Costmap2DROS::latencyCB(const ros::TimerEvent &event)
+{
+  std::vector<std::string> sources;
+  std::vector<std::vector<LatencyHistogram> > histograms;
+  layered_costmap_->getLatencyTracer()->getHistograms(sources, histograms);
+
+  for (unsigned int i = 0; i < sources.size(); ++i)
+  {
+    costmap_2d::ObservationLatency msg;
+    msg.header.stamp = ros::Time::now();
+    msg.header.frame_id = global_frame_;
+    msg.source = sources[i];
+    for (unsigned int bin = 0; bin < LatencyHistogram::BINS; ++bin)
+      msg.bin_edges.push_back(LatencyHistogram::binEdge(bin));
+
+    for (unsigned int stage = 0; stage < LatencyTracer::NUM_STAGES; ++stage)
+    {
+      const LatencyHistogram& histogram = histograms[i][stage];
+      msg.stages.push_back(LatencyTracer::getStageName(stage));
+      for (unsigned int bin = 0; bin < LatencyHistogram::BINS; ++bin)
+        msg.counts.push_back(histogram.getCount(bin));
+      msg.median.push_back(histogram.quantile(0.5));
+      msg.p95.push_back(histogram.quantile(0.95));
+      msg.max.push_back(histogram.getMax());
+    }
+    latency_pub_.publish(msg);
+  }
+}
+
+bool Costmap2DROS::saveSnapshotService(std_srvs::Empty::Request& req, std_srvs::Empty::Response& resp)
+{
+  if (snapshot_file_.empty())
+  {
+    ROS_ERROR("Cannot save a costmap snapshot, the snapshot_file parameter is not set");
+    return false;
+  }
+
+  // the layers may only be read between two updates, so the update thread saves
+  snapshot_saved_ = false;
+  snapshot_requested_ = true;
+  ros::Rate r(100.0);
+  ros::WallTime timeout = ros::WallTime::now() + ros::WallDuration(10.0);
+  while (ros::ok() && snapshot_requested_ && ros::WallTime::now() < timeout)
+    r.sleep();
+
+  if (snapshot_requested_)
+  {
+    snapshot_requested_ = false;
+    ROS_ERROR("The map update loop did not save the costmap snapshot, is it running?");
+    return false;
+  }
+  return snapshot_saved_;
+}
+
 void Costmap2DROS::start()
 {
   std::vector < boost::shared_ptr<Layer> > *plugins = layered_costmap_->getPlugins();
@@ -0,0 +1,271 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/costmap_snapshot.h>
+#include <ros/console.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace costmap_2d
+{
+const uint32_t CostmapSnapshot::MAGIC;
+const uint32_t CostmapSnapshot::FORMAT_VERSION;
+const size_t CostmapSnapshot::ALIGNMENT;
+
+static size_t align(size_t offset)
+{
+  return (offset + CostmapSnapshot::ALIGNMENT - 1) / CostmapSnapshot::ALIGNMENT * CostmapSnapshot::ALIGNMENT;
+}
+
+CostmapSnapshot::CostmapSnapshot() :
+    mapped_(NULL), mapped_size_(0)
+{
+}
+
+CostmapSnapshot::~CostmapSnapshot()
+{
+  close();
+}
+
+uint64_t CostmapSnapshot::hash(const void* data, size_t size, uint64_t seed)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t h = seed;
+  for (size_t i = 0; i < size; ++i)
+  {
+    h ^= bytes[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+void CostmapSnapshot::addSection(const std::string& name, const void* data, size_t size)
+{
+  Section* section = NULL;
+  for (unsigned int i = 0; i < sections_.size(); ++i)
+  {
+    if (sections_[i].name == name)
+      section = &sections_[i];
+  }
+  if (section == NULL)
+  {
+    sections_.push_back(Section());
+    section = &sections_.back();
+    section->name = name;
+  }
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  section->data.assign(bytes, bytes + size);
+}
+
+void CostmapSnapshot::addGrid(const std::string& name, const Costmap2D& grid)
+{
+  GridHeader header;
+  memset(&header, 0, sizeof(header));
+  header.size_x = grid.getSizeInCellsX();
+  header.size_y = grid.getSizeInCellsY();
+  header.resolution = grid.getResolution();
+  header.origin_x = grid.getOriginX();
+  header.origin_y = grid.getOriginY();
+
+  size_t cells = (size_t)header.size_x * header.size_y;
+  std::vector<unsigned char> data(sizeof(header) + cells);
+  memcpy(&data[0], &header, sizeof(header));
+  if (cells > 0)
+    memcpy(&data[sizeof(header)], grid.getCharMap(), cells);
+  addSection(name, &data[0], data.size());
+}
+
+bool CostmapSnapshot::save(const std::string& path, const std::string& frame_id) const
+{
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = MAGIC;
+  header.format_version = FORMAT_VERSION;
+  header.num_sections = sections_.size();
+  strncpy(header.frame_id, frame_id.c_str(), sizeof(header.frame_id) - 1);
+
+  std::vector<SectionEntry> entries(sections_.size());
+  size_t offset = align(sizeof(FileHeader) + entries.size() * sizeof(SectionEntry));
+  for (unsigned int i = 0; i < sections_.size(); ++i)
+  {
+    memset(&entries[i], 0, sizeof(SectionEntry));
+    strncpy(entries[i].name, sections_[i].name.c_str(), sizeof(entries[i].name) - 1);
+    entries[i].offset = offset;
+    entries[i].size = sections_[i].data.size();
+    offset = align(offset + entries[i].size);
+  }
+
+  std::string tmp_path = path + ".tmp";
+  FILE* file = fopen(tmp_path.c_str(), "wb");
+  if (file == NULL)
+  {
+    ROS_ERROR("Could not write costmap snapshot %s: %s", tmp_path.c_str(), strerror(errno));
+    return false;
+  }
+
+  static const char padding[ALIGNMENT] = {0};
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  if (!entries.empty())
+    ok = ok && fwrite(&entries[0], sizeof(SectionEntry), entries.size(), file) == entries.size();
+  size_t written = sizeof(FileHeader) + entries.size() * sizeof(SectionEntry);
+  for (unsigned int i = 0; i < sections_.size() && ok; ++i)
+  {
+    ok = fwrite(padding, 1, entries[i].offset - written, file) == entries[i].offset - written;
+    if (entries[i].size > 0)
+      ok = ok && fwrite(&sections_[i].data[0], 1, entries[i].size, file) == entries[i].size;
+    written = entries[i].offset + entries[i].size;
+  }
+  ok = (fclose(file) == 0) && ok;
+
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0)
+  {
+    ROS_ERROR("Could not write costmap snapshot %s: %s", path.c_str(), strerror(errno));
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool CostmapSnapshot::load(const std::string& path)
+{
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  void* addr = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(FileHeader))
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+  {
+    ROS_WARN("Could not map costmap snapshot %s", path.c_str());
+    return false;
+  }
+
+  mapped_ = static_cast<const unsigned char*>(addr);
+  mapped_size_ = st.st_size;
+
+  const FileHeader* header = reinterpret_cast<const FileHeader*>(mapped_);
+  if (header->magic != MAGIC || header->format_version != FORMAT_VERSION)
+  {
+    ROS_WARN("%s is not a costmap snapshot of format version %u", path.c_str(), FORMAT_VERSION);
+    close();
+    return false;
+  }
+
+  uint64_t table_end = sizeof(FileHeader) + (uint64_t)header->num_sections * sizeof(SectionEntry);
+  bool valid = table_end <= mapped_size_ && memchr(header->frame_id, 0, sizeof(header->frame_id)) != NULL;
+  const SectionEntry* entries = reinterpret_cast<const SectionEntry*>(mapped_ + sizeof(FileHeader));
+  for (uint32_t i = 0; valid && i < header->num_sections; ++i)
+  {
+    valid = entries[i].offset >= table_end && entries[i].offset <= mapped_size_
+        && entries[i].size <= mapped_size_ - entries[i].offset
+        && memchr(entries[i].name, 0, sizeof(entries[i].name)) != NULL;
+  }
+  if (!valid)
+  {
+    ROS_WARN("Costmap snapshot %s is truncated or corrupt", path.c_str());
+    close();
+    return false;
+  }
+  return true;
+}
+
+void CostmapSnapshot::close()
+{
+  if (mapped_ == NULL)
+    return;
+  munmap(const_cast<unsigned char*>(mapped_), mapped_size_);
+  mapped_ = NULL;
+  mapped_size_ = 0;
+}
+
+std::string CostmapSnapshot::getFrameID() const
+{
+  if (mapped_ == NULL)
+    return std::string();
+  return reinterpret_cast<const FileHeader*>(mapped_)->frame_id;
+}
+
+const unsigned char* CostmapSnapshot::getSection(const std::string& name, size_t& size) const
+{
+  if (mapped_ == NULL)
+    return NULL;
+
+  const FileHeader* header = reinterpret_cast<const FileHeader*>(mapped_);
+  const SectionEntry* entries = reinterpret_cast<const SectionEntry*>(mapped_ + sizeof(FileHeader));
+  for (uint32_t i = 0; i < header->num_sections; ++i)
+  {
+    if (name == entries[i].name)
+    {
+      size = entries[i].size;
+      return mapped_ + entries[i].offset;
+    }
+  }
+  return NULL;
+}
+
+bool CostmapSnapshot::matchesGrid(const std::string& name, const Costmap2D& grid) const
+{
+  size_t size;
+  const unsigned char* data = getSection(name, size);
+  if (data == NULL || size < sizeof(GridHeader))
+    return false;
+
+  GridHeader header;
+  memcpy(&header, data, sizeof(header));
+  return header.size_x == grid.getSizeInCellsX() && header.size_y == grid.getSizeInCellsY()
+      && header.resolution == grid.getResolution() && header.origin_x == grid.getOriginX()
+      && header.origin_y == grid.getOriginY() && size == sizeof(header) + (size_t)header.size_x * header.size_y;
+}
+
+bool CostmapSnapshot::getGrid(const std::string& name, Costmap2D& grid) const
+{
+  if (!matchesGrid(name, grid))
+    return false;
+
+  size_t size;
+  const unsigned char* data = getSection(name, size);
+  memcpy(grid.getCharMap(), data + sizeof(GridHeader), size - sizeof(GridHeader));
+  return true;
+}
+
+}  // namespace costmap_2d
@@ -0,0 +1,264 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/latency_tracer.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+namespace costmap_2d
+{
+const unsigned int LatencyHistogram::BINS;
+
+static const double FIRST_BIN_EDGE = 0.0005;
+
+// traces waiting for a read, a costmap nobody reports reads for only keeps the latest
+static const size_t MAX_UNREAD = 1000;
+
+LatencyHistogram::LatencyHistogram() :
+    total_(0), max_(0.0)
+{
+  std::fill(counts_, counts_ + BINS, 0);
+}
+
+double LatencyHistogram::binEdge(unsigned int bin)
+{
+  return FIRST_BIN_EDGE * pow(2.0, bin / 2.0);
+}
+
+void LatencyHistogram::add(double seconds)
+{
+  unsigned int bin = 0;
+  if (seconds > FIRST_BIN_EDGE)
+    bin = (unsigned int)std::min(BINS - 1.0, ceil(2.0 * log2(seconds / FIRST_BIN_EDGE) - 1e-9));
+  counts_[bin]++;
+  total_++;
+  max_ = std::max(max_, seconds);
+}
+
+double LatencyHistogram::quantile(double fraction) const
+{
+  if (total_ == 0)
+    return 0.0;
+
+  uint64_t target = (uint64_t)ceil(fraction * total_), count = 0;
+  for (unsigned int bin = 0; bin < BINS - 1; ++bin)
+  {
+    count += counts_[bin];
+    if (count >= target)
+      return std::min(binEdge(bin), max_);
+  }
+  return max_;
+}
+
+const char* LatencyTracer::getStageName(unsigned int stage)
+{
+  static const char* names[NUM_STAGES] = {"buffered", "used", "mapped", "read"};
+  return stage < NUM_STAGES ? names[stage] : "";
+}
+
+LatencyTracer::LatencyTracer() :
+    enabled_(false), trace_file_(NULL), trace_empty_(true)
+{
+}
+
+LatencyTracer::~LatencyTracer()
+{
+  closeTrace();
+}
+
+void LatencyTracer::setEnabled(bool enabled)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  enabled_ = enabled;
+  used_.clear();
+  mapped_.clear();
+}
+
+bool LatencyTracer::openTrace(const std::string& path)
+{
+  closeTrace();
+  boost::mutex::scoped_lock lock(mutex_);
+  trace_file_ = fopen(path.c_str(), "w");
+  if (trace_file_ == NULL)
+  {
+    ROS_ERROR("Could not open the latency trace %s: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  // the JSON array format, chrome://tracing also loads it without the closing bracket
+  fprintf(trace_file_, "[\n");
+  trace_empty_ = true;
+  for (unsigned int i = 0; i < sources_.size(); ++i)
+  {
+    fprintf(trace_file_, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            trace_empty_ ? "" : ",\n", i, sources_[i].c_str());
+    trace_empty_ = false;
+  }
+  enabled_ = true;
+  return true;
+}
+
+void LatencyTracer::closeTrace()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if (trace_file_ == NULL)
+    return;
+  fprintf(trace_file_, "\n]\n");
+  fclose(trace_file_);
+  trace_file_ = NULL;
+}
+
+unsigned int LatencyTracer::getSource(const std::string& source)
+{
+  unsigned int index = std::find(sources_.begin(), sources_.end(), source) - sources_.begin();
+  if (index == sources_.size())
+  {
+    sources_.push_back(source);
+    histograms_.push_back(std::vector<LatencyHistogram>(NUM_STAGES));
+    mapped_until_.push_back(ros::Time());
+    if (trace_file_ != NULL)
+    {
+      fprintf(trace_file_, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+              trace_empty_ ? "" : ",\n", index, source.c_str());
+      trace_empty_ = false;
+    }
+  }
+  return index;
+}
+
+void LatencyTracer::writeSpan(unsigned int source, const char* name, const ros::Time& start, const ros::Time& end)
+{
+  double duration = std::max(0.0, (end - start).toSec());
+  fprintf(trace_file_, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.1f,\"dur\":%.1f,\"pid\":1,\"tid\":%u}",
+          trace_empty_ ? "" : ",\n", name, sources_[source].c_str(), start.toSec() * 1e6, duration * 1e6, source);
+  trace_empty_ = false;
+}
+
+void LatencyTracer::observationUsed(const std::string& source, const ros::Time& stamp, const ros::Time& buffered)
+{
+  if (!enabled_)
+    return;
+
+  boost::mutex::scoped_lock lock(mutex_);
+  unsigned int index = getSource(source);
+
+  // buffers that keep observations around hand them to every update
+  if (stamp <= mapped_until_[index])
+    return;
+  for (unsigned int i = 0; i < used_.size(); ++i)
+  {
+    if (used_[i].source == index && used_[i].stamp == stamp)
+      return;
+  }
+
+  Trace trace;
+  trace.source = index;
+  trace.stamp = stamp;
+  trace.buffered = buffered;
+  trace.used = ros::Time::now();
+  used_.push_back(trace);
+}
+
+void LatencyTracer::mapUpdated()
+{
+  if (!enabled_)
+    return;
+
+  boost::mutex::scoped_lock lock(mutex_);
+  if (used_.empty())
+    return;
+
+  ros::Time now = ros::Time::now();
+  for (unsigned int i = 0; i < used_.size(); ++i)
+  {
+    Trace& trace = used_[i];
+    trace.mapped = now;
+    std::vector<LatencyHistogram>& histograms = histograms_[trace.source];
+    histograms[BUFFERED].add((trace.buffered - trace.stamp).toSec());
+    histograms[USED].add((trace.used - trace.stamp).toSec());
+    histograms[MAPPED].add((now - trace.stamp).toSec());
+    mapped_until_[trace.source] = std::max(mapped_until_[trace.source], trace.stamp);
+
+    if (trace_file_ != NULL)
+    {
+      writeSpan(trace.source, "sensor to buffer", trace.stamp, trace.buffered);
+      writeSpan(trace.source, "buffer to update", trace.buffered, trace.used);
+      writeSpan(trace.source, "map update", trace.used, trace.mapped);
+    }
+  }
+
+  mapped_.insert(mapped_.end(), used_.begin(), used_.end());
+  used_.clear();
+  if (mapped_.size() > MAX_UNREAD)
+    mapped_.erase(mapped_.begin(), mapped_.end() - MAX_UNREAD);
+
+  if (trace_file_ != NULL)
+    fflush(trace_file_);
+}
+
+void LatencyTracer::costmapRead()
+{
+  if (!enabled_)
+    return;
+
+  boost::mutex::scoped_lock lock(mutex_);
+  if (mapped_.empty())
+    return;
+
+  ros::Time now = ros::Time::now();
+  for (unsigned int i = 0; i < mapped_.size(); ++i)
+  {
+    const Trace& trace = mapped_[i];
+    histograms_[trace.source][READ].add((now - trace.stamp).toSec());
+    if (trace_file_ != NULL)
+      writeSpan(trace.source, "map to read", trace.mapped, now);
+  }
+  mapped_.clear();
+
+  if (trace_file_ != NULL)
+    fflush(trace_file_);
+}
+
+void LatencyTracer::getHistograms(std::vector<std::string>& sources,
+                                  std::vector<std::vector<LatencyHistogram> >& histograms) const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  sources = sources_;
+  histograms = histograms_;
+}
+
+}  // namespace costmap_2d
@@ -110,7 +110,10 @@ void LayeredCostmap::updateMap(double origin_x, double origin_y, double origin_y
   ROS_DEBUG("Updating area x: [%d, %d] y: [%d, %d]", x0, xn, y0, yn);
 
   if (xn < x0 || yn < y0)
+  {
+    latency_tracer_.mapUpdated();
     return;
+  }
 
   costmap_.resetMap(x0, y0, xn, yn);
 
@@ -121,6 +124,7 @@ void LayeredCostmap::updateMap(double origin_x, double origin_y, double origin_y
     {
       (*plugin)->updateCosts(costmap_, x0, y0, xn, yn);
     }
+    latency_tracer_.mapUpdated();
   }
 
   bx0_ = x0;
@@ -0,0 +1,85 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/nearest_cell.h>
+#include <cmath>
+
+namespace costmap_2d
+{
+bool findNearestCell(const Costmap2D& costmap, const float* values, float limit, double wx, double wy,
+                     double radius, unsigned int& mx, unsigned int& my)
+{
+  int nx = costmap.getSizeInCellsX(), ny = costmap.getSizeInCellsY();
+  double resolution = costmap.getResolution();
+
+  // worldToMapNoBounds truncates towards zero, points below the origin need the cell under them
+  int x = (int)floor((wx - costmap.getOriginX()) / resolution);
+  int y = (int)floor((wy - costmap.getOriginY()) / resolution);
+  int rings = (int)(radius / resolution);
+  int best_d = -1;
+
+  // no cell of ring k is closer than k cells
+  for (int k = 0; k <= rings; ++k)
+  {
+    if (best_d >= 0 && k * k > best_d)
+      break;
+
+    for (int dy = -k; dy <= k; ++dy)
+    {
+      int cy = y + dy;
+      if (cy < 0 || cy >= ny)
+        continue;
+
+      // full rows at the top and bottom of the ring, end points otherwise
+      int step = (dy == -k || dy == k) ? 1 : 2 * k;
+      for (int dx = -k; dx <= k; dx += step)
+      {
+        int cx = x + dx;
+        if (cx < 0 || cx >= nx || values[cy * nx + cx] >= limit)
+          continue;
+        int d = dx * dx + dy * dy;
+        if (best_d < 0 || d < best_d)
+        {
+          best_d = d;
+          mx = cx;
+          my = cy;
+        }
+      }
+    }
+  }
+
+  return best_d >= 0;
+}
+
+}  // namespace costmap_2d
@@ -39,6 +39,8 @@
 #include <pcl/point_types.h>
 #include <pcl_ros/transforms.h>
 #include <pcl/ros/conversions.h>
+#include <cmath>
+#include <cstring>
 
 using namespace std;
 using namespace tf;
@@ -52,7 +54,7 @@ ObservationBuffer::ObservationBuffer(string topic_name, double observation_keep_
     tf_(tf), observation_keep_time_(observation_keep_time), expected_update_rate_(expected_update_rate), last_updated_(
         ros::Time::now()), global_frame_(global_frame), sensor_frame_(sensor_frame), topic_name_(topic_name), min_obstacle_height_(
         min_obstacle_height), max_obstacle_height_(max_obstacle_height), obstacle_range_(obstacle_range), raytrace_range_(
-        raytrace_range), tf_tolerance_(tf_tolerance)
+        raytrace_range), tf_tolerance_(tf_tolerance), beam_angle_min_(0.0), beam_angle_increment_(0.0)
 {
 }
 
@@ -127,7 +129,7 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
   Stamped < tf::Vector3 > global_origin;
 
   //create a new observation on the list to be populated
-  observation_list_.push_front(Observation());
+  newObservation();
 
   //check whether the origin frame has been set explicitly or whether we should get it from the cloud
   string origin_frame = sensor_frame_ == "" ? cloud.header.frame_id : sensor_frame_;
@@ -144,6 +146,7 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
     //make sure to pass on the raytrace/obstacle range of the observation buffer to the observations the costmap will see
     observation_list_.front().raytrace_range_ = raytrace_range_;
     observation_list_.front().obstacle_range_ = obstacle_range_;
+    observation_list_.front().topic_ = topic_name_;
 
     pcl::PointCloud < pcl::PointXYZ > global_frame_cloud;
 
@@ -183,12 +186,236 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
 
   //if the update was successful, we want to update the last updated time
   last_updated_ = ros::Time::now();
+  observation_list_.front().buffered_time_ = last_updated_;
 
   //we'll also remove any stale observations from the list
   purgeStaleObservations();
 
 }
 
+Observation& ObservationBuffer::newObservation()
+{
+  if (spare_observations_.empty())
+  {
+    observation_list_.push_front(Observation());
+    return observation_list_.front();
+  }
+
+  observation_list_.splice(observation_list_.begin(), spare_observations_, spare_observations_.begin());
+  Observation& obs = observation_list_.front();
+  obs.cloud_.points.clear();
+  obs.cell_cloud_.points.clear();
+  obs.cell_resolution_ = 0.0;
+  return obs;
+}
+
+bool ObservationBuffer::beginObservation(const std::string& frame_id, const ros::Time& stamp,
+                                         tf::StampedTransform& transform, Observation& observation)
+{
+  lock();
+  string global_frame = global_frame_;
+  unlock();
+
+  //check whether the origin frame has been set explicitly or whether we should get it from the message
+  string origin_frame = sensor_frame_ == "" ? frame_id : sensor_frame_;
+
+  try
+  {
+    tf_.lookupTransform(global_frame, frame_id, stamp, transform);
+
+    tf::Vector3 origin = transform.getOrigin();
+    if (origin_frame != frame_id)
+    {
+      Stamped < tf::Vector3 > local_origin(tf::Vector3(0, 0, 0), stamp, origin_frame), global_origin;
+      tf_.transformPoint(global_frame, local_origin, global_origin);
+      origin = global_origin;
+    }
+    observation.origin_.x = origin.getX();
+    observation.origin_.y = origin.getY();
+    observation.origin_.z = origin.getZ();
+  }
+  catch (TransformException& ex)
+  {
+    ROS_ERROR("TF Exception that should never happen for sensor frame: %s, cloud frame: %s, %s", sensor_frame_.c_str(),
+              frame_id.c_str(), ex.what());
+    return false;
+  }
+
+  observation.raytrace_range_ = raytrace_range_;
+  observation.obstacle_range_ = obstacle_range_;
+  observation.topic_ = topic_name_;
+  observation.cloud_.header.stamp = stamp;
+  observation.cloud_.header.frame_id = global_frame;
+  observation.cloud_.points.clear();
+  observation.cell_cloud_.points.clear();
+  observation.cell_resolution_ = 0.0;
+  return true;
+}
+
+/**
+ * @brief The rows of a transform, applied to points in one pass with the height filter
+ */
+struct PointTransform
+{
+  PointTransform(const tf::Transform& transform)
+  {
+    const tf::Matrix3x3& basis = transform.getBasis();
+    const tf::Vector3& origin = transform.getOrigin();
+    for (int i = 0; i < 3; ++i)
+    {
+      r[i][0] = basis[i].x();
+      r[i][1] = basis[i].y();
+      r[i][2] = basis[i].z();
+      r[i][3] = origin[i];
+    }
+  }
+
+  double r[3][4];
+};
+
+bool ObservationBuffer::transformScan(const sensor_msgs::LaserScan& scan, Observation& observation)
+{
+  tf::StampedTransform transform;
+  if (!beginObservation(scan.header.frame_id, scan.header.stamp, transform, observation))
+    return false;
+
+  unsigned int n = scan.ranges.size();
+  if (beam_cos_.size() != n || beam_angle_min_ != scan.angle_min || beam_angle_increment_ != scan.angle_increment)
+  {
+    beam_cos_.resize(n);
+    beam_sin_.resize(n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+      double angle = scan.angle_min + i * (double)scan.angle_increment;
+      beam_cos_[i] = cos(angle);
+      beam_sin_[i] = sin(angle);
+    }
+    beam_angle_min_ = scan.angle_min;
+    beam_angle_increment_ = scan.angle_increment;
+  }
+
+  const PointTransform t(transform);
+  std::vector<pcl::PointXYZ>& points = observation.cloud_.points;
+  points.resize(n);
+  unsigned int point_count = 0;
+
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    //the same beams the laser projector keeps, which also drops NaN and inf
+    double range = scan.ranges[i];
+    if (!(range < scan.range_max && range >= scan.range_min))
+      continue;
+
+    double x = range * beam_cos_[i], y = range * beam_sin_[i];
+    double z = t.r[2][0] * x + t.r[2][1] * y + t.r[2][3];
+    if (!(z <= max_obstacle_height_ && z >= min_obstacle_height_))
+      continue;
+
+    pcl::PointXYZ& p = points[point_count++];
+    p.x = t.r[0][0] * x + t.r[0][1] * y + t.r[0][3];
+    p.y = t.r[1][0] * x + t.r[1][1] * y + t.r[1][3];
+    p.z = z;
+  }
+
+  points.resize(point_count);
+  observation.cloud_.width = point_count;
+  observation.cloud_.height = 1;
+  return true;
+}
+
+bool ObservationBuffer::transformCloud(const sensor_msgs::PointCloud2& cloud, Observation& observation)
+{
+  //find float coordinates we can read in place, anything else goes through pcl first
+  int offsets[3] = {-1, -1, -1};
+  for (unsigned int i = 0; i < cloud.fields.size(); ++i)
+  {
+    const sensor_msgs::PointField& field = cloud.fields[i];
+    int axis = field.name == "x" ? 0 : field.name == "y" ? 1 : field.name == "z" ? 2 : -1;
+    if (axis >= 0 && field.datatype == sensor_msgs::PointField::FLOAT32 && field.count == 1
+        && field.offset + sizeof(float) <= cloud.point_step)
+      offsets[axis] = field.offset;
+  }
+
+  const unsigned char* data = cloud.data.empty() ? NULL : &cloud.data[0];
+  unsigned int width = cloud.width, height = cloud.height, point_step = cloud.point_step, row_step = cloud.row_step;
+  pcl::PointCloud < pcl::PointXYZ > pcl_cloud;
+  if (offsets[0] < 0 || offsets[1] < 0 || offsets[2] < 0 || cloud.is_bigendian
+      || (uint64_t)row_step * height > cloud.data.size() || (uint64_t)point_step * width > row_step)
+  {
+    try
+    {
+      pcl::fromROSMsg(cloud, pcl_cloud);
+    }
+    catch (pcl::PCLException& ex)
+    {
+      ROS_ERROR("Failed to convert a message to a pcl type, dropping observation: %s", ex.what());
+      return false;
+    }
+    data = pcl_cloud.points.empty() ? NULL : reinterpret_cast<const unsigned char*>(&pcl_cloud.points[0]);
+    width = pcl_cloud.points.size();
+    height = 1;
+    point_step = sizeof(pcl::PointXYZ);
+    row_step = width * point_step;
+    offsets[0] = 0;
+    offsets[1] = sizeof(float);
+    offsets[2] = 2 * sizeof(float);
+  }
+
+  tf::StampedTransform transform;
+  if (!beginObservation(cloud.header.frame_id, cloud.header.stamp, transform, observation))
+    return false;
+
+  const PointTransform t(transform);
+  std::vector<pcl::PointXYZ>& points = observation.cloud_.points;
+  points.resize((size_t)width * height);
+  unsigned int point_count = 0;
+
+  for (unsigned int row = 0; data != NULL && row < height; ++row)
+  {
+    const unsigned char* point = data + (size_t)row * row_step;
+    for (unsigned int col = 0; col < width; ++col, point += point_step)
+    {
+      float coords[3];
+      memcpy(&coords[0], point + offsets[0], sizeof(float));
+      memcpy(&coords[1], point + offsets[1], sizeof(float));
+      memcpy(&coords[2], point + offsets[2], sizeof(float));
+      double x = coords[0], y = coords[1], z = coords[2];
+
+      double gz = t.r[2][0] * x + t.r[2][1] * y + t.r[2][2] * z + t.r[2][3];
+      if (!(gz <= max_obstacle_height_ && gz >= min_obstacle_height_))
+        continue;
+
+      pcl::PointXYZ& p = points[point_count++];
+      p.x = t.r[0][0] * x + t.r[0][1] * y + t.r[0][2] * z + t.r[0][3];
+      p.y = t.r[1][0] * x + t.r[1][1] * y + t.r[1][2] * z + t.r[1][3];
+      p.z = gz;
+    }
+  }
+
+  points.resize(point_count);
+  observation.cloud_.width = point_count;
+  observation.cloud_.height = 1;
+  return true;
+}
+
+void ObservationBuffer::bufferObservation(Observation& observation)
+{
+  newObservation().swap(observation);
+
+  last_updated_ = ros::Time::now();
+  observation_list_.front().buffered_time_ = last_updated_;
+  purgeStaleObservations();
+}
+
+void ObservationBuffer::traceObservations(LatencyTracer& tracer)
+{
+  list<Observation>::iterator obs_it;
+  for (obs_it = observation_list_.begin(); obs_it != observation_list_.end(); ++obs_it)
+  {
+    tracer.observationUsed(topic_name_, obs_it->cloud_.header.stamp, obs_it->buffered_time_);
+  }
+}
+
 //returns a copy of the observations
 void ObservationBuffer::getObservations(vector<Observation>& observations)
 {
@@ -212,7 +439,7 @@ void ObservationBuffer::purgeStaleObservations()
     //if we're keeping observations for no time... then we'll only keep one observation
     if (observation_keep_time_ == ros::Duration(0.0))
     {
-      observation_list_.erase(++obs_it, observation_list_.end());
+      recycleObservations(++obs_it);
       return;
     }
 
@@ -224,13 +451,26 @@ void ObservationBuffer::purgeStaleObservations()
       ros::Duration time_diff = last_updated_ - obs.cloud_.header.stamp;
       if ((last_updated_ - obs.cloud_.header.stamp) > observation_keep_time_)
       {
-        observation_list_.erase(obs_it, observation_list_.end());
+        recycleObservations(obs_it);
         return;
       }
     }
   }
 }
 
+void ObservationBuffer::recycleObservations(std::list<Observation>::iterator first)
+{
+  if (first == observation_list_.end())
+    return;
+
+  //keep the storage of one observation around for the next one to be buffered
+  std::list<Observation>::iterator rest = first;
+  ++rest;
+  spare_observations_.clear();
+  spare_observations_.splice(spare_observations_.begin(), observation_list_, first);
+  observation_list_.erase(rest, observation_list_.end());
+}
+
 bool ObservationBuffer::isCurrent() const
 {
   if (expected_update_rate_ == ros::Duration(0.0))
@@ -0,0 +1,315 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/observation_worker.h>
+#include <sensor_msgs/point_cloud_conversion.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cmath>
+
+namespace costmap_2d
+{
+static const unsigned int NO_POINT = 0xffffffff;
+
+ObservationWorker::ObservationWorker(unsigned int queue_size) :
+    enqueue_pos_(0), dequeue_pos_(0), pending_(false), shutdown_(false), thread_(NULL), grid_origin_x_(0.0),
+    grid_origin_y_(0.0), grid_resolution_(0.0)
+{
+  size_t size = 2;
+  while (size < queue_size)
+    size *= 2;
+  slots_.resize(size);
+  for (size_t i = 0; i < size; ++i)
+    slots_[i].sequence = i;
+  mask_ = size - 1;
+}
+
+ObservationWorker::~ObservationWorker()
+{
+  stop();
+}
+
+void ObservationWorker::addBuffer(const boost::shared_ptr<ObservationBuffer>& buffer)
+{
+  buffers_.push_back(buffer);
+}
+
+void ObservationWorker::start()
+{
+  if (thread_ == NULL)
+    thread_ = new boost::thread(boost::bind(&ObservationWorker::run, this));
+}
+
+void ObservationWorker::stop()
+{
+  if (thread_ == NULL)
+    return;
+
+  {
+    boost::lock_guard<boost::mutex> lock(wake_mutex_);
+    shutdown_ = true;
+  }
+  wake_.notify_one();
+  thread_->join();
+  delete thread_;
+  thread_ = NULL;
+}
+
+void ObservationWorker::setGrid(double origin_x, double origin_y, double resolution)
+{
+  boost::lock_guard<boost::mutex> lock(grid_mutex_);
+  grid_origin_x_ = origin_x;
+  grid_origin_y_ = origin_y;
+  grid_resolution_ = resolution;
+}
+
+bool ObservationWorker::enqueue(const boost::shared_ptr<ObservationBuffer>& buffer,
+                                const sensor_msgs::LaserScanConstPtr& message)
+{
+  Message m;
+  m.scan = message;
+  return push(buffer, m);
+}
+
+bool ObservationWorker::enqueue(const boost::shared_ptr<ObservationBuffer>& buffer,
+                                const sensor_msgs::PointCloudConstPtr& message)
+{
+  Message m;
+  m.cloud = message;
+  return push(buffer, m);
+}
+
+bool ObservationWorker::enqueue(const boost::shared_ptr<ObservationBuffer>& buffer,
+                                const sensor_msgs::PointCloud2ConstPtr& message)
+{
+  Message m;
+  m.cloud2 = message;
+  return push(buffer, m);
+}
+
+bool ObservationWorker::push(const boost::shared_ptr<ObservationBuffer>& buffer, Message& message)
+{
+  message.buffer = std::find(buffers_.begin(), buffers_.end(), buffer) - buffers_.begin();
+  if (message.buffer == buffers_.size())
+  {
+    ROS_ERROR("A message was queued for an observation buffer the worker does not know, dropping it");
+    return false;
+  }
+
+  //claim a slot by moving the enqueue position past it, a slot is free when its sequence equals the position
+  size_t pos = enqueue_pos_;
+  Slot* slot;
+  while (true)
+  {
+    slot = &slots_[pos & mask_];
+    size_t sequence = slot->sequence;
+    __sync_synchronize();
+    long diff = (long)sequence - (long)pos;
+    if (diff == 0)
+    {
+      if (__sync_bool_compare_and_swap(&enqueue_pos_, pos, pos + 1))
+        break;
+    }
+    else if (diff < 0)
+    {
+      ROS_WARN_THROTTLE(1.0, "Sensor processing is falling behind, dropping a message");
+      return false;
+    }
+    pos = enqueue_pos_;
+  }
+
+  slot->message = message;
+  __sync_synchronize();
+  slot->sequence = pos + 1;
+
+  {
+    boost::lock_guard<boost::mutex> lock(wake_mutex_);
+    pending_ = true;
+  }
+  wake_.notify_one();
+  return true;
+}
+
+bool ObservationWorker::pop(Message& message)
+{
+  //there is only one consumer, so the dequeue position needs no compare and swap
+  size_t pos = dequeue_pos_;
+  Slot& slot = slots_[pos & mask_];
+  size_t sequence = slot.sequence;
+  __sync_synchronize();
+  if (sequence != pos + 1)
+    return false;
+
+  message = slot.message;
+  slot.message = Message();
+  dequeue_pos_ = pos + 1;
+  __sync_synchronize();
+  slot.sequence = pos + mask_ + 1;
+  return true;
+}
+
+void ObservationWorker::run()
+{
+  std::vector<size_t> latest;
+  while (true)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock(wake_mutex_);
+      while (!pending_ && !shutdown_)
+        wake_.wait(lock);
+      if (shutdown_)
+        return;
+      pending_ = false;
+    }
+
+    batch_.clear();
+    Message message;
+    while (pop(message))
+      batch_.push_back(message);
+
+    //a buffer that only keeps its latest observation has no use for older messages
+    latest.assign(buffers_.size(), 0);
+    for (size_t i = 0; i < batch_.size(); ++i)
+      latest[batch_[i].buffer] = i;
+
+    for (size_t i = 0; i < batch_.size(); ++i)
+    {
+      if (latest[batch_[i].buffer] != i && buffers_[batch_[i].buffer]->keepsLatestOnly())
+        continue;
+      process(batch_[i]);
+    }
+    batch_.clear();
+  }
+}
+
+void ObservationWorker::process(const Message& message)
+{
+  ObservationBuffer& buffer = *buffers_[message.buffer];
+
+  bool transformed;
+  if (message.scan)
+    transformed = buffer.transformScan(*message.scan, observation_);
+  else if (message.cloud2)
+    transformed = buffer.transformCloud(*message.cloud2, observation_);
+  else
+  {
+    sensor_msgs::PointCloud2 cloud2;
+    if (!sensor_msgs::convertPointCloudToPointCloud2(*message.cloud, cloud2))
+    {
+      ROS_ERROR("Failed to convert a PointCloud to a PointCloud2, dropping message");
+      return;
+    }
+    transformed = buffer.transformCloud(cloud2, observation_);
+  }
+  if (!transformed)
+    return;
+
+  double origin_x, origin_y, resolution;
+  {
+    boost::lock_guard<boost::mutex> lock(grid_mutex_);
+    origin_x = grid_origin_x_;
+    origin_y = grid_origin_y_;
+    resolution = grid_resolution_;
+  }
+  if (resolution > 0.0)
+    binObservation(observation_, origin_x, origin_y, resolution);
+
+  buffer.lock();
+  buffer.bufferObservation(observation_);
+  buffer.unlock();
+}
+
+void ObservationWorker::binObservation(Observation& observation, double origin_x, double origin_y,
+                                       double resolution)
+{
+  const std::vector<pcl::PointXYZ>& points = observation.cloud_.points;
+  std::vector<pcl::PointXYZ>& cells = observation.cell_cloud_.points;
+  cells.clear();
+
+  //open addressing on the cell coordinates, at most half full
+  size_t table_size = 16;
+  while (table_size < 2 * points.size())
+    table_size *= 2;
+  if (cell_keys_.size() < table_size)
+  {
+    cell_keys_.resize(table_size);
+    cell_points_.resize(table_size);
+  }
+  std::fill(cell_points_.begin(), cell_points_.begin() + table_size, NO_POINT);
+  size_t mask = table_size - 1;
+
+  const geometry_msgs::Point& origin = observation.origin_;
+  double sq_obstacle_range = observation.obstacle_range_ * observation.obstacle_range_;
+
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    const pcl::PointXYZ& p = points[i];
+    double px = p.x, py = p.y, pz = p.z;
+
+    //the same range check the obstacle layer makes when marking
+    double sq_dist = (px - origin.x) * (px - origin.x) + (py - origin.y) * (py - origin.y)
+        + (pz - origin.z) * (pz - origin.z);
+    if (sq_dist >= sq_obstacle_range)
+      continue;
+
+    int32_t cx = (int32_t)floor((px - origin_x) / resolution);
+    int32_t cy = (int32_t)floor((py - origin_y) / resolution);
+    uint64_t key = ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+
+    size_t h = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while (cell_points_[h] != NO_POINT && cell_keys_[h] != key)
+      h = (h + 1) & mask;
+
+    if (cell_points_[h] == NO_POINT)
+    {
+      cell_keys_[h] = key;
+      cell_points_[h] = cells.size();
+      cells.push_back(p);
+    }
+    else if (p.z < cells[cell_points_[h]].z)
+    {
+      //a cell is marked if any of its points is low enough, so the lowest one decides
+      cells[cell_points_[h]] = p;
+    }
+  }
+
+  observation.cell_cloud_.header = observation.cloud_.header;
+  observation.cell_cloud_.width = cells.size();
+  observation.cell_cloud_.height = 1;
+  observation.cell_origin_x_ = origin_x;
+  observation.cell_origin_y_ = origin_y;
+  observation.cell_resolution_ = resolution;
+}
+
+}  // namespace costmap_2d
@@ -0,0 +1,297 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/shared_costmap.h>
+#include <ros/console.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+namespace costmap_2d
+{
+const uint32_t SharedCostmap::MAGIC;
+const uint32_t SharedCostmap::LAYOUT;
+const size_t SharedCostmap::DATA_OFFSET;
+
+SharedCostmap::SharedCostmap() :
+    header_(NULL), data_(NULL), mapped_size_(0), capacity_(0), owner_(false)
+{
+}
+
+SharedCostmap::~SharedCostmap()
+{
+  close();
+}
+
+std::string SharedCostmap::segmentName(const std::string& name)
+{
+  // shm_open wants exactly one slash, at the front
+  std::string segment = name;
+  std::replace(segment.begin(), segment.end(), '/', '_');
+  if (!segment.empty() && segment[0] == '_')
+    segment[0] = '/';
+  else
+    segment = "/" + segment;
+  return segment;
+}
+
+void SharedCostmap::markStale(const std::string& segment)
+{
+  int fd = shm_open(segment.c_str(), O_RDWR, 0);
+  if (fd < 0)
+    return;
+  void* addr = mmap(NULL, sizeof(SharedCostmapHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    return;
+  static_cast<SharedCostmapHeader*>(addr)->stale = 1;
+  __sync_synchronize();
+  munmap(addr, sizeof(SharedCostmapHeader));
+}
+
+bool SharedCostmap::create(const std::string& name, uint64_t capacity)
+{
+  close();
+  std::string segment = segmentName(name);
+
+  // clients of a segment we replace have to find the new one
+  markStale(segment);
+  shm_unlink(segment.c_str());
+
+  int fd = shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0)
+  {
+    ROS_ERROR("Could not create shared costmap segment %s: %s", segment.c_str(), strerror(errno));
+    return false;
+  }
+
+  size_t size = DATA_OFFSET + std::max<uint64_t>(capacity, 1);
+  void* addr = MAP_FAILED;
+  if (ftruncate(fd, size) == 0)
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+  {
+    ROS_ERROR("Could not map shared costmap segment %s: %s", segment.c_str(), strerror(errno));
+    shm_unlink(segment.c_str());
+    return false;
+  }
+
+  header_ = static_cast<SharedCostmapHeader*>(addr);
+  data_ = static_cast<unsigned char*>(addr) + DATA_OFFSET;
+  mapped_size_ = size;
+  capacity_ = size - DATA_OFFSET;
+  name_ = segment;
+  owner_ = true;
+
+  header_->layout = LAYOUT;
+  header_->sequence = 0;
+  header_->stale = 0;
+  header_->capacity = capacity_;
+  // the magic goes last, clients refuse the segment until it is there
+  __sync_synchronize();
+  header_->magic = MAGIC;
+  __sync_synchronize();
+  return true;
+}
+
+bool SharedCostmap::open(const std::string& name)
+{
+  std::string segment = segmentName(name);
+  int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  void* addr = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)(DATA_OFFSET + 1))
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    return false;
+
+  const SharedCostmapHeader* header = static_cast<const SharedCostmapHeader*>(addr);
+  __sync_synchronize();
+  if (header->magic != MAGIC || header->layout != LAYOUT || header->capacity > st.st_size - DATA_OFFSET)
+  {
+    munmap(addr, st.st_size);
+    return false;
+  }
+
+  close();
+  header_ = const_cast<SharedCostmapHeader*>(header);
+  data_ = static_cast<unsigned char*>(addr) + DATA_OFFSET;
+  mapped_size_ = st.st_size;
+  capacity_ = header->capacity;
+  name_ = segment;
+  owner_ = false;
+  return true;
+}
+
+void SharedCostmap::close()
+{
+  if (header_ == NULL)
+    return;
+
+  if (owner_)
+  {
+    header_->stale = 1;
+    __sync_synchronize();
+    shm_unlink(name_.c_str());
+  }
+  munmap(header_, mapped_size_);
+  header_ = NULL;
+  data_ = NULL;
+  mapped_size_ = 0;
+  capacity_ = 0;
+  owner_ = false;
+}
+
+bool SharedCostmap::isStale() const
+{
+  if (header_ == NULL)
+    return true;
+  __sync_synchronize();
+  return header_->stale != 0;
+}
+
+uint32_t SharedCostmap::getVersion() const
+{
+  if (header_ == NULL)
+    return 0;
+  uint32_t version = *static_cast<volatile uint32_t*>(&header_->sequence);
+  __sync_synchronize();
+  return version;
+}
+
+bool SharedCostmap::unchanged(uint32_t version) const
+{
+  __sync_synchronize();
+  return (version & 1) == 0 && version == getVersion();
+}
+
+bool SharedCostmap::getInfo(SharedCostmapInfo& info) const
+{
+  if (header_ == NULL)
+    return false;
+
+  // the owner only holds the sequence odd for a copy, so this rarely loops
+  for (int attempt = 0; attempt < 100; ++attempt)
+  {
+    uint32_t version = getVersion();
+    if (version == 0)
+      return false;
+    if (version & 1)
+    {
+      sched_yield();
+      continue;
+    }
+
+    info.version = version;
+    info.size_x = header_->size_x;
+    info.size_y = header_->size_y;
+    info.resolution = header_->resolution;
+    info.origin_x = header_->origin_x;
+    info.origin_y = header_->origin_y;
+    info.frame_id.assign(header_->frame_id, strnlen(header_->frame_id, sizeof(header_->frame_id)));
+
+    if (unchanged(version))
+      return (uint64_t)info.size_x * info.size_y <= capacity_;
+  }
+  return false;
+}
+
+bool SharedCostmap::publish(const Costmap2D& costmap, const std::string& frame_id, unsigned int x0,
+                            unsigned int xn, unsigned int y0, unsigned int yn)
+{
+  if (header_ == NULL || !owner_)
+    return false;
+
+  unsigned int size_x = costmap.getSizeInCellsX(), size_y = costmap.getSizeInCellsY();
+  uint64_t cells = (uint64_t)size_x * size_y;
+  if (cells > capacity_)
+  {
+    ROS_INFO("Growing shared costmap segment %s to %u X %u cells", name_.c_str(), size_x, size_y);
+    std::string name = name_;
+    if (!create(name, cells))
+      return false;
+  }
+
+  std::string frame = frame_id.substr(0, sizeof(header_->frame_id) - 1);
+  bool geometry_changed = header_->sequence == 0 || header_->size_x != size_x || header_->size_y != size_y
+      || header_->resolution != costmap.getResolution() || header_->origin_x != costmap.getOriginX()
+      || header_->origin_y != costmap.getOriginY() || frame != header_->frame_id;
+  if (geometry_changed)
+  {
+    x0 = y0 = 0;
+    xn = size_x;
+    yn = size_y;
+  }
+  xn = std::min(xn, size_x);
+  yn = std::min(yn, size_y);
+  if (xn <= x0 || yn <= y0)
+    return true;
+
+  __sync_fetch_and_add(&header_->sequence, 1);
+  __sync_synchronize();
+
+  if (geometry_changed)
+  {
+    header_->size_x = size_x;
+    header_->size_y = size_y;
+    header_->resolution = costmap.getResolution();
+    header_->origin_x = costmap.getOriginX();
+    header_->origin_y = costmap.getOriginY();
+    memset(header_->frame_id, 0, sizeof(header_->frame_id));
+    memcpy(header_->frame_id, frame.c_str(), frame.size());
+  }
+
+  const unsigned char* master = costmap.getCharMap();
+  for (unsigned int y = y0; y < yn; ++y)
+  {
+    unsigned int index = y * size_x + x0;
+    memcpy(data_ + index, master + index, xn - x0);
+  }
+
+  __sync_synchronize();
+  __sync_fetch_and_add(&header_->sequence, 1);
+  return true;
+}
+
+}  // namespace costmap_2d
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+
+#include "costmap_2d/costmap_snapshot.h"
+
+using namespace costmap_2d;
+
+std::string testFile(const char* name)
+{
+  char buf[128];
+  snprintf(buf, sizeof(buf), "/tmp/costmap_snapshot_test_%s_%d.bin", name, (int)getpid());
+  return buf;
+}
+
+TEST(costmap_snapshot, save_and_load)
+{
+  std::string path = testFile("load");
+  Costmap2D grid(30, 20, 0.05, -1.0, 2.0);
+  for (unsigned int j = 0; j < 20; j++)
+    for (unsigned int i = 0; i < 30; i++)
+      grid.setCost(i, j, (unsigned char)(i * 7 + j));
+  double parameters[2] = {0.55, 10.0};
+
+  {
+    CostmapSnapshot snapshot;
+    snapshot.addGrid("master", grid);
+    snapshot.addSection("layer/parameters", parameters, sizeof(parameters));
+    snapshot.addSection("layer/empty", NULL, 0);
+    ASSERT_TRUE(snapshot.save(path, "/map"));
+  }
+
+  CostmapSnapshot snapshot;
+  ASSERT_TRUE(snapshot.load(path));
+  EXPECT_EQ("/map", snapshot.getFrameID());
+
+  size_t size;
+  const unsigned char* data = snapshot.getSection("layer/parameters", size);
+  ASSERT_TRUE(data != NULL);
+  ASSERT_EQ(sizeof(parameters), size);
+  EXPECT_EQ(0, memcmp(data, parameters, size));
+  EXPECT_EQ(0u, (size_t)data % CostmapSnapshot::ALIGNMENT);
+  ASSERT_TRUE(snapshot.getSection("layer/empty", size) != NULL);
+  EXPECT_EQ(0u, size);
+  EXPECT_TRUE(snapshot.getSection("layer/missing", size) == NULL);
+
+  // grids only restore into the same geometry
+  Costmap2D restored(30, 20, 0.05, -1.0, 2.0);
+  ASSERT_TRUE(snapshot.getGrid("master", restored));
+  EXPECT_EQ(0, memcmp(grid.getCharMap(), restored.getCharMap(), 600));
+  Costmap2D moved(30, 20, 0.05, -1.05, 2.0);
+  EXPECT_FALSE(snapshot.matchesGrid("master", moved));
+  Costmap2D larger(31, 20, 0.05, -1.0, 2.0);
+  EXPECT_FALSE(snapshot.getGrid("master", larger));
+  EXPECT_FALSE(snapshot.matchesGrid("layer/parameters", restored));
+
+  unlink(path.c_str());
+}
+
+TEST(costmap_snapshot, rejects_bad_files)
+{
+  std::string path = testFile("bad");
+  CostmapSnapshot snapshot;
+  EXPECT_FALSE(snapshot.load(path));
+
+  // another format version
+  {
+    CostmapSnapshot writer;
+    writer.addSection("a", "abc", 3);
+    ASSERT_TRUE(writer.save(path, "/map"));
+  }
+  FILE* file = fopen(path.c_str(), "r+b");
+  ASSERT_TRUE(file != NULL);
+  uint32_t version = CostmapSnapshot::FORMAT_VERSION + 1;
+  fseek(file, 4, SEEK_SET);
+  fwrite(&version, sizeof(version), 1, file);
+  fclose(file);
+  EXPECT_FALSE(snapshot.load(path));
+
+  // truncated
+  {
+    CostmapSnapshot writer;
+    Costmap2D grid(100, 100, 0.1, 0.0, 0.0);
+    writer.addGrid("master", grid);
+    ASSERT_TRUE(writer.save(path, "/map"));
+  }
+  ASSERT_TRUE(snapshot.load(path));
+  snapshot.close();
+  ASSERT_EQ(0, truncate(path.c_str(), 1000));
+  EXPECT_FALSE(snapshot.load(path));
+  EXPECT_FALSE(snapshot.isLoaded());
+
+  unlink(path.c_str());
+}
+
+TEST(costmap_snapshot, hash)
+{
+  const char* a = "costmap";
+  EXPECT_EQ(CostmapSnapshot::hash(a, 7), CostmapSnapshot::hash(a + 4, 3, CostmapSnapshot::hash(a, 4)));
+  EXPECT_NE(CostmapSnapshot::hash(a, 7), CostmapSnapshot::hash(a, 6));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "costmap_2d/latency_tracer.h"
+
+using namespace costmap_2d;
+
+TEST(latency_tracer, histogram_bins)
+{
+  LatencyHistogram histogram;
+  EXPECT_EQ(0.0, histogram.quantile(0.5));
+
+  histogram.add(0.0001);
+  histogram.add(0.0005);
+  histogram.add(0.0006);
+  histogram.add(0.05);
+  histogram.add(100.0);
+  EXPECT_EQ(2u, histogram.getCount(0));
+  EXPECT_EQ(1u, histogram.getCount(1));
+  EXPECT_EQ(1u, histogram.getCount(LatencyHistogram::BINS - 1));
+  EXPECT_EQ(5u, histogram.getTotal());
+  EXPECT_DOUBLE_EQ(100.0, histogram.getMax());
+
+  // every latency is at most the edge of its bin, and more than the edge below
+  for (unsigned int bin = 0; bin < LatencyHistogram::BINS; bin++)
+    EXPECT_LT(LatencyHistogram::binEdge(bin), LatencyHistogram::binEdge(bin + 1));
+  EXPECT_LE(0.05, histogram.quantile(0.8));
+  EXPECT_GT(0.05 * 1.42, histogram.quantile(0.8));
+  EXPECT_DOUBLE_EQ(100.0, histogram.quantile(1.0));
+}
+
+TEST(latency_tracer, stages)
+{
+  LatencyTracer tracer;
+  ros::Time stamp = ros::Time::now() - ros::Duration(0.05);
+
+  // nothing is kept while disabled
+  tracer.observationUsed("scan", stamp, stamp);
+  tracer.mapUpdated();
+  std::vector<std::string> sources;
+  std::vector<std::vector<LatencyHistogram> > histograms;
+  tracer.getHistograms(sources, histograms);
+  EXPECT_TRUE(sources.empty());
+
+  tracer.setEnabled(true);
+  tracer.observationUsed("scan", stamp, stamp + ros::Duration(0.01));
+  tracer.observationUsed("scan", stamp, stamp + ros::Duration(0.01));
+  tracer.observationUsed("cloud", stamp, stamp);
+  tracer.mapUpdated();
+
+  // a buffer with persistence hands the same observation to the next update
+  tracer.observationUsed("scan", stamp, stamp + ros::Duration(0.01));
+  tracer.mapUpdated();
+  tracer.costmapRead();
+  tracer.costmapRead();
+
+  tracer.getHistograms(sources, histograms);
+  ASSERT_EQ(2u, sources.size());
+  EXPECT_EQ("scan", sources[0]);
+  for (unsigned int stage = 0; stage < LatencyTracer::NUM_STAGES; stage++)
+  {
+    EXPECT_EQ(1u, histograms[0][stage].getTotal()) << LatencyTracer::getStageName(stage);
+    EXPECT_EQ(1u, histograms[1][stage].getTotal()) << LatencyTracer::getStageName(stage);
+  }
+  EXPECT_NEAR(0.01, histograms[0][LatencyTracer::BUFFERED].getMax(), 1e-6);
+  EXPECT_LE(0.05, histograms[0][LatencyTracer::USED].getMax());
+  EXPECT_LE(histograms[0][LatencyTracer::USED].getMax(), histograms[0][LatencyTracer::MAPPED].getMax());
+  EXPECT_LE(histograms[0][LatencyTracer::MAPPED].getMax(), histograms[0][LatencyTracer::READ].getMax());
+}
+
+TEST(latency_tracer, chrome_trace)
+{
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/latency_tracer_test_%d.json", (int)getpid());
+
+  {
+    LatencyTracer tracer;
+    ASSERT_TRUE(tracer.openTrace(path));
+    EXPECT_TRUE(tracer.isEnabled());
+    ros::Time stamp = ros::Time::now();
+    tracer.observationUsed("scan", stamp, stamp);
+    tracer.mapUpdated();
+    tracer.costmapRead();
+  }
+
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  std::string trace = contents.str();
+  unlink(path);
+
+  EXPECT_EQ(0u, trace.find("[\n{\"name\":\"thread_name\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"sensor to buffer\",\"cat\":\"scan\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"map to read\""));
+  EXPECT_EQ(trace.size() - 3, trace.rfind("\n]\n"));
+}
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
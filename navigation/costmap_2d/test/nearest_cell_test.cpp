@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "costmap_2d/nearest_cell.h"
+
+using namespace costmap_2d;
+
+static const float HIGH = 1.0e10;
+
+TEST(nearest_cell, ring_order)
+{
+  Costmap2D costmap(20, 20, 1.0, 0.0, 0.0);
+  std::vector<float> values(20 * 20, HIGH);
+  // around (10,5): (13,8) is in ring 3 at d^2 = 18, (14,5) is in ring 4 but closer at d^2 = 16
+  values[8 * 20 + 13] = 100.0;
+  values[5 * 20 + 14] = 100.0;
+  values[0 * 20 + 0] = 100.0;
+
+  unsigned int mx, my;
+  EXPECT_FALSE(findNearestCell(costmap, &values[0], HIGH, 10.5, 5.5, 2.0, mx, my));
+  ASSERT_TRUE(findNearestCell(costmap, &values[0], HIGH, 10.5, 5.5, 3.0, mx, my));
+  EXPECT_EQ(13, mx);
+  EXPECT_EQ(8, my);
+  ASSERT_TRUE(findNearestCell(costmap, &values[0], HIGH, 10.5, 5.5, 5.0, mx, my));
+  EXPECT_EQ(14, mx);
+  EXPECT_EQ(5, my);
+
+  // the cell of the point itself has a value
+  ASSERT_TRUE(findNearestCell(costmap, &values[0], HIGH, 13.9, 8.1, 5.0, mx, my));
+  EXPECT_EQ(13, mx);
+  EXPECT_EQ(8, my);
+}
+
+TEST(nearest_cell, off_map_negative)
+{
+  Costmap2D costmap(20, 20, 0.5, -2.0, 1.0);
+  std::vector<float> values(20 * 20, HIGH);
+  values[3 * 20 + 1] = 100.0;
+
+  // (-2.4, 2.7) is in cell (-1, 3), two cells from (1, 3), truncation would put it in (0, 3)
+  unsigned int mx, my;
+  EXPECT_FALSE(findNearestCell(costmap, &values[0], HIGH, -2.4, 2.7, 0.5, mx, my));
+  ASSERT_TRUE(findNearestCell(costmap, &values[0], HIGH, -2.4, 2.7, 1.0, mx, my));
+  EXPECT_EQ(1, mx);
+  EXPECT_EQ(3, my);
+
+  double wx, wy;
+  costmap.mapToWorld(mx, my, wx, wy);
+  EXPECT_DOUBLE_EQ(-1.25, wx);
+  EXPECT_DOUBLE_EQ(2.75, wy);
+
+  // below the origin in both directions
+  values[0] = 100.0;
+  ASSERT_TRUE(findNearestCell(costmap, &values[0], HIGH, -2.1, 0.9, 0.5, mx, my));
+  EXPECT_EQ(0, mx);
+  EXPECT_EQ(0, my);
+  EXPECT_FALSE(findNearestCell(costmap, &values[0], HIGH, -3.6, -0.6, 1.0, mx, my));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -35,6 +35,7 @@
 #include <costmap_2d/costmap_2d.h>
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/observation_buffer.h>
+#include <costmap_2d/observation_worker.h>
 #include <testing_helper.h>
 #include <set>
 #include <gtest/gtest.h>
@@ -140,6 +141,161 @@ TEST(costmap, testZThreshold){
   ASSERT_EQ(countValues(*costmap, costmap_2d::LETHAL_OBSTACLE), 1);
 }
 
+/**
+ * Observations binned by the ingestion worker mark the same cells as the full cloud
+ */
+TEST(costmap, testBinnedObservations){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, true), binned_layers("frame", false, true);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  binned_layers.resizeMap(10, 10, 1, 0, 0);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  ObstacleLayer* binned_olayer = addObstacleLayer(binned_layers, tf);
+
+  // Several points per cell, only the low ones mark and only within range of the origin
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  for (int i = 0; i < 40; i++)
+    cloud.points.push_back(pcl::PointXYZ(0.25 * i, 0.1 * i, (i % 3) * 1.5));
+
+  geometry_msgs::Point origin;
+  Observation obs(origin, cloud, 7.0, 0.0);
+  olayer->addStaticObservation(obs, true, false);
+
+  ObservationWorker worker;
+  worker.binObservation(obs, 0.0, 0.0, 1.0);
+  ASSERT_LT(obs.cell_cloud_.points.size(), cloud.points.size());
+  binned_olayer->addStaticObservation(obs, true, false);
+
+  layers.updateMap(0,0,0);
+  binned_layers.updateMap(0,0,0);
+
+  Costmap2D* costmap = layers.getCostmap();
+  Costmap2D* binned_costmap = binned_layers.getCostmap();
+  ASSERT_GT(countValues(*costmap, costmap_2d::LETHAL_OBSTACLE), 0);
+  for (unsigned int j = 0; j < costmap->getSizeInCellsY(); j++)
+    for (unsigned int i = 0; i < costmap->getSizeInCellsX(); i++)
+      ASSERT_EQ(costmap->getCost(i, j), binned_costmap->getCost(i, j));
+}
+
+
+/**
+ * Cells binned on a grid that does not line up with the layer's cells are not used
+ */
+TEST(costmap, testBinnedOnOtherGrid){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, true), moved_layers("frame", false, true);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  moved_layers.resizeMap(10, 10, 1, 0, 0);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  ObstacleLayer* moved_olayer = addObstacleLayer(moved_layers, tf);
+
+  // Both points are low enough to mark, but they share a cell of a grid shifted by half a cell
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  cloud.points.push_back(pcl::PointXYZ(0.8, 0.8, 0.05));
+  cloud.points.push_back(pcl::PointXYZ(1.2, 1.2, 0.1));
+
+  geometry_msgs::Point origin;
+  Observation obs(origin, cloud, 7.0, 0.0);
+  ObservationWorker worker;
+  worker.binObservation(obs, 0.5, 0.5, 1.0);
+  ASSERT_EQ(obs.cell_cloud_.points.size(), (unsigned int)1);
+  olayer->addStaticObservation(obs, true, false);
+
+  // A grid moved by whole cells, as the rolling window moves, has the same cells.
+  // Without the full cloud only the cells can mark.
+  Observation moved_obs(origin, cloud, 7.0, 0.0);
+  worker.binObservation(moved_obs, -3.0, 2.0, 1.0);
+  ASSERT_EQ(moved_obs.cell_cloud_.points.size(), (unsigned int)2);
+  moved_obs.cloud_.points.clear();
+  moved_olayer->addStaticObservation(moved_obs, true, false);
+
+  layers.updateMap(0,0,0);
+  moved_layers.updateMap(0,0,0);
+
+  ASSERT_EQ(countValues(*layers.getCostmap(), costmap_2d::LETHAL_OBSTACLE), 2);
+  ASSERT_EQ(layers.getCostmap()->getCost(1, 1), costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(countValues(*moved_layers.getCostmap(), costmap_2d::LETHAL_OBSTACLE), 2);
+}
+
+sensor_msgs::PointCloudConstPtr makeCloud(const std::string& frame, const ros::Time& stamp, double x)
+{
+  sensor_msgs::PointCloudPtr cloud(new sensor_msgs::PointCloud);
+  cloud->header.frame_id = frame;
+  cloud->header.stamp = stamp;
+  geometry_msgs::Point32 point;
+  point.x = x;
+  point.y = 1.0;
+  point.z = 0.5;
+  cloud->points.push_back(point);
+  return cloud;
+}
+
+// Waits for the worker to fill a buffer with at least count observations
+bool waitForObservations(ObservationBuffer& buffer, unsigned int count, std::vector<Observation>& observations)
+{
+  ros::WallTime end = ros::WallTime::now() + ros::WallDuration(5.0);
+  while (ros::WallTime::now() < end)
+  {
+    observations.clear();
+    buffer.lock();
+    buffer.getObservations(observations);
+    buffer.unlock();
+    if (observations.size() >= count)
+      return true;
+    ros::WallDuration(0.01).sleep();
+  }
+  return false;
+}
+
+/**
+ * Messages go through the queue of the worker thread into their buffers
+ */
+TEST(costmap, testObservationWorker){
+  tf::TransformListener tf;
+  boost::shared_ptr<ObservationBuffer> kept(
+      new ObservationBuffer("kept", 60.0, 0.0, -1.0, 2.0, 10.0, 10.0, tf, "frame", "", 0.1));
+  boost::shared_ptr<ObservationBuffer> latest(
+      new ObservationBuffer("latest", 0.0, 0.0, -1.0, 2.0, 10.0, 10.0, tf, "frame", "", 0.1));
+  boost::shared_ptr<ObservationBuffer> unknown(
+      new ObservationBuffer("unknown", 0.0, 0.0, -1.0, 2.0, 10.0, 10.0, tf, "frame", "", 0.1));
+  ObservationWorker worker(4);
+  worker.addBuffer(kept);
+  worker.addBuffer(latest);
+  ros::Time stamp = ros::Time::now();
+
+  ASSERT_FALSE(worker.enqueue(unknown, makeCloud("frame", stamp, 0.0)));
+
+  // Until the thread runs, the messages wait in the queue, which holds four of them
+  ASSERT_TRUE(worker.enqueue(latest, makeCloud("frame", stamp, 1.0)));
+  ASSERT_TRUE(worker.enqueue(latest, makeCloud("frame", stamp, 2.0)));
+  ASSERT_TRUE(worker.enqueue(kept, makeCloud("frame", stamp, 3.0)));
+  // Only the last message for a buffer that keeps its latest observation is processed,
+  // this one cannot be transformed, so the buffer stays empty unless an older one got through
+  ASSERT_TRUE(worker.enqueue(latest, makeCloud("nowhere", stamp, 4.0)));
+  ASSERT_FALSE(worker.enqueue(kept, makeCloud("frame", stamp, 5.0)));
+
+  // The queue is drained in order, the older messages for the latest buffer would have come before the kept one
+  worker.start();
+  std::vector<Observation> observations;
+  ASSERT_TRUE(waitForObservations(*kept, 1, observations));
+  ASSERT_EQ(observations.size(), (unsigned int)1);
+  ASSERT_FLOAT_EQ(observations[0].cloud_.points[0].x, 3.0);
+  observations.clear();
+  latest->lock();
+  latest->getObservations(observations);
+  latest->unlock();
+  ASSERT_EQ(observations.size(), (unsigned int)0);
+
+  // The idle thread wakes up for new messages, and the queue takes messages again
+  ASSERT_TRUE(worker.enqueue(kept, makeCloud("frame", stamp + ros::Duration(0.1), 6.0)));
+  ASSERT_TRUE(worker.enqueue(latest, makeCloud("frame", stamp + ros::Duration(0.1), 7.0)));
+  ASSERT_TRUE(waitForObservations(*kept, 2, observations));
+  ASSERT_FLOAT_EQ(observations[0].cloud_.points[0].x, 6.0);
+  ASSERT_EQ(observations[0].topic_, "kept");
+  ASSERT_TRUE(waitForObservations(*latest, 1, observations));
+  ASSERT_FLOAT_EQ(observations[0].cloud_.points[0].x, 7.0);
+}
+
 
 /**
  * Verify that dynamic obstacles are added
@@ -187,6 +343,50 @@ TEST(costmap, testMultipleAdditions){
 
 }
 
+/**
+ * Verify that clearing a region resets only the cells that changed and reports their bounds
+ */
+TEST(costmap, testClearRegion){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, true);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+
+  olayer->setCost(1, 1, LETHAL_OBSTACLE);
+  olayer->setCost(5, 5, LETHAL_OBSTACLE);
+  olayer->setCost(7, 2, LETHAL_OBSTACLE);
+
+  // Keep the cells between 4 and 6 in both directions and clear everything else
+  ASSERT_TRUE(olayer->clearRegion(4.5, 4.5, 6.5, 6.5, true));
+  ASSERT_EQ(olayer->getCost(1, 1), costmap_2d::NO_INFORMATION);
+  ASSERT_EQ(olayer->getCost(7, 2), costmap_2d::NO_INFORMATION);
+  ASSERT_EQ(olayer->getCost(5, 5), costmap_2d::LETHAL_OBSTACLE);
+
+  // The next update only covers the two cells that were cleared
+  double minx, miny, maxx, maxy;
+  layers.updateMap(0,0,0);
+  layers.getUpdatedBounds(minx, miny, maxx, maxy);
+  ASSERT_DOUBLE_EQ(minx, 1.0);
+  ASSERT_DOUBLE_EQ(miny, 1.0);
+  ASSERT_DOUBLE_EQ(maxx, 8.0);
+  ASSERT_DOUBLE_EQ(maxy, 3.0);
+
+  // Now clear inside the window
+  ASSERT_TRUE(olayer->clearRegion(4.5, 4.5, 6.5, 6.5, false));
+  ASSERT_EQ(olayer->getCost(5, 5), costmap_2d::NO_INFORMATION);
+  layers.updateMap(0,0,0);
+  layers.getUpdatedBounds(minx, miny, maxx, maxy);
+  ASSERT_DOUBLE_EQ(minx, 5.0);
+  ASSERT_DOUBLE_EQ(miny, 5.0);
+  ASSERT_DOUBLE_EQ(maxx, 6.0);
+  ASSERT_DOUBLE_EQ(maxy, 6.0);
+
+  // Clearing cells that are already unknown doesn't ask for an update
+  ASSERT_TRUE(olayer->clearRegion(0.0, 0.0, 10.0, 10.0, false));
+  layers.updateMap(0,0,0);
+  layers.getUpdatedBounds(minx, miny, maxx, maxy);
+  ASSERT_GT(minx, maxx);
+}
 
 int main(int argc, char** argv){
   ros::init(argc, argv, "obstacle_tests");
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+
+#include "costmap_2d/shared_costmap.h"
+
+using namespace costmap_2d;
+
+std::string testSegment(const char* name)
+{
+  char buf[64];
+  snprintf(buf, sizeof(buf), "shared_costmap_test_%s_%d", name, (int)getpid());
+  return buf;
+}
+
+void fill(Costmap2D& costmap, unsigned char offset)
+{
+  for (unsigned int j = 0; j < costmap.getSizeInCellsY(); j++)
+    for (unsigned int i = 0; i < costmap.getSizeInCellsX(); i++)
+      costmap.setCost(i, j, (unsigned char)(i + 10 * j + offset));
+}
+
+TEST(shared_costmap, segment_name)
+{
+  EXPECT_EQ("/foo", SharedCostmap::segmentName("foo"));
+  EXPECT_EQ("/foo", SharedCostmap::segmentName("/foo"));
+  EXPECT_EQ("/robot_global_costmap", SharedCostmap::segmentName("robot/global_costmap"));
+}
+
+TEST(shared_costmap, publish_and_read)
+{
+  std::string name = testSegment("read");
+  Costmap2D costmap(10, 8, 0.05, 1.0, -2.0);
+  fill(costmap, 0);
+
+  SharedCostmap owner, client;
+  ASSERT_TRUE(owner.create(name, 80));
+  ASSERT_TRUE(client.open(name));
+  EXPECT_FALSE(client.isStale());
+
+  // nothing published yet
+  SharedCostmapInfo info;
+  EXPECT_EQ(0u, client.getVersion());
+  EXPECT_FALSE(client.getInfo(info));
+
+  // a new geometry is published in whole, whatever the bounds
+  ASSERT_TRUE(owner.publish(costmap, "/map", 2, 3, 2, 3));
+  ASSERT_TRUE(client.getInfo(info));
+  EXPECT_EQ(10u, info.size_x);
+  EXPECT_EQ(8u, info.size_y);
+  EXPECT_DOUBLE_EQ(0.05, info.resolution);
+  EXPECT_DOUBLE_EQ(1.0, info.origin_x);
+  EXPECT_DOUBLE_EQ(-2.0, info.origin_y);
+  EXPECT_EQ("/map", info.frame_id);
+  EXPECT_EQ(0, memcmp(costmap.getCharMap(), client.getData(), 80));
+  uint32_t version = client.getVersion();
+  EXPECT_TRUE(client.unchanged(version));
+
+  // later publishes only copy the given window
+  fill(costmap, 100);
+  ASSERT_TRUE(owner.publish(costmap, "/map", 2, 4, 1, 3));
+  EXPECT_FALSE(client.unchanged(version));
+  ASSERT_TRUE(client.getInfo(info));
+  EXPECT_GT(info.version, version);
+  for (unsigned int j = 0; j < 8; j++)
+    for (unsigned int i = 0; i < 10; i++)
+    {
+      bool inside = i >= 2 && i < 4 && j >= 1 && j < 3;
+      EXPECT_EQ((unsigned char)(i + 10 * j + (inside ? 100 : 0)), client.getData()[j * 10 + i]);
+    }
+
+  // an empty window is not a new version
+  version = client.getVersion();
+  ASSERT_TRUE(owner.publish(costmap, "/map", 4, 4, 0, 8));
+  EXPECT_TRUE(client.unchanged(version));
+
+  // clients can not publish
+  EXPECT_FALSE(client.publish(costmap, "/map", 0, 10, 0, 8));
+}
+
+TEST(shared_costmap, grow_and_shutdown)
+{
+  std::string name = testSegment("grow");
+  Costmap2D small(4, 4, 0.1, 0.0, 0.0);
+  fill(small, 0);
+  Costmap2D large(20, 10, 0.1, 0.0, 0.0);
+  fill(large, 50);
+
+  SharedCostmap* owner = new SharedCostmap();
+  SharedCostmap client;
+  ASSERT_TRUE(owner->create(name, 16));
+  ASSERT_TRUE(owner->publish(small, "/map", 0, 4, 0, 4));
+  ASSERT_TRUE(client.open(name));
+
+  // the owner moves to a bigger segment, the client finds it
+  ASSERT_TRUE(owner->publish(large, "/map", 0, 20, 0, 10));
+  EXPECT_TRUE(client.isStale());
+  SharedCostmapInfo info;
+  ASSERT_TRUE(client.getInfo(info));
+  EXPECT_EQ(4u, info.size_x);
+  ASSERT_TRUE(client.open(name));
+  EXPECT_FALSE(client.isStale());
+  ASSERT_TRUE(client.getInfo(info));
+  EXPECT_EQ(20u, info.size_x);
+  EXPECT_EQ(10u, info.size_y);
+  EXPECT_EQ(0, memcmp(large.getCharMap(), client.getData(), 200));
+
+  // after the owner is gone the last version stays readable
+  delete owner;
+  EXPECT_TRUE(client.isStale());
+  EXPECT_FALSE(client.open(name));
+  ASSERT_TRUE(client.getInfo(info));
+  EXPECT_EQ(0, memcmp(large.getCharMap(), client.getData(), 200));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
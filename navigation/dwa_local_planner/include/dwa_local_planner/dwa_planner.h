@@ -54,11 +54,15 @@
 #include <base_local_planner/local_planner_limits.h>
 #include <base_local_planner/local_planner_util.h>
 #include <base_local_planner/simple_trajectory_generator.h>
+#include <base_local_planner/warm_start_trajectory_generator.h>
 
 #include <base_local_planner/oscillation_cost_function.h>
 #include <base_local_planner/map_grid_cost_function.h>
 #include <base_local_planner/obstacle_cost_function.h>
+#include <base_local_planner/obstacle_tracker.h>
+#include <base_local_planner/velocity_obstacle_cost_function.h>
 #include <base_local_planner/simple_scored_sampling_planner.h>
+#include <dwa_local_planner/trajectory_refiner.h>
 
 #include <nav_msgs/Path.h>
 
@@ -119,6 +123,25 @@ namespace dwa_local_planner {
       void updatePlanAndLocalCosts(tf::Stamped<tf::Pose> global_pose,
           const std::vector<geometry_msgs::PoseStamped>& new_plan);
 
+      /**
+       * @brief Optimize the best sample of each cycle as a sequence of commands over the horizon
+       * @param refine Whether to refine at all
+       * @param num_intervals How many commands the horizon is split into
+       * @param max_iterations How many gradient steps to take at most per cycle
+       */
+      void setRefinement(bool refine, int num_intervals, int max_iterations);
+
+      /**
+       * @brief Whether moving obstacles are tracked, in which case updateObstacleTracks should be called every cycle
+       */
+      bool tracksMovingObstacles();
+
+      /**
+       * @brief Feed the marking observations of the local costmap to the moving obstacle tracker
+       * @param observations The observations, in the global frame of the costmap
+       */
+      void updateObstacleTracks(const std::vector<costmap_2d::Observation>& observations);
+
       /**
        * @brief Get the period at which the local planner is expected to run
        * @return The simulation period
@@ -152,6 +175,7 @@ namespace dwa_local_planner {
 
       double sim_period_;///< @brief The number of seconds to use to compute max/min vels for dwa
       base_local_planner::Trajectory result_traj_;
+      bool warm_start_sampling_; ///< @brief Whether to sample around the previous command first
 
       double forward_point_distance_;
 
@@ -166,15 +190,22 @@ namespace dwa_local_planner {
       base_local_planner::MapGridVisualizer map_viz_; ///< @brief The map grid visualizer for outputting the potential field generated by the cost function
 
       // see constructor body for explanations
-      base_local_planner::SimpleTrajectoryGenerator generator_;
+      base_local_planner::WarmStartTrajectoryGenerator generator_;
       base_local_planner::OscillationCostFunction oscillation_costs_;
       base_local_planner::ObstacleCostFunction obstacle_costs_;
+      base_local_planner::ObstacleTracker obstacle_tracker_;
+      base_local_planner::VelocityObstacleCostFunction moving_obstacle_costs_;
+      int moving_obstacle_min_hits_;
       base_local_planner::MapGridCostFunction path_costs_;
       base_local_planner::MapGridCostFunction goal_costs_;
       base_local_planner::MapGridCostFunction goal_front_costs_;
       base_local_planner::MapGridCostFunction alignment_costs_;
 
       base_local_planner::SimpleScoredSamplingPlanner scored_sampling_planner_;
+
+      bool refine_trajectories_;
+      TrajectoryRefiner refiner_;
+      TrajectoryRefiner::ScoringFunction refiner_score_, refiner_obstacle_score_;
   };
 };
 #endif
@@ -120,6 +120,9 @@ namespace dwa_local_planner {
         return initialized_;
       }
 
+    protected:
+      boost::shared_ptr<DWAPlanner> dp_; ///< @brief The trajectory controller
+
     private:
       /**
        * @brief Callback to update the local planner's parameters based on dynamic reconfigure
@@ -137,8 +140,6 @@ namespace dwa_local_planner {
 
       base_local_planner::LocalPlannerUtil planner_util_;
 
-      boost::shared_ptr<DWAPlanner> dp_; ///< @brief The trajectory controller
-
       costmap_2d::Costmap2DROS* costmap_ros_;
 
       dynamic_reconfigure::Server<DWAPlannerConfig> *dsrv_;
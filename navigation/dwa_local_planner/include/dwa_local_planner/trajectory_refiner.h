@@ -0,0 +1,126 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2009, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef DWA_LOCAL_PLANNER_TRAJECTORY_REFINER_H_
+#define DWA_LOCAL_PLANNER_TRAJECTORY_REFINER_H_
+
+#include <vector>
+#include <Eigen/Core>
+#include <boost/function.hpp>
+
+#include <base_local_planner/trajectory.h>
+#include <base_local_planner/local_planner_limits.h>
+
+namespace dwa_local_planner {
+  /**
+   * @class TrajectoryRefiner
+   * @brief Improves a sampled trajectory by optimizing a short sequence of velocity
+   * commands over the simulation horizon, scored by the same critics as the samples.
+   *
+   * The horizon is split into equally long intervals with one command each. Starting
+   * from the constant command of the sample, the commands follow a finite difference
+   * gradient of the trajectory cost, projected onto the velocity limits and onto what
+   * the acceleration limits allow between neighboring intervals. Only the first
+   * command is ever executed, the rest gives the cost a look at how the robot
+   * would continue. A step is only taken if it does not bring the trajectory
+   * closer to obstacles than the sample was.
+   */
+  class TrajectoryRefiner {
+    public:
+      /**
+       * Scores a trajectory, negative for invalid ones
+       */
+      typedef boost::function<double (base_local_planner::Trajectory&)> ScoringFunction;
+
+      TrajectoryRefiner();
+
+      /**
+       * @param num_intervals how many commands the horizon is split into
+       * @param max_iterations how many gradient steps to take at most
+       */
+      void setParameters(int num_intervals, int max_iterations);
+
+      /**
+       * @param sim_time length of the horizon
+       * @param sim_granularity distance between trajectory points
+       * @param angular_sim_granularity angle between trajectory points
+       * @param sim_period time until the next command, bounds the change of the first command
+       */
+      void setSimulation(double sim_time, double sim_granularity, double angular_sim_granularity, double sim_period);
+
+      /**
+       * @param pos current robot position
+       * @param vel current robot velocity
+       * @param limits current velocity and acceleration limits
+       * @param score the critics
+       * @param obstacle_score the obstacle critic alone, the refined trajectory never scores worse on it than the sample
+       * @param traj the best sample on input with its cost, the refined trajectory on output if one was better
+       * @return true if traj was replaced by a better trajectory
+       */
+      bool refine(const Eigen::Vector3f& pos,
+          const Eigen::Vector3f& vel,
+          base_local_planner::LocalPlannerLimits& limits,
+          const ScoringFunction& score,
+          const ScoringFunction& obstacle_score,
+          base_local_planner::Trajectory& traj);
+
+      /**
+       * Number of trajectories scored by the last call to refine
+       */
+      unsigned int getNumEvaluations() const {
+        return num_evaluations_;
+      }
+
+    private:
+      /**
+       * Moves the commands into the velocity limits and the acceleration limits between intervals
+       */
+      void project(std::vector<Eigen::Vector3f>& commands);
+
+      /**
+       * Simulates the commands and scores the result, returns the cost or a negative value
+       */
+      double evaluate(const std::vector<Eigen::Vector3f>& commands, base_local_planner::Trajectory& traj);
+
+      int num_intervals_, max_iterations_;
+      double sim_time_, sim_granularity_, angular_sim_granularity_, sim_period_;
+
+      // state of the current call to refine
+      Eigen::Vector3f pos_, vel_;
+      base_local_planner::LocalPlannerLimits* limits_;
+      const ScoringFunction* score_;
+      unsigned int num_evaluations_;
+  };
+};
+#endif
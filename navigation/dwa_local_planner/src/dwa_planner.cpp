@@ -58,6 +58,12 @@ namespace dwa_local_planner {
         config.angular_sim_granularity,
         config.use_dwa,
         sim_period_);
+    generator_.setIntegration((base_local_planner::SimpleTrajectoryGenerator::Integration) config.rollout_integration);
+    refiner_.setSimulation(
+        config.sim_time,
+        config.sim_granularity,
+        config.angular_sim_granularity,
+        sim_period_);
 
     double resolution = planner_util_->getCostmap()->getResolution();
     pdist_scale_ = config.path_distance_bias;
@@ -72,6 +78,10 @@ namespace dwa_local_planner {
     occdist_scale_ = config.occdist_scale;
     obstacle_costs_.setScale(resolution * occdist_scale_);
 
+    moving_obstacle_costs_.setScale(config.moving_obstacle_scale);
+    moving_obstacle_costs_.setParams(config.moving_obstacle_horizon, config.moving_obstacle_min_speed,
+        moving_obstacle_min_hits_, config.moving_obstacle_margin);
+
     stop_time_buffer_ = config.stop_time_buffer;
     oscillation_costs_.setOscillationResetDist(config.oscillation_reset_dist, config.oscillation_reset_angle);
     forward_point_distance_ = config.forward_point_distance;
@@ -114,6 +124,7 @@ namespace dwa_local_planner {
   DWAPlanner::DWAPlanner(std::string name, base_local_planner::LocalPlannerUtil *planner_util) :
       planner_util_(planner_util),
       obstacle_costs_(planner_util->getCostmap()),
+      moving_obstacle_costs_(&obstacle_tracker_),
       path_costs_(planner_util->getCostmap()),
       goal_costs_(planner_util->getCostmap(), 0.0, 0.0, true),
       goal_front_costs_(planner_util->getCostmap(), 0.0, 0.0, true),
@@ -154,11 +165,26 @@ namespace dwa_local_planner {
     traj_cloud_pub_.advertise(private_nh, "trajectory_cloud", 1);
     private_nh.param("publish_traj_pc", publish_traj_pc_, false);
 
+    // clusters of the marking observations followed over time, see base_local_planner::ObstacleTracker
+    double cluster_tolerance, max_cluster_size, association_distance, max_track_age;
+    int min_cluster_points, max_tracks;
+    private_nh.param("moving_obstacle_cluster_tolerance", cluster_tolerance, 0.2);
+    private_nh.param("moving_obstacle_max_size", max_cluster_size, 1.0);
+    private_nh.param("moving_obstacle_min_points", min_cluster_points, 3);
+    private_nh.param("moving_obstacle_association_distance", association_distance, 0.5);
+    private_nh.param("moving_obstacle_max_age", max_track_age, 0.5);
+    private_nh.param("moving_obstacle_max_tracks", max_tracks, 50);
+    private_nh.param("moving_obstacle_min_hits", moving_obstacle_min_hits_, 3);
+    obstacle_tracker_.setParams(cluster_tolerance, max_cluster_size, std::max(1, min_cluster_points),
+        association_distance, max_track_age, std::max(0, max_tracks));
+    moving_obstacle_costs_.setScale(0.0);
+
     // set up all the cost functions that will be applied in order
     // (any function returning negative values will abort scoring, so the order can improve performance)
     std::vector<base_local_planner::TrajectoryCostFunction*> critics;
     critics.push_back(&oscillation_costs_); // discards oscillating motions (assisgns cost -1)
     critics.push_back(&obstacle_costs_); // discards trajectories that move into obstacles
+    critics.push_back(&moving_obstacle_costs_); // prefers trajectories that stay clear of where moving obstacles are headed
     critics.push_back(&goal_front_costs_); // prefers trajectories that make the nose go towards (local) nose goal
     critics.push_back(&alignment_costs_); // prefers trajectories that keep the robot nose on nose path
     critics.push_back(&path_costs_); // prefers trajectories on global path
@@ -169,6 +195,43 @@ namespace dwa_local_planner {
     generator_list.push_back(&generator_);
 
     scored_sampling_planner_ = base_local_planner::SimpleScoredSamplingPlanner(generator_list, critics);
+
+    // scoring the samples of one cycle can be spread over several threads
+    int num_threads;
+    private_nh.param("num_threads", num_threads, 1);
+    scored_sampling_planner_.setNumThreads(num_threads);
+
+    // sampling around the last command first gives the critics a tight bound early on
+    private_nh.param("warm_start_sampling", warm_start_sampling_, false);
+    result_traj_.cost_ = -1;
+
+    refine_trajectories_ = false;
+    refiner_score_ = boost::bind(
+        static_cast<double (base_local_planner::SimpleScoredSamplingPlanner::*)(base_local_planner::Trajectory&, double)>(
+            &base_local_planner::SimpleScoredSamplingPlanner::scoreTrajectory),
+        &scored_sampling_planner_, _1, -1.0);
+    refiner_obstacle_score_ = boost::bind(&base_local_planner::ObstacleCostFunction::scoreTrajectory, &obstacle_costs_, _1);
+  }
+
+  bool DWAPlanner::tracksMovingObstacles() {
+    boost::mutex::scoped_lock l(configuration_mutex_);
+    return moving_obstacle_costs_.getScale() != 0;
+  }
+
+  void DWAPlanner::updateObstacleTracks(const std::vector<costmap_2d::Observation>& observations) {
+    obstacle_tracker_.update(observations);
+  }
+
+  void DWAPlanner::setRefinement(bool refine, int num_intervals, int max_iterations) {
+    boost::mutex::scoped_lock l(configuration_mutex_);
+    refine_trajectories_ = refine;
+    refiner_.setParameters(num_intervals, max_iterations);
+    // the refinement follows the gradient of the costs, which the grid distances only have when interpolated
+    obstacle_costs_.setInterpolation(refine);
+    path_costs_.setInterpolation(refine);
+    goal_costs_.setInterpolation(refine);
+    goal_front_costs_.setInterpolation(refine);
+    alignment_costs_.setInterpolation(refine);
   }
 
   // used for visualization only, total_costs are not really total costs
@@ -285,6 +348,9 @@ namespace dwa_local_planner {
       std::vector<geometry_msgs::Point> footprint_spec) {
 
     obstacle_costs_.setFootprint(footprint_spec);
+    moving_obstacle_costs_.setFootprint(footprint_spec);
+    // the moving obstacles are predicted from their last observation to now, when the trajectories start
+    moving_obstacle_costs_.setStamp(ros::Time::now().toSec());
 
     //make sure that our configuration doesn't change mid-run
     boost::mutex::scoped_lock l(configuration_mutex_);
@@ -296,6 +362,11 @@ namespace dwa_local_planner {
     base_local_planner::LocalPlannerLimits limits = planner_util_->getCurrentLimits();
 
     // prepare cost functions and generators for this run
+    if (warm_start_sampling_ && result_traj_.cost_ >= 0) {
+      generator_.setWarmStart(Eigen::Vector3f(result_traj_.xv_, result_traj_.yv_, result_traj_.thetav_));
+    } else {
+      generator_.clearWarmStart();
+    }
     generator_.initialise(pos,
         vel,
         goal,
@@ -304,8 +375,20 @@ namespace dwa_local_planner {
 
     result_traj_.cost_ = -7;
     // find best trajectory by sampling and scoring the samples
-    std::vector<base_local_planner::Trajectory> all_explored;
-    scored_sampling_planner_.findBestTrajectory(result_traj_, &all_explored);
+    ros::WallTime start = ros::WallTime::now();
+    scored_sampling_planner_.findBestTrajectory(result_traj_);
+    ROS_DEBUG_NAMED("dwa_local_planner", "Scored %u samples in %.2f ms, %u of them cut short by the bound%s",
+        scored_sampling_planner_.getNumExplored(), (ros::WallTime::now() - start).toSec() * 1000.0,
+        scored_sampling_planner_.getNumPruned(), warm_start_sampling_ ? " (warm start)" : "");
+
+    // improve on the best sample by letting the command vary over the horizon
+    if (refine_trajectories_ && result_traj_.cost_ >= 0) {
+      double sample_cost = result_traj_.cost_;
+      if (refiner_.refine(pos, vel, limits, refiner_score_, refiner_obstacle_score_, result_traj_)) {
+        ROS_DEBUG_NAMED("dwa_local_planner", "Refined the best sample from cost %.3f to %.3f with %u more trajectories",
+            sample_cost, result_traj_.cost_, refiner_.getNumEvaluations());
+      }
+    }
 
     if(publish_traj_pc_)
     {
@@ -314,8 +397,9 @@ namespace dwa_local_planner {
         traj_cloud_.width=0;
         traj_cloud_.height=0;
         traj_cloud_.header.stamp = ros::Time::now();
-        for(std::vector<base_local_planner::Trajectory>::iterator t=all_explored.begin(); t != all_explored.end(); t++)
+        for(unsigned int n = 0; n < scored_sampling_planner_.getNumExplored(); ++n)
         {
+            const base_local_planner::Trajectory* t = &scored_sampling_planner_.getExplored(n);
             if(t->cost_<0)
                 continue;
             // Fill out the plan
@@ -44,6 +44,7 @@
 #include <pluginlib/class_list_macros.h>
 
 #include <base_local_planner/goal_functions.h>
+#include <costmap_2d/obstacle_layer.h>
 #include <nav_msgs/Path.h>
 
 //register this planner as a BaseLocalPlanner plugin
@@ -258,6 +259,19 @@ namespace dwa_local_planner {
     }
     ROS_DEBUG_NAMED("dwa_local_planner", "Received a transformed plan with %zu points.", transformed_plan.size());
 
+    if (dp_->tracksMovingObstacles()) {
+      // what the obstacle layers of the local costmap have seen, in its global frame
+      std::vector<costmap_2d::Observation> observations;
+      std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap_ros_->getLayeredCostmap()->getPlugins();
+      for (std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator plugin = plugins->begin(); plugin != plugins->end(); ++plugin) {
+        costmap_2d::ObstacleLayer* obstacle_layer = dynamic_cast<costmap_2d::ObstacleLayer*>(plugin->get());
+        if (obstacle_layer != NULL) {
+          obstacle_layer->getMarkingObservations(observations);
+        }
+      }
+      dp_->updateObstacleTracks(observations);
+    }
+
     // update plan in dwa_planner even if we just stop and rotate, to allow checkTrajectory
     dp_->updatePlanAndLocalCosts(current_pose_, transformed_plan);
 
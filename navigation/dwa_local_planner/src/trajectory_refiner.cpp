@@ -0,0 +1,225 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2009, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <dwa_local_planner/trajectory_refiner.h>
+#include <base_local_planner/simple_trajectory_generator.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace dwa_local_planner {
+
+  TrajectoryRefiner::TrajectoryRefiner() :
+    num_intervals_(3), max_iterations_(5),
+    sim_time_(1.0), sim_granularity_(0.025), angular_sim_granularity_(0.1), sim_period_(0.05),
+    limits_(NULL), score_(NULL), num_evaluations_(0) {}
+
+  void TrajectoryRefiner::setParameters(int num_intervals, int max_iterations) {
+    num_intervals_ = std::max(1, num_intervals);
+    max_iterations_ = std::max(0, max_iterations);
+  }
+
+  void TrajectoryRefiner::setSimulation(double sim_time, double sim_granularity, double angular_sim_granularity, double sim_period) {
+    sim_time_ = sim_time;
+    sim_granularity_ = sim_granularity;
+    angular_sim_granularity_ = angular_sim_granularity;
+    sim_period_ = sim_period;
+  }
+
+  void TrajectoryRefiner::project(std::vector<Eigen::Vector3f>& commands) {
+    Eigen::Vector3f acc = limits_->getAccLimits();
+    Eigen::Vector3f min_vel(limits_->min_vel_x, limits_->min_vel_y, -limits_->max_rot_vel);
+    Eigen::Vector3f max_vel(limits_->max_vel_x, limits_->max_vel_y, limits_->max_rot_vel);
+    double interval = sim_time_ / num_intervals_;
+
+    // the first command has to be reachable within one control period, like the samples,
+    // each later one within an interval from the one before
+    Eigen::Vector3f previous = vel_;
+    double dt = sim_period_;
+    for (unsigned int k = 0; k < commands.size(); ++k) {
+      for (int d = 0; d < 3; ++d) {
+        double lo = std::max(double(min_vel[d]), previous[d] - acc[d] * dt);
+        double hi = std::min(double(max_vel[d]), previous[d] + acc[d] * dt);
+        commands[k][d] = std::max(std::min(double(commands[k][d]), hi), lo);
+      }
+      double vmag = hypot(commands[k][0], commands[k][1]);
+      if (limits_->max_trans_vel >= 0 && vmag > limits_->max_trans_vel) {
+        commands[k][0] *= limits_->max_trans_vel / vmag;
+        commands[k][1] *= limits_->max_trans_vel / vmag;
+      }
+      previous = commands[k];
+      dt = interval;
+    }
+  }
+
+  double TrajectoryRefiner::evaluate(const std::vector<Eigen::Vector3f>& commands, base_local_planner::Trajectory& traj) {
+    num_evaluations_++;
+    traj.resetPoints();
+    traj.cost_ = -1.0;
+    traj.xv_ = commands[0][0];
+    traj.yv_ = commands[0][1];
+    traj.thetav_ = commands[0][2];
+
+    // the same minimum velocities the generator demands from its samples
+    double eps = 1e-4;
+    double vmag = hypot(commands[0][0], commands[0][1]);
+    if ((limits_->min_trans_vel >= 0 && vmag + eps < limits_->min_trans_vel) &&
+        (limits_->min_rot_vel >= 0 && fabs(commands[0][2]) + eps < limits_->min_rot_vel)) {
+      return -1.0;
+    }
+
+    // as many points as a sample covering the same distance and angle would get
+    double interval = sim_time_ / num_intervals_;
+    double distance = 0, angle = 0;
+    for (unsigned int k = 0; k < commands.size(); ++k) {
+      distance += hypot(commands[k][0], commands[k][1]) * interval;
+      angle += fabs(commands[k][2]) * interval;
+    }
+    int num_steps = ceil(std::max(distance / sim_granularity_, angle / angular_sim_granularity_));
+    if (num_steps == 0) {
+      return -1.0;
+    }
+    double dt = sim_time_ / num_steps;
+    traj.time_delta_ = dt;
+
+    Eigen::Vector3f pos = pos_;
+    for (int i = 0; i < num_steps; ++i) {
+      traj.addPoint(pos[0], pos[1], pos[2]);
+      unsigned int k = std::min(int(i * dt / interval), num_intervals_ - 1);
+      pos = base_local_planner::SimpleTrajectoryGenerator::computeNewPositions(pos, commands[k], dt);
+    }
+
+    traj.cost_ = (*score_)(traj);
+    return traj.cost_;
+  }
+
+  bool TrajectoryRefiner::refine(const Eigen::Vector3f& pos,
+      const Eigen::Vector3f& vel,
+      base_local_planner::LocalPlannerLimits& limits,
+      const ScoringFunction& score,
+      const ScoringFunction& obstacle_score,
+      base_local_planner::Trajectory& traj) {
+    num_evaluations_ = 0;
+    if (traj.cost_ < 0 || max_iterations_ == 0) {
+      return false;
+    }
+    pos_ = pos;
+    vel_ = vel;
+    limits_ = &limits;
+    score_ = &score;
+
+    // the sample as a constant command over the horizon, scored with the same rollout as the candidates
+    std::vector<Eigen::Vector3f> commands(num_intervals_, Eigen::Vector3f(traj.xv_, traj.yv_, traj.thetav_));
+    project(commands);
+    base_local_planner::Trajectory best, candidate;
+    double best_cost = evaluate(commands, best);
+    if (best_cost < 0) {
+      return false;
+    }
+    double seed_cost = best_cost;
+    double seed_obstacle_cost = obstacle_score(best);
+
+    // velocities are measured in how much they can change within a control period,
+    // dimensions the robot cannot move in are left alone
+    Eigen::Vector3f window = limits.getAccLimits() * sim_period_;
+    bool active[3];
+    active[0] = limits.max_vel_x > limits.min_vel_x;
+    active[1] = limits.max_vel_y > limits.min_vel_y;
+    active[2] = limits.max_rot_vel > 0;
+
+    std::vector<Eigen::Vector3f> gradient(num_intervals_), trial(num_intervals_);
+    for (int iteration = 0; iteration < max_iterations_; ++iteration) {
+      // forward differences, backward where the limits are in the way
+      double largest = 0;
+      for (int k = 0; k < num_intervals_; ++k) {
+        gradient[k] = Eigen::Vector3f::Zero();
+        for (int d = 0; d < 3; ++d) {
+          if ( ! active[d] || window[d] <= 0) {
+            continue;
+          }
+          double h = 0.1 * window[d];
+          trial = commands;
+          trial[k][d] += h;
+          project(trial);
+          double delta = trial[k][d] - commands[k][d];
+          if (fabs(delta) < 1e-3 * h) {
+            trial = commands;
+            trial[k][d] -= h;
+            project(trial);
+            delta = trial[k][d] - commands[k][d];
+          }
+          if (fabs(delta) < 1e-3 * h) {
+            continue;
+          }
+          double cost = evaluate(trial, candidate);
+          if (cost < 0) {
+            continue;
+          }
+          // descent direction in window units
+          gradient[k][d] = -(cost - best_cost) / delta * window[d];
+          largest = std::max(largest, double(fabs(gradient[k][d])));
+        }
+      }
+      if (largest == 0) {
+        break;
+      }
+
+      // halve the step until the cost goes down, the longest step moves one command by a window
+      bool improved = false;
+      for (double step = 1.0; step > 0.1 && !improved; step *= 0.5) {
+        trial = commands;
+        for (int k = 0; k < num_intervals_; ++k) {
+          trial[k] += (step / largest) * gradient[k].cwiseProduct(window);
+        }
+        project(trial);
+        double cost = evaluate(trial, candidate);
+        if (cost >= 0 && cost < best_cost && obstacle_score(candidate) <= seed_obstacle_cost) {
+          commands = trial;
+          best_cost = cost;
+          best = candidate;
+          improved = true;
+        }
+      }
+      if ( ! improved) {
+        break;
+      }
+    }
+
+    if (best_cost < seed_cost) {
+      traj = best;
+      return true;
+    }
+    return false;
+  }
+};
@@ -0,0 +1,203 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2009, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+#include <base_local_planner/obstacle_cost_function.h>
+#include <base_local_planner/simple_trajectory_generator.h>
+#include <dwa_local_planner/trajectory_refiner.h>
+
+using namespace dwa_local_planner;
+
+namespace {
+
+const double SIM_TIME = 1.7, SIM_GRANULARITY = 0.025, ANGULAR_SIM_GRANULARITY = 0.1, SIM_PERIOD = 0.05;
+const double GOAL_X = 5.0, GOAL_Y = 2.5;
+
+// a 6m x 6m map with one round obstacle in it, inflated the way the inflation layer would
+void addObstacle(costmap_2d::Costmap2D& costmap, double ox, double oy, double radius) {
+  for (unsigned int i = 0; i < costmap.getSizeInCellsX(); ++i) {
+    for (unsigned int j = 0; j < costmap.getSizeInCellsY(); ++j) {
+      double wx, wy;
+      costmap.mapToWorld(i, j, wx, wy);
+      double distance = hypot(wx - ox, wy - oy) - radius;
+      unsigned char cost = 0;
+      if (distance <= 0) {
+        cost = costmap_2d::LETHAL_OBSTACLE;
+      } else if (distance <= 0.1) {
+        cost = costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+      } else if (distance < 1.0) {
+        cost = (unsigned char)((costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1) * exp(-3.0 * (distance - 0.1)));
+      }
+      costmap.setCost(i, j, std::max(cost, costmap.getCost(i, j)));
+    }
+  }
+}
+
+std::vector<geometry_msgs::Point> squareFootprint(double half_size) {
+  std::vector<geometry_msgs::Point> footprint;
+  geometry_msgs::Point pt;
+  pt.z = 0.0;
+  pt.x = half_size;  pt.y = half_size;  footprint.push_back(pt);
+  pt.x = -half_size; pt.y = half_size;  footprint.push_back(pt);
+  pt.x = -half_size; pt.y = -half_size; footprint.push_back(pt);
+  pt.x = half_size;  pt.y = -half_size; footprint.push_back(pt);
+  return footprint;
+}
+
+base_local_planner::LocalPlannerLimits makeLimits() {
+  return base_local_planner::LocalPlannerLimits(0.55, 0.1, 0.55, 0.0, 0.0, 0.0, 1.0, 0.4,
+      2.5, 0.0, 3.2, 2.5, 0.1, 0.1);
+}
+
+// the same rollout the refiner gives a constant command
+void rollOut(const Eigen::Vector3f& pos, const Eigen::Vector3f& vel, base_local_planner::Trajectory& traj) {
+  traj.resetPoints();
+  traj.xv_ = vel[0];
+  traj.yv_ = vel[1];
+  traj.thetav_ = vel[2];
+  double distance = hypot(vel[0], vel[1]) * SIM_TIME;
+  double angle = fabs(vel[2]) * SIM_TIME;
+  int num_steps = ceil(std::max(distance / SIM_GRANULARITY, angle / ANGULAR_SIM_GRANULARITY));
+  double dt = SIM_TIME / num_steps;
+  traj.time_delta_ = dt;
+  Eigen::Vector3f p = pos;
+  for (int i = 0; i < num_steps; ++i) {
+    traj.addPoint(p[0], p[1], p[2]);
+    p = base_local_planner::SimpleTrajectoryGenerator::computeNewPositions(p, vel, dt);
+  }
+}
+
+class TrajectoryRefinerTest : public testing::Test {
+  public:
+    TrajectoryRefinerTest() :
+        costmap_(120, 120, 0.05, 0.0, 0.0),
+        obstacle_costs_(&costmap_),
+        limits_(makeLimits()),
+        obstacle_scale_(0.02) {
+      addObstacle(costmap_, 2.6, 2.3, 0.1);
+      obstacle_costs_.setFootprint(squareFootprint(0.1));
+      obstacle_costs_.setParams(limits_.max_trans_vel, 0.0, limits_.max_trans_vel);
+      obstacle_costs_.setInterpolation(true);
+      obstacle_score_ = boost::bind(&base_local_planner::ObstacleCostFunction::scoreTrajectory, &obstacle_costs_, _1);
+      score_ = boost::bind(&TrajectoryRefinerTest::score, this, _1);
+      refiner_.setParameters(3, 10);
+      refiner_.setSimulation(SIM_TIME, SIM_GRANULARITY, ANGULAR_SIM_GRANULARITY, SIM_PERIOD);
+    }
+
+    // distance of the last point to the goal plus the obstacle critic, like the planner weighs them
+    double score(base_local_planner::Trajectory& traj) {
+      if (traj.getPointsSize() == 0) {
+        return -1.0;
+      }
+      double obstacle_cost = obstacle_costs_.scoreTrajectory(traj);
+      if (obstacle_cost < 0) {
+        return obstacle_cost;
+      }
+      double px, py, pth;
+      traj.getPoint(traj.getPointsSize() - 1, px, py, pth);
+      return hypot(GOAL_X - px, GOAL_Y - py) + obstacle_scale_ * obstacle_cost;
+    }
+
+    costmap_2d::Costmap2D costmap_;
+    base_local_planner::ObstacleCostFunction obstacle_costs_;
+    base_local_planner::LocalPlannerLimits limits_;
+    double obstacle_scale_;
+    TrajectoryRefiner refiner_;
+    TrajectoryRefiner::ScoringFunction score_, obstacle_score_;
+};
+
+}
+
+TEST_F(TrajectoryRefinerTest, interpolatedObstacleCostIsSmooth) {
+  // moving the last point by a fraction of a cell changes the interpolated cost, not the cell cost
+  base_local_planner::Trajectory near, nearer;
+  near.addPoint(1.90, 2.5, 0.0);
+  nearer.addPoint(1.92, 2.5, 0.0);
+  double near_cost = obstacle_score_(near), nearer_cost = obstacle_score_(nearer);
+  EXPECT_GT(near_cost, 0.0);
+  EXPECT_GT(nearer_cost, near_cost);
+
+  obstacle_costs_.setInterpolation(false);
+  EXPECT_EQ(obstacle_score_(near), obstacle_score_(nearer));
+}
+
+TEST_F(TrajectoryRefinerTest, lowersTotalCostWithoutRaisingObstacleCost) {
+  Eigen::Vector3f pos(1.0, 2.5, 0.0);
+  Eigen::Vector3f vel(0.3, 0.0, 0.0);
+  int num_refined = 0;
+  for (int i = -4; i <= 4; ++i) {
+    base_local_planner::Trajectory seed;
+    rollOut(pos, Eigen::Vector3f(0.5, 0.0, 0.1 * i), seed);
+    seed.cost_ = score_(seed);
+    ASSERT_GE(seed.cost_, 0.0);
+    double seed_obstacle_cost = obstacle_score_(seed);
+
+    base_local_planner::Trajectory traj = seed;
+    if (refiner_.refine(pos, vel, limits_, score_, obstacle_score_, traj)) {
+      num_refined++;
+      EXPECT_LT(traj.cost_, seed.cost_);
+      EXPECT_NEAR(score_(traj), traj.cost_, 1e-9);
+      EXPECT_LE(obstacle_score_(traj), seed_obstacle_cost);
+    } else {
+      EXPECT_EQ(seed.cost_, traj.cost_);
+    }
+  }
+  EXPECT_GT(num_refined, 0);
+}
+
+TEST_F(TrajectoryRefinerTest, followsObstacleGradient) {
+  // with only the obstacle critic to go by, the refinement has to steer away from the obstacle
+  obstacle_scale_ = 1.0;
+  Eigen::Vector3f pos(1.5, 2.4, 0.0);
+  base_local_planner::Trajectory seed;
+  rollOut(pos, Eigen::Vector3f(0.3, 0.0, 0.0), seed);
+  seed.cost_ = obstacle_score_(seed);
+  ASSERT_GT(seed.cost_, 0.0);
+
+  base_local_planner::Trajectory traj = seed;
+  ASSERT_TRUE(refiner_.refine(pos, Eigen::Vector3f(0.3, 0.0, 0.0), limits_, obstacle_score_, obstacle_score_, traj));
+  EXPECT_LT(traj.cost_, seed.cost_);
+  EXPECT_LT(obstacle_score_(traj), obstacle_score_(seed));
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -40,6 +40,7 @@
 
 #include <global_planner/planner_core.h>
 #include <global_planner/expander.h>
+#include <global_planner/landmark_cache.h>
 #include <vector>
 #include <algorithm>
 
@@ -65,9 +66,22 @@ class AStarExpansion : public Expander {
         AStarExpansion(PotentialCalculator* p_calc, int nx, int ny);
         bool calculatePotentials(unsigned char* costs, int start_x, int start_y, int end_x, int end_y, int cycles,
                                 float* potential);
+
+        /**
+         * @brief  Uses landmark distances to tighten the heuristic, NULL to use the distance alone
+         */
+        void setLandmarks(LandmarkCache* landmarks) {
+            landmarks_ = landmarks;
+        }
+        int getCellsVisited() const {
+            return cells_visited_;
+        }
     private:
         void add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x, int end_y);
+        float heuristic(int i, int end_x, int end_y);
         std::vector<Index> queue_;
+        std::vector<bool> closed_;
+        LandmarkCache* landmarks_;
 };
 
 } //end namespace global_planner
@@ -0,0 +1,145 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef _LANDMARK_CACHE_H
+#define _LANDMARK_CACHE_H
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <stdint.h>
+
+namespace global_planner {
+
+/**
+ * @class LandmarkCache
+ * @brief Distance fields from a few landmark cells of the costmap, for ALT (A*, landmarks, triangle
+ * inequality) heuristics. The fields live in a memory-mapped file, so they survive restarts.
+ *
+ * Distances are taken on the costmap the search runs on, with the A* step cost (the cost of a cell plus the
+ * neutral cost, saturated). A step between two cells costs as much as entering the cheaper of them, which
+ * keeps the distances symmetric, so |d(L,goal) - d(L,n)| is a lower bound on the cost from n to the goal.
+ *
+ * The fields belong to a copy of the costmap that is never more expensive than the real one: cells that got
+ * more expensive keep their old cost, since that leaves every bound valid, and cells that got cheaper are
+ * taken over and the fields are repaired around them only.
+ */
+class LandmarkCache {
+    public:
+        /**
+         * @param filename The file to keep the fields in, empty to keep them in memory only
+         * @param count The number of landmarks
+         */
+        LandmarkCache(const std::string& filename, int count);
+        ~LandmarkCache();
+
+        /**
+         * @brief  Makes the distance fields valid for a costmap, repairing them where it got cheaper
+         * @param costs The costmap the search runs on
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         * @param neutral_cost The neutral cost of the planner
+         * @return True if the cache can be used
+         */
+        bool update(const unsigned char* costs, int nx, int ny, unsigned char neutral_cost);
+
+        /**
+         * @brief  Sets the goal cell for subsequent heuristic() calls
+         */
+        void setGoal(int goal_i) {
+            goal_fields_ = fields_ + goal_i * count_;
+        }
+
+        /**
+         * @brief  Lower bound on the cost from a cell to the goal set with setGoal(), in A* step costs
+         */
+        inline float heuristic(int i) const {
+            const float* fields = fields_ + i * count_;
+            float h = 0;
+            for (int k = 0; k < count_; k++) {
+                float d = fabsf(goal_fields_[k] - fields[k]);
+                if (d > h)
+                    h = d;
+            }
+            return h;
+        }
+
+        bool isValid() const {
+            return valid_;
+        }
+
+    private:
+        struct Header {
+                char magic[8];
+                uint32_t version;
+                uint32_t nx, ny, count, neutral_cost;
+                uint32_t valid;
+        };
+
+        bool mapStorage(int nx, int ny, unsigned char neutral_cost);
+        void unmapStorage();
+        typedef std::pair<float, int> Entry;
+        typedef std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > Queue;
+
+        void build();
+        void computeField(int landmark_i, int k);
+        void repairField(const std::vector<int>& cheaper, int k);
+        void propagate(Queue& queue, int k);
+        int getNeighbors(int i, int* neighbors) const;
+
+        /** @brief Cost of a step between neighboring cells, the cost of entering the cheaper one */
+        inline float stepCost(int a, int b) const {
+            return std::min(std::min(map_[a], map_[b]) + neutral_cost_, 255);
+        }
+
+        std::string filename_;
+        int count_;
+        int nx_, ny_, ns_;
+        unsigned char neutral_cost_;
+
+        char* data_;           /**< header, map, landmark cells, then the fields */
+        size_t data_size_;
+        bool mapped_;
+        Header* header_;
+        unsigned char* map_;    /**< costs the fields are exact for, never above the costmap */
+        int32_t* landmarks_;
+        float* fields_;         /**< count_ distances per cell, cell-major */
+        const float* goal_fields_;
+        bool valid_;
+};
+
+} //end namespace global_planner
+#endif
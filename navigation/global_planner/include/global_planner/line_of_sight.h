@@ -0,0 +1,127 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef _LINE_OF_SIGHT_H
+#define _LINE_OF_SIGHT_H
+#include <vector>
+#include <math.h>
+#include <costmap_2d/cost_values.h>
+
+namespace global_planner {
+
+/**
+ * @class LineOfSight
+ * @brief Straight-line traversal costs on the raw costmap, and any-angle shortening of grid paths
+ */
+class LineOfSight {
+    public:
+        LineOfSight(int nx, int ny) :
+                unknown_(false), lethal_cost_(254), neutral_cost_(50), factor_(3.0) {
+            setSize(nx, ny);
+        }
+
+        /**
+         * @brief  Sets or resets the size of the map
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         */
+        void setSize(int nx, int ny) {
+            nx_ = nx;
+            ny_ = ny;
+        }
+        void setLethalCost(unsigned char lethal_cost) {
+            lethal_cost_ = lethal_cost;
+        }
+        void setNeutralCost(unsigned char neutral_cost) {
+            neutral_cost_ = neutral_cost;
+        }
+        void setFactor(float factor) {
+            factor_ = factor;
+        }
+        /**
+         * @brief  Whether unknown cells can be crossed, they then cost as much as the most expensive free cell.
+         * Off by default, like in the grid expanders.
+         */
+        void setHasUnknown(bool unknown) {
+            unknown_ = unknown;
+        }
+
+        /**
+         * @brief  Computes the cost of driving straight between two cells, walking the cells in between with Bresenham
+         * @param costs The costmap
+         * @param x0 The x position of the first cell
+         * @param y0 The y position of the first cell
+         * @param x1 The x position of the second cell
+         * @param y1 The y position of the second cell
+         * @param cost Filled with the mean cell cost along the line times its length
+         * @return False if a lethal cell lies on the line
+         */
+        bool lineCost(unsigned char* costs, int x0, int y0, int x1, int y1, float& cost);
+
+        /**
+         * @brief  Removes the waypoints of a path that can be skipped by a straight segment costing no more
+         * than the part of the path it replaces
+         * @param costs The costmap
+         * @param path The path to shorten, in (sub)cell coordinates
+         */
+        void shortenPath(unsigned char* costs, std::vector<std::pair<float, float> >& path);
+
+        float getCost(unsigned char* costs, int n) {
+            float c = costs[n];
+            if (c < lethal_cost_ - 1 || (unknown_ && c == costmap_2d::NO_INFORMATION)) {
+                c = c * factor_ + neutral_cost_;
+                if (c >= lethal_cost_)
+                    c = lethal_cost_ - 1;
+                return c;
+            }
+            return lethal_cost_;
+        }
+
+    private:
+        inline int toIndex(int x, int y) {
+            return x + nx_ * y;
+        }
+        inline int toCell(float v) {
+            return (int) floorf(v + 0.5);
+        }
+        float segmentCost(unsigned char* costs, const std::pair<float, float>& a, const std::pair<float, float>& b);
+
+        int nx_, ny_;
+        bool unknown_;
+        unsigned char lethal_cost_, neutral_cost_;
+        float factor_;
+};
+
+} //end namespace global_planner
+#endif
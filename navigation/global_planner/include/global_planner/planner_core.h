@@ -50,6 +50,7 @@
 #include <global_planner/potential_calculator.h>
 #include <global_planner/expander.h>
 #include <global_planner/traceback.h>
+#include <global_planner/line_of_sight.h>
 #include <global_planner/GlobalPlannerConfig.h>
 
 #define POT_HIGH 1.0e10		// unassigned cell potential
@@ -57,6 +58,8 @@ namespace global_planner {
 
 class Expander;
 class GridPath;
+class AStarExpansion;
+class LandmarkCache;
 
 /**
  * @class PlannerCore
@@ -173,6 +176,17 @@ class PlannerCore : public nav_core::BaseGlobalPlanner {
         PotentialCalculator* p_calc_;
         Expander* planner_;
         Traceback* path_maker_;
+        LineOfSight* line_of_sight_;
+        bool shorten_path_;
+
+        /**
+         * @brief  Brings the landmark cache up to date with the costmap
+         * @return True if the landmarks can be used for this plan
+         */
+        bool updateLandmarks();
+        AStarExpansion* astar_;
+        LandmarkCache* landmarks_;
+        unsigned char neutral_cost_;
 
         ros::Publisher potential_pub_;
 
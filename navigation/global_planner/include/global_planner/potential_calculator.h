@@ -56,6 +56,13 @@ class PotentialCalculator {
             return prev_potential + cost;
         }
 
+        /**
+         * @brief  The smallest share of its cost a cell adds to the potential of its lowest neighbor
+         */
+        virtual float getMinStepFactor() {
+            return 1.0;
+        }
+
         /**
          * @brief  Sets or resets the size of the map
          * @param nx The x size of the map
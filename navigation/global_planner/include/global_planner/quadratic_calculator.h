@@ -47,6 +47,11 @@ class QuadraticCalculator : public PotentialCalculator {
         QuadraticCalculator(int nx, int ny): PotentialCalculator(nx,ny) {}
 
         float calculatePotential(float* potential, unsigned char cost, int n, float prev_potential);
+
+        /** @brief The two-neighbor update adds at least 0.704 of the cost, when both neighbors are equal */
+        float getMinStepFactor() {
+            return 0.7040;
+        }
 };
 
 
@@ -0,0 +1,92 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef _THETA_STAR_H
+#define _THETA_STAR_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <global_planner/traceback.h>
+#include <global_planner/line_of_sight.h>
+#include <global_planner/astar.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class ThetaStarExpansion
+ * @brief Any-angle A*: a cell may take the parent of the cell it is reached from as its own parent
+ * whenever the straight line between them is not blocked, so paths are chains of straight segments.
+ * The potential holds the cost from the start, parents are kept for ThetaStarPath.
+ */
+class ThetaStarExpansion : public Expander {
+    public:
+        ThetaStarExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        bool calculatePotentials(unsigned char* costs, int start_x, int start_y, int end_x, int end_y, int cycles,
+                                float* potential);
+
+        void setSize(int nx, int ny);
+
+        /**
+         * @brief  Parent of a cell after calculatePotentials, -1 if the cell was not reached
+         */
+        int getParent(int i) const {
+            return parents_[i];
+        }
+
+    private:
+        void add(unsigned char* costs, float* potential, int current_i, int next_x, int next_y, int end_x, int end_y);
+
+        std::vector<Index> queue_;
+        std::vector<int> parents_;
+        LineOfSight los_;
+};
+
+/**
+ * @class ThetaStarPath
+ * @brief Extracts the path found by a ThetaStarExpansion by following cell parents
+ */
+class ThetaStarPath : public Traceback {
+    public:
+        ThetaStarPath(PotentialCalculator* p_calc, ThetaStarExpansion* expander) :
+                Traceback(p_calc), expander_(expander) {
+        }
+        bool getPath(float* potential, int end_x, int end_y, std::vector<std::pair<float, float> >& path);
+
+    private:
+        ThetaStarExpansion* expander_;
+};
+
+} //end namespace global_planner
+#endif
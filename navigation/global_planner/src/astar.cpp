@@ -40,7 +40,7 @@
 namespace global_planner {
 
 AStarExpansion::AStarExpansion(PotentialCalculator* p_calc, int xs, int ys) :
-        Expander(p_calc, xs, ys) {
+        Expander(p_calc, xs, ys), landmarks_(NULL) {
 }
 
 bool AStarExpansion::calculatePotentials(unsigned char* costs, int start_x, int start_y, int end_x, int end_y,
@@ -53,18 +53,33 @@ bool AStarExpansion::calculatePotentials(unsigned char* costs, int start_x, int
     potential[start_i] = 0;
 
     int goal_i = toIndex(end_x, end_y);
+    if (landmarks_)
+        landmarks_->setGoal(goal_i);
+    cells_visited_ = 0;
+
+    closed_.assign(ns_, false);
 
     while (queue_.size() > 0) {
         Index top = queue_[0];
         std::pop_heap(queue_.begin(), queue_.end(), greater1());
         queue_.pop_back();
 
+        // skip stale entries, the cell was improved and expanded since this one was queued
         int i = top.i;
+        if (closed_[i])
+            continue;
+        closed_[i] = true;
+        cells_visited_++;
+
         if (i == goal_i)
             return true;
 
-        add(costs, potential, potential[i], i + 1, end_x, end_y);
-        add(costs, potential, potential[i], i - 1, end_x, end_y);
+        // rows do not wrap around, the landmark distances do not either
+        int x = i % nx_;
+        if (x < nx_ - 1)
+            add(costs, potential, potential[i], i + 1, end_x, end_y);
+        if (x > 0)
+            add(costs, potential, potential[i], i - 1, end_x, end_y);
         add(costs, potential, potential[i], i + nx_, end_x, end_y);
         add(costs, potential, potential[i], i - nx_, end_x, end_y);
     }
@@ -74,15 +89,28 @@ bool AStarExpansion::calculatePotentials(unsigned char* costs, int start_x, int
 
 void AStarExpansion::add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x,
                          int end_y) {
-    if (potential[next_i] < POT_HIGH)
+    if (next_i < 0 || next_i >= ns_ || closed_[next_i])
         return;
 
-    potential[next_i] = p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential);
-    int x = next_i % nx_, y = next_i / nx_;
-    float distance = abs(end_x - x) + abs(end_y - y);
+    // the calculator takes the cost as an unsigned char, saturate instead of wrapping around
+    unsigned char cost = std::min(costs[next_i] + neutral_cost_, 255);
+    float next_potential = p_calc_->calculatePotential(potential, cost, next_i, prev_potential);
+    // open cells take a cheaper way in when one turns up, so a consistent heuristic gives the cheapest path
+    if (next_potential >= potential[next_i])
+        return;
 
-    queue_.push_back(Index(next_i, potential[next_i] + distance * neutral_cost_));
+    potential[next_i] = next_potential;
+    queue_.push_back(Index(next_i, next_potential + heuristic(next_i, end_x, end_y)));
     std::push_heap(queue_.begin(), queue_.end(), greater1());
 }
 
+float AStarExpansion::heuristic(int i, int end_x, int end_y) {
+    int x = i % nx_, y = i / nx_;
+    float distance = (abs(end_x - x) + abs(end_y - y)) * neutral_cost_;
+    // the landmark bound counts whole step costs, the calculator may add less than that per cell
+    if (landmarks_)
+        distance = std::max(distance, landmarks_->heuristic(i) * p_calc_->getMinStepFactor());
+    return distance;
+}
+
 } //end namespace global_planner
@@ -0,0 +1,273 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <global_planner/landmark_cache.h>
+#include <ros/console.h>
+#include <ros/time.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace global_planner {
+
+static const char LANDMARK_MAGIC[8] = { 'G', 'P', 'L', 'A', 'N', 'D', 'M', 'K' };
+static const uint32_t LANDMARK_VERSION = 2;
+static const float LANDMARK_UNREACHED = 1.0e10;
+
+LandmarkCache::LandmarkCache(const std::string& filename, int count) :
+        filename_(filename), count_(count), nx_(0), ny_(0), ns_(0), neutral_cost_(0), data_(NULL), data_size_(0),
+        mapped_(false), header_(NULL), map_(NULL), landmarks_(NULL), fields_(NULL), goal_fields_(NULL),
+        valid_(false) {
+}
+
+LandmarkCache::~LandmarkCache() {
+    unmapStorage();
+}
+
+bool LandmarkCache::mapStorage(int nx, int ny, unsigned char neutral_cost) {
+    nx_ = nx;
+    ny_ = ny;
+    ns_ = nx * ny;
+    neutral_cost_ = neutral_cost;
+
+    // keep every section 8 byte aligned
+    size_t header_size = (sizeof(Header) + 7) & ~7;
+    size_t map_size = ((size_t) ns_ + 7) & ~7;
+    size_t landmarks_size = ((size_t) count_ * sizeof(int32_t) + 7) & ~7;
+    data_size_ = header_size + map_size + landmarks_size + (size_t) ns_ * count_ * sizeof(float);
+
+    if (filename_.empty()) {
+        data_ = new char[data_size_];
+        memset(data_, 0, data_size_);
+        mapped_ = false;
+    } else {
+        int fd = open(filename_.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            ROS_ERROR("Cannot open landmark cache %s: %s", filename_.c_str(), strerror(errno));
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t) st.st_size != data_size_) {
+            // wrong size, start over with a zeroed (invalid) file
+            if (ftruncate(fd, 0) != 0 || ftruncate(fd, data_size_) != 0) {
+                ROS_ERROR("Cannot resize landmark cache %s: %s", filename_.c_str(), strerror(errno));
+                close(fd);
+                return false;
+            }
+        }
+        void* addr = mmap(NULL, data_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+            ROS_ERROR("Cannot map landmark cache %s: %s", filename_.c_str(), strerror(errno));
+            return false;
+        }
+        data_ = (char*) addr;
+        mapped_ = true;
+    }
+
+    header_ = (Header*) data_;
+    map_ = (unsigned char*) (data_ + header_size);
+    landmarks_ = (int32_t*) (data_ + header_size + map_size);
+    fields_ = (float*) (data_ + header_size + map_size + landmarks_size);
+    goal_fields_ = fields_;
+
+    valid_ = memcmp(header_->magic, LANDMARK_MAGIC, sizeof(LANDMARK_MAGIC)) == 0
+            && header_->version == LANDMARK_VERSION && header_->nx == (uint32_t) nx && header_->ny == (uint32_t) ny
+            && header_->count == (uint32_t) count_ && header_->neutral_cost == neutral_cost && header_->valid;
+    if (!valid_) {
+        memcpy(header_->magic, LANDMARK_MAGIC, sizeof(LANDMARK_MAGIC));
+        header_->version = LANDMARK_VERSION;
+        header_->nx = nx;
+        header_->ny = ny;
+        header_->count = count_;
+        header_->neutral_cost = neutral_cost;
+        header_->valid = 0;
+    }
+    return true;
+}
+
+void LandmarkCache::unmapStorage() {
+    if (data_) {
+        if (mapped_)
+            munmap(data_, data_size_);
+        else
+            delete[] data_;
+    }
+    data_ = NULL;
+    header_ = NULL;
+    valid_ = false;
+}
+
+bool LandmarkCache::update(const unsigned char* costs, int nx, int ny, unsigned char neutral_cost) {
+    if (count_ <= 0)
+        return false;
+
+    if (data_ == NULL || nx != nx_ || ny != ny_ || neutral_cost != neutral_cost_) {
+        unmapStorage();
+        if (!mapStorage(nx, ny, neutral_cost))
+            return false;
+    }
+
+    if (!valid_) {
+        header_->valid = 0;
+        memcpy(map_, costs, ns_);
+        build();
+        header_->valid = 1;
+        if (mapped_)
+            msync(data_, data_size_, MS_ASYNC);
+        valid_ = true;
+        return true;
+    }
+
+    // the fields stay lower bounds where the costmap got more expensive, only cheaper cells need a repair
+    std::vector<int> cheaper;
+    for (int i = 0; i < ns_; i++) {
+        if (costs[i] < map_[i]) {
+            map_[i] = costs[i];
+            cheaper.push_back(i);
+        }
+    }
+    if (cheaper.empty())
+        return true;
+
+    ros::WallTime start = ros::WallTime::now();
+    header_->valid = 0;
+    for (int k = 0; k < count_; k++)
+        repairField(cheaper, k);
+    header_->valid = 1;
+    if (mapped_)
+        msync(data_, data_size_, MS_ASYNC);
+    ROS_DEBUG("Repaired landmark distance fields around %d cheaper cells in %.3f s", (int) cheaper.size(),
+              (ros::WallTime::now() - start).toSec());
+    return true;
+}
+
+void LandmarkCache::build() {
+    ros::WallTime start = ros::WallTime::now();
+
+    // farthest point selection: every new landmark is the free cell farthest from all previous ones
+    std::vector<float> min_distance(ns_, LANDMARK_UNREACHED);
+    int next = 0;
+    for (int i = 0; i < ns_; i++) {
+        if (map_[i] == 0) {
+            next = i;
+            break;
+        }
+    }
+
+    for (int k = 0; k < count_; k++) {
+        landmarks_[k] = next;
+        computeField(next, k);
+
+        float farthest = -1;
+        for (int i = 0; i < ns_; i++) {
+            float d = fields_[i * count_ + k];
+            if (d < min_distance[i])
+                min_distance[i] = d;
+            if (map_[i] == 0 && min_distance[i] < LANDMARK_UNREACHED && min_distance[i] > farthest) {
+                farthest = min_distance[i];
+                next = i;
+            }
+        }
+    }
+
+    ROS_INFO("Built %d landmark distance fields for a %d X %d map in %.3f s", count_, nx_, ny_,
+             (ros::WallTime::now() - start).toSec());
+}
+
+int LandmarkCache::getNeighbors(int i, int* neighbors) const {
+    int x = i % nx_, y = i / nx_, n = 0;
+    if (x > 0)
+        neighbors[n++] = i - 1;
+    if (x < nx_ - 1)
+        neighbors[n++] = i + 1;
+    if (y > 0)
+        neighbors[n++] = i - nx_;
+    if (y < ny_ - 1)
+        neighbors[n++] = i + nx_;
+    return n;
+}
+
+void LandmarkCache::computeField(int landmark_i, int k) {
+    for (int i = 0; i < ns_; i++)
+        fields_[i * count_ + k] = LANDMARK_UNREACHED;
+
+    Queue queue;
+    fields_[landmark_i * count_ + k] = 0;
+    queue.push(Entry(0, landmark_i));
+    propagate(queue, k);
+}
+
+void LandmarkCache::repairField(const std::vector<int>& cheaper, int k) {
+    // distances only drop, so a Dijkstra pass started at the cheaper cells reaches every cell that changes
+    Queue queue;
+    int neighbors[4];
+    for (unsigned int c = 0; c < cheaper.size(); c++) {
+        int j = cheaper[c];
+        float& field = fields_[j * count_ + k];
+        int n = getNeighbors(j, neighbors);
+        for (int m = 0; m < n; m++)
+            field = std::min(field, fields_[neighbors[m] * count_ + k] + stepCost(neighbors[m], j));
+        // the steps out of the cell got cheaper as well
+        if (field < LANDMARK_UNREACHED)
+            queue.push(Entry(field, j));
+    }
+    propagate(queue, k);
+}
+
+void LandmarkCache::propagate(Queue& queue, int k) {
+    int neighbors[4];
+    while (!queue.empty()) {
+        Entry top = queue.top();
+        queue.pop();
+        int i = top.second;
+        if (top.first > fields_[i * count_ + k])
+            continue;
+
+        int n = getNeighbors(i, neighbors);
+        for (int m = 0; m < n; m++) {
+            int j = neighbors[m];
+            float d = top.first + stepCost(i, j);
+            if (d < fields_[j * count_ + k]) {
+                fields_[j * count_ + k] = d;
+                queue.push(Entry(d, j));
+            }
+        }
+    }
+}
+
+} //end namespace global_planner
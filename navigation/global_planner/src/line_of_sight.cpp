@@ -0,0 +1,109 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <global_planner/line_of_sight.h>
+#include <math.h>
+#include <stdlib.h>
+
+namespace global_planner {
+
+bool LineOfSight::lineCost(unsigned char* costs, int x0, int y0, int x1, int y1, float& cost) {
+    int dx = abs(x1 - x0), dy = abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    int error = dx - dy;
+
+    int x = x0, y = y0, n = 0;
+    float sum = 0;
+    while (x != x1 || y != y1) {
+        int e2 = 2 * error;
+        if (e2 > -dy) {
+            error -= dy;
+            x += sx;
+        }
+        if (e2 < dx) {
+            error += dx;
+            y += sy;
+        }
+        if (x < 0 || x >= nx_ || y < 0 || y >= ny_)
+            return false;
+
+        float c = getCost(costs, toIndex(x, y));
+        if (c >= lethal_cost_)
+            return false;
+        sum += c;
+        n++;
+    }
+
+    cost = n > 0 ? sum / n * hypotf(x1 - x0, y1 - y0) : 0;
+    return true;
+}
+
+void LineOfSight::shortenPath(unsigned char* costs, std::vector<std::pair<float, float> >& path) {
+    if (path.size() < 3)
+        return;
+
+    std::vector<std::pair<float, float> > shortened;
+    shortened.push_back(path[0]);
+
+    // cost along the path from the last kept waypoint to path[i]
+    float path_cost = 0;
+    int ax = toCell(path[0].first), ay = toCell(path[0].second);
+    for (unsigned int i = 1; i + 1 < path.size(); i++) {
+        path_cost += segmentCost(costs, path[i - 1], path[i]);
+        float next_cost = path_cost + segmentCost(costs, path[i], path[i + 1]);
+
+        // skip path[i] if the last kept waypoint sees path[i+1] for no more than the path costs
+        float line_cost;
+        if (lineCost(costs, ax, ay, toCell(path[i + 1].first), toCell(path[i + 1].second), line_cost)
+                && line_cost <= next_cost)
+            continue;
+
+        shortened.push_back(path[i]);
+        ax = toCell(path[i].first);
+        ay = toCell(path[i].second);
+        path_cost = 0;
+    }
+    shortened.push_back(path.back());
+    path.swap(shortened);
+}
+
+float LineOfSight::segmentCost(unsigned char* costs, const std::pair<float, float>& a,
+                               const std::pair<float, float>& b) {
+    float cost;
+    if (!lineCost(costs, toCell(a.first), toCell(a.second), toCell(b.first), toCell(b.second), cost))
+        return 0; // the original path is trusted as is
+    return cost;
+}
+
+} //end namespace global_planner
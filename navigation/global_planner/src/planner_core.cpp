@@ -40,12 +40,15 @@
 #include <tf/transform_listener.h>
 #include <costmap_2d/cost_values.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/nearest_cell.h>
 
 #include <global_planner/dijkstra.h>
 #include <global_planner/astar.h>
 #include <global_planner/grid_path.h>
 #include <global_planner/gradient_path.h>
 #include <global_planner/quadratic_calculator.h>
+#include <global_planner/theta_star.h>
+#include <global_planner/landmark_cache.h>
 
 //register this planner as a BaseGlobalPlanner plugin
 PLUGINLIB_DECLARE_CLASS(global_planner, PlannerCore, global_planner::PlannerCore, nav_core::BaseGlobalPlanner)
@@ -93,24 +96,52 @@ void PlannerCore::initialize(std::string name, costmap_2d::Costmap2DROS* costmap
         else
             p_calc_ = new PotentialCalculator(cx, cy);
 
-        bool use_dijkstra;
+        bool use_dijkstra, use_theta_star;
         private_nh.param("use_dijkstra", use_dijkstra, true);
-        if (use_dijkstra)
+        private_nh.param("use_theta_star", use_theta_star, false);
+        ThetaStarExpansion* theta_star = NULL;
+        astar_ = NULL;
+        if (use_theta_star)
+            planner_ = theta_star = new ThetaStarExpansion(p_calc_, cx, cy);
+        else if (use_dijkstra)
             planner_ = new DijkstraExpansion(p_calc_, cx, cy);
         else
-            planner_ = new AStarExpansion(p_calc_, cx, cy);
+            planner_ = astar_ = new AStarExpansion(p_calc_, cx, cy);
+
+        //landmark distances on the costmap, for the A* heuristic
+        bool use_landmarks;
+        private_nh.param("use_landmarks", use_landmarks, false);
+        landmarks_ = NULL;
+        neutral_cost_ = 50;
+        if (use_landmarks && astar_ == NULL)
+            ROS_WARN("Landmarks only speed up A*, set use_dijkstra to false to use them");
+        else if (use_landmarks) {
+            int landmark_count;
+            std::string landmark_cache_file;
+            private_nh.param("landmark_count", landmark_count, 8);
+            private_nh.param("landmark_cache_file", landmark_cache_file, std::string(""));
+            landmarks_ = new LandmarkCache(landmark_cache_file, landmark_count);
+        }
 
+        //theta* keeps the parents of the cells, which already form an any-angle path
         bool use_grid_path;
         private_nh.param("use_grid_path", use_grid_path, false);
-        if (use_grid_path)
+        if (use_theta_star)
+            path_maker_ = new ThetaStarPath(p_calc_, theta_star);
+        else if (use_grid_path)
             path_maker_ = new GridPath(p_calc_);
         else
             path_maker_ = new GradientPath(p_calc_);
 
+        private_nh.param("shorten_path", shorten_path_, false);
+        line_of_sight_ = new LineOfSight(cx, cy);
+
         plan_pub_ = private_nh.advertise<nav_msgs::Path>("plan", 1);
         potential_pub_ = private_nh.advertise<nav_msgs::OccupancyGrid>("potential", 1);
 
         private_nh.param("allow_unknown", allow_unknown_, true);
+        //only theta* crosses unknown space, dijkstra and A* keep it lethal and so do shortcuts of their paths
+        planner_->setHasUnknown(allow_unknown_);
         private_nh.param("planner_window_x", planner_window_x_, 0.0);
         private_nh.param("planner_window_y", planner_window_y_, 0.0);
         private_nh.param("default_tolerance", default_tolerance_, 0.0);
@@ -140,6 +171,10 @@ void PlannerCore::reconfigureCB(global_planner::GlobalPlannerConfig& config, uin
     path_maker_->setLethalCost(config.lethal_cost);
     planner_->setNeutralCost(config.neutral_cost);
     planner_->setFactor(config.cost_factor);
+    neutral_cost_ = config.neutral_cost;
+    line_of_sight_->setLethalCost(config.lethal_cost);
+    line_of_sight_->setNeutralCost(config.neutral_cost);
+    line_of_sight_->setFactor(config.cost_factor);
 }
 
 void PlannerCore::clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my) {
@@ -216,10 +251,18 @@ bool PlannerCore::makePlan(const geometry_msgs::PoseStamped& start, const geomet
     wx = goal.pose.position.x;
     wy = goal.pose.position.y;
 
-    if (!costmap->worldToMap(wx, wy, goal_x, goal_y)) {
-        ROS_WARN(
-                "The goal sent to the navfn planner is off the global costmap. Planning will always fail to this goal.");
-        return false;
+    bool goal_on_map = costmap->worldToMap(wx, wy, goal_x, goal_y);
+    if (!goal_on_map) {
+        if (tolerance <= 0.0) {
+            ROS_WARN(
+                    "The goal sent to the navfn planner is off the global costmap. Planning will always fail to this goal.");
+            return false;
+        }
+        //expand towards the closest cell on the map
+        int mx, my;
+        costmap->worldToMapEnforceBounds(wx, wy, mx, my);
+        goal_x = mx;
+        goal_y = my;
     }
 
     //clear the starting cell within the costmap because we know it can't be an obstacle
@@ -232,13 +275,29 @@ bool PlannerCore::makePlan(const geometry_msgs::PoseStamped& start, const geomet
     p_calc_->setSize(nx, ny);
     planner_->setSize(nx, ny);
     path_maker_->setSize(nx, ny);
+    line_of_sight_->setSize(nx, ny);
     potential_array_ = new float[nx * ny];
 
-    bool found_legal = planner_->calculatePotentials(costmap->getCharMap(), start_x, start_y, goal_x, goal_y,
-                                                    nx * ny * 2, potential_array_);
+    if (landmarks_)
+        astar_->setLandmarks(updateLandmarks() ? landmarks_ : NULL);
 
-    //**********************888
+    planner_->calculatePotentials(costmap->getCharMap(), start_x, start_y, goal_x, goal_y, nx * ny * 2,
+                                  potential_array_);
+    if (astar_)
+        ROS_DEBUG("A* expanded %d cells", astar_->getCellsVisited());
+
+    //search outward from the goal cell for the closest cell the potential reached
     double resolution = costmap->getResolution();
+    unsigned int best_x, best_y;
+    bool found_legal = costmap_2d::findNearestCell(*costmap, potential_array_, POT_HIGH, wx, wy, tolerance, best_x,
+                                                   best_y);
+
+    //keep the exact goal if its own cell was reached
+    geometry_msgs::PoseStamped best_pose = goal;
+    if (found_legal && (best_x != goal_x || best_y != goal_y || !goal_on_map))
+        costmap->mapToWorld(best_x, best_y, best_pose.pose.position.x, best_pose.pose.position.y);
+
+    //**********************888
     nav_msgs::OccupancyGrid grid;
     // Publish Whole Grid
     grid.header.frame_id = costmap_ros_->getGlobalFrameID();
@@ -278,9 +337,9 @@ bool PlannerCore::makePlan(const geometry_msgs::PoseStamped& start, const geomet
 
     if (found_legal) {
         //extract the plan
-        if (getPlanFromPotential(goal, plan)) {
+        if (getPlanFromPotential(best_pose, plan)) {
             //make sure the goal we push on has the same timestamp as the rest of the plan
-            geometry_msgs::PoseStamped goal_copy = goal;
+            geometry_msgs::PoseStamped goal_copy = best_pose;
             goal_copy.header.stamp = ros::Time::now();
             //plan.push_back(goal_copy);
         } else {
@@ -294,6 +353,13 @@ bool PlannerCore::makePlan(const geometry_msgs::PoseStamped& start, const geomet
     return !plan.empty();
 }
 
+bool PlannerCore::updateLandmarks() {
+    //the landmark distances have to be taken on the same costs the search runs on
+    costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+    return landmarks_->update(costmap->getCharMap(), costmap->getSizeInCellsX(), costmap->getSizeInCellsY(),
+                              neutral_cost_);
+}
+
 void PlannerCore::publishPlan(const std::vector<geometry_msgs::PoseStamped>& path, double r, double g, double b,
                               double a) {
     if (!initialized_) {
@@ -353,6 +419,10 @@ bool PlannerCore::getPlanFromPotential(const geometry_msgs::PoseStamped& goal,
         return false;
     }
 
+    //drop the waypoints that straight segments can skip
+    if (shorten_path_)
+        line_of_sight_->shortenPath(costmap->getCharMap(), path);
+
     ros::Time plan_time = ros::Time::now();
     for (unsigned int i = 0; i < path.size(); i++) {
         std::pair<float, float> point = path[i];
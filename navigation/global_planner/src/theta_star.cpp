@@ -0,0 +1,141 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <global_planner/theta_star.h>
+
+namespace global_planner {
+
+ThetaStarExpansion::ThetaStarExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), los_(nx, ny) {
+    setSize(nx, ny);
+}
+
+void ThetaStarExpansion::setSize(int nx, int ny) {
+    Expander::setSize(nx, ny);
+    los_.setSize(nx, ny);
+    parents_.resize(ns_);
+}
+
+bool ThetaStarExpansion::calculatePotentials(unsigned char* costs, int start_x, int start_y, int end_x, int end_y,
+                                            int cycles, float* potential) {
+    los_.setLethalCost(lethal_cost_);
+    los_.setNeutralCost(neutral_cost_);
+    los_.setFactor(factor_);
+    los_.setHasUnknown(unknown_);
+
+    queue_.clear();
+    std::fill(potential, potential + ns_, POT_HIGH);
+    std::fill(parents_.begin(), parents_.end(), -1);
+
+    int start_i = toIndex(start_x, start_y);
+    potential[start_i] = 0;
+    parents_[start_i] = start_i;
+    queue_.push_back(Index(start_i, 0));
+
+    int goal_i = toIndex(end_x, end_y);
+
+    for (int cycle = 0; cycle < cycles && queue_.size() > 0; cycle++) {
+        Index top = queue_[0];
+        std::pop_heap(queue_.begin(), queue_.end(), greater1());
+        queue_.pop_back();
+
+        int i = top.i;
+        if (i == goal_i)
+            return true;
+
+        // skip stale entries, the cell was improved after this one was queued
+        int x = i % nx_, y = i / nx_;
+        if (top.cost > potential[i] + hypotf(end_x - x, end_y - y) * neutral_cost_)
+            continue;
+
+        for (int yd = -1; yd <= 1; yd++)
+            for (int xd = -1; xd <= 1; xd++)
+                if (xd != 0 || yd != 0)
+                    add(costs, potential, i, x + xd, y + yd, end_x, end_y);
+    }
+
+    return false;
+}
+
+void ThetaStarExpansion::add(unsigned char* costs, float* potential, int current_i, int next_x, int next_y, int end_x,
+                             int end_y) {
+    if (next_x < 0 || next_x >= nx_ || next_y < 0 || next_y >= ny_)
+        return;
+
+    int next_i = toIndex(next_x, next_y);
+    if (los_.getCost(costs, next_i) >= lethal_cost_)
+        return;
+
+    // path 2: straight from the parent of the current cell
+    int parent_i = parents_[current_i];
+    float cost, next_potential;
+    if (los_.lineCost(costs, parent_i % nx_, parent_i / nx_, next_x, next_y, cost)) {
+        next_potential = potential[parent_i] + cost;
+    } else {
+        // path 1: through the current cell
+        los_.lineCost(costs, current_i % nx_, current_i / nx_, next_x, next_y, cost);
+        next_potential = potential[current_i] + cost;
+        parent_i = current_i;
+    }
+
+    if (next_potential >= potential[next_i])
+        return;
+
+    potential[next_i] = next_potential;
+    parents_[next_i] = parent_i;
+
+    float distance = hypotf(end_x - next_x, end_y - next_y);
+    queue_.push_back(Index(next_i, next_potential + distance * neutral_cost_));
+    std::push_heap(queue_.begin(), queue_.end(), greater1());
+}
+
+bool ThetaStarPath::getPath(float* potential, int end_x, int end_y, std::vector<std::pair<float, float> >& path) {
+    int i = getIndex(end_x, end_y);
+    if (potential[i] >= POT_HIGH)
+        return false;
+
+    // follow parents back to the start, whose parent is itself
+    for (int n = 0; n < xs_ * ys_; n++) {
+        path.push_back(std::make_pair((float) (i % xs_), (float) (i / xs_)));
+        int parent = expander_->getParent(i);
+        if (parent < 0)
+            return false;
+        if (parent == i)
+            return true;
+        i = parent;
+    }
+    return false;
+}
+
+} //end namespace global_planner
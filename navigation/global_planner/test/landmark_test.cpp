@@ -0,0 +1,169 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <gtest/gtest.h>
+#include <queue>
+#include <vector>
+#include <global_planner/astar.h>
+#include <global_planner/landmark_cache.h>
+
+using namespace global_planner;
+
+static const int NX = 120, NY = 80;
+static const unsigned char NEUTRAL = 50;
+
+// cost of the cheapest 4-connected path from every cell to the goal, entering a cell costs its A* step cost
+static std::vector<float> costToGoal(const std::vector<unsigned char>& costs, int goal_i) {
+    std::vector<float> d(NX * NY, POT_HIGH);
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    d[goal_i] = 0;
+    queue.push(Entry(0, goal_i));
+    while (!queue.empty()) {
+        Entry top = queue.top();
+        queue.pop();
+        int b = top.second;
+        if (top.first > d[b])
+            continue;
+        int x = b % NX, y = b / NX;
+        int neighbors[4] = { x > 0 ? b - 1 : -1, x < NX - 1 ? b + 1 : -1, y > 0 ? b - NX : -1,
+                             y < NY - 1 ? b + NX : -1 };
+        for (int n = 0; n < 4; n++) {
+            int a = neighbors[n];
+            if (a < 0)
+                continue;
+            float step = std::min(costs[b] + NEUTRAL, 255);
+            if (top.first + step < d[a]) {
+                d[a] = top.first + step;
+                queue.push(Entry(d[a], a));
+            }
+        }
+    }
+    return d;
+}
+
+static std::vector<unsigned char> makeMap() {
+    std::vector<unsigned char> costs(NX * NY, 0);
+    // walls with a gap at alternating ends
+    for (int w = 1; w < 4; w++) {
+        int gap = (w % 2) ? NY - 12 : 4;
+        for (int y = 0; y < NY; y++)
+            if (y < gap || y > gap + 6)
+                costs[y * NX + w * 30] = 254;
+    }
+    // a band of inflation like costs
+    for (int y = 30; y < 50; y++)
+        for (int x = 0; x < NX; x++)
+            if (costs[y * NX + x] == 0)
+                costs[y * NX + x] = (x * 7 + y * 13) % 120;
+    return costs;
+}
+
+class LandmarkTest : public testing::Test {
+    protected:
+        LandmarkTest() :
+                calculator_(NX, NY), astar_(&calculator_, NX, NY), landmarks_("", 6), potential_(NX * NY) {
+            astar_.setNeutralCost(NEUTRAL);
+        }
+
+        // plans with and without landmarks, both have to find the cheapest path
+        void checkPlans(std::vector<unsigned char>& costs) {
+            ASSERT_TRUE(landmarks_.update(&costs[0], NX, NY, NEUTRAL));
+            int ends[4][4] = { { 5, 5, 115, 75 }, { 115, 75, 5, 5 }, { 40, 40, 100, 10 }, { 2, 70, 60, 35 } };
+            for (int e = 0; e < 4; e++) {
+                int start_i = ends[e][1] * NX + ends[e][0], goal_i = ends[e][3] * NX + ends[e][2];
+                std::vector<float> exact = costToGoal(costs, goal_i);
+
+                astar_.setLandmarks(NULL);
+                ASSERT_TRUE(astar_.calculatePotentials(&costs[0], ends[e][0], ends[e][1], ends[e][2], ends[e][3],
+                                                       NX * NY * 2, &potential_[0]));
+                float plain_cost = potential_[goal_i];
+                int plain_visited = astar_.getCellsVisited();
+
+                astar_.setLandmarks(&landmarks_);
+                ASSERT_TRUE(astar_.calculatePotentials(&costs[0], ends[e][0], ends[e][1], ends[e][2], ends[e][3],
+                                                       NX * NY * 2, &potential_[0]));
+                EXPECT_EQ(exact[start_i], plain_cost) << "plan " << e;
+                EXPECT_EQ(exact[start_i], potential_[goal_i]) << "plan " << e;
+                EXPECT_LE(astar_.getCellsVisited(), plain_visited) << "plan " << e;
+
+                // the bound never overestimates
+                landmarks_.setGoal(goal_i);
+                for (int i = 0; i < NX * NY; i++)
+                    ASSERT_LE(landmarks_.heuristic(i), exact[i]) << "cell " << i % NX << ", " << i / NX;
+            }
+        }
+
+        PotentialCalculator calculator_;
+        AStarExpansion astar_;
+        LandmarkCache landmarks_;
+        std::vector<float> potential_;
+};
+
+TEST_F(LandmarkTest, same_path_cost)
+{
+    std::vector<unsigned char> costs = makeMap();
+    checkPlans(costs);
+}
+
+TEST_F(LandmarkTest, costmap_changes)
+{
+    std::vector<unsigned char> costs = makeMap();
+    checkPlans(costs);
+
+    // an obstacle shows up, the fields keep the old costs there
+    for (int y = 60; y < 70; y++)
+        for (int x = 60; x < 70; x++)
+            costs[y * NX + x] = 254;
+    checkPlans(costs);
+
+    // a wall gets a new gap and the band is cleared, paths through them get cheaper
+    for (int y = 20; y < 28; y++)
+        costs[y * NX + 60] = 0;
+    for (int i = 30 * NX; i < 50 * NX; i++)
+        if (costs[i] < 254)
+            costs[i] = 0;
+    checkPlans(costs);
+
+    // the obstacle goes away again
+    for (int y = 60; y < 70; y++)
+        for (int x = 60; x < 70; x++)
+            costs[y * NX + x] = 0;
+    checkPlans(costs);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,116 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <gtest/gtest.h>
+#include <vector>
+#include <global_planner/line_of_sight.h>
+
+using namespace global_planner;
+
+typedef std::vector<std::pair<float, float> > Path;
+
+TEST(LineOfSight, straight_line_through_free_space)
+{
+    std::vector<unsigned char> costs(20 * 20, costmap_2d::FREE_SPACE);
+    LineOfSight los(20, 20);
+
+    float cost;
+    ASSERT_TRUE(los.lineCost(&costs[0], 2, 3, 17, 11, cost));
+    // free cells cost neutral, times the length of the line
+    EXPECT_NEAR(50 * hypotf(15, 8), cost, 1e-3);
+
+    // a staircase through free space becomes a single segment
+    Path path;
+    for (int i = 0; i < 10; i++) {
+        path.push_back(std::make_pair((float) i, (float) (i / 2)));
+        path.push_back(std::make_pair((float) i + 0.5f, (float) (i / 2)));
+    }
+    los.shortenPath(&costs[0], path);
+    ASSERT_EQ(2u, path.size());
+    EXPECT_EQ(0.0f, path[0].first);
+    EXPECT_EQ(9.5f, path[1].first);
+}
+
+TEST(LineOfSight, blocked_line)
+{
+    std::vector<unsigned char> costs(20 * 20, costmap_2d::FREE_SPACE);
+    LineOfSight los(20, 20);
+
+    // a wall across x = 10, open above y = 15
+    for (int y = 0; y < 15; y++)
+        costs[y * 20 + 10] = costmap_2d::LETHAL_OBSTACLE;
+
+    float cost;
+    EXPECT_FALSE(los.lineCost(&costs[0], 2, 5, 17, 5, cost));
+    EXPECT_FALSE(los.lineCost(&costs[0], 2, 2, 17, 12, cost));
+    EXPECT_TRUE(los.lineCost(&costs[0], 2, 16, 17, 16, cost));
+
+    // a path around the wall keeps a waypoint on each side of its end
+    Path path;
+    for (int y = 5; y <= 17; y++)
+        path.push_back(std::make_pair(3.0f, (float) y));
+    for (int x = 4; x <= 16; x++)
+        path.push_back(std::make_pair((float) x, 17.0f));
+    for (int y = 16; y >= 5; y--)
+        path.push_back(std::make_pair(16.0f, (float) y));
+    los.shortenPath(&costs[0], path);
+
+    ASSERT_GT(path.size(), 2u);
+    ASSERT_LT(path.size(), 10u);
+    for (unsigned int i = 0; i + 1 < path.size(); i++)
+        EXPECT_TRUE(los.lineCost(&costs[0], (int) path[i].first, (int) path[i].second, (int) path[i + 1].first,
+                                 (int) path[i + 1].second, cost)) << "segment " << i;
+}
+
+TEST(LineOfSight, unknown_space)
+{
+    std::vector<unsigned char> costs(20 * 20, costmap_2d::FREE_SPACE);
+    for (int y = 0; y < 20; y++)
+        costs[y * 20 + 10] = costmap_2d::NO_INFORMATION;
+    LineOfSight los(20, 20);
+
+    // unknown cells cost as much as the most expensive free cell, like in the expanders
+    float cost;
+    los.setHasUnknown(true);
+    EXPECT_TRUE(los.lineCost(&costs[0], 2, 5, 17, 5, cost));
+    EXPECT_EQ(costmap_2d::LETHAL_OBSTACLE - 1, los.getCost(&costs[0], 5 * 20 + 10));
+
+    los.setHasUnknown(false);
+    EXPECT_FALSE(los.lineCost(&costs[0], 2, 5, 17, 5, cost));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,173 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <gtest/gtest.h>
+#include <vector>
+#include <global_planner/theta_star.h>
+#include <global_planner/dijkstra.h>
+
+using namespace global_planner;
+
+typedef std::vector<std::pair<float, float> > Path;
+
+static const int NX = 40, NY = 40;
+
+// free space inside a lethal border, like the planner outlines the costmap
+std::vector<unsigned char> makeMap() {
+    std::vector<unsigned char> costs(NX * NY, costmap_2d::FREE_SPACE);
+    for (int x = 0; x < NX; x++)
+        costs[x] = costs[(NY - 1) * NX + x] = costmap_2d::LETHAL_OBSTACLE;
+    for (int y = 0; y < NY; y++)
+        costs[y * NX] = costs[y * NX + NX - 1] = costmap_2d::LETHAL_OBSTACLE;
+    return costs;
+}
+
+// runs theta* from start to goal, the path goes from the goal back to the start
+bool planThetaStar(std::vector<unsigned char>& costs, bool allow_unknown, int start_x, int start_y, int goal_x,
+                   int goal_y, Path& path, float& path_cost) {
+    PotentialCalculator p_calc(NX, NY);
+    ThetaStarExpansion expander(&p_calc, NX, NY);
+    ThetaStarPath path_maker(&p_calc, &expander);
+    path_maker.setSize(NX, NY);
+    expander.setHasUnknown(allow_unknown);
+
+    std::vector<float> potential(NX * NY);
+    path.clear();
+    if (!expander.calculatePotentials(&costs[0], start_x, start_y, goal_x, goal_y, NX * NY * 2, &potential[0]))
+        return false;
+    if (!path_maker.getPath(&potential[0], goal_x, goal_y, path))
+        return false;
+    path_cost = potential[goal_x + NX * goal_y];
+    return true;
+}
+
+float planDijkstra(std::vector<unsigned char>& costs, bool allow_unknown, int start_x, int start_y, int goal_x,
+                   int goal_y) {
+    PotentialCalculator p_calc(NX, NY);
+    DijkstraExpansion expander(&p_calc, NX, NY);
+    expander.setSize(NX, NY);
+    expander.setHasUnknown(allow_unknown);
+
+    std::vector<float> potential(NX * NY);
+    expander.calculatePotentials(&costs[0], start_x, start_y, goal_x, goal_y, NX * NY * 2, &potential[0]);
+    return potential[goal_x + NX * goal_y];
+}
+
+// checks that the path runs from the goal to the start in straight segments, and returns what they cost
+float checkPath(std::vector<unsigned char>& costs, bool allow_unknown, const Path& path, int start_x, int start_y,
+                int goal_x, int goal_y) {
+    LineOfSight los(NX, NY);
+    los.setHasUnknown(allow_unknown);
+
+    EXPECT_GE(path.size(), 2u);
+    EXPECT_EQ(goal_x, (int) path.front().first);
+    EXPECT_EQ(goal_y, (int) path.front().second);
+    EXPECT_EQ(start_x, (int) path.back().first);
+    EXPECT_EQ(start_y, (int) path.back().second);
+
+    float total = 0, cost;
+    for (unsigned int i = 0; i + 1 < path.size(); i++) {
+        EXPECT_TRUE(los.lineCost(&costs[0], (int) path[i].first, (int) path[i].second, (int) path[i + 1].first,
+                                 (int) path[i + 1].second, cost)) << "segment " << i;
+        total += cost;
+    }
+    return total;
+}
+
+TEST(ThetaStar, around_walls)
+{
+    std::vector<unsigned char> costs = makeMap();
+    // two walls to wind around, the first open at the top and the second at the bottom
+    for (int y = 1; y < 30; y++)
+        costs[y * NX + 20] = costmap_2d::LETHAL_OBSTACLE;
+    for (int y = 10; y < NY - 1; y++)
+        costs[y * NX + 10] = costmap_2d::LETHAL_OBSTACLE;
+
+    Path path;
+    float path_cost;
+    ASSERT_TRUE(planThetaStar(costs, false, 4, 30, 35, 6, path, path_cost));
+    float segment_cost = checkPath(costs, false, path, 4, 30, 35, 6);
+    EXPECT_NEAR(path_cost, segment_cost, 1e-3 * path_cost);
+
+    // straight segments between the corners beat the grid
+    float grid_cost = planDijkstra(costs, false, 4, 30, 35, 6);
+    ASSERT_LT(grid_cost, POT_HIGH);
+    EXPECT_LE(path_cost, grid_cost);
+    EXPECT_LT(path.size(), 10u);
+}
+
+TEST(ThetaStar, unknown_space)
+{
+    std::vector<unsigned char> costs = makeMap();
+    // a band of unknown cells across the map with a gap far from the straight line
+    for (int y = 1; y < NY - 1; y++)
+        costs[y * NX + 20] = costmap_2d::NO_INFORMATION;
+    for (int y = 33; y < 36; y++)
+        costs[y * NX + 20] = costmap_2d::FREE_SPACE;
+
+    // without unknown space, the path goes through the gap
+    Path known_path;
+    float known_cost;
+    ASSERT_TRUE(planThetaStar(costs, false, 5, 5, 35, 5, known_path, known_cost));
+    checkPath(costs, false, known_path, 5, 5, 35, 5);
+
+    // with it, straight across the band
+    Path path;
+    float path_cost;
+    ASSERT_TRUE(planThetaStar(costs, true, 5, 5, 35, 5, path, path_cost));
+    checkPath(costs, true, path, 5, 5, 35, 5);
+    EXPECT_LT(path_cost, known_cost);
+    float cost;
+    LineOfSight known(NX, NY);
+    bool crosses_unknown = false;
+    for (unsigned int i = 0; i + 1 < path.size(); i++)
+        crosses_unknown |= !known.lineCost(&costs[0], (int) path[i].first, (int) path[i].second,
+                                           (int) path[i + 1].first, (int) path[i + 1].second, cost);
+    EXPECT_TRUE(crosses_unknown);
+
+    // closing the gap leaves no way through known space
+    for (int y = 33; y < 36; y++)
+        costs[y * NX + 20] = costmap_2d::NO_INFORMATION;
+    EXPECT_FALSE(planThetaStar(costs, false, 5, 5, 35, 5, path, path_cost));
+    EXPECT_TRUE(planThetaStar(costs, true, 5, 5, 35, 5, path, path_cost));
+
+    // dijkstra keeps unknown cells lethal either way
+    EXPECT_GE(planDijkstra(costs, true, 5, 5, 35, 5), POT_HIGH);
+    EXPECT_GE(planDijkstra(costs, false, 5, 5, 35, 5), POT_HIGH);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
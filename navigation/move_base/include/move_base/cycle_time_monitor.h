@@ -0,0 +1,79 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef MOVE_BASE_CYCLE_TIME_MONITOR_H_
+#define MOVE_BASE_CYCLE_TIME_MONITOR_H_
+
+#include <diagnostic_updater/diagnostic_updater.h>
+
+namespace move_base {
+  /**
+   * @class CycleTimeMonitor
+   * @brief Collects the timing of the control loop between two diagnostics reports:
+   * missed deadlines and a histogram of the jitter of the loop period
+   */
+  class CycleTimeMonitor {
+    public:
+      CycleTimeMonitor();
+
+      /**
+       * @brief  Record one control cycle
+       * @param period Time since the start of the previous cycle, zero or less if there was none
+       * @param desired_period The period the loop is supposed to run at
+       * @param work_time Time spent in the cycle before going to sleep
+       */
+      void addCycle(double period, double desired_period, double work_time);
+
+      /**
+       * @brief  Fill a diagnostics status with the statistics collected since the last report and start over
+       */
+      void report(diagnostic_updater::DiagnosticStatusWrapper& stat);
+
+      /**
+       * @brief  The fraction of cycles that may miss their deadline before the status is a warning
+       */
+      void setMaxMissRatio(double ratio){ max_miss_ratio_ = ratio; }
+
+    private:
+      void reset();
+
+      static const int NUM_BINS = 6;
+
+      unsigned int num_cycles_, num_missed_;
+      double total_work_time_, max_work_time_, max_jitter_;
+      unsigned int jitter_histogram_[NUM_BINS];
+      double max_miss_ratio_;
+  };
+};
+#endif
@@ -59,6 +59,12 @@
 #include <dynamic_reconfigure/server.h>
 #include "move_base/MoveBaseConfig.h"
 
+#include <move_base/path_smoother.h>
+#include <move_base/plan_mailbox.h>
+#include <move_base/cycle_time_monitor.h>
+
+#include <diagnostic_updater/diagnostic_updater.h>
+
 namespace move_base {
   //typedefs to help us out with the action server so that we don't hace to type so much
   typedef actionlib::SimpleActionServer<move_base_msgs::MoveBaseAction> MoveBaseActionServer;
@@ -158,6 +164,14 @@ namespace move_base {
 
       double distance(const geometry_msgs::PoseStamped& p1, const geometry_msgs::PoseStamped& p2);
 
+      /**
+       * @brief  Find the part of a plan that the robot has not passed yet
+       * @param pose The current pose of the robot
+       * @param plan The plan to prune
+       * @return The index of the pose in the plan closest to the robot
+       */
+      unsigned int findPlanStart(const geometry_msgs::PoseStamped& pose, const std::vector<geometry_msgs::PoseStamped>& plan);
+
       geometry_msgs::PoseStamped goalToGlobalFrame(const geometry_msgs::PoseStamped& goal_pose_msg);
 
       tf::TransformListener& tf_;
@@ -168,6 +182,7 @@ namespace move_base {
       costmap_2d::Costmap2DROS* planner_costmap_ros_, *controller_costmap_ros_;
 
       boost::shared_ptr<nav_core::BaseGlobalPlanner> planner_;
+      PathSmoother path_smoother_;
       std::string robot_base_frame_, global_frame_;
 
       std::vector<boost::shared_ptr<nav_core::RecoveryBehavior> > recovery_behaviors_;
@@ -192,10 +207,10 @@ namespace move_base {
       pluginlib::ClassLoader<nav_core::BaseLocalPlanner> blp_loader_;
       pluginlib::ClassLoader<nav_core::RecoveryBehavior> recovery_loader_;
 
-      //set up plan triple buffer
-      std::vector<geometry_msgs::PoseStamped>* planner_plan_;
-      std::vector<geometry_msgs::PoseStamped>* latest_plan_;
-      std::vector<geometry_msgs::PoseStamped>* controller_plan_;
+      //plans go from the planner thread to the controller through the mailbox, the
+      //controller keeps the part of the plan the robot has not passed yet
+      PlanMailbox plan_mailbox_;
+      std::vector<geometry_msgs::PoseStamped> controller_plan_;
 
       //set up the planner's thread
       bool runPlanner_;
@@ -213,7 +228,9 @@ namespace move_base {
       move_base::MoveBaseConfig last_config_;
       move_base::MoveBaseConfig default_config_;
       bool setup_, p_freq_change_, c_freq_change_;
-      bool new_global_plan_;
+
+      diagnostic_updater::Updater diagnostic_updater_;
+      CycleTimeMonitor cycle_monitor_;
   };
 };
 #endif
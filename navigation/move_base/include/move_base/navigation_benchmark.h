@@ -0,0 +1,162 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef MOVE_BASE_NAVIGATION_BENCHMARK_H_
+#define MOVE_BASE_NAVIGATION_BENCHMARK_H_
+
+#include <vector>
+#include <string>
+
+#include <costmap_2d/costmap_2d.h>
+
+namespace move_base {
+  /**
+   * @class BenchmarkWorld
+   * @brief The ground truth a benchmark robot drives in, loaded from a recorded map
+   */
+  class BenchmarkWorld {
+    public:
+      /**
+       * @brief  Load a map from a binary pgm file, the origin of the world is the lower left corner
+       * @param filename The file to load
+       * @param resolution The size of a pixel in meters
+       * @param raw_costmap True if the pixels are costmap values (like navfn's willow_costmap.pgm),
+       * false for map_server style images where dark pixels are occupied
+       * @return True if the map was loaded
+       */
+      bool load(const std::string& filename, double resolution, bool raw_costmap);
+
+      /**
+       * @brief  Whether a point is inside an obstacle, everything off the map is
+       */
+      bool isOccupied(double wx, double wy) const;
+
+      const costmap_2d::Costmap2D& getMap() const { return map_; }
+
+    private:
+      costmap_2d::Costmap2D map_; ///< @brief LETHAL_OBSTACLE for occupied cells, FREE_SPACE otherwise
+  };
+
+  /**
+   * @class BenchmarkConfig
+   * @brief One configuration of the navigation stack to benchmark, the defaults match
+   * the defaults of move_base, navfn and the dwa_local_planner
+   */
+  class BenchmarkConfig {
+    public:
+      BenchmarkConfig();
+
+      /**
+       * @brief  Set a parameter by the name it has here
+       * @return False if there is no such parameter
+       */
+      bool set(const std::string& key, double value);
+
+      std::string name;
+
+      //move_base
+      double controller_frequency, planner_frequency;
+      double xy_goal_tolerance, timeout;
+
+      //robot and sensor
+      double robot_radius, max_vel_x, max_rot_vel, acc_lim_x, acc_lim_theta;
+      double laser_range;
+      int laser_beams;
+
+      //costmaps
+      bool static_map; ///< @brief If false the costmaps only know what the laser has seen
+      double local_costmap_size, inflation_radius, cost_scaling_factor;
+
+      //plan smoothing, see move_base::PathSmoother
+      bool smooth_plan;
+      double smoothing_decimation, smoothing_max_curvature;
+
+      //planners
+      bool use_astar;
+      bool warm_start; ///< @brief DWAPlanner only
+      int local_planner; ///< @brief 0 for dwa_local_planner::DWAPlanner, 1 for base_local_planner::TrajectoryPlanner
+      int vx_samples, vth_samples;
+      int rollout_integration; ///< @brief A base_local_planner::SimpleTrajectoryGenerator::Integration, DWAPlanner only
+      bool refine; ///< @brief Refine the best sample like dwa_local_planner::MPCPlannerROS, DWAPlanner only
+      int mpc_intervals, mpc_iterations;
+      double sim_time, path_distance_bias, goal_distance_bias, occdist_scale;
+  };
+
+  /**
+   * @class BenchmarkResult
+   * @brief What happened on one run from start to goal
+   */
+  class BenchmarkResult {
+    public:
+      BenchmarkResult() : reached_goal(false), time_to_goal(0.0), path_length(0.0), wall_time(0.0) {}
+
+      /**
+       * @brief  The p-th percentile (0 to 100) of a set of samples, zero if there are none
+       */
+      static double percentile(std::vector<double> samples, double p);
+
+      bool reached_goal;
+      std::string failure; ///< @brief Why the goal was not reached
+      double time_to_goal; ///< @brief Simulated time in seconds
+      double path_length; ///< @brief Distance driven in meters
+      double wall_time; ///< @brief Time it took to run the benchmark in seconds
+      std::vector<double> planner_latencies, controller_latencies; ///< @brief In seconds, one per call
+  };
+
+  /**
+   * @class NavigationBenchmark
+   * @brief Drives a simulated differential drive robot with a laser from a start to a
+   * goal, with layered costmaps, navfn as the global planner and the DWAPlanner or the
+   * TrajectoryPlanner as the local planner. The local planners read their parameters from
+   * the parameter server, so it needs a ROS master. It runs as fast as the planners
+   * allow, on simulated time, so results only depend on the configuration.
+   */
+  class NavigationBenchmark {
+    public:
+      NavigationBenchmark(const BenchmarkWorld& world) : world_(world) {}
+
+      /**
+       * @brief  Run one configuration from start to goal
+       * @param config The configuration to run
+       * @param start_x, start_y, start_th The start pose of the robot in the world
+       * @param goal_x, goal_y The goal position
+       */
+      BenchmarkResult run(const BenchmarkConfig& config, double start_x, double start_y, double start_th,
+          double goal_x, double goal_y);
+
+    private:
+      const BenchmarkWorld& world_;
+  };
+};
+#endif
@@ -0,0 +1,133 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef MOVE_BASE_PATH_SMOOTHER_H_
+#define MOVE_BASE_PATH_SMOOTHER_H_
+
+#include <vector>
+#include <string>
+
+#include <ros/ros.h>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/PoseStamped.h>
+
+namespace move_base {
+  /**
+   * @class PathSmoother
+   * @brief Post-processes global plans before they are handed to the local planner:
+   * gradient smoothing against the costmap, decimation and curvature limiting
+   */
+  class PathSmoother {
+    public:
+      PathSmoother();
+
+      /**
+       * @brief  Load the smoothing parameters, ~path_smoother/... provides the defaults
+       * and ~<planner_name>/path_smoother/... overrides them for a given planner
+       * @param planner_name The name the global planner was initialized with
+       */
+      void initialize(const std::string& planner_name);
+
+      /**
+       * @brief  Whether smoothing is turned on for the current planner
+       */
+      bool isEnabled() const { return enabled_; }
+
+      /**
+       * @brief  Smooth a plan in place, the start and goal poses are kept
+       * @param costmap The costmap the plan was made on, must be locked by the caller
+       * @param plan The plan to smooth, expected to be in the costmap's frame
+       * @return True if the plan was modified, false if it was left untouched
+       */
+      bool smooth(const costmap_2d::Costmap2D& costmap, std::vector<geometry_msgs::PoseStamped>& plan);
+
+      void setWeights(double weight_data, double weight_smooth, double weight_costmap);
+      void setLimits(int max_iterations, double max_time, double tolerance);
+      void setDecimationDistance(double distance){ decimation_distance_ = distance; }
+      void setMaxCurvature(double curvature){ max_curvature_ = curvature; }
+      void setEnabled(bool enabled){ enabled_ = enabled; }
+
+    private:
+      /**
+       * @brief  Gradient descent on data fidelity + smoothness + costmap terms
+       * @return The number of iterations run
+       */
+      int smoothPoints(const costmap_2d::Costmap2D& costmap, const ros::WallTime& start);
+
+      /**
+       * @brief  Drop points closer than decimation_distance_ to the last kept one,
+       * as long as the shortcut does not cross higher cost than the points it replaces
+       */
+      void decimatePoints(const costmap_2d::Costmap2D& costmap);
+
+      /**
+       * @brief  Pull points whose curvature exceeds max_curvature_ towards their neighbours' midpoint
+       */
+      void limitCurvature(const costmap_2d::Costmap2D& costmap, const ros::WallTime& start);
+
+      /**
+       * @brief  Cost of the cell under a world point, NO_INFORMATION off the map
+       */
+      unsigned char pointCost(const costmap_2d::Costmap2D& costmap, double wx, double wy) const;
+
+      /**
+       * @brief  Cost of a cell, NO_INFORMATION off the map
+       */
+      unsigned char cellCost(const costmap_2d::Costmap2D& costmap, int mx, int my) const;
+
+      /**
+       * @brief  Highest cost of the cells the segment between two points touches
+       */
+      unsigned char segmentCost(const costmap_2d::Costmap2D& costmap, double x0, double y0, double x1, double y1) const;
+
+      /**
+       * @brief  Check whether point i may move to a new position without its segments to the neighbouring points
+       * getting closer to an obstacle than allowed
+       */
+      bool moveAllowed(const costmap_2d::Costmap2D& costmap, unsigned int i, double tx, double ty) const;
+
+      double pathLength() const;
+
+      bool outOfTime(const ros::WallTime& start) const;
+
+      bool enabled_;
+      double weight_data_, weight_smooth_, weight_costmap_;
+      int max_iterations_;
+      double max_time_, tolerance_;
+      double decimation_distance_, max_curvature_;
+
+      std::vector<double> xs_, ys_, orig_xs_, orig_ys_;
+  };
+};
+#endif
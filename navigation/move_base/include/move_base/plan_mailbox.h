@@ -0,0 +1,102 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef MOVE_BASE_PLAN_MAILBOX_H_
+#define MOVE_BASE_PLAN_MAILBOX_H_
+
+#include <vector>
+#include <geometry_msgs/PoseStamped.h>
+
+namespace move_base {
+  /**
+   * @class PlanMailbox
+   * @brief Hands global plans from the planner thread to the controller without a lock
+   *
+   * A triple buffer: the producer fills its own buffer and swaps it with the shared
+   * one, the consumer swaps its own buffer with the shared one when a new plan was
+   * posted. The swaps are single atomic exchanges, so neither side ever waits for the
+   * other, and the consumer always gets the most recent plan. There must be at most
+   * one producer and one consumer at a time.
+   */
+  class PlanMailbox {
+    public:
+      PlanMailbox();
+
+      /**
+       * @brief  The producer's buffer, to be filled with the next plan
+       */
+      std::vector<geometry_msgs::PoseStamped>& writeBuffer() { return buffers_[back_]; }
+
+      /**
+       * @brief  Post the contents of the write buffer as the latest plan, the write
+       * buffer is then replaced by a stale one
+       */
+      void post();
+
+      /**
+       * @brief  Whether a plan was posted that the consumer has not taken yet
+       */
+      bool hasNewPlan() const { return (shared_ & FRESH) != 0; }
+
+      /**
+       * @brief  Make the latest posted plan the read buffer
+       * @return True if there was a new plan, false if the read buffer is unchanged
+       */
+      bool take();
+
+      /**
+       * @brief  The consumer's buffer, holds the plan last taken
+       */
+      const std::vector<geometry_msgs::PoseStamped>& readBuffer() const { return buffers_[front_]; }
+
+      /**
+       * @brief  Drop any plan that was posted but not taken, and empty the read buffer.
+       * Called from the consumer side
+       */
+      void discard();
+
+    private:
+      static const int FRESH = 4;
+
+      /**
+       * @brief  Atomically store value in the shared slot and return what was there
+       */
+      int exchange(int value);
+
+      std::vector<geometry_msgs::PoseStamped> buffers_[3];
+      int back_, front_; ///< @brief Owned by the producer and the consumer respectively
+      volatile int shared_; ///< @brief Index of the shared buffer, or'd with FRESH once posted
+  };
+};
+#endif
@@ -0,0 +1,100 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <move_base/cycle_time_monitor.h>
+#include <cmath>
+#include <algorithm>
+#include <boost/lexical_cast.hpp>
+
+namespace move_base {
+
+  //upper edges of the jitter bins in percent of the desired period, the last bin is open
+  static const int jitter_bin_edges[] = {5, 10, 25, 50, 100};
+
+  CycleTimeMonitor::CycleTimeMonitor() : max_miss_ratio_(0.05) {
+    reset();
+  }
+
+  void CycleTimeMonitor::reset(){
+    num_cycles_ = 0;
+    num_missed_ = 0;
+    total_work_time_ = 0.0;
+    max_work_time_ = 0.0;
+    max_jitter_ = 0.0;
+    for(int i = 0; i < NUM_BINS; ++i)
+      jitter_histogram_[i] = 0;
+  }
+
+  void CycleTimeMonitor::addCycle(double period, double desired_period, double work_time){
+    num_cycles_++;
+    total_work_time_ += work_time;
+    max_work_time_ = std::max(max_work_time_, work_time);
+    if(work_time > desired_period)
+      num_missed_++;
+
+    //the first cycle of a goal has no previous one to measure the period against
+    if(period <= 0.0 || desired_period <= 0.0)
+      return;
+
+    double jitter = fabs(period - desired_period) / desired_period;
+    max_jitter_ = std::max(max_jitter_, jitter);
+    int bin = 0;
+    while(bin < NUM_BINS - 1 && 100.0 * jitter >= jitter_bin_edges[bin])
+      bin++;
+    jitter_histogram_[bin]++;
+  }
+
+  void CycleTimeMonitor::report(diagnostic_updater::DiagnosticStatusWrapper& stat){
+    if(num_cycles_ == 0){
+      stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "No control cycles since the last report");
+      return;
+    }
+
+    if(num_missed_ > max_miss_ratio_ * num_cycles_)
+      stat.summaryf(diagnostic_msgs::DiagnosticStatus::WARN, "%u of %u cycles missed their deadline", num_missed_, num_cycles_);
+    else
+      stat.summaryf(diagnostic_msgs::DiagnosticStatus::OK, "%u of %u cycles missed their deadline", num_missed_, num_cycles_);
+
+    stat.add("Cycles", num_cycles_);
+    stat.add("Missed deadlines", num_missed_);
+    stat.add("Mean cycle time", total_work_time_ / num_cycles_);
+    stat.add("Max cycle time", max_work_time_);
+    stat.add("Max jitter", max_jitter_);
+    for(int i = 0; i < NUM_BINS - 1; ++i)
+      stat.add("Jitter < " + boost::lexical_cast<std::string>(jitter_bin_edges[i]) + "%", jitter_histogram_[i]);
+    stat.add("Jitter >= " + boost::lexical_cast<std::string>(jitter_bin_edges[NUM_BINS - 2]) + "%", jitter_histogram_[NUM_BINS - 1]);
+
+    reset();
+  }
+};
@@ -37,6 +37,7 @@
 *********************************************************************/
 #include <move_base/move_base.h>
 #include <cmath>
+#include <cfloat>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/thread.hpp>
@@ -52,8 +53,7 @@ namespace move_base {
     bgp_loader_("nav_core", "nav_core::BaseGlobalPlanner"),
     blp_loader_("nav_core", "nav_core::BaseLocalPlanner"), 
     recovery_loader_("nav_core", "nav_core::RecoveryBehavior"),
-    planner_plan_(NULL), latest_plan_(NULL), controller_plan_(NULL),
-    runPlanner_(false), setup_(false), p_freq_change_(false), c_freq_change_(false), new_global_plan_(false) {
+    runPlanner_(false), setup_(false), p_freq_change_(false), c_freq_change_(false) {
 
     as_ = new MoveBaseActionServer(ros::NodeHandle(), "move_base", boost::bind(&MoveBase::executeCb, this, _1), false);
 
@@ -76,11 +76,6 @@ namespace move_base {
     private_nh.param("oscillation_timeout", oscillation_timeout_, 0.0);
     private_nh.param("oscillation_distance", oscillation_distance_, 0.5);
 
-    //set up plan triple buffer
-    planner_plan_ = new std::vector<geometry_msgs::PoseStamped>();
-    latest_plan_ = new std::vector<geometry_msgs::PoseStamped>();
-    controller_plan_ = new std::vector<geometry_msgs::PoseStamped>();
-
     //set up the planner's thread
     planner_thread_ = new boost::thread(boost::bind(&MoveBase::planThread, this));
 
@@ -107,6 +102,13 @@ namespace move_base {
     private_nh.param("clearing_rotation_allowed", clearing_rotation_allowed_, true);
     private_nh.param("recovery_behavior_enabled", recovery_behavior_enabled_, true);
 
+    //report the timing of the control loop on /diagnostics
+    double max_missed_cycles;
+    private_nh.param("max_missed_cycles", max_missed_cycles, 0.05);
+    cycle_monitor_.setMaxMissRatio(max_missed_cycles);
+    diagnostic_updater_.setHardwareID("none");
+    diagnostic_updater_.add("Controller loop", &cycle_monitor_, &CycleTimeMonitor::report);
+
     //create the ros wrapper for the planner's costmap... and initializer a pointer we'll use with the underlying map
     planner_costmap_ros_ = new costmap_2d::Costmap2DROS("global_costmap", tf_);
     planner_costmap_ros_->pause();
@@ -129,6 +131,7 @@ namespace move_base {
 
       planner_ = bgp_loader_.createInstance(global_planner);
       planner_->initialize(bgp_loader_.getName(global_planner), planner_costmap_ros_);
+      path_smoother_.initialize(bgp_loader_.getName(global_planner));
     } catch (const pluginlib::PluginlibException& ex)
     {
       ROS_FATAL("Failed to create the %s planner, are you sure it is properly registered and that the containing library is built? Exception: %s", global_planner.c_str(), ex.what());
@@ -262,12 +265,13 @@ namespace move_base {
         // wait for the current planner to finish planning
         boost::unique_lock<boost::mutex> lock(planner_mutex_);
 
-        // Clean up before initializing the new planner
-        planner_plan_->clear();
-        latest_plan_->clear();
-        controller_plan_->clear();
+        // Clean up before initializing the new planner, the configuration mutex
+        // keeps the controller out so we can act as the consumer of the mailbox
+        plan_mailbox_.discard();
+        controller_plan_.clear();
         resetState();
         planner_->initialize(bgp_loader_.getName(config.base_global_planner), planner_costmap_ros_);
+        path_smoother_.initialize(bgp_loader_.getName(config.base_global_planner));
 
         lock.unlock();
       } catch (const pluginlib::PluginlibException& ex)
@@ -298,9 +302,8 @@ namespace move_base {
         }
         tc_ = blp_loader_.createInstance(config.base_local_planner);
         // Clean up before initializing the new planner
-        planner_plan_->clear();
-        latest_plan_->clear();
-        controller_plan_->clear();
+        plan_mailbox_.discard();
+        controller_plan_.clear();
         resetState();
         tc_->initialize(blp_loader_.getName(config.base_local_planner), &tf_, controller_costmap_ros_);
       } catch (const pluginlib::PluginlibException& ex)
@@ -457,10 +460,6 @@ namespace move_base {
 
     planner_thread_->interrupt();
     planner_thread_->join();
-
-    delete planner_plan_;
-    delete latest_plan_;
-    delete controller_plan_;
   }
 
   bool MoveBase::makePlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan){
@@ -491,6 +490,15 @@ namespace move_base {
       return false;
     }
 
+    //smooth the plan before the controller gets it, we still hold the costmap lock here
+    if(path_smoother_.isEnabled()){
+      if(plan.front().header.frame_id == planner_costmap_ros_->getGlobalFrameID())
+        path_smoother_.smooth(*(planner_costmap_ros_->getCostmap()), plan);
+      else
+        ROS_WARN_THROTTLE(1.0, "The plan is in the %s frame but the planner costmap is in %s, not smoothing it",
+            plan.front().header.frame_id.c_str(), planner_costmap_ros_->getGlobalFrameID().c_str());
+    }
+
     return true;
   }
 
@@ -582,19 +590,17 @@ namespace move_base {
       ROS_DEBUG_NAMED("move_base_plan_thread","Planning...");
 
       //run planner
-      planner_plan_->clear();
-      bool gotPlan = n.ok() && makePlan(temp_goal, *planner_plan_);
+      std::vector<geometry_msgs::PoseStamped>& planner_plan = plan_mailbox_.writeBuffer();
+      planner_plan.clear();
+      bool gotPlan = n.ok() && makePlan(temp_goal, planner_plan);
 
       if(gotPlan){
-        ROS_DEBUG_NAMED("move_base_plan_thread","Got Plan with %zu points!", planner_plan_->size());
-        //pointer swap the plans under mutex (the controller will pull from latest_plan_)
-        std::vector<geometry_msgs::PoseStamped>* temp_plan = planner_plan_;
+        ROS_DEBUG_NAMED("move_base_plan_thread","Got Plan with %zu points!", planner_plan.size());
+        //hand the plan to the controller, this never waits on the controller
+        plan_mailbox_.post();
 
         lock.lock();
-        planner_plan_ = latest_plan_;
-        latest_plan_ = temp_plan;
         last_valid_plan_ = ros::Time::now();
-        new_global_plan_ = true;
 
         ROS_DEBUG_NAMED("move_base_plan_thread","Generated a plan from the base_global_planner");
 
@@ -659,6 +665,7 @@ namespace move_base {
     last_oscillation_reset_ = ros::Time::now();
 
     ros::NodeHandle n;
+    ros::WallTime last_start;
     while(n.ok())
     {
       if(c_freq_change_)
@@ -753,6 +760,11 @@ namespace move_base {
       ros::WallDuration t_diff = ros::WallTime::now() - start;
       ROS_DEBUG_NAMED("move_base","Full control cycle time: %.9f\n", t_diff.toSec());
 
+      double period = last_start.isZero() ? 0.0 : (start - last_start).toSec();
+      last_start = start;
+      cycle_monitor_.addCycle(period, 1 / controller_frequency_, t_diff.toSec());
+      diagnostic_updater_.update();
+
       r.sleep();
       //make sure to sleep for the remainder of our cycle time
       if(r.cycleTime() > ros::Duration(1 / controller_frequency_) && state_ == CONTROLLING)
@@ -776,6 +788,24 @@ namespace move_base {
         + (p1.pose.position.y - p2.pose.position.y) * (p1.pose.position.y - p2.pose.position.y));
   }
 
+  unsigned int MoveBase::findPlanStart(const geometry_msgs::PoseStamped& pose, const std::vector<geometry_msgs::PoseStamped>& plan)
+  {
+    //the plan starts where the robot was when planning began, walk along it until
+    //it clearly leaves the robot behind and keep the closest pose seen so far
+    unsigned int closest = 0;
+    double closest_dist = DBL_MAX;
+    for(unsigned int i = 0; i < plan.size(); ++i){
+      double dist = distance(pose, plan[i]);
+      if(dist < closest_dist){
+        closest_dist = dist;
+        closest = i;
+      }
+      else if(dist > closest_dist + 1.0)
+        break;
+    }
+    return closest;
+  }
+
   bool MoveBase::executeCycle(geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& global_plan){
     boost::recursive_mutex::scoped_lock ecl(configuration_mutex_);
     //we need to be able to publish velocity commands
@@ -811,28 +841,20 @@ namespace move_base {
     }
 
     //if we have a new plan then grab it and give it to the controller
-    if(new_global_plan_){
-      //make sure to set the new plan flag to false
-      new_global_plan_ = false;
-
-      ROS_DEBUG_NAMED("move_base","Got a new plan...swap pointers");
-
-      //do a pointer swap under mutex
-      std::vector<geometry_msgs::PoseStamped>* temp_plan = controller_plan_;
-
-      boost::unique_lock<boost::mutex> lock(planner_mutex_);
-      controller_plan_ = latest_plan_;
-      latest_plan_ = temp_plan;
-      lock.unlock();
-      ROS_DEBUG_NAMED("move_base","pointers swapped!");
-
-      if(!tc_->setPlan(*controller_plan_)){
+    if(plan_mailbox_.take()){
+      //the planner may have taken a while, only pass on what the robot has not passed yet
+      const std::vector<geometry_msgs::PoseStamped>& latest_plan = plan_mailbox_.readBuffer();
+      unsigned int plan_start = findPlanStart(current_position, latest_plan);
+      controller_plan_.assign(latest_plan.begin() + plan_start, latest_plan.end());
+      ROS_DEBUG_NAMED("move_base","Got a new plan, skipped %u of its %zu poses", plan_start, latest_plan.size());
+
+      if(!tc_->setPlan(controller_plan_)){
         //ABORT and SHUTDOWN COSTMAPS
         ROS_ERROR("Failed to pass global plan to the controller, aborting.");
         resetState();
 
         //disable the planner thread
-        lock.lock();
+        boost::unique_lock<boost::mutex> lock(planner_mutex_);
         runPlanner_ = false;
         lock.unlock();
 
@@ -886,6 +908,8 @@ namespace move_base {
         
         {
          boost::unique_lock< boost::shared_mutex > lock(*(controller_costmap_ros_->getCostmap()->getLock()));
+         //everything in the costmap now reaches the local planner
+         controller_costmap_ros_->getLayeredCostmap()->getLatencyTracer()->costmapRead();
         
         if(tc_->computeVelocityCommands(cmd_vel)){
           ROS_DEBUG_NAMED( "move_base", "Got a valid command from the local planner: %.3lf, %.3lf, %.3lf",
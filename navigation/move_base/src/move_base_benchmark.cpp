@@ -0,0 +1,149 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <move_base/navigation_benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/algorithm/string.hpp>
+#include <ros/ros.h>
+
+void usage(const char* name){
+  fprintf(stderr,
+      "Usage: %s [options] --start x y theta --goal x y map.pgm\n"
+      "Runs the navigation stack from start to goal on a recorded map, needs a ROS master\n"
+      "  --resolution r     size of a map pixel in meters (default 0.05)\n"
+      "  --raw              the map holds costmap values, like navfn's willow_costmap.pgm\n"
+      "  --repeat n         run each configuration n times to collect latencies (default 1)\n"
+      "  --config name:key=value,...\n"
+      "                     a configuration to benchmark, may be given more than once,\n"
+      "                     see move_base::BenchmarkConfig for the keys\n", name);
+}
+
+int main(int argc, char** argv){
+  ros::init(argc, argv, "move_base_benchmark", ros::init_options::AnonymousName);
+
+  std::string map_file;
+  double resolution = 0.05;
+  bool raw = false;
+  int repeat = 1;
+  double start[3], goal[2];
+  bool have_start = false, have_goal = false;
+  std::vector<move_base::BenchmarkConfig> configs;
+
+  for(int i = 1; i < argc; ++i){
+    if(!strcmp(argv[i], "--resolution") && i + 1 < argc)
+      resolution = atof(argv[++i]);
+    else if(!strcmp(argv[i], "--raw"))
+      raw = true;
+    else if(!strcmp(argv[i], "--repeat") && i + 1 < argc)
+      repeat = std::max(1, atoi(argv[++i]));
+    else if(!strcmp(argv[i], "--start") && i + 3 < argc){
+      for(int j = 0; j < 3; ++j)
+        start[j] = atof(argv[++i]);
+      have_start = true;
+    }
+    else if(!strcmp(argv[i], "--goal") && i + 2 < argc){
+      for(int j = 0; j < 2; ++j)
+        goal[j] = atof(argv[++i]);
+      have_goal = true;
+    }
+    else if(!strcmp(argv[i], "--config") && i + 1 < argc){
+      std::string spec = argv[++i];
+      move_base::BenchmarkConfig config;
+      size_t colon = spec.find(':');
+      config.name = spec.substr(0, colon);
+      std::vector<std::string> settings;
+      if(colon != std::string::npos){
+        std::string setting_list = spec.substr(colon + 1);
+        boost::split(settings, setting_list, boost::is_any_of(","));
+      }
+      for(unsigned int j = 0; j < settings.size(); ++j){
+        size_t equals = settings[j].find('=');
+        if(equals == std::string::npos || !config.set(settings[j].substr(0, equals), atof(settings[j].substr(equals + 1).c_str()))){
+          fprintf(stderr, "Unknown setting %s in configuration %s\n", settings[j].c_str(), config.name.c_str());
+          return 1;
+        }
+      }
+      configs.push_back(config);
+    }
+    else if(argv[i][0] != '-' && map_file.empty())
+      map_file = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if(map_file.empty() || !have_start || !have_goal){
+    usage(argv[0]);
+    return 1;
+  }
+  if(configs.empty())
+    configs.push_back(move_base::BenchmarkConfig());
+
+  move_base::BenchmarkWorld world;
+  if(!world.load(map_file, resolution, raw))
+    return 1;
+  move_base::NavigationBenchmark benchmark(world);
+
+  printf("%-16s %-9s %9s %9s %8s   %-29s   %-29s\n", "config", "result", "time [s]", "path [m]", "rt factor",
+      "planner p50/p90/p99/max [ms]", "controller p50/p90/p99/max [ms]");
+  for(unsigned int i = 0; i < configs.size(); ++i){
+    //the runs are deterministic up to the latencies, which are pooled
+    move_base::BenchmarkResult result;
+    std::vector<double> planner_latencies, controller_latencies;
+    double wall_time = 0.0;
+    for(int r = 0; r < repeat; ++r){
+      result = benchmark.run(configs[i], start[0], start[1], start[2], goal[0], goal[1]);
+      planner_latencies.insert(planner_latencies.end(), result.planner_latencies.begin(), result.planner_latencies.end());
+      controller_latencies.insert(controller_latencies.end(), result.controller_latencies.begin(), result.controller_latencies.end());
+      wall_time += result.wall_time;
+    }
+
+    printf("%-16s %-9s %9.2f %9.2f %8.1fx   %6.2f %6.2f %6.2f %7.2f   %6.2f %6.2f %6.2f %7.2f\n",
+        configs[i].name.c_str(), result.reached_goal ? "reached" : result.failure.c_str(),
+        result.time_to_goal, result.path_length, result.time_to_goal * repeat / wall_time,
+        1000 * move_base::BenchmarkResult::percentile(planner_latencies, 50),
+        1000 * move_base::BenchmarkResult::percentile(planner_latencies, 90),
+        1000 * move_base::BenchmarkResult::percentile(planner_latencies, 99),
+        1000 * move_base::BenchmarkResult::percentile(planner_latencies, 100),
+        1000 * move_base::BenchmarkResult::percentile(controller_latencies, 50),
+        1000 * move_base::BenchmarkResult::percentile(controller_latencies, 90),
+        1000 * move_base::BenchmarkResult::percentile(controller_latencies, 99),
+        1000 * move_base::BenchmarkResult::percentile(controller_latencies, 100));
+  }
+  return 0;
+}
@@ -0,0 +1,634 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <move_base/navigation_benchmark.h>
+#include <move_base/path_smoother.h>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ros/ros.h>
+#include <tf/transform_datatypes.h>
+#include <costmap_2d/cost_values.h>
+#include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/inflation_layer.h>
+#include <navfn/navfn.h>
+#include <base_local_planner/local_planner_limits.h>
+#include <base_local_planner/local_planner_util.h>
+#include <base_local_planner/costmap_model.h>
+#include <base_local_planner/trajectory_planner.h>
+#include <dwa_local_planner/dwa_planner.h>
+
+using costmap_2d::LETHAL_OBSTACLE;
+using costmap_2d::FREE_SPACE;
+
+namespace move_base {
+
+  bool BenchmarkWorld::load(const std::string& filename, double resolution, bool raw_costmap){
+    FILE* file = fopen(filename.c_str(), "rb");
+    if(file == NULL){
+      fprintf(stderr, "Can't open map %s\n", filename.c_str());
+      return false;
+    }
+
+    //header: magic number, width, height and maximum value, possibly with comments in between
+    char magic[3] = {0, 0, 0};
+    int header[3];
+    bool valid = fread(magic, 1, 2, file) == 2 && magic[0] == 'P' && magic[1] == '5';
+    for(int i = 0; valid && i < 3; ++i){
+      int c;
+      while((c = fgetc(file)) == '#' || isspace(c)){
+        if(c == '#')
+          while((c = fgetc(file)) != '\n' && c != EOF);
+      }
+      ungetc(c, file);
+      valid = fscanf(file, "%d", &header[i]) == 1;
+    }
+    //a single whitespace separates the header from the pixels
+    valid = valid && isspace(fgetc(file)) && header[0] > 0 && header[1] > 0 && header[2] > 0 && header[2] < 256;
+    if(!valid){
+      fprintf(stderr, "%s is not a binary pgm file\n", filename.c_str());
+      fclose(file);
+      return false;
+    }
+
+    unsigned int size_x = header[0], size_y = header[1];
+    std::vector<unsigned char> pixels(size_x * size_y);
+    size_t read = fread(&pixels[0], 1, pixels.size(), file);
+    fclose(file);
+    if(read != pixels.size()){
+      fprintf(stderr, "%s is truncated\n", filename.c_str());
+      return false;
+    }
+
+    map_.resizeMap(size_x, size_y, resolution, 0.0, 0.0);
+    for(unsigned int row = 0; row < size_y; ++row){
+      for(unsigned int col = 0; col < size_x; ++col){
+        unsigned char value = pixels[row * size_x + col] * 255 / header[2];
+        bool occupied;
+        if(raw_costmap)
+          occupied = value >= LETHAL_OBSTACLE;
+        else
+          //anything that is not clearly free in the image counts as occupied
+          occupied = (255 - value) / 255.0 > 0.196;
+        //the first row of the image is the top of the map
+        map_.setCost(col, size_y - 1 - row, occupied ? LETHAL_OBSTACLE : FREE_SPACE);
+      }
+    }
+    return true;
+  }
+
+  bool BenchmarkWorld::isOccupied(double wx, double wy) const {
+    unsigned int mx, my;
+    if(!map_.worldToMap(wx, wy, mx, my))
+      return true;
+    return map_.getCost(mx, my) == LETHAL_OBSTACLE;
+  }
+
+  BenchmarkConfig::BenchmarkConfig() :
+    name("default"),
+    controller_frequency(20.0), planner_frequency(0.0),
+    xy_goal_tolerance(0.1), timeout(300.0),
+    robot_radius(0.2), max_vel_x(0.55), max_rot_vel(1.0), acc_lim_x(2.5), acc_lim_theta(3.2),
+    laser_range(10.0), laser_beams(360),
+    static_map(true), local_costmap_size(6.0), inflation_radius(0.55), cost_scaling_factor(10.0),
+    smooth_plan(false), smoothing_decimation(0.0), smoothing_max_curvature(0.0),
+    use_astar(false), warm_start(false), local_planner(0), vx_samples(3), vth_samples(20), rollout_integration(0),
+    refine(false), mpc_intervals(3), mpc_iterations(5),
+    sim_time(1.7), path_distance_bias(32.0), goal_distance_bias(24.0), occdist_scale(0.01) {}
+
+  bool BenchmarkConfig::set(const std::string& key, double value){
+    if(key == "controller_frequency") controller_frequency = value;
+    else if(key == "planner_frequency") planner_frequency = value;
+    else if(key == "xy_goal_tolerance") xy_goal_tolerance = value;
+    else if(key == "timeout") timeout = value;
+    else if(key == "robot_radius") robot_radius = value;
+    else if(key == "max_vel_x") max_vel_x = value;
+    else if(key == "max_rot_vel") max_rot_vel = value;
+    else if(key == "acc_lim_x") acc_lim_x = value;
+    else if(key == "acc_lim_theta") acc_lim_theta = value;
+    else if(key == "laser_range") laser_range = value;
+    else if(key == "laser_beams") laser_beams = (int)value;
+    else if(key == "static_map") static_map = value != 0.0;
+    else if(key == "local_costmap_size") local_costmap_size = value;
+    else if(key == "inflation_radius") inflation_radius = value;
+    else if(key == "cost_scaling_factor") cost_scaling_factor = value;
+    else if(key == "smooth_plan") smooth_plan = value != 0.0;
+    else if(key == "smoothing_decimation") smoothing_decimation = value;
+    else if(key == "smoothing_max_curvature") smoothing_max_curvature = value;
+    else if(key == "use_astar") use_astar = value != 0.0;
+    else if(key == "warm_start") warm_start = value != 0.0;
+    else if(key == "local_planner") local_planner = (int)value;
+    else if(key == "vx_samples") vx_samples = (int)value;
+    else if(key == "vth_samples") vth_samples = (int)value;
+    else if(key == "rollout_integration") rollout_integration = (int)value;
+    else if(key == "refine") refine = value != 0.0;
+    else if(key == "mpc_intervals") mpc_intervals = (int)value;
+    else if(key == "mpc_iterations") mpc_iterations = (int)value;
+    else if(key == "sim_time") sim_time = value;
+    else if(key == "path_distance_bias") path_distance_bias = value;
+    else if(key == "goal_distance_bias") goal_distance_bias = value;
+    else if(key == "occdist_scale") occdist_scale = value;
+    else
+      return false;
+    return true;
+  }
+
+  double BenchmarkResult::percentile(std::vector<double> samples, double p){
+    if(samples.empty())
+      return 0.0;
+    unsigned int n = std::min((unsigned int)(p / 100.0 * samples.size()), (unsigned int)samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+    return samples[n];
+  }
+
+  //grow bounds to the whole costmap, rolling costmaps are rewritten completely every update
+  static void touchCostmap(const costmap_2d::Costmap2D& costmap, double* min_x, double* min_y, double* max_x, double* max_y){
+    *min_x = std::min(*min_x, costmap.getOriginX());
+    *min_y = std::min(*min_y, costmap.getOriginY());
+    *max_x = std::max(*max_x, costmap.getOriginX() + costmap.getSizeInMetersX());
+    *max_y = std::max(*max_y, costmap.getOriginY() + costmap.getSizeInMetersY());
+  }
+
+  /**
+   * @brief Puts the obstacles of the world into the costmap, takes the place of the static layer
+   */
+  class WorldMapLayer : public costmap_2d::Layer {
+    public:
+      WorldMapLayer(const BenchmarkWorld& world) : world_(world), has_updated_(false) {}
+
+      virtual void onInitialize(){
+        current_ = true;
+        enabled_ = true;
+      }
+
+      virtual void updateBounds(double origin_x, double origin_y, double origin_yaw, double* min_x, double* min_y,
+          double* max_x, double* max_y){
+        if(has_updated_ && !layered_costmap_->isRolling())
+          return;
+        touchCostmap(*layered_costmap_->getCostmap(), min_x, min_y, max_x, max_y);
+        has_updated_ = true;
+      }
+
+      virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j){
+        for(int j = min_j; j < max_j; ++j){
+          for(int i = min_i; i < max_i; ++i){
+            double wx, wy;
+            master_grid.mapToWorld(i, j, wx, wy);
+            if(world_.isOccupied(wx, wy))
+              master_grid.setCost(i, j, LETHAL_OBSTACLE);
+          }
+        }
+      }
+
+    private:
+      const BenchmarkWorld& world_;
+      bool has_updated_;
+  };
+
+  /**
+   * @brief Marks what the simulated laser hits, takes the place of the obstacle layer.
+   * The world does not change, so nothing is ever cleared: a static costmap keeps
+   * every hit, a rolling one only has those of the latest scan.
+   */
+  class LaserLayer : public costmap_2d::Layer {
+    public:
+      virtual void onInitialize(){
+        current_ = true;
+        enabled_ = true;
+        matchSize();
+      }
+
+      virtual void matchSize(){
+        costmap_2d::Costmap2D* costmap = layered_costmap_->getCostmap();
+        marked_.assign(costmap->getSizeInCellsX() * costmap->getSizeInCellsY(), false);
+      }
+
+      /**
+       * @brief  Take in a scan, a static costmap marks the new hits right away and
+       * updates them on the next update of the costmap
+       */
+      void setScan(const std::vector<std::pair<double, double> >& hits){
+        hits_ = hits;
+        if(layered_costmap_->isRolling())
+          return;
+
+        costmap_2d::Costmap2D* costmap = layered_costmap_->getCostmap();
+        for(unsigned int i = 0; i < hits_.size(); ++i){
+          unsigned int mx, my;
+          if(!costmap->worldToMap(hits_[i].first, hits_[i].second, mx, my) || marked_[costmap->getIndex(mx, my)])
+            continue;
+          marked_[costmap->getIndex(mx, my)] = true;
+          changed_.push_back(hits_[i]);
+        }
+      }
+
+      virtual void updateBounds(double origin_x, double origin_y, double origin_yaw, double* min_x, double* min_y,
+          double* max_x, double* max_y){
+        if(layered_costmap_->isRolling()){
+          touchCostmap(*layered_costmap_->getCostmap(), min_x, min_y, max_x, max_y);
+          return;
+        }
+
+        for(unsigned int i = 0; i < changed_.size(); ++i){
+          *min_x = std::min(*min_x, changed_[i].first);
+          *min_y = std::min(*min_y, changed_[i].second);
+          *max_x = std::max(*max_x, changed_[i].first);
+          *max_y = std::max(*max_y, changed_[i].second);
+        }
+        changed_.clear();
+      }
+
+      virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j){
+        if(layered_costmap_->isRolling()){
+          for(unsigned int i = 0; i < hits_.size(); ++i){
+            unsigned int mx, my;
+            if(master_grid.worldToMap(hits_[i].first, hits_[i].second, mx, my))
+              master_grid.setCost(mx, my, LETHAL_OBSTACLE);
+          }
+          return;
+        }
+
+        for(int j = min_j; j < max_j; ++j){
+          for(int i = min_i; i < max_i; ++i){
+            if(marked_[master_grid.getIndex(i, j)])
+              master_grid.setCost(i, j, LETHAL_OBSTACLE);
+          }
+        }
+      }
+
+    private:
+      std::vector<std::pair<double, double> > hits_, changed_;
+      std::vector<bool> marked_;
+  };
+
+  /**
+   * @brief The inflation layer without its dynamic_reconfigure server, the benchmark sets its parameters
+   */
+  class HeadlessInflationLayer : public costmap_2d::InflationLayer {
+    public:
+      virtual void onInitialize(){
+        current_ = true;
+        enabled_ = true;
+        matchSize();
+      }
+  };
+
+  /**
+   * @brief State of one run: the costmaps, the planners and the robot
+   */
+  class BenchmarkRun {
+    public:
+      BenchmarkRun(const BenchmarkWorld& world, const BenchmarkConfig& config);
+      ~BenchmarkRun();
+
+      BenchmarkResult run(double start_x, double start_y, double start_th, double goal_x, double goal_y);
+
+    private:
+      void setUpCostmap(costmap_2d::LayeredCostmap& costmap, boost::shared_ptr<LaserLayer>& laser,
+          unsigned int size_x, unsigned int size_y, double origin_x, double origin_y);
+      void setUpDWAPlanner();
+      void setUpTrajectoryPlanner();
+      void scan(std::vector<std::pair<double, double> >& hits);
+      bool makePlan(double goal_x, double goal_y);
+      bool computeVelocityCommands(double& v, double& w);
+
+      const BenchmarkWorld& world_;
+      const BenchmarkConfig& config_;
+      std::vector<geometry_msgs::Point> footprint_;
+
+      costmap_2d::LayeredCostmap global_costmap_, local_costmap_;
+      boost::shared_ptr<LaserLayer> global_laser_, local_laser_;
+
+      navfn::NavFn* navfn_;
+      PathSmoother smoother_;
+      std::vector<geometry_msgs::PoseStamped> global_plan_;
+
+      //the local planners, without their ROS wrappers
+      base_local_planner::LocalPlannerLimits limits_;
+      base_local_planner::LocalPlannerUtil planner_util_;
+      dwa_local_planner::DWAPlanner* dwa_planner_;
+      base_local_planner::CostmapModel* world_model_;
+      base_local_planner::TrajectoryPlanner* trajectory_planner_;
+
+      //the robot
+      double x_, y_, th_, v_, w_;
+  };
+
+  BenchmarkRun::BenchmarkRun(const BenchmarkWorld& world, const BenchmarkConfig& config) :
+    world_(world), config_(config),
+    global_costmap_("map", false, false), local_costmap_("map", true, false),
+    navfn_(NULL),
+    limits_(config.max_vel_x, 0.1, config.max_vel_x, 0.0, 0.0, 0.0, config.max_rot_vel, 0.4,
+        config.acc_lim_x, 0.0, config.acc_lim_theta, config.acc_lim_x, config.xy_goal_tolerance, 0.1),
+    dwa_planner_(NULL), world_model_(NULL), trajectory_planner_(NULL),
+    x_(0.0), y_(0.0), th_(0.0), v_(0.0), w_(0.0)
+  {
+    //a round robot
+    for(int i = 0; i < 16; ++i){
+      geometry_msgs::Point pt;
+      pt.x = config.robot_radius * cos(i * M_PI / 8);
+      pt.y = config.robot_radius * sin(i * M_PI / 8);
+      footprint_.push_back(pt);
+    }
+
+    const costmap_2d::Costmap2D& map = world.getMap();
+    setUpCostmap(global_costmap_, global_laser_, map.getSizeInCellsX(), map.getSizeInCellsY(),
+        map.getOriginX(), map.getOriginY());
+    unsigned int local_cells = (unsigned int)(config.local_costmap_size / map.getResolution());
+    setUpCostmap(local_costmap_, local_laser_, local_cells, local_cells, 0.0, 0.0);
+
+    navfn_ = new navfn::NavFn(map.getSizeInCellsX(), map.getSizeInCellsY());
+    smoother_.setEnabled(config.smooth_plan);
+    smoother_.setDecimationDistance(config.smoothing_decimation);
+    smoother_.setMaxCurvature(config.smoothing_max_curvature);
+
+    if(config.local_planner == 0)
+      setUpDWAPlanner();
+    else
+      setUpTrajectoryPlanner();
+  }
+
+  BenchmarkRun::~BenchmarkRun(){
+    delete dwa_planner_;
+    delete trajectory_planner_;
+    delete world_model_;
+    delete navfn_;
+  }
+
+  void BenchmarkRun::setUpDWAPlanner(){
+    //the parameters DWAPlannerROS leaves to the planner, which reads them when it is created
+    std::string name = "DWAPlannerROS";
+    ros::NodeHandle private_nh("~/" + name);
+    private_nh.setParam("controller_frequency", config_.controller_frequency);
+    private_nh.setParam("warm_start_sampling", config_.warm_start);
+
+    planner_util_.initialize(NULL, local_costmap_.getCostmap(), "map");
+    dwa_planner_ = new dwa_local_planner::DWAPlanner(name, &planner_util_);
+
+    //what DWAPlannerROS::reconfigureCB does, starting from the dynamic_reconfigure defaults
+    planner_util_.reconfigureCB(limits_, false);
+    dwa_local_planner::DWAPlannerConfig dwa_config = dwa_local_planner::DWAPlannerConfig::__getDefault__();
+    dwa_config.max_trans_vel = limits_.max_trans_vel;
+    dwa_config.sim_time = config_.sim_time;
+    dwa_config.path_distance_bias = config_.path_distance_bias;
+    dwa_config.goal_distance_bias = config_.goal_distance_bias;
+    dwa_config.occdist_scale = config_.occdist_scale;
+    dwa_config.vx_samples = config_.vx_samples;
+    dwa_config.vy_samples = 1;
+    dwa_config.vth_samples = config_.vth_samples;
+    dwa_config.rollout_integration = config_.rollout_integration;
+    dwa_planner_->reconfigure(dwa_config);
+
+    //what MPCPlannerROS adds
+    dwa_planner_->setRefinement(config_.refine, config_.mpc_intervals, config_.mpc_iterations);
+  }
+
+  void BenchmarkRun::setUpTrajectoryPlanner(){
+    //what TrajectoryPlannerROS::initialize passes with its default parameters, for a differential drive
+    world_model_ = new base_local_planner::CostmapModel(*local_costmap_.getCostmap());
+    trajectory_planner_ = new base_local_planner::TrajectoryPlanner(*world_model_, *local_costmap_.getCostmap(), footprint_,
+        config_.acc_lim_x, 0.0, config_.acc_lim_theta, config_.sim_time, 0.025, config_.vx_samples, config_.vth_samples,
+        0.6, 0.8, config_.occdist_scale, 0.325, 0.05, 0.10, M_PI_4, false,
+        config_.max_vel_x, 0.1, config_.max_rot_vel, -config_.max_rot_vel, 0.4, -0.1,
+        true, false, 0.8, false, false, std::vector<double>(), 0.2, 1.0 / config_.controller_frequency, 0.025);
+  }
+
+  void BenchmarkRun::setUpCostmap(costmap_2d::LayeredCostmap& costmap, boost::shared_ptr<LaserLayer>& laser,
+      unsigned int size_x, unsigned int size_y, double origin_x, double origin_y){
+    costmap.resizeMap(size_x, size_y, world_.getMap().getResolution(), origin_x, origin_y);
+
+    if(config_.static_map){
+      boost::shared_ptr<WorldMapLayer> world_layer(new WorldMapLayer(world_));
+      costmap.addPlugin(world_layer);
+      world_layer->initialize(&costmap, "static_layer", NULL);
+    }
+
+    laser.reset(new LaserLayer());
+    costmap.addPlugin(laser);
+    laser->initialize(&costmap, "obstacle_layer", NULL);
+
+    boost::shared_ptr<HeadlessInflationLayer> inflation(new HeadlessInflationLayer());
+    costmap.addPlugin(inflation);
+    inflation->initialize(&costmap, "inflation_layer", NULL);
+    inflation->setInflationParameters(config_.inflation_radius, config_.cost_scaling_factor);
+
+    costmap.setFootprint(footprint_);
+  }
+
+  void BenchmarkRun::scan(std::vector<std::pair<double, double> >& hits){
+    hits.clear();
+    double step = world_.getMap().getResolution() / 2;
+    for(int i = 0; i < config_.laser_beams; ++i){
+      double angle = th_ + 2 * M_PI * i / config_.laser_beams;
+      double dx = cos(angle) * step, dy = sin(angle) * step;
+      double wx = x_, wy = y_;
+      for(double range = 0.0; range <= config_.laser_range; range += step){
+        if(world_.isOccupied(wx, wy)){
+          hits.push_back(std::make_pair(wx, wy));
+          break;
+        }
+        wx += dx;
+        wy += dy;
+      }
+    }
+  }
+
+  bool BenchmarkRun::makePlan(double goal_x, double goal_y){
+    global_plan_.clear();
+    costmap_2d::Costmap2D* costmap = global_costmap_.getCostmap();
+    unsigned int start_mx, start_my, goal_mx, goal_my;
+    if(!costmap->worldToMap(x_, y_, start_mx, start_my) || !costmap->worldToMap(goal_x, goal_y, goal_mx, goal_my))
+      return false;
+
+    //like navfn_ros, propagate from the robot and follow the gradient back from the goal
+    navfn_->setNavArr(costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
+    navfn_->setCostmap(costmap->getCharMap(), true, true);
+    int map_start[2] = {(int)start_mx, (int)start_my};
+    int map_goal[2] = {(int)goal_mx, (int)goal_my};
+    navfn_->setStart(map_goal);
+    navfn_->setGoal(map_start);
+    bool found = config_.use_astar ? navfn_->calcNavFnAstar() : navfn_->calcNavFnDijkstra(true);
+    if(!found || navfn_->getPathLen() == 0)
+      return false;
+
+    float* path_x = navfn_->getPathX();
+    float* path_y = navfn_->getPathY();
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = "map";
+    pose.pose.orientation.w = 1.0;
+    for(int i = navfn_->getPathLen() - 1; i >= 0; --i){
+      pose.pose.position.x = costmap->getOriginX() + (path_x[i] + 0.5) * costmap->getResolution();
+      pose.pose.position.y = costmap->getOriginY() + (path_y[i] + 0.5) * costmap->getResolution();
+      global_plan_.push_back(pose);
+    }
+    pose.pose.position.x = goal_x;
+    pose.pose.position.y = goal_y;
+    global_plan_.push_back(pose);
+
+    //like move_base, the smoothing counts towards the planner's latency
+    smoother_.smooth(*costmap, global_plan_);
+    if(dwa_planner_)
+      dwa_planner_->setPlan(global_plan_);
+    return true;
+  }
+
+  bool BenchmarkRun::computeVelocityCommands(double& v, double& w){
+    v = w = 0.0;
+
+    //the part of the global plan from the closest pose on, as long as it stays on the local costmap
+    costmap_2d::Costmap2D* costmap = local_costmap_.getCostmap();
+    unsigned int closest = 0;
+    double closest_sq_dist = 1e30;
+    for(unsigned int i = 0; i < global_plan_.size(); ++i){
+      double dx = global_plan_[i].pose.position.x - x_, dy = global_plan_[i].pose.position.y - y_;
+      if(dx * dx + dy * dy < closest_sq_dist){
+        closest_sq_dist = dx * dx + dy * dy;
+        closest = i;
+      }
+    }
+    std::vector<geometry_msgs::PoseStamped> local_plan;
+    unsigned int mx, my;
+    for(unsigned int i = closest; i < global_plan_.size(); ++i){
+      if(!costmap->worldToMap(global_plan_[i].pose.position.x, global_plan_[i].pose.position.y, mx, my))
+        break;
+      local_plan.push_back(global_plan_[i]);
+    }
+    if(local_plan.empty())
+      return false;
+
+    //the pose and the odometry the way the ROS wrappers hand them to the planners
+    tf::Stamped<tf::Pose> pose(tf::Pose(tf::createQuaternionFromYaw(th_), tf::Vector3(x_, y_, 0)), ros::Time(), "map");
+    tf::Stamped<tf::Pose> vel(tf::Pose(tf::createQuaternionFromYaw(w_), tf::Vector3(v_, 0, 0)), ros::Time(), "base_link");
+    tf::Stamped<tf::Pose> drive_cmds;
+    drive_cmds.frame_id_ = "base_link";
+
+    base_local_planner::Trajectory path;
+    if(dwa_planner_){
+      dwa_planner_->updatePlanAndLocalCosts(pose, local_plan);
+      path = dwa_planner_->findBestPath(pose, vel, drive_cmds, footprint_);
+    }
+    else{
+      trajectory_planner_->updatePlan(local_plan);
+      path = trajectory_planner_->findBestPath(pose, vel, drive_cmds);
+    }
+    if(path.cost_ < 0)
+      return false;
+
+    v = drive_cmds.getOrigin().getX();
+    w = tf::getYaw(drive_cmds.getRotation());
+    return true;
+  }
+
+  BenchmarkResult BenchmarkRun::run(double start_x, double start_y, double start_th, double goal_x, double goal_y){
+    BenchmarkResult result;
+    ros::WallTime run_start = ros::WallTime::now();
+    x_ = start_x;
+    y_ = start_y;
+    th_ = start_th;
+    v_ = w_ = 0.0;
+
+    double dt = 1.0 / config_.controller_frequency;
+    double next_plan = 0.0, last_valid_control = 0.0;
+    bool need_plan = true;
+    std::vector<std::pair<double, double> > hits;
+    double t = 0.0;
+    for(; t < config_.timeout; t += dt){
+      if(hypot(goal_x - x_, goal_y - y_) <= config_.xy_goal_tolerance){
+        result.reached_goal = true;
+        break;
+      }
+      if(world_.isOccupied(x_, y_)){
+        result.failure = "collision";
+        break;
+      }
+
+      scan(hits);
+      global_laser_->setScan(hits);
+      local_laser_->setScan(hits);
+
+      //the global costmap is only brought up to date when the planner needs it
+      if(need_plan || (config_.planner_frequency > 0.0 && t >= next_plan)){
+        global_costmap_.updateMap(x_, y_, th_);
+        ros::WallTime start = ros::WallTime::now();
+        bool got_plan = makePlan(goal_x, goal_y);
+        result.planner_latencies.push_back((ros::WallTime::now() - start).toSec());
+        if(!got_plan){
+          result.failure = "no plan";
+          break;
+        }
+        need_plan = false;
+        if(config_.planner_frequency > 0.0)
+          next_plan = t + 1.0 / config_.planner_frequency;
+      }
+
+      local_costmap_.updateMap(x_, y_, th_);
+      double cmd_v, cmd_w;
+      ros::WallTime start = ros::WallTime::now();
+      bool got_command = computeVelocityCommands(cmd_v, cmd_w);
+      result.controller_latencies.push_back((ros::WallTime::now() - start).toSec());
+      if(got_command)
+        last_valid_control = t;
+      else if(t - last_valid_control > 1.0){
+        //like move_base, go back to planning when the controller is stuck
+        need_plan = true;
+        last_valid_control = t;
+      }
+
+      //the base follows the command within its acceleration limits
+      double dv = config_.acc_lim_x * dt, dw = config_.acc_lim_theta * dt;
+      v_ = std::max(v_ - dv, std::min(v_ + dv, cmd_v));
+      w_ = std::max(w_ - dw, std::min(w_ + dw, cmd_w));
+      double mid_th = th_ + w_ * dt / 2;
+      x_ += v_ * cos(mid_th) * dt;
+      y_ += v_ * sin(mid_th) * dt;
+      th_ += w_ * dt;
+      result.path_length += fabs(v_) * dt;
+    }
+
+    if(!result.reached_goal && result.failure.empty())
+      result.failure = "timeout";
+    result.time_to_goal = t;
+    result.wall_time = (ros::WallTime::now() - run_start).toSec();
+    return result;
+  }
+
+  BenchmarkResult NavigationBenchmark::run(const BenchmarkConfig& config, double start_x, double start_y, double start_th,
+      double goal_x, double goal_y){
+    BenchmarkRun run(world_, config);
+    return run.run(start_x, start_y, start_th, goal_x, goal_y);
+  }
+};
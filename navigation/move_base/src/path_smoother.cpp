@@ -0,0 +1,317 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <move_base/path_smoother.h>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+
+#include <costmap_2d/cost_values.h>
+#include <tf/transform_datatypes.h>
+
+namespace move_base {
+
+  PathSmoother::PathSmoother() :
+    enabled_(false),
+    weight_data_(0.2), weight_smooth_(0.3), weight_costmap_(0.1),
+    max_iterations_(100), max_time_(0.05), tolerance_(1e-4),
+    decimation_distance_(0.0), max_curvature_(0.0) {}
+
+  void PathSmoother::initialize(const std::string& planner_name){
+    //the defaults for all planners live under ~path_smoother
+    ros::NodeHandle default_nh("~/path_smoother");
+    default_nh.param("enabled", enabled_, false);
+    default_nh.param("weight_data", weight_data_, 0.2);
+    default_nh.param("weight_smooth", weight_smooth_, 0.3);
+    default_nh.param("weight_costmap", weight_costmap_, 0.1);
+    default_nh.param("max_iterations", max_iterations_, 100);
+    default_nh.param("max_time", max_time_, 0.05);
+    default_nh.param("tolerance", tolerance_, 1e-4);
+    default_nh.param("decimation_distance", decimation_distance_, 0.0);
+    default_nh.param("max_curvature", max_curvature_, 0.0);
+
+    //and each planner can override them in its own namespace
+    ros::NodeHandle planner_nh("~/" + planner_name + "/path_smoother");
+    planner_nh.param("enabled", enabled_, enabled_);
+    planner_nh.param("weight_data", weight_data_, weight_data_);
+    planner_nh.param("weight_smooth", weight_smooth_, weight_smooth_);
+    planner_nh.param("weight_costmap", weight_costmap_, weight_costmap_);
+    planner_nh.param("max_iterations", max_iterations_, max_iterations_);
+    planner_nh.param("max_time", max_time_, max_time_);
+    planner_nh.param("tolerance", tolerance_, tolerance_);
+    planner_nh.param("decimation_distance", decimation_distance_, decimation_distance_);
+    planner_nh.param("max_curvature", max_curvature_, max_curvature_);
+
+    if(enabled_)
+      ROS_INFO("Smoothing plans from %s: weights %.2f/%.2f/%.2f, decimation %.2f m, max curvature %.2f, budget %d iterations / %.3f s",
+          planner_name.c_str(), weight_data_, weight_smooth_, weight_costmap_, decimation_distance_, max_curvature_, max_iterations_, max_time_);
+  }
+
+  void PathSmoother::setWeights(double weight_data, double weight_smooth, double weight_costmap){
+    weight_data_ = weight_data;
+    weight_smooth_ = weight_smooth;
+    weight_costmap_ = weight_costmap;
+  }
+
+  void PathSmoother::setLimits(int max_iterations, double max_time, double tolerance){
+    max_iterations_ = max_iterations;
+    max_time_ = max_time;
+    tolerance_ = tolerance;
+  }
+
+  bool PathSmoother::smooth(const costmap_2d::Costmap2D& costmap, std::vector<geometry_msgs::PoseStamped>& plan){
+    if(!enabled_ || plan.size() < 3)
+      return false;
+
+    ros::WallTime start = ros::WallTime::now();
+
+    unsigned int n = plan.size();
+    xs_.resize(n);
+    ys_.resize(n);
+    for(unsigned int i = 0; i < n; ++i){
+      xs_[i] = plan[i].pose.position.x;
+      ys_[i] = plan[i].pose.position.y;
+    }
+    orig_xs_ = xs_;
+    orig_ys_ = ys_;
+    double length_before = pathLength();
+
+    int iterations = smoothPoints(costmap, start);
+
+    if(decimation_distance_ > 0.0)
+      decimatePoints(costmap);
+
+    if(max_curvature_ > 0.0)
+      limitCurvature(costmap, start);
+
+    //rebuild the plan, the end poses keep their original orientation and the
+    //ones in between face along the path
+    std::vector<geometry_msgs::PoseStamped> smoothed(xs_.size());
+    smoothed.front() = plan.front();
+    smoothed.back() = plan.back();
+    for(unsigned int i = 1; i < xs_.size() - 1; ++i){
+      geometry_msgs::PoseStamped& pose = smoothed[i];
+      pose.header = plan.front().header;
+      pose.pose.position.x = xs_[i];
+      pose.pose.position.y = ys_[i];
+      pose.pose.position.z = 0.0;
+      pose.pose.orientation = tf::createQuaternionMsgFromYaw(atan2(ys_[i + 1] - ys_[i - 1], xs_[i + 1] - xs_[i - 1]));
+    }
+    plan.swap(smoothed);
+
+    ROS_DEBUG_NAMED("move_base", "Smoothed plan from %u to %zu poses, length %.3f to %.3f m, %d iterations in %.4f s",
+        n, plan.size(), length_before, pathLength(), iterations, (ros::WallTime::now() - start).toSec());
+    return true;
+  }
+
+  int PathSmoother::smoothPoints(const costmap_2d::Costmap2D& costmap, const ros::WallTime& start){
+    double resolution = costmap.getResolution();
+    unsigned int n = xs_.size();
+    int iteration = 0;
+    for(; iteration < max_iterations_ && !outOfTime(start); ++iteration){
+      double change = 0.0;
+      for(unsigned int i = 1; i < n - 1; ++i){
+        double x = xs_[i], y = ys_[i];
+        double dx = weight_data_ * (orig_xs_[i] - x) + weight_smooth_ * (xs_[i - 1] + xs_[i + 1] - 2.0 * x);
+        double dy = weight_data_ * (orig_ys_[i] - y) + weight_smooth_ * (ys_[i - 1] + ys_[i + 1] - 2.0 * y);
+
+        if(weight_costmap_ > 0.0){
+          //central difference of the cost, scaled so the steepest possible slope moves a point half a cell per unit weight
+          double scale = weight_costmap_ * resolution / (2.0 * costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+          int c_px = std::min(pointCost(costmap, x + resolution, y), costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+          int c_nx = std::min(pointCost(costmap, x - resolution, y), costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+          int c_py = std::min(pointCost(costmap, x, y + resolution), costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+          int c_ny = std::min(pointCost(costmap, x, y - resolution), costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+          dx -= scale * (c_px - c_nx);
+          dy -= scale * (c_py - c_ny);
+        }
+
+        if(!moveAllowed(costmap, i, x + dx, y + dy))
+          continue;
+
+        xs_[i] = x + dx;
+        ys_[i] = y + dy;
+        change += fabs(dx) + fabs(dy);
+      }
+
+      if(change < tolerance_)
+        return iteration + 1;
+    }
+    return iteration;
+  }
+
+  void PathSmoother::decimatePoints(const costmap_2d::Costmap2D& costmap){
+    unsigned int n = xs_.size();
+    std::vector<double> kept_xs, kept_ys;
+    kept_xs.reserve(n);
+    kept_ys.reserve(n);
+    kept_xs.push_back(xs_[0]);
+    kept_ys.push_back(ys_[0]);
+
+    for(unsigned int i = 1; i < n - 1; ++i){
+      double lx = kept_xs.back(), ly = kept_ys.back();
+      //keep the point if dropping it would leave too long a segment
+      if(hypot(xs_[i + 1] - lx, ys_[i + 1] - ly) > decimation_distance_){
+        kept_xs.push_back(xs_[i]);
+        kept_ys.push_back(ys_[i]);
+        continue;
+      }
+
+      //or if the shortcut crosses higher cost than the two segments it replaces
+      unsigned char replaced = std::max(segmentCost(costmap, lx, ly, xs_[i], ys_[i]),
+          segmentCost(costmap, xs_[i], ys_[i], xs_[i + 1], ys_[i + 1]));
+      if(segmentCost(costmap, lx, ly, xs_[i + 1], ys_[i + 1]) > replaced){
+        kept_xs.push_back(xs_[i]);
+        kept_ys.push_back(ys_[i]);
+      }
+    }
+
+    kept_xs.push_back(xs_[n - 1]);
+    kept_ys.push_back(ys_[n - 1]);
+    xs_.swap(kept_xs);
+    ys_.swap(kept_ys);
+  }
+
+  void PathSmoother::limitCurvature(const costmap_2d::Costmap2D& costmap, const ros::WallTime& start){
+    unsigned int n = xs_.size();
+    for(int pass = 0; pass < max_iterations_ && !outOfTime(start); ++pass){
+      bool adjusted = false;
+      for(unsigned int i = 1; i < n - 1; ++i){
+        double ax = xs_[i] - xs_[i - 1], ay = ys_[i] - ys_[i - 1];
+        double bx = xs_[i + 1] - xs_[i], by = ys_[i + 1] - ys_[i];
+        double cx = xs_[i + 1] - xs_[i - 1], cy = ys_[i + 1] - ys_[i - 1];
+        double denom = hypot(ax, ay) * hypot(bx, by) * hypot(cx, cy);
+        if(denom < 1e-12)
+          continue;
+
+        //curvature of the circle through the three points
+        double curvature = 2.0 * fabs(ax * cy - ay * cx) / denom;
+        if(curvature <= max_curvature_)
+          continue;
+
+        //move halfway towards the midpoint of the neighbours
+        double tx = 0.5 * xs_[i] + 0.25 * (xs_[i - 1] + xs_[i + 1]);
+        double ty = 0.5 * ys_[i] + 0.25 * (ys_[i - 1] + ys_[i + 1]);
+        if(!moveAllowed(costmap, i, tx, ty))
+          continue;
+
+        xs_[i] = tx;
+        ys_[i] = ty;
+        adjusted = true;
+      }
+
+      if(!adjusted)
+        return;
+    }
+  }
+
+  unsigned char PathSmoother::pointCost(const costmap_2d::Costmap2D& costmap, double wx, double wy) const {
+    unsigned int mx, my;
+    if(!costmap.worldToMap(wx, wy, mx, my))
+      return costmap_2d::NO_INFORMATION;
+    return costmap.getCost(mx, my);
+  }
+
+  unsigned char PathSmoother::cellCost(const costmap_2d::Costmap2D& costmap, int mx, int my) const {
+    if(mx < 0 || my < 0 || mx >= (int)costmap.getSizeInCellsX() || my >= (int)costmap.getSizeInCellsY())
+      return costmap_2d::NO_INFORMATION;
+    return costmap.getCost(mx, my);
+  }
+
+  unsigned char PathSmoother::segmentCost(const costmap_2d::Costmap2D& costmap, double x0, double y0, double x1, double y1) const {
+    //walk every cell the segment touches, in map coordinates
+    double resolution = costmap.getResolution();
+    double fx0 = (x0 - costmap.getOriginX()) / resolution, fy0 = (y0 - costmap.getOriginY()) / resolution;
+    double fx1 = (x1 - costmap.getOriginX()) / resolution, fy1 = (y1 - costmap.getOriginY()) / resolution;
+    int mx = (int)floor(fx0), my = (int)floor(fy0);
+    int end_x = (int)floor(fx1), end_y = (int)floor(fy1);
+
+    double dx = fx1 - fx0, dy = fy1 - fy0;
+    int step_x = dx > 0.0 ? 1 : -1, step_y = dy > 0.0 ? 1 : -1;
+    //distance along the segment, as a fraction of it, to the next cell border in x and in y
+    double delta_x = dx != 0.0 ? fabs(1.0 / dx) : std::numeric_limits<double>::infinity();
+    double delta_y = dy != 0.0 ? fabs(1.0 / dy) : std::numeric_limits<double>::infinity();
+    double next_x = dx != 0.0 ? (step_x > 0 ? mx + 1 - fx0 : fx0 - mx) * delta_x : std::numeric_limits<double>::infinity();
+    double next_y = dy != 0.0 ? (step_y > 0 ? my + 1 - fy0 : fy0 - my) * delta_y : std::numeric_limits<double>::infinity();
+
+    unsigned char max_cost = cellCost(costmap, mx, my);
+    int steps = abs(end_x - mx) + abs(end_y - my);
+    for(int s = 0; s < steps; ++s){
+      if(fabs(next_x - next_y) < 1e-9){
+        //the segment goes through a cell corner, both cells beside it count as touched
+        max_cost = std::max(max_cost, std::max(cellCost(costmap, mx + step_x, my), cellCost(costmap, mx, my + step_y)));
+        mx += step_x;
+        my += step_y;
+        next_x += delta_x;
+        next_y += delta_y;
+        ++s;
+      }
+      else if(next_x < next_y){
+        mx += step_x;
+        next_x += delta_x;
+      }
+      else{
+        my += step_y;
+        next_y += delta_y;
+      }
+      max_cost = std::max(max_cost, cellCost(costmap, mx, my));
+    }
+    return max_cost;
+  }
+
+  bool PathSmoother::moveAllowed(const costmap_2d::Costmap2D& costmap, unsigned int i, double tx, double ty) const {
+    //the segments to both neighbours are checked, not just the cell the point lands in, so a point cannot pull its
+    //path across the corner of an obstacle. They may go anywhere the robot fits, and otherwise nowhere worse than now
+    unsigned char to_cost = std::max(segmentCost(costmap, xs_[i - 1], ys_[i - 1], tx, ty),
+        segmentCost(costmap, tx, ty, xs_[i + 1], ys_[i + 1]));
+    if(to_cost < costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
+      return true;
+    unsigned char from_cost = std::max(segmentCost(costmap, xs_[i - 1], ys_[i - 1], xs_[i], ys_[i]),
+        segmentCost(costmap, xs_[i], ys_[i], xs_[i + 1], ys_[i + 1]));
+    return to_cost <= from_cost;
+  }
+
+  double PathSmoother::pathLength() const {
+    double length = 0.0;
+    for(unsigned int i = 1; i < xs_.size(); ++i)
+      length += hypot(xs_[i] - xs_[i - 1], ys_[i] - ys_[i - 1]);
+    return length;
+  }
+
+  bool PathSmoother::outOfTime(const ros::WallTime& start) const {
+    return max_time_ > 0.0 && (ros::WallTime::now() - start).toSec() > max_time_;
+  }
+
+};
@@ -0,0 +1,135 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <gtest/gtest.h>
+#include <cmath>
+#include <move_base/path_smoother.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+using namespace move_base;
+
+namespace {
+
+void addPoint(std::vector<geometry_msgs::PoseStamped>& plan, double x, double y){
+  geometry_msgs::PoseStamped pose;
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.position.z = 0.0;
+  pose.pose.orientation.x = pose.pose.orientation.y = pose.pose.orientation.z = 0.0;
+  pose.pose.orientation.w = 1.0;
+  plan.push_back(pose);
+}
+
+// highest cost along the plan, sampled every millimetre
+unsigned char planCost(const costmap_2d::Costmap2D& costmap, const std::vector<geometry_msgs::PoseStamped>& plan){
+  unsigned char max_cost = 0;
+  for(unsigned int i = 1; i < plan.size(); ++i){
+    double x0 = plan[i - 1].pose.position.x, y0 = plan[i - 1].pose.position.y;
+    double x1 = plan[i].pose.position.x, y1 = plan[i].pose.position.y;
+    int samples = std::max(1, (int)ceil(hypot(x1 - x0, y1 - y0) / 0.001));
+    for(int s = 0; s <= samples; ++s){
+      double t = (double)s / samples;
+      unsigned int mx, my;
+      if(!costmap.worldToMap(x0 + t * (x1 - x0), y0 + t * (y1 - y0), mx, my))
+        return costmap_2d::NO_INFORMATION;
+      max_cost = std::max(max_cost, costmap.getCost(mx, my));
+    }
+  }
+  return max_cost;
+}
+
+double planLength(const std::vector<geometry_msgs::PoseStamped>& plan){
+  double length = 0.0;
+  for(unsigned int i = 1; i < plan.size(); ++i)
+    length += hypot(plan[i].pose.position.x - plan[i - 1].pose.position.x,
+        plan[i].pose.position.y - plan[i - 1].pose.position.y);
+  return length;
+}
+
+PathSmoother aggressiveSmoother(){
+  PathSmoother smoother;
+  smoother.setEnabled(true);
+  smoother.setWeights(0.0, 0.5, 0.0);
+  smoother.setLimits(500, 0.0, 1e-9);
+  smoother.setMaxCurvature(0.1);
+  return smoother;
+}
+
+}
+
+// a sparse plan hugging the corner of an obstacle, every point is in free space but pulling the corner point
+// towards its neighbours would take the segments through the obstacle
+TEST(PathSmoother, obstacle_corner){
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+  for(unsigned int my = 0; my < 20; ++my)
+    for(unsigned int mx = 20; mx < 40; ++mx)
+      costmap.setCost(mx, my, costmap_2d::LETHAL_OBSTACLE);
+
+  std::vector<geometry_msgs::PoseStamped> plan;
+  for(double y = 0.3; y < 2.0; y += 0.25)
+    addPoint(plan, 1.85, y);
+  for(double x = 1.85; x < 3.9; x += 0.25)
+    addPoint(plan, x, 2.05);
+  ASSERT_LT(planCost(costmap, plan), costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+
+  PathSmoother smoother = aggressiveSmoother();
+  ASSERT_TRUE(smoother.smooth(costmap, plan));
+  EXPECT_LT(planCost(costmap, plan), costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+
+  // and decimation may not take the shortcut either
+  smoother.setDecimationDistance(1.0);
+  ASSERT_TRUE(smoother.smooth(costmap, plan));
+  EXPECT_LT(planCost(costmap, plan), costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+}
+
+// without obstacles around, a zig-zag is straightened out
+TEST(PathSmoother, free_space){
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+
+  std::vector<geometry_msgs::PoseStamped> plan;
+  for(int i = 0; i < 15; ++i)
+    addPoint(plan, 0.5 + 0.2 * i, i % 2 == 0 ? 2.0 : 2.1);
+  double length_before = planLength(plan);
+
+  PathSmoother smoother = aggressiveSmoother();
+  ASSERT_TRUE(smoother.smooth(costmap, plan));
+  EXPECT_LT(planLength(plan), length_before);
+  EXPECT_EQ(0, planCost(costmap, plan));
+}
+
+int main(int argc, char** argv){
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -45,6 +45,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <boost/thread.hpp>
 
 // cost defs
 #define COST_UNKNOWN_ROS 255		// 255 is unknown cost
@@ -77,6 +78,9 @@
 // priority buffers
 #define PRIORITYBUFSIZE 10000
 
+// smallest priority block worth handing to the worker threads
+#define PARALLEL_MINBLOCK 256
+
 
 namespace navfn {
   /**
@@ -236,6 +240,52 @@ positions at about 1/2 cell resolution; else returns 0.
        */
       bool propNavFnAstar(int cycles); /**< returns true if start point found */
 
+      /**
+       * @brief  Sets the number of threads used by propNavFnDijkstra
+       * @param n The number of threads, values <= 1 select the serial propagation
+       *
+       * In parallel mode each priority block is updated Jacobi-style: every cell of the
+       * block computes its new potential from the potentials of the previous cycle, so
+       * the result does not depend on the number of threads or on scheduling, but may
+       * differ slightly from the in-place serial update.
+       */
+      void setNumThreads(int n);
+      int nthreads;		/**< number of propagation threads, 1 is serial */
+
+      /** parallel propagation buffers */
+      float *blkpot;		/**< new potentials of the cells in the current priority block */
+      int **thrNextP, **thrOverP;	/**< per-thread push buffers, merged after each cycle */
+      int *thrNextPe, *thrOverPe;	/**< end points of per-thread push buffers */
+      int thrBufSize;		/**< size of each per-thread push buffer */
+
+      /**
+       * @brief  Updates the cell at curP[i] without modifying the potential array
+       * @param i The index into the current priority block
+       * @param t The thread whose push buffers receive the affected neighbors
+       */
+      void updateCellBlock(int i, int t);
+
+      /**
+       * @brief  Updates one slice of the current priority block
+       * @param t The slice to update, in [0, nthreads)
+       */
+      void propBlockSlice(int t);
+
+      /**
+       * @brief  Updates the whole current priority block and merges the per-thread push buffers
+       */
+      void propBlockParallel();
+
+      /**
+       * @brief  Worker thread loop, runs propBlockSlice(t) once per priority block
+       * @param t The slice handled by this worker
+       */
+      void propWorker(int t);
+
+      boost::thread_group *workers;	/**< worker threads 1..nthreads-1, slice 0 runs on the caller */
+      boost::barrier *blkStart, *blkDone;	/**< block synchronization barriers */
+      bool blkQuit;		/**< tells the workers to exit */
+
       /** gradient and paths */
       float *gradx, *grady;		/**< gradient arrays, size of potential array */
       float *pathx, *pathy;		/**< path points, as subpixel cell coordinates */
@@ -137,11 +137,22 @@ namespace navfn {
     npathbuf = npath = 0;
     pathx = pathy = NULL;
     pathStep = 0.5;
+
+    // parallel propagation, off by default
+    nthreads = 1;
+    blkpot = NULL;
+    thrNextP = thrOverP = NULL;
+    thrNextPe = thrOverPe = NULL;
+    thrBufSize = 0;
+    workers = NULL;
+    blkStart = blkDone = NULL;
+    blkQuit = false;
   }
 
 
   NavFn::~NavFn()
   {
+    setNumThreads(1);		// stops the workers and frees their buffers
     if(costarr)
       delete[] costarr;
     if(potarr)
@@ -185,6 +196,74 @@ namespace navfn {
       ROS_DEBUG("[NavFn] Setting start to %d,%d\n", start[0], start[1]);
     }
 
+  //
+  // Set number of propagation threads
+  // Starts persistent workers, slice 0 of each block runs on the caller
+  //
+
+  void
+    NavFn::setNumThreads(int n)
+    {
+      if (n < 1) n = 1;
+
+      // stop current workers
+      if (workers)
+      {
+        blkQuit = true;
+        blkStart->wait();
+        workers->join_all();
+        delete workers;
+        delete blkStart;
+        delete blkDone;
+        workers = NULL;
+        blkStart = blkDone = NULL;
+        blkQuit = false;
+      }
+
+      if (blkpot)
+      {
+        delete[] blkpot;
+        for (int t=0; t<nthreads; t++)
+        {
+          delete[] thrNextP[t];
+          delete[] thrOverP[t];
+        }
+        delete[] thrNextP;
+        delete[] thrOverP;
+        delete[] thrNextPe;
+        delete[] thrOverPe;
+        blkpot = NULL;
+        thrNextP = thrOverP = NULL;
+        thrNextPe = thrOverPe = NULL;
+      }
+
+      nthreads = n;
+      if (nthreads == 1)
+        return;
+
+      // each cell pushes at most four neighbors
+      blkpot = new float[PRIORITYBUFSIZE];
+      thrBufSize = 4*(PRIORITYBUFSIZE/nthreads + 1);
+      thrNextP = new int*[nthreads];
+      thrOverP = new int*[nthreads];
+      thrNextPe = new int[nthreads];
+      thrOverPe = new int[nthreads];
+      for (int t=0; t<nthreads; t++)
+      {
+        thrNextP[t] = new int[thrBufSize];
+        thrOverP[t] = new int[thrBufSize];
+        thrNextPe[t] = thrOverPe[t] = 0;
+      }
+
+      blkStart = new boost::barrier(nthreads);
+      blkDone = new boost::barrier(nthreads);
+      workers = new boost::thread_group;
+      for (int t=1; t<nthreads; t++)
+        workers->create_thread(boost::bind(&NavFn::propWorker, this, t));
+
+      ROS_DEBUG("[NavFn] Using %d propagation threads\n", nthreads);
+    }
+
   //
   // Set/Reset map size
   //
@@ -547,6 +626,157 @@ namespace navfn {
     }
 
 
+  //
+  // Block update for parallel propagation
+  // Same planar-wave update as updateCell(), but the new potential goes
+  //   to blkpot[i] and affected neighbors go to the push buffers of
+  //   thread <t>; potarr is only read, so slices can run concurrently.
+  //   Pending flags are checked when the buffers are merged.
+  //
+
+  inline void
+    NavFn::updateCellBlock(int i, int t)
+    {
+      int n = curP[i];
+      blkpot[i] = POT_HIGH;
+
+      // get neighbors
+      float u,d,l,r;
+      l = potarr[n-1];
+      r = potarr[n+1];
+      u = potarr[n-nx];
+      d = potarr[n+nx];
+
+      // find lowest, and its lowest neighbor
+      float ta, tc;
+      if (l<r) tc=l; else tc=r;
+      if (u<d) ta=u; else ta=d;
+
+      // do planar wave update
+      if (costarr[n] < COST_OBS)	// don't propagate into obstacles
+      {
+        float hf = (float)costarr[n]; // traversability factor
+        float dc = tc-ta;		// relative cost between ta,tc
+        if (dc < 0) 		// ta is lowest
+        {
+          dc = -dc;
+          ta = tc;
+        }
+
+        // calculate new potential
+        float pot;
+        if (dc >= hf)		// if too large, use ta-only update
+          pot = ta+hf;
+        else			// two-neighbor interpolation update
+        {
+          float d = dc/hf;
+          float v = -0.2301*d*d + 0.5307*d + 0.7040;
+          pot = ta + hf*v;
+        }
+
+        // record affected neighbors for this thread
+        if (pot < potarr[n])
+        {
+          float le = INVSQRT2*(float)costarr[n-1];
+          float re = INVSQRT2*(float)costarr[n+1];
+          float ue = INVSQRT2*(float)costarr[n-nx];
+          float de = INVSQRT2*(float)costarr[n+nx];
+          blkpot[i] = pot;
+          int *pb;
+          int *pe;
+          if (pot < curT)	// low-cost buffer block
+          {
+            pb = thrNextP[t];
+            pe = &thrNextPe[t];
+          }
+          else			// overflow block
+          {
+            pb = thrOverP[t];
+            pe = &thrOverPe[t];
+          }
+          if (l > pot+le) pb[(*pe)++] = n-1;
+          if (r > pot+re) pb[(*pe)++] = n+1;
+          if (u > pot+ue) pb[(*pe)++] = n-nx;
+          if (d > pot+de) pb[(*pe)++] = n+nx;
+        }
+      }
+    }
+
+
+  // update slice <t> of the current priority block
+
+  void
+    NavFn::propBlockSlice(int t)
+    {
+      int lo = (int)(((long)curPe*t)/nthreads);
+      int hi = (int)(((long)curPe*(t+1))/nthreads);
+      thrNextPe[t] = 0;
+      thrOverPe[t] = 0;
+      for (int i=lo; i<hi; i++)
+        updateCellBlock(i,t);
+    }
+
+
+  // worker thread loop, one slice per priority block
+
+  void
+    NavFn::propWorker(int t)
+    {
+      while (true)
+      {
+        blkStart->wait();
+        if (blkQuit)
+          return;
+        propBlockSlice(t);
+        blkDone->wait();
+      }
+    }
+
+
+  //
+  // update the current priority block with all threads
+  // small blocks are sliced identically but run on the caller,
+  //   so the result does not depend on where a slice ran
+  //
+
+  void
+    NavFn::propBlockParallel()
+    {
+      if (curPe >= PARALLEL_MINBLOCK)
+      {
+        blkStart->wait();
+        propBlockSlice(0);
+        blkDone->wait();
+      }
+      else
+      {
+        for (int t=0; t<nthreads; t++)
+          propBlockSlice(t);
+      }
+
+      // write back new potentials, each cell is in the block only once
+      int *pb = curP;
+      for (int i=0; i<curPe; i++, pb++)
+        if (blkpot[i] < potarr[*pb])
+          potarr[*pb] = blkpot[i];
+
+      // merge push buffers in slice order, low-cost block first so the
+      //   merged order is the same for any number of threads
+      for (int t=0; t<nthreads; t++)
+      {
+        pb = thrNextP[t];
+        for (int i=0; i<thrNextPe[t]; i++, pb++)
+          push_next(*pb);
+      }
+      for (int t=0; t<nthreads; t++)
+      {
+        pb = thrOverP[t];
+        for (int i=0; i<thrOverPe[t]; i++, pb++)
+          push_over(*pb);
+      }
+    }
+
+
   //
   // Use A* method for setting priorities
   // Critical function: calculate updated potential value of a cell,
@@ -677,10 +907,15 @@ namespace navfn {
           pending[*(pb++)] = false;
 
         // process current priority buffer
-        pb = curP; 
-        i = curPe;
-        while (i-- > 0)		
-          updateCell(*pb++);
+        if (nthreads > 1)
+          propBlockParallel();
+        else
+        {
+          pb = curP; 
+          i = curPe;
+          while (i-- > 0)		
+            updateCell(*pb++);
+        }
 
         if (displayInt > 0 &&  (cycle % displayInt) == 0)
           displayFn(this);
@@ -39,6 +39,7 @@
 #include <tf/transform_listener.h>
 #include <costmap_2d/cost_values.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/nearest_cell.h>
 
 //register this planner as a BaseGlobalPlanner plugin
 PLUGINLIB_DECLARE_CLASS(navfn, NavfnROS, navfn::NavfnROS, nav_core::BaseGlobalPlanner)
@@ -74,6 +75,11 @@ namespace navfn {
       private_nh.param("planner_window_x", planner_window_x_, 0.0);
       private_nh.param("planner_window_y", planner_window_y_, 0.0);
       private_nh.param("default_tolerance", default_tolerance_, 0.0);
+
+      //threads used to propagate the navigation function, 1 is serial
+      int num_threads;
+      private_nh.param("num_threads", num_threads, 1);
+      planner_->setNumThreads(num_threads);
         
       double costmap_pub_freq;
       private_nh.param("planner_costmap_publish_frequency", costmap_pub_freq, 0.0);
@@ -100,25 +106,9 @@ namespace navfn {
       return false;
     }
 
-    double resolution = costmap_ros_->getCostmap()->getResolution();
-    geometry_msgs::Point p;
-    p = world_point;
-
-    p.y = world_point.y - tolerance;
-
-    while(p.y <= world_point.y + tolerance){
-      p.x = world_point.x - tolerance;
-      while(p.x <= world_point.x + tolerance){
-        double potential = getPointPotential(p);
-        if(potential < POT_HIGH){
-          return true;
-        }
-        p.x += resolution;
-      }
-      p.y += resolution;
-    }
-
-    return false;
+    unsigned int mx, my;
+    return costmap_2d::findNearestCell(*costmap_ros_->getCostmap(), planner_->potarr, POT_HIGH, world_point.x,
+                                       world_point.y, tolerance, mx, my);
   }
 
   double NavfnROS::getPointPotential(const geometry_msgs::Point& world_point){
@@ -266,7 +256,8 @@ namespace navfn {
     wx = goal.pose.position.x;
     wy = goal.pose.position.y;
 
-    if(!costmap->worldToMap(wx, wy, mx, my)){
+    bool goal_on_map = costmap->worldToMap(wx, wy, mx, my);
+    if(!goal_on_map){
       if(tolerance <= 0.0){
         ROS_WARN("The goal sent to the navfn planner is off the global costmap. Planning will always fail to this goal.");
         return false;
@@ -285,29 +276,15 @@ namespace navfn {
     //bool success = planner_->calcNavFnAstar();
     planner_->calcNavFnDijkstra(true);
 
-    double resolution = costmap->getResolution();
-    geometry_msgs::PoseStamped p, best_pose;
-    p = goal;
-
-    bool found_legal = false;
-    double best_sdist = DBL_MAX;
-
-    p.pose.position.y = goal.pose.position.y - tolerance;
+    //search outward from the goal cell for the closest cell the potential reached
+    unsigned int best_x, best_y;
+    bool found_legal = costmap_2d::findNearestCell(*costmap, planner_->potarr, POT_HIGH, wx, wy, tolerance,
+                                                   best_x, best_y);
 
-    while(p.pose.position.y <= goal.pose.position.y + tolerance){
-      p.pose.position.x = goal.pose.position.x - tolerance;
-      while(p.pose.position.x <= goal.pose.position.x + tolerance){
-        double potential = getPointPotential(p.pose.position);
-        double sdist = sq_distance(p, goal);
-        if(potential < POT_HIGH && sdist < best_sdist){
-          best_sdist = sdist;
-          best_pose = p;
-          found_legal = true;
-        }
-        p.pose.position.x += resolution;
-      }
-      p.pose.position.y += resolution;
-    }
+    //keep the exact goal if its own cell was reached
+    geometry_msgs::PoseStamped best_pose = goal;
+    if(found_legal && (best_x != (unsigned int)map_goal[0] || best_y != (unsigned int)map_goal[1] || !goal_on_map))
+      costmap->mapToWorld(best_x, best_y, best_pose.pose.position.x, best_pose.pose.position.y);
 
     if(found_legal){
       //extract the plan
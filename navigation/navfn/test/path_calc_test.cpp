@@ -153,6 +153,66 @@ TEST(PathCalc, easy_nav_should_always_work)
   EXPECT_TRUE( nav->calcNavFnDijkstra( true ));
 }
 
+TEST(PathCalc, parallel_propagation_matches_serial)
+{
+  navfn::NavFn* serial = make_willow_nav();
+  navfn::NavFn* parallel = make_willow_nav();
+  ASSERT_TRUE( serial != NULL );
+  ASSERT_TRUE( parallel != NULL );
+  parallel->setNumThreads( 4 );
+
+  int goal[2];
+  int start[2];
+
+  start[0] = 428;
+  start[1] = 746;
+
+  goal[0] = 350;
+  goal[1] = 450;
+
+  serial->setGoal( goal );
+  serial->setStart( start );
+  parallel->setGoal( goal );
+  parallel->setStart( start );
+
+  // plans agree
+  EXPECT_TRUE( serial->calcNavFnDijkstra( true ));
+  EXPECT_TRUE( parallel->calcNavFnDijkstra( true ));
+  int start_cell = start[1] * serial->nx + start[0];
+  EXPECT_NEAR( serial->potarr[ start_cell ], parallel->potarr[ start_cell ], 0.01 * serial->potarr[ start_cell ] );
+  EXPECT_NEAR( serial->npath, parallel->npath, 0.05 * serial->npath );
+
+  // full fields have the same reachable set, potentials within 5%
+  EXPECT_TRUE( serial->calcNavFnDijkstra( false ));
+  EXPECT_TRUE( parallel->calcNavFnDijkstra( false ));
+  int reached = 0;
+  for( int i = 0; i < serial->ns; i++ )
+  {
+    float ps = serial->potarr[ i ];
+    float pp = parallel->potarr[ i ];
+    ASSERT_EQ( ps < POT_HIGH, pp < POT_HIGH ) << "cell " << i;
+    if( ps < POT_HIGH )
+    {
+      EXPECT_NEAR( ps, pp, 0.05 * ps + 1.0 ) << "cell " << i;
+      reached++;
+    }
+  }
+  EXPECT_GT( reached, 0 );
+
+  // the thread count only changes scheduling, not the result
+  navfn::NavFn* parallel2 = make_willow_nav();
+  ASSERT_TRUE( parallel2 != NULL );
+  parallel2->setNumThreads( 3 );
+  parallel2->setGoal( goal );
+  parallel2->setStart( start );
+  EXPECT_TRUE( parallel2->calcNavFnDijkstra( false ));
+  EXPECT_EQ( 0, memcmp( parallel->potarr, parallel2->potarr, parallel->ns * sizeof(float) ));
+
+  delete serial;
+  delete parallel;
+  delete parallel2;
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);